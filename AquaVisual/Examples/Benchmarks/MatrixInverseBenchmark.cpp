@@ -0,0 +1,213 @@
+#include "AquaVisual/Math.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <utility>
+#include <vector>
+
+using namespace AquaVisual;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t kMatrixCount = 10000;
+constexpr int kRepetitions = 100;
+
+// Largest accepted relative error. The general set is far less well
+// conditioned than the transforms, so it gets a looser limit.
+constexpr double kGeneralTolerance = 1e-4;
+constexpr double kTransformTolerance = 1e-5;
+
+// Gauss-Jordan elimination with partial pivoting in double precision, used
+// as the reference the float inverses are measured against
+bool ReferenceInverse(const Matrix4 &matrix, double out[4][4]) {
+  double a[4][8];
+  for (int row = 0; row < 4; row++) {
+    for (int col = 0; col < 4; col++) {
+      a[row][col] = matrix.m[col][row];
+      a[row][col + 4] = row == col ? 1.0 : 0.0;
+    }
+  }
+  for (int col = 0; col < 4; col++) {
+    int pivot = col;
+    for (int row = col + 1; row < 4; row++) {
+      if (std::abs(a[row][col]) > std::abs(a[pivot][col])) {
+        pivot = row;
+      }
+    }
+    if (a[pivot][col] == 0.0) {
+      return false;
+    }
+    for (int k = 0; k < 8; k++) {
+      std::swap(a[col][k], a[pivot][k]);
+    }
+    const double scale = 1.0 / a[col][col];
+    for (int k = 0; k < 8; k++) {
+      a[col][k] *= scale;
+    }
+    for (int row = 0; row < 4; row++) {
+      if (row == col) {
+        continue;
+      }
+      const double factor = a[row][col];
+      for (int k = 0; k < 8; k++) {
+        a[row][k] -= factor * a[col][k];
+      }
+    }
+  }
+  for (int row = 0; row < 4; row++) {
+    for (int col = 0; col < 4; col++) {
+      out[col][row] = a[row][col + 4];
+    }
+  }
+  return true;
+}
+
+// Random entries around a dominant diagonal so the set stays invertible
+std::vector<Matrix4> CreateGeneral(std::mt19937 &rng) {
+  std::uniform_real_distribution<float> entry(-1.0f, 1.0f);
+  std::vector<Matrix4> matrices(kMatrixCount);
+  for (Matrix4 &matrix : matrices) {
+    for (int col = 0; col < 4; col++) {
+      for (int row = 0; row < 4; row++) {
+        matrix.m[col][row] = entry(rng) + (row == col ? 2.0f : 0.0f);
+      }
+    }
+  }
+  return matrices;
+}
+
+// Translate * rotate * non-uniform scale, like a model matrix
+std::vector<Matrix4> CreateAffine(std::mt19937 &rng) {
+  std::uniform_real_distribution<float> angle(-Math::PI, Math::PI);
+  std::uniform_real_distribution<float> offset(-100.0f, 100.0f);
+  std::uniform_real_distribution<float> scale(0.5f, 2.0f);
+  std::vector<Matrix4> matrices(kMatrixCount);
+  for (Matrix4 &matrix : matrices) {
+    const Vector3 translation(offset(rng), offset(rng), offset(rng));
+    matrix = Matrix4::Translate(translation) *
+             Matrix4::RotateY(angle(rng)) * Matrix4::RotateX(angle(rng)) *
+             Matrix4::Scale(Vector3(scale(rng), scale(rng), scale(rng)));
+  }
+  return matrices;
+}
+
+// Rotation plus translation, like a view matrix
+std::vector<Matrix4> CreateRigid(std::mt19937 &rng) {
+  std::uniform_real_distribution<float> angle(-Math::PI, Math::PI);
+  std::uniform_real_distribution<float> offset(-100.0f, 100.0f);
+  std::vector<Matrix4> matrices(kMatrixCount);
+  for (Matrix4 &matrix : matrices) {
+    const Vector3 translation(offset(rng), offset(rng), offset(rng));
+    matrix = Matrix4::Translate(translation) *
+             Matrix4::RotateZ(angle(rng)) * Matrix4::RotateY(angle(rng)) *
+             Matrix4::RotateX(angle(rng));
+  }
+  return matrices;
+}
+
+// Largest element error relative to the largest reference element, so
+// translations of 100 don't drown out the rotation part
+template <typename Invert>
+void MeasureAccuracy(const std::vector<Matrix4> &matrices, Invert invert,
+                     double &maxError, double &meanError) {
+  maxError = 0.0;
+  double sum = 0.0;
+  size_t count = 0;
+  for (const Matrix4 &matrix : matrices) {
+    double reference[4][4];
+    if (!ReferenceInverse(matrix, reference)) {
+      continue;
+    }
+    const Matrix4 inverse = invert(matrix);
+    double magnitude = 0.0;
+    double error = 0.0;
+    for (int col = 0; col < 4; col++) {
+      for (int row = 0; row < 4; row++) {
+        magnitude = std::max(magnitude, std::abs(reference[col][row]));
+        error = std::max(error, std::abs(inverse.m[col][row] -
+                                         reference[col][row]));
+      }
+    }
+    error /= magnitude;
+    maxError = std::max(maxError, error);
+    sum += error;
+    count++;
+  }
+  meanError = count > 0 ? sum / count : 0.0;
+}
+
+// Nanoseconds per inverse; the checksum keeps the loop from being dropped
+template <typename Invert>
+double MeasureTime(const std::vector<Matrix4> &matrices, Invert invert,
+                   float &checksum) {
+  const auto start = Clock::now();
+  for (int repetition = 0; repetition < kRepetitions; repetition++) {
+    for (const Matrix4 &matrix : matrices) {
+      checksum += invert(matrix).m[3][0];
+    }
+  }
+  const std::chrono::duration<double, std::nano> elapsed =
+      Clock::now() - start;
+  return elapsed.count() / (static_cast<double>(matrices.size()) *
+                            kRepetitions);
+}
+
+// Returns false when the max error exceeds tolerance
+template <typename Invert>
+bool Report(const char *name, const std::vector<Matrix4> &matrices,
+            Invert invert, double tolerance, float &checksum) {
+  double maxError = 0.0;
+  double meanError = 0.0;
+  MeasureAccuracy(matrices, invert, maxError, meanError);
+  const double nanoseconds = MeasureTime(matrices, invert, checksum);
+  const bool passed = maxError <= tolerance;
+  std::printf("%-24s %12.3e %12.3e %10.0e %10.2f %s\n", name, maxError,
+              meanError, tolerance, nanoseconds, passed ? "ok" : "FAIL");
+  return passed;
+}
+
+} // namespace
+
+int main() {
+  std::printf("=== AquaVisual Matrix Inverse Benchmark ===\n");
+  std::printf("%zu matrices per set, errors relative to a double precision "
+              "reference\n\n",
+              kMatrixCount);
+  std::printf("%-24s %12s %12s %10s %10s\n", "method / set", "max error",
+              "mean error", "tolerance", "ns/op");
+
+  std::mt19937 rng(42);
+  const std::vector<Matrix4> general = CreateGeneral(rng);
+  const std::vector<Matrix4> affine = CreateAffine(rng);
+  const std::vector<Matrix4> rigid = CreateRigid(rng);
+
+  const auto inverse = [](const Matrix4 &m) { return m.Inverse(); };
+  const auto inverseAffine = [](const Matrix4 &m) { return m.InverseAffine(); };
+  const auto inverseRigid = [](const Matrix4 &m) { return m.InverseRigid(); };
+
+  float checksum = 0.0f;
+  bool passed = true;
+  passed &= Report("Inverse / general", general, inverse, kGeneralTolerance,
+                   checksum);
+  passed &= Report("Inverse / affine", affine, inverse, kTransformTolerance,
+                   checksum);
+  passed &= Report("InverseAffine / affine", affine, inverseAffine,
+                   kTransformTolerance, checksum);
+  passed &= Report("Inverse / rigid", rigid, inverse, kTransformTolerance,
+                   checksum);
+  passed &= Report("InverseAffine / rigid", rigid, inverseAffine,
+                   kTransformTolerance, checksum);
+  passed &= Report("InverseRigid / rigid", rigid, inverseRigid,
+                   kTransformTolerance, checksum);
+
+  std::printf("\nchecksum %g\n", checksum);
+  if (!passed) {
+    std::printf("accuracy check FAILED\n");
+    return 1;
+  }
+  return 0;
+}
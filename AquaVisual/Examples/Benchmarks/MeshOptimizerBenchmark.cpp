@@ -0,0 +1,99 @@
+#include "AquaVisual/Math.h"
+#include "AquaVisual/Resources/MeshOptimizer.h"
+#include "AquaVisual/Resources/ObjLoader.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <utility>
+#include <vector>
+
+using namespace AquaVisual;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Row by row grid bent into a sphere, the order most generators produce
+Mesh CreateGridSphere(int segments) {
+  std::vector<Vertex> vertices;
+  std::vector<uint32_t> indices;
+  for (int lat = 0; lat <= segments; ++lat) {
+    const float theta = lat * Math::PI / segments;
+    for (int lon = 0; lon <= segments; ++lon) {
+      const float phi = lon * 2.0f * Math::PI / segments;
+      const Vector3 position(std::sin(theta) * std::cos(phi), std::cos(theta),
+                             std::sin(theta) * std::sin(phi));
+      vertices.emplace_back(position, position,
+                            Vector2(static_cast<float>(lon) / segments,
+                                    static_cast<float>(lat) / segments));
+    }
+  }
+  for (int lat = 0; lat < segments; ++lat) {
+    for (int lon = 0; lon < segments; ++lon) {
+      const uint32_t current = lat * (segments + 1) + lon;
+      const uint32_t next = current + segments + 1;
+      indices.insert(indices.end(), {current, next, current + 1, current + 1,
+                                     next, next + 1});
+    }
+  }
+  return Mesh(std::move(vertices), std::move(indices));
+}
+
+// Same triangles in random order, like a badly exported asset
+Mesh Shuffled(const Mesh &mesh) {
+  const std::vector<uint32_t> indices = mesh.GetIndices().ToVector();
+  std::vector<uint32_t> order(indices.size() / 3);
+  for (size_t i = 0; i < order.size(); i++) {
+    order[i] = static_cast<uint32_t>(i);
+  }
+  std::shuffle(order.begin(), order.end(), std::mt19937(42));
+  std::vector<uint32_t> shuffled;
+  shuffled.reserve(indices.size());
+  for (uint32_t triangle : order) {
+    shuffled.insert(shuffled.end(), indices.begin() + triangle * 3,
+                    indices.begin() + triangle * 3 + 3);
+  }
+  Mesh result(mesh);
+  result.SetIndices(shuffled);
+  return result;
+}
+
+void Run(const char *name, Mesh mesh) {
+  const Clock::time_point start = Clock::now();
+  const MeshOptimizer::Report report = MeshOptimizer::Optimize(mesh);
+  const double ms =
+      std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+  std::printf("%-24s %9zu %7.3f %7.3f %7.3f %7.3f %10.1f\n", name,
+              mesh.GetIndexCount() / 3, report.before.acmr, report.after.acmr,
+              report.before.atvr, report.after.atvr, ms);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  std::printf("=== AquaVisual Mesh Optimizer Benchmark ===\n");
+  std::printf("FIFO cache of %u vertices; pass an OBJ path to add a mesh\n\n",
+              MeshOptimizer::DEFAULT_CACHE_SIZE);
+  std::printf("%-24s %9s %7s %7s %7s %7s %10s\n", "mesh", "triangles",
+              "ACMR", "-> ACMR", "ATVR", "-> ATVR", "ms");
+
+  for (int segments : {32, 128, 512}) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "sphere %d", segments);
+    Mesh sphere = CreateGridSphere(segments);
+    Run(name, sphere);
+    std::snprintf(name, sizeof(name), "sphere %d shuffled", segments);
+    Run(name, Shuffled(sphere));
+  }
+
+  for (int i = 1; i < argc; i++) {
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    if (ObjLoader::Load(argv[i], vertices, indices)) {
+      Run(argv[i], Mesh(std::move(vertices), std::move(indices)));
+    }
+  }
+  return 0;
+}
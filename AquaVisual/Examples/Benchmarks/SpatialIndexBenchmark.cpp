@@ -0,0 +1,180 @@
+#include "AquaVisual/Core/DynamicBVH.h"
+#include "AquaVisual/Core/LooseOctree.h"
+#include "AquaVisual/Core/SpatialHashGrid.h"
+#include "AquaVisual/Math.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace AquaVisual;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int FRAME_COUNT = 30;
+constexpr int BOX_QUERIES_PER_FRAME = 256;
+constexpr int RAYS_PER_FRAME = 64;
+
+struct SceneObject {
+  AABB bounds;
+  Vector3 velocity;
+};
+
+struct Result {
+  double insertMs = 0.0;
+  double updateMs = 0.0;  // per frame
+  double frustumMs = 0.0; // per frame
+  double boxMs = 0.0;     // per frame, all box queries
+  double rayMs = 0.0;     // per frame, all rays
+  size_t hits = 0;        // keeps the queries from being optimized out
+};
+
+double Elapsed(Clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start)
+      .count();
+}
+
+// Objects of mostly similar size with a few large ones, spread so density
+// stays the same whatever the count
+std::vector<SceneObject> CreateObjects(size_t count, float worldHalfSize,
+                                       uint32_t seed) {
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<float> position(-worldHalfSize,
+                                                 worldHalfSize);
+  std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+  std::uniform_real_distribution<float> direction(-1.0f, 1.0f);
+
+  std::vector<SceneObject> objects(count);
+  for (SceneObject &object : objects) {
+    const float size =
+        unit(rng) < 0.02f ? 4.0f + 12.0f * unit(rng) : 0.25f + unit(rng);
+    object.bounds = AABB::FromCenterExtents(
+        Vector3(position(rng), position(rng), position(rng)),
+        Vector3(size, size, size));
+    object.velocity =
+        Vector3(direction(rng), direction(rng), direction(rng)) * 4.0f;
+  }
+  return objects;
+}
+
+Result Run(SpatialIndex &index, std::vector<SceneObject> objects,
+           float motionRate, float worldHalfSize) {
+  Result result;
+  std::mt19937 rng(1234);
+  std::uniform_real_distribution<float> position(-worldHalfSize,
+                                                 worldHalfSize);
+  std::uniform_real_distribution<float> direction(-1.0f, 1.0f);
+  std::vector<int32_t> proxies(objects.size());
+  std::vector<void *> hits;
+
+  Clock::time_point start = Clock::now();
+  for (size_t i = 0; i < objects.size(); i++) {
+    proxies[i] = index.Insert(objects[i].bounds, &objects[i]);
+  }
+  result.insertMs = Elapsed(start);
+
+  const size_t movingCount = static_cast<size_t>(motionRate * objects.size());
+  const float deltaTime = 1.0f / 60.0f;
+  const Matrix4 projection = Matrix4::Perspective(
+      60.0f * Math::PI / 180.0f, 16.0f / 9.0f, 0.1f, worldHalfSize);
+
+  for (int frame = 0; frame < FRAME_COUNT; frame++) {
+    // The same leading objects move every frame
+    start = Clock::now();
+    for (size_t i = 0; i < movingCount; i++) {
+      SceneObject &object = objects[i];
+      const Vector3 step = object.velocity * deltaTime;
+      object.bounds = AABB(object.bounds.minimum + step,
+                           object.bounds.maximum + step);
+      index.Update(proxies[i], object.bounds, step);
+    }
+    result.updateMs += Elapsed(start);
+
+    const float angle = frame * 0.2f;
+    const Vector3 eye(std::cos(angle) * worldHalfSize * 0.5f, 0.0f,
+                      std::sin(angle) * worldHalfSize * 0.5f);
+    const Frustum frustum = Frustum::FromMatrix(
+        projection *
+        Matrix4::LookAt(eye, Vector3(0.0f), Vector3(0.0f, 1.0f, 0.0f)));
+    hits.clear();
+    start = Clock::now();
+    index.QueryFrustum(frustum, hits);
+    result.frustumMs += Elapsed(start);
+    result.hits += hits.size();
+
+    start = Clock::now();
+    for (int i = 0; i < BOX_QUERIES_PER_FRAME; i++) {
+      hits.clear();
+      const Vector3 center(position(rng), position(rng), position(rng));
+      index.QueryAABB(AABB::FromCenterExtents(center, Vector3(4.0f)), hits);
+      result.hits += hits.size();
+    }
+    result.boxMs += Elapsed(start);
+
+    start = Clock::now();
+    for (int i = 0; i < RAYS_PER_FRAME; i++) {
+      const Ray ray{Vector3(position(rng), position(rng), position(rng)),
+                    Vector3(direction(rng), direction(rng), direction(rng))
+                        .Normalize()};
+      result.hits += index.Raycast(ray, 2.0f * worldHalfSize) ? 1 : 0;
+    }
+    result.rayMs += Elapsed(start);
+  }
+
+  result.updateMs /= FRAME_COUNT;
+  result.frustumMs /= FRAME_COUNT;
+  result.boxMs /= FRAME_COUNT;
+  result.rayMs /= FRAME_COUNT;
+  return result;
+}
+
+} // namespace
+
+int main() {
+  std::printf("=== AquaVisual Spatial Index Benchmark ===\n");
+  std::printf("%d frames; %d box queries and %d rays per frame\n\n",
+              FRAME_COUNT, BOX_QUERIES_PER_FRAME, RAYS_PER_FRAME);
+
+  struct IndexType {
+    const char *name;
+    std::function<std::unique_ptr<SpatialIndex>(float worldHalfSize)> create;
+  };
+  const IndexType indexTypes[] = {
+      {"DynamicBVH", [](float) { return std::make_unique<DynamicBVH>(); }},
+      {"SpatialHashGrid",
+       [](float) { return std::make_unique<SpatialHashGrid>(4.0f); }},
+      {"LooseOctree",
+       [](float worldHalfSize) {
+         return std::make_unique<LooseOctree>(Vector3(0.0f), worldHalfSize);
+       }},
+  };
+  const size_t objectCounts[] = {1000, 10000, 100000};
+  const float motionRates[] = {0.0f, 0.1f, 1.0f};
+
+  std::printf("%-16s %8s %7s %10s %10s %10s %10s %10s\n", "index", "objects",
+              "moving", "insert ms", "update ms", "frustum ms", "boxes ms",
+              "rays ms");
+  for (size_t count : objectCounts) {
+    // About one object per 64 cubic units
+    const float worldHalfSize = 2.0f * std::cbrt(static_cast<float>(count));
+    const std::vector<SceneObject> objects =
+        CreateObjects(count, worldHalfSize, 42);
+    for (float motionRate : motionRates) {
+      for (const IndexType &type : indexTypes) {
+        std::unique_ptr<SpatialIndex> index = type.create(worldHalfSize);
+        const Result result = Run(*index, objects, motionRate, worldHalfSize);
+        std::printf("%-16s %8zu %6.0f%% %10.3f %10.3f %10.3f %10.3f %10.3f\n",
+                    type.name, count, motionRate * 100.0f, result.insertMs,
+                    result.updateMs, result.frustumMs, result.boxMs,
+                    result.rayMs);
+      }
+    }
+    std::printf("\n");
+  }
+  return 0;
+}
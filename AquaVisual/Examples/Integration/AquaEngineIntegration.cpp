@@ -247,8 +247,8 @@ private:
     m_time += deltaTime;
 
     // Rotate the cube
-    m_cubeTransform.rotation.y = m_time * m_rotationSpeed;
-    m_cubeTransform.rotation.x = m_time * m_rotationSpeed * 0.5f;
+    m_cubeTransform.SetEulerAngles(AquaVisual::Vector3(
+        m_time * m_rotationSpeed * 0.5f, m_time * m_rotationSpeed, 0.0f));
   }
 
   void Render() {
@@ -7,6 +7,7 @@
 
 #ifdef AQUA_HAS_VULKAN
 #include <vulkan/vulkan.h>
+#include "MemoryAllocator.h"
 #endif
 
 namespace AquaVisual {
@@ -23,7 +24,8 @@ enum class BufferType {
 enum BufferUsage {
     BUFFER_USAGE_STATIC = 0x01,   // Static data, rarely updated
     BUFFER_USAGE_DYNAMIC = 0x02,  // Dynamic data, frequently updated
-    BUFFER_USAGE_STREAM = 0x04    // Stream data, updated every frame
+    BUFFER_USAGE_STREAM = 0x04,   // Stream data, updated every frame
+    BUFFER_USAGE_PERSISTENT = 0x08 // Mapped once at creation, updates are a plain memcpy
 };
 
 // Buffer base class
@@ -44,6 +46,14 @@ public:
     // Memory mapping
     virtual void* Map() = 0;
     virtual void Unmap() = 0;
+
+    // Persistently mapped buffers stay mapped until destroyed. On non-coherent
+    // memory, CPU writes through Map() need Flush() and GPU writes need
+    // Invalidate() before they are read; UpdateData() flushes by itself.
+    static constexpr size_t WHOLE_SIZE = ~static_cast<size_t>(0);
+    virtual bool IsPersistentlyMapped() const { return false; }
+    virtual bool Flush(size_t /*size*/ = WHOLE_SIZE, size_t /*offset*/ = 0) { return true; }
+    virtual bool Invalidate(size_t /*size*/ = WHOLE_SIZE, size_t /*offset*/ = 0) { return true; }
     
     // Get information
     size_t GetSize() const { return m_size; }
@@ -57,6 +67,9 @@ protected:
 };
 
 // Vulkan buffer implementation
+// Static vertex and index buffers live in device-local memory and are written
+// through UploadManager; all other buffers are host-visible. Uniform buffers
+// and dynamic/stream/persistent buffers are mapped once at creation.
 class AQUA_API VulkanBuffer : public Buffer {
 public:
     VulkanBuffer();
@@ -67,10 +80,15 @@ public:
     bool UpdateData(const void* data, size_t size, size_t offset = 0) override;
     void* Map() override;
     void Unmap() override;
+    bool IsPersistentlyMapped() const override;
+    bool Flush(size_t size = WHOLE_SIZE, size_t offset = 0) override;
+    bool Invalidate(size_t size = WHOLE_SIZE, size_t offset = 0) override;
     
 #ifdef AQUA_HAS_VULKAN
     VkBuffer GetVulkanBuffer() const { return m_buffer; }
-    VkDeviceMemory GetVulkanMemory() const { return m_memory; }
+    VkDeviceMemory GetVulkanMemory() const { return m_allocation.memory; }
+    VkDeviceSize GetMemoryOffset() const { return m_allocation.offset; }
+    bool IsDeviceLocal() const { return m_deviceLocal; }
     
     // Vulkan specific methods
     bool CreateVulkanBuffer(VkDevice device, VkPhysicalDevice physicalDevice);
@@ -79,10 +97,11 @@ public:
 private:
     VkDevice m_device = VK_NULL_HANDLE;
     VkBuffer m_buffer = VK_NULL_HANDLE;
-    VkDeviceMemory m_memory = VK_NULL_HANDLE;
+    MemoryAllocation m_allocation;
     void* m_mappedData = nullptr;
-    
-    uint32_t FindMemoryType(VkPhysicalDevice physicalDevice, uint32_t typeFilter, VkMemoryPropertyFlags properties);
+    bool m_deviceLocal = false;
+    bool m_persistent = false;
+    bool m_coherent = true;
 #endif
 };
 
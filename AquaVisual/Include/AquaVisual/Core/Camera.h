@@ -1,7 +1,9 @@
 #pragma once
 
+#include "../Math/Geometry.h"
 #include "../Math/Matrix.h"
 #include "../Math/Vector.h"
+#include <cstdint>
 
 namespace AquaVisual {
 
@@ -43,7 +45,16 @@ public:
 
     const Matrix4& GetViewMatrix() const;
     const Matrix4& GetProjectionMatrix() const;
-    Matrix4 GetViewProjectionMatrix() const;
+    // Projection * view, its inverse (for unprojecting picking rays) and the
+    // world-space culling volume, rebuilt only after the camera changes
+    const Matrix4& GetViewProjectionMatrix() const;
+    const Matrix4& GetInverseViewProjectionMatrix() const;
+    const Frustum& GetFrustum() const;
+
+    // Bumped by every change to the view or projection. Values are unique
+    // across cameras, so a consumer can remember the last version it saw and
+    // skip work while it still matches.
+    uint64_t GetVersion() const { return m_version; }
 
     void LookAt(const Vector3& position, const Vector3& target, const Vector3& up);
     void Move(const Vector3& offset);
@@ -55,7 +66,8 @@ public:
     void Zoom(float factor);
 
 private:
-    void UpdateViewMatrix();
+    void MarkViewDirty();
+    void MarkProjectionDirty();
 
     Vector3 m_position;
     Vector3 m_target;
@@ -71,9 +83,16 @@ private:
 
     mutable Matrix4 m_viewMatrix;
     mutable Matrix4 m_projectionMatrix;
+    mutable Matrix4 m_viewProjectionMatrix;
+    mutable Matrix4 m_inverseViewProjectionMatrix;
+    mutable Frustum m_frustum;
 
     mutable bool m_viewMatrixDirty;
     mutable bool m_projectionMatrixDirty;
+    mutable bool m_viewProjectionDirty;
+    mutable bool m_inverseViewProjectionDirty;
+
+    uint64_t m_version;
 };
 
 } // namespace AquaVisual
\ No newline at end of file
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "SpatialIndex.h"
+#include <cstdint>
+#include <vector>
+
+namespace AquaVisual {
+
+// Incrementally updated bounding volume hierarchy over dynamic objects.
+//
+// Each object is a leaf proxy holding a fattened copy of its bounds, so small
+// movements leave the tree untouched; Update() only reinserts a proxy once it
+// leaves its fat box. Insertions pick the sibling by surface area heuristic
+// and the tree is kept balanced with rotations on the way back up.
+//
+// Queries walk a flattened copy of the tree: nodes stored depth first, 32
+// bytes each, with the index to skip to when a subtree is rejected, so
+// traversal is a forward scan without a stack. The copy is rebuilt lazily by
+// the first query after a change; queries are safe to run concurrently once
+// it exists, i.e. after Flatten() or any query.
+class AQUA_API DynamicBVH : public SpatialIndex {
+public:
+  static constexpr int32_t NULL_NODE = NULL_PROXY;
+
+  // Leaf bounds are grown by margin on every side
+  explicit DynamicBVH(float margin = 0.1f);
+
+  std::unique_ptr<SpatialIndex> Clone() const override;
+
+  int32_t Insert(const AABB &bounds, void *userData) override;
+  // Remove and Update ignore NULL_PROXY and ids that are not live leaves
+  void Remove(int32_t proxy) override;
+  // displacement stretches the fat box ahead of the object; returns true
+  // when the proxy had to be reinserted
+  bool Update(int32_t proxy, const AABB &bounds,
+              const Vector3 &displacement = Vector3(0.0f)) override;
+  void Clear() override;
+
+  void *GetUserData(int32_t proxy) const override {
+    return m_nodes[proxy].userData;
+  }
+  const AABB &GetFatBounds(int32_t proxy) const {
+    return m_nodes[proxy].bounds;
+  }
+  uint32_t GetProxyCount() const override { return m_proxyCount; }
+  // Longest root to leaf path, 0 for a single leaf
+  int32_t GetHeight() const;
+
+  // Queries test the fat bounds
+  void QueryFrustum(const Frustum &frustum,
+                    std::vector<void *> &results) const override;
+  void QueryAABB(const AABB &box, std::vector<void *> &results) const override;
+  void QuerySphere(const BoundingSphere &sphere,
+                   std::vector<void *> &results) const override;
+  void *Raycast(const Ray &ray, float maxDistance, const RayTest &test = {},
+                float *distance = nullptr) const override;
+
+  // Rebuild the flattened traversal copy now instead of on the next query
+  void Flatten() const;
+
+private:
+  struct Node {
+    AABB bounds;
+    void *userData = nullptr;
+    int32_t parent = NULL_NODE; // next free node while on the free list
+    int32_t child1 = NULL_NODE;
+    int32_t child2 = NULL_NODE;
+    int32_t height = 0; // 0 for leaves, -1 for free nodes
+
+    bool IsLeaf() const { return child1 == NULL_NODE; }
+  };
+
+  struct FlatNode {
+    AABB bounds;
+    uint32_t skip;  // first node after this subtree
+    int32_t proxy;  // leaf proxy, or NULL_NODE for internal nodes
+  };
+
+  bool IsLeafProxy(int32_t proxy) const;
+  int32_t AllocateNode();
+  void FreeNode(int32_t node);
+  void InsertLeaf(int32_t leaf);
+  void RemoveLeaf(int32_t leaf);
+  int32_t Balance(int32_t node);
+  // Recompute bounds and height from node up to the root
+  void Refit(int32_t node);
+  uint32_t FlattenNode(int32_t node) const;
+  void AppendLeaves(uint32_t begin, uint32_t end,
+                    std::vector<void *> &results) const;
+
+  std::vector<Node> m_nodes;
+  int32_t m_root = NULL_NODE;
+  int32_t m_freeList = NULL_NODE;
+  uint32_t m_proxyCount = 0;
+  float m_margin;
+
+  mutable std::vector<FlatNode> m_flat;
+  mutable bool m_flatDirty = true;
+};
+
+} // namespace AquaVisual
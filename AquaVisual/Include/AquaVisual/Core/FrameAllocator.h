@@ -0,0 +1,90 @@
+#pragma once
+
+#include "Common.h"
+#include "MemoryAllocator.h"
+#include <cstdint>
+
+#include <vulkan/vulkan.h>
+
+namespace AquaVisual {
+
+// Block of per-frame memory returned by FrameAllocator
+struct FrameAllocation {
+  void *data = nullptr;    // CPU write pointer
+  VkBuffer buffer = VK_NULL_HANDLE;
+  uint32_t offset = 0;     // dynamic offset into buffer
+  VkDeviceSize size = 0;
+
+  bool IsValid() const { return data != nullptr; }
+};
+
+// Frame allocator statistics
+struct FrameAllocatorStats {
+  VkDeviceSize frameSize = 0;
+  VkDeviceSize usedBytes = 0; // current frame
+  VkDeviceSize peakBytes = 0;
+  uint32_t allocations = 0;   // current frame
+  uint64_t overflows = 0;
+};
+
+// Per-frame bump allocator over one persistently mapped buffer.
+// The buffer is split into one region per frame in flight; BeginFrame()
+// rewinds the region of the frame being recorded, whose previous contents the
+// GPU has finished reading. Allocations are aligned for use as
+// UNIFORM_BUFFER_DYNAMIC / STORAGE_BUFFER_DYNAMIC descriptors, so a single
+// descriptor set per frame can address every block through its dynamic
+// offset. Blocks bound with a descriptor range of R bytes must be allocated
+// with at least R bytes. The buffer can also be bound as a per-instance
+// vertex stream or as an indirect draw command buffer.
+class AQUA_API FrameAllocator {
+public:
+  static constexpr VkDeviceSize DEFAULT_FRAME_SIZE = 4ull * 1024 * 1024;
+
+  FrameAllocator();
+  ~FrameAllocator();
+
+  bool Initialize(VkDevice device, VkPhysicalDevice physicalDevice,
+                  uint32_t framesInFlight,
+                  VkDeviceSize frameSize = DEFAULT_FRAME_SIZE);
+  void Shutdown();
+
+  // Start allocating from the region of the given frame slot. Call after
+  // waiting on the frame fence.
+  void BeginFrame(uint32_t frameIndex);
+
+  // Make this frame's writes visible to the device (non-coherent memory)
+  void EndFrame();
+
+  // Returns an invalid allocation when the frame region is exhausted
+  FrameAllocation Allocate(VkDeviceSize size);
+
+  // Allocate with the buffer offset a multiple of `alignment`, which need not
+  // be a power of two. Arrays of records aligned to their own size can be
+  // addressed by index from the start of the buffer (e.g. firstInstance).
+  // Not suitable for dynamic uniform offsets unless alignment is a multiple
+  // of GetAlignment().
+  FrameAllocation Allocate(VkDeviceSize size, VkDeviceSize alignment);
+
+  VkBuffer GetBuffer() const { return m_buffer; }
+  VkDeviceSize GetAlignment() const { return m_alignment; }
+  FrameAllocatorStats GetStats() const;
+
+private:
+  VkDevice m_device = VK_NULL_HANDLE;
+  VkBuffer m_buffer = VK_NULL_HANDLE;
+  MemoryAllocation m_allocation;
+  char *m_mapped = nullptr;
+  bool m_coherent = true;
+
+  VkDeviceSize m_alignment = 256;
+  VkDeviceSize m_frameSize = 0;
+  uint32_t m_framesInFlight = 0;
+
+  VkDeviceSize m_frameBegin = 0; // region of the current frame
+  VkDeviceSize m_frameOffset = 0;
+  uint32_t m_allocationCount = 0;
+  VkDeviceSize m_peakBytes = 0;
+  uint64_t m_overflows = 0;
+};
+
+} // namespace AquaVisual
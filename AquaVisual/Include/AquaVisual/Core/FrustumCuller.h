@@ -0,0 +1,54 @@
+#pragma once
+
+#include "../Math/Geometry.h"
+#include "Common.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace AquaVisual {
+
+// Culling statistics for the last Cull()
+struct CullingStats {
+  uint32_t tested = 0;
+  uint32_t visible = 0;
+  uint32_t culled = 0;
+};
+
+// CPU visibility test of many world-space boxes against one frustum.
+// Bounds live in one packed array, indexed like the caller's objects, so the
+// batched Frustum::CullAABBs can stream them. Cull() splits the array across
+// the JobSystem workers in runs of whole mask words, then compacts the
+// visible indices in ascending order for submission.
+class AQUA_API FrustumCuller {
+public:
+  // New entries are empty boxes, which are never visible
+  void Resize(size_t count);
+  void Clear();
+  size_t GetCount() const { return m_bounds.size(); }
+
+  void SetBounds(size_t index, const AABB &worldBounds) {
+    m_bounds[index] = worldBounds;
+  }
+  const AABB &GetBounds(size_t index) const { return m_bounds[index]; }
+  // Whole array, for filling bounds in bulk
+  AABB *GetBoundsData() { return m_bounds.data(); }
+
+  // Test every box and rebuild the visible list; returns the visible count
+  size_t Cull(const Frustum &frustum);
+
+  // Result of the last Cull()
+  const std::vector<uint32_t> &GetVisible() const { return m_visible; }
+  bool IsVisible(size_t index) const {
+    return (m_visibleMask[index / 32] >> (index % 32)) & 1u;
+  }
+  const CullingStats &GetStats() const { return m_stats; }
+
+private:
+  std::vector<AABB> m_bounds;
+  std::vector<uint32_t> m_visibleMask; // bit per box
+  std::vector<uint32_t> m_visible;
+  CullingStats m_stats;
+};
+
+} // namespace AquaVisual
@@ -0,0 +1,146 @@
+#pragma once
+
+#include "Common.h"
+#include "MemoryAllocator.h"
+#include "../Resources/Mesh.h"
+#include "../Resources/VertexPacking.h"
+#include <cstdint>
+#include <list>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+namespace AquaVisual {
+
+// Location of a mesh inside the shared geometry buffers, laid out to fill a
+// VkDrawIndexedIndirectCommand directly
+struct ArenaMesh {
+  uint32_t firstIndex = 0;
+  uint32_t indexCount = 0;
+  int32_t vertexOffset = 0;
+  uint32_t vertexCount = 0;
+  float boundingSphere[4] = {0.0f, 0.0f, 0.0f, 0.0f}; // mesh space, for culling
+  uint32_t lodCount = 0; // LOD index lists follow the base indices
+  uint32_t lodFirstIndex[Mesh::MAX_LODS] = {};
+  uint32_t lodIndexCount[Mesh::MAX_LODS] = {};
+  uint32_t allocatedIndices = 0; // base and LOD indices
+  uint64_t version = 0;
+  uint64_t lastUsedFrame = 0;
+};
+
+// Geometry arena statistics
+struct GeometryArenaStats {
+  size_t residentMeshes = 0;
+  uint64_t uploads = 0;
+  uint64_t evictions = 0;
+  uint64_t failedAllocations = 0; // meshes that did not fit
+  uint32_t usedVertices = 0;
+  uint32_t vertexCapacity = 0;
+  uint32_t usedIndices = 0;
+  uint32_t indexCapacity = 0;
+};
+
+// One device-local vertex buffer and one index buffer shared by all static
+// meshes, so a whole frame can be drawn with a single set of buffer binds and
+// indirect draws. Ranges are first-fit sub-allocated and coalesced on free;
+// meshes without indices get a sequential index range so every resident mesh
+// is drawable with vkCmdDrawIndexedIndirect. Entries follow the MeshCache
+// rules: keyed by Mesh::GetId(), re-uploaded when the version changes, least
+// recently used evicted when full, ranges recycled once frames in flight no
+// longer reference them. Vertices are stored in one VertexFormat; packed
+// positions are quantized within each mesh's bounds.
+class AQUA_API GeometryArena {
+public:
+  static constexpr VkDeviceSize DEFAULT_VERTEX_BYTES = 64ull * 1024 * 1024;
+  static constexpr VkDeviceSize DEFAULT_INDEX_BYTES = 32ull * 1024 * 1024;
+
+  GeometryArena();
+  ~GeometryArena();
+
+  bool Initialize(VkDevice device, VkPhysicalDevice physicalDevice,
+                  uint32_t framesInFlight,
+                  VkDeviceSize vertexBytes = DEFAULT_VERTEX_BYTES,
+                  VkDeviceSize indexBytes = DEFAULT_INDEX_BYTES,
+                  VertexFormat vertexFormat = VertexFormat::Float32);
+  void Shutdown();
+  bool IsInitialized() const { return m_device != VK_NULL_HANDLE; }
+
+  // Advance frame counter and recycle ranges no longer in use by the GPU.
+  // Call after waiting on the frame fence.
+  void BeginFrame();
+
+  // Get the arena range of a mesh, uploading it on first use or after a
+  // change. Returns nullptr when the mesh does not fit.
+  const ArenaMesh *Acquire(const Mesh &mesh);
+
+  bool Evict(uint64_t meshId);
+  void Clear();
+
+  VkBuffer GetVertexBuffer() const { return m_vertexBuffer; }
+  VkBuffer GetIndexBuffer() const { return m_indexBuffer; }
+  VertexFormat GetVertexFormat() const { return m_vertexFormat; }
+  GeometryArenaStats GetStats() const;
+
+private:
+  // First-fit allocator over [0, capacity) in elements
+  class RangeAllocator {
+  public:
+    void Reset(uint32_t capacity);
+    bool Allocate(uint32_t count, uint32_t &offset);
+    void Free(uint32_t offset, uint32_t count);
+    uint32_t GetCapacity() const { return m_capacity; }
+    uint32_t GetUsed() const { return m_used; }
+
+  private:
+    std::map<uint32_t, uint32_t> m_freeRanges; // offset -> count
+    uint32_t m_capacity = 0;
+    uint32_t m_used = 0;
+  };
+
+  struct Entry {
+    ArenaMesh data;
+    std::list<uint64_t>::iterator lruIt;
+  };
+
+  struct PendingRelease {
+    ArenaMesh data;
+    uint64_t releaseFrame;
+  };
+
+  bool CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage,
+                    VkBuffer &buffer, MemoryAllocation &allocation);
+  bool AllocateRanges(uint32_t vertexCount, uint32_t indexCount,
+                      ArenaMesh &out);
+  bool EvictLeastRecentlyUsed();
+  void EvictEntry(std::unordered_map<uint64_t, Entry>::iterator it);
+  void FreeRanges(const ArenaMesh &data);
+  static void ComputeBoundingSphere(const Mesh &mesh, ArenaMesh &out);
+  void ReleaseCompleted(bool force);
+
+  VkDevice m_device = VK_NULL_HANDLE;
+  uint32_t m_framesInFlight = 2;
+  VertexFormat m_vertexFormat = VertexFormat::Float32;
+
+  VkBuffer m_vertexBuffer = VK_NULL_HANDLE;
+  MemoryAllocation m_vertexAllocation;
+  VkBuffer m_indexBuffer = VK_NULL_HANDLE;
+  MemoryAllocation m_indexAllocation;
+
+  RangeAllocator m_vertexRanges;
+  RangeAllocator m_indexRanges;
+
+  std::unordered_map<uint64_t, Entry> m_entries;
+  std::list<uint64_t> m_lru; // front = most recently used
+  std::vector<PendingRelease> m_pendingReleases;
+  std::vector<uint32_t> m_sequentialIndices; // scratch for non-indexed meshes
+  std::vector<PackedVertex> m_packedVertices; // scratch for packed uploads
+
+  uint64_t m_frameNumber = 0;
+  uint64_t m_uploads = 0;
+  uint64_t m_evictions = 0;
+  uint64_t m_failedAllocations = 0;
+};
+
+} // namespace AquaVisual
@@ -0,0 +1,177 @@
+#pragma once
+
+#include "Common.h"
+#include "MemoryAllocator.h"
+#include <cstdint>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+namespace AquaVisual {
+
+class FrameAllocator;
+
+// One indirect draw to be culled, std430 layout of cull_instances.comp.
+// The bounding sphere is in mesh space; the shader transforms it by the
+// model matrix of every instance in the draw. Meshlet draws also carry the
+// meshlet's packed normal cone (see Meshlet) for a back-face test.
+struct CullCandidate {
+  float boundingSphere[4] = {0.0f, 0.0f, 0.0f, 0.0f}; // center, radius
+  uint32_t indexCount = 0;
+  uint32_t instanceCount = 0;
+  uint32_t firstIndex = 0;
+  int32_t vertexOffset = 0;
+  uint32_t firstInstance = 0;
+  uint32_t batch = 0;       // index of the draw count slot
+  uint32_t outputBase = 0;  // first output command of the batch
+  uint32_t cone = 0;        // packed normal cone, 0 skips the test
+};
+
+// GPU culling statistics
+struct GpuCullingStats {
+  uint32_t candidates = 0; // draws dispatched this frame
+  uint32_t batches = 0;
+  bool occlusion = false;  // Hi-Z test active this frame
+  // Results of the last frame the GPU finished with this frame slot
+  uint32_t completedCandidates = 0;
+  uint32_t completedVisible = 0;
+};
+
+// Compute-shader visibility culling for indirect draws. Candidates are tested
+// against the camera frustum and, optionally, against a hierarchical depth
+// pyramid built from the previous frame's depth buffer. Surviving draws are
+// written to a per-frame indirect argument buffer: compacted with one draw
+// count per batch when the device can draw with a GPU count, or in place
+// with instanceCount = 0 for culled draws otherwise. Draw counts live in
+// host-visible memory and are read back once the frame has completed, which
+// makes the stage observable on software implementations such as lavapipe.
+//
+// Bounds are the mesh's vertex bounds under each instance transform; vertex
+// shaders that displace geometry beyond them must not be culled this way.
+class AQUA_API GpuCuller {
+public:
+  static constexpr uint32_t MAX_BATCHES = 1024;
+  static constexpr uint32_t DEFAULT_MAX_DRAWS = 128 * 1024;
+
+  GpuCuller();
+  ~GpuCuller();
+
+  // frameBuffer is the frame allocator buffer holding candidates, instance
+  // data and parameters
+  bool Initialize(VkDevice device, VkPhysicalDevice physicalDevice,
+                  uint32_t framesInFlight, VkBuffer frameBuffer,
+                  uint32_t maxDraws = DEFAULT_MAX_DRAWS,
+                  bool enableOcclusion = true);
+  void Shutdown();
+  bool IsInitialized() const { return m_device != VK_NULL_HANDLE; }
+
+  // (Re)build the depth pyramid for a depth buffer. depthView must be a
+  // depth-aspect view of an image created with SAMPLED usage. Passing a null
+  // view disables the occlusion test. Call while the device is idle.
+  bool SetDepthSource(VkImage depthImage, VkImageView depthView,
+                      VkFormat depthFormat, uint32_t width, uint32_t height);
+
+  // Read back the results of the frame slot's previous use. Call after
+  // waiting on the frame fence.
+  void BeginFrame(uint32_t frameIndex);
+
+  // Write the candidates and record the culling dispatch. Must be recorded
+  // outside a render pass; draws may read the output once it returns true.
+  // compact selects the atomic compaction path used with a draw count.
+  // cameraPosition is the world space eye for the normal cone test.
+  bool Dispatch(VkCommandBuffer commandBuffer, FrameAllocator &allocator,
+                const std::vector<CullCandidate> &candidates,
+                uint32_t batchCount, const float viewProjection[16],
+                const float cameraPosition[3], bool compact);
+
+  // Build the depth pyramid from the frame's depth buffer after the render
+  // pass ended. The depth image is left in SHADER_READ_ONLY_OPTIMAL.
+  void BuildDepthPyramid(VkCommandBuffer commandBuffer,
+                         const float viewProjection[16]);
+
+  bool IsOcclusionEnabled() const { return m_depthView != VK_NULL_HANDLE; }
+  uint32_t GetMaxDraws() const { return m_maxDraws; }
+
+  // Output of the current frame: commands of a batch start at
+  // outputBase * sizeof(VkDrawIndexedIndirectCommand), its draw count at
+  // batch * sizeof(uint32_t)
+  VkBuffer GetCommandBuffer() const;
+  VkBuffer GetCountBuffer() const;
+
+  const GpuCullingStats &GetStats() const { return m_stats; }
+
+private:
+  // Shared with cull_instances.comp (std140)
+  struct CullParams {
+    float frustumPlanes[6][4];
+    float previousViewProjection[16];
+    float depthPyramidSize[4]; // width, height, levels, unused
+    float cameraPosition[4];   // xyz, unused
+    uint32_t candidateCount;
+    uint32_t flags;
+    uint32_t padding[2];
+  };
+
+  struct FrameResources {
+    VkBuffer commandBuffer = VK_NULL_HANDLE;
+    MemoryAllocation commandAllocation;
+    VkBuffer countBuffer = VK_NULL_HANDLE;
+    MemoryAllocation countAllocation;
+    const uint32_t *counts = nullptr; // mapped
+    VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+    uint32_t candidateCount = 0;
+    uint32_t batchCount = 0;
+  };
+
+  bool CreateFrameResources(VkBuffer frameBuffer);
+  bool CreateCullPipeline();
+  bool CreatePyramidPipeline();
+  bool CreatePyramid(uint32_t width, uint32_t height);
+  void DestroyPyramid();
+  void WritePyramidDescriptors();
+  void InitializePyramidLayout(VkCommandBuffer commandBuffer);
+  VkShaderModule LoadShader(const char *path);
+  static void ExtractFrustumPlanes(const float viewProjection[16],
+                                   float planes[6][4]);
+
+  VkDevice m_device = VK_NULL_HANDLE;
+  VkPhysicalDevice m_physicalDevice = VK_NULL_HANDLE;
+  uint32_t m_framesInFlight = 2;
+  uint32_t m_maxDraws = DEFAULT_MAX_DRAWS;
+  bool m_occlusionRequested = true;
+
+  // Culling pass
+  VkDescriptorSetLayout m_cullSetLayout = VK_NULL_HANDLE;
+  VkPipelineLayout m_cullPipelineLayout = VK_NULL_HANDLE;
+  VkPipeline m_cullPipeline = VK_NULL_HANDLE;
+  VkDescriptorPool m_cullDescriptorPool = VK_NULL_HANDLE;
+  std::vector<FrameResources> m_frames;
+  uint32_t m_frameIndex = 0;
+
+  // Depth pyramid, R32_SFLOAT with a full mip chain kept in GENERAL layout
+  VkDescriptorSetLayout m_pyramidSetLayout = VK_NULL_HANDLE;
+  VkPipelineLayout m_pyramidPipelineLayout = VK_NULL_HANDLE;
+  VkPipeline m_pyramidPipeline = VK_NULL_HANDLE;
+  VkDescriptorPool m_pyramidDescriptorPool = VK_NULL_HANDLE;
+  VkSampler m_sampler = VK_NULL_HANDLE;
+  VkImage m_pyramidImage = VK_NULL_HANDLE;
+  MemoryAllocation m_pyramidAllocation;
+  VkImageView m_pyramidView = VK_NULL_HANDLE; // all levels
+  std::vector<VkImageView> m_pyramidLevelViews;
+  std::vector<VkDescriptorSet> m_pyramidSets;
+  uint32_t m_pyramidWidth = 0;
+  uint32_t m_pyramidHeight = 0;
+  bool m_pyramidInitialized = false; // layout transitioned to GENERAL
+  bool m_pyramidValid = false;       // holds a built depth pyramid
+  float m_pyramidViewProjection[16] = {};
+
+  VkImage m_depthImage = VK_NULL_HANDLE;
+  VkImageView m_depthView = VK_NULL_HANDLE;
+  VkImageAspectFlags m_depthAspects = VK_IMAGE_ASPECT_DEPTH_BIT;
+  uint32_t m_depthWidth = 0;
+  uint32_t m_depthHeight = 0;
+
+  GpuCullingStats m_stats;
+};
+
+} // namespace AquaVisual
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "Common.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace AquaVisual {
+
+// Fixed pool of worker threads for data-parallel loops.
+// ParallelFor splits [0, count) into chunks that the workers and the calling
+// thread pull from a shared counter; it returns once every chunk has run.
+// Until Initialize() is called, and for loops too small to be worth waking
+// the workers, the body simply runs on the calling thread. Calls made from
+// inside a running body also run inline.
+class AQUA_API JobSystem {
+public:
+  static JobSystem &Instance();
+
+  // workerCount = 0 uses one thread per hardware core minus the caller
+  bool Initialize(uint32_t workerCount = 0);
+  void Shutdown();
+  bool IsInitialized() const { return !m_workers.empty(); }
+  uint32_t GetWorkerCount() const {
+    return static_cast<uint32_t>(m_workers.size());
+  }
+
+  // Run body(begin, end) over [0, count) in chunks of at least minChunk
+  // items
+  void ParallelFor(size_t count, size_t minChunk,
+                   const std::function<void(size_t, size_t)> &body);
+
+private:
+  JobSystem() = default;
+  ~JobSystem();
+  JobSystem(const JobSystem &) = delete;
+  JobSystem &operator=(const JobSystem &) = delete;
+
+  struct Loop {
+    const std::function<void(size_t, size_t)> *body = nullptr;
+    size_t count = 0;
+    size_t chunk = 0;
+    std::atomic<size_t> next{0};
+    std::atomic<size_t> remaining{0}; // chunks not yet finished
+    // Workers holding the loop, guarded by m_mutex
+    uint32_t activeWorkers = 0;
+  };
+
+  void WorkerMain();
+  void RunChunks(Loop &loop);
+
+  std::vector<std::thread> m_workers;
+  std::mutex m_mutex;
+  std::condition_variable m_wake;
+  std::condition_variable m_done;
+  std::mutex m_submitMutex; // one loop in flight at a time
+  Loop *m_loop = nullptr;
+  uint64_t m_generation = 0; // bumped for every submitted loop
+  bool m_stopping = false;
+};
+
+} // namespace AquaVisual
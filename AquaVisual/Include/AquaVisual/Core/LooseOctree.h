@@ -0,0 +1,96 @@
+#pragma once
+
+#include "SpatialIndex.h"
+#include <cstdint>
+#include <vector>
+
+namespace AquaVisual {
+
+// Octree whose node bounds are twice the size of the cube they subdivide, so
+// every object fits in exactly one node: the deepest one whose cube contains
+// its center and whose size is at least the object's. Large objects stay near
+// the root and small ones sink, which keeps mixed sizes cheap to query.
+//
+// Updates that keep an object in the same node only rewrite its bounds.
+// Nodes are created on demand and freed once empty. Objects centered outside
+// the root cube are kept in the root and tested by every query.
+class AQUA_API LooseOctree : public SpatialIndex {
+public:
+  // center and halfSize describe the cube the tree subdivides
+  explicit LooseOctree(const Vector3 &center = Vector3(0.0f),
+                       float halfSize = 1024.0f, int maxDepth = 8);
+
+  std::unique_ptr<SpatialIndex> Clone() const override;
+
+  int32_t Insert(const AABB &bounds, void *userData) override;
+  void Remove(int32_t proxy) override;
+  bool Update(int32_t proxy, const AABB &bounds,
+              const Vector3 &displacement = Vector3(0.0f)) override;
+  void Clear() override;
+
+  uint32_t GetProxyCount() const override { return m_proxyCount; }
+  void *GetUserData(int32_t proxy) const override {
+    return m_proxies[proxy].userData;
+  }
+  size_t GetNodeCount() const { return m_nodes.size() - m_freeNodes.size(); }
+
+  void QueryFrustum(const Frustum &frustum,
+                    std::vector<void *> &results) const override;
+  void QueryAABB(const AABB &box, std::vector<void *> &results) const override;
+  void QuerySphere(const BoundingSphere &sphere,
+                   std::vector<void *> &results) const override;
+  void *Raycast(const Ray &ray, float maxDistance, const RayTest &test = {},
+                float *distance = nullptr) const override;
+
+private:
+  static constexpr int32_t NULL_NODE = -1;
+  static constexpr int32_t ROOT = 0;
+
+  struct Proxy {
+    AABB bounds;
+    void *userData = nullptr;
+    int32_t node = NULL_NODE;
+    uint32_t slot = 0;             // position in the node's list
+    int32_t nextFree = NULL_PROXY; // while on the free list
+  };
+
+  struct Node {
+    Vector3 center;
+    float halfSize = 0.0f;
+    int32_t depth = 0;
+    int32_t parent = NULL_NODE;
+    int32_t children[8] = {NULL_NODE, NULL_NODE, NULL_NODE, NULL_NODE,
+                           NULL_NODE, NULL_NODE, NULL_NODE, NULL_NODE};
+    std::vector<int32_t> proxies;
+
+    bool HasChildren() const;
+    // Twice the cube, the most any object placed here can reach
+    AABB GetLooseBounds() const {
+      const Vector3 reach(2.0f * halfSize);
+      return AABB(center - reach, center + reach);
+    }
+  };
+
+  // Node the bounds belong in; with create false returns NULL_NODE when
+  // that node does not exist yet
+  int32_t FindNode(const AABB &bounds, bool create);
+  int32_t AllocateNode(int32_t parent, int octant);
+  void Link(int32_t proxy, int32_t node);
+  void Unlink(int32_t proxy);
+  void AppendSubtree(int32_t node, std::vector<void *> &results) const;
+
+  // Depth first walk calling visit(node) on every node whose loose bounds
+  // pass accept; the root is always visited
+  template <typename Accept, typename Visitor>
+  void Traverse(Accept &&accept, Visitor &&visit) const;
+
+  std::vector<Proxy> m_proxies;
+  int32_t m_freeList = NULL_PROXY;
+  uint32_t m_proxyCount = 0;
+
+  std::vector<Node> m_nodes;
+  std::vector<int32_t> m_freeNodes;
+  int m_maxDepth;
+};
+
+} // namespace AquaVisual
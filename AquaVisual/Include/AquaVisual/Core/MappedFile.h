@@ -0,0 +1,38 @@
+#pragma once
+
+#include "Common.h"
+#include <cstddef>
+#include <string>
+
+namespace AquaVisual {
+
+// Read-only memory mapping of a whole file. Pages are loaded by the OS on
+// first touch, so large files can be parsed in place, from several threads,
+// without reading them into a buffer first.
+class AQUA_API MappedFile {
+public:
+  MappedFile() = default;
+  ~MappedFile();
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  // Replaces any open mapping; an empty file opens with a null data pointer
+  bool Open(const std::string &path);
+  void Close();
+
+  bool IsOpen() const { return m_open; }
+  const char *GetData() const { return m_data; }
+  size_t GetSize() const { return m_size; }
+
+private:
+  const char *m_data = nullptr;
+  size_t m_size = 0;
+  bool m_open = false;
+#ifdef _WIN32
+  void *m_file = nullptr;
+  void *m_mapping = nullptr;
+#endif
+};
+
+} // namespace AquaVisual
@@ -0,0 +1,152 @@
+#pragma once
+
+#include "Common.h"
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+namespace AquaVisual {
+
+// Sub-allocation strategy of a memory pool
+enum class AllocationStrategy {
+  Buddy, // General purpose: power-of-two blocks, coalesced on free
+  Linear // Bump allocation: a block is reset once all its allocations are freed
+};
+
+// Resource kind, buffers and optimal-tiling images never share a block so
+// bufferImageGranularity does not have to be tracked per allocation
+enum class AllocationResource { Buffer, Image };
+
+class MemoryBlock;
+
+// Range of device memory handed out by MemoryAllocator
+struct MemoryAllocation {
+  VkDeviceMemory memory = VK_NULL_HANDLE;
+  VkDeviceSize offset = 0;
+  VkDeviceSize size = 0;
+  uint32_t memoryTypeIndex = UINT32_MAX;
+
+  // Internal bookkeeping
+  MemoryBlock *block = nullptr;
+  uint32_t order = 0;
+
+  bool IsValid() const { return memory != VK_NULL_HANDLE; }
+};
+
+// Allocator statistics
+struct MemoryAllocatorStats {
+  uint32_t deviceMemoryCount = 0; // live vkAllocateMemory objects
+  uint32_t maxDeviceMemoryCount = 0; // maxMemoryAllocationCount
+  uint32_t blockCount = 0;
+  uint32_t dedicatedCount = 0;
+  uint64_t allocationCount = 0; // live sub-allocations
+  uint64_t totalAllocations = 0;
+  uint64_t totalFrees = 0;
+  VkDeviceSize reservedBytes = 0; // device memory owned by the allocator
+  VkDeviceSize usedBytes = 0;     // bytes requested by live allocations
+};
+
+// Block-based GPU memory allocator.
+// Every buffer and image goes through this instead of calling
+// vkAllocateMemory directly, which keeps the number of device memory objects
+// far below maxMemoryAllocationCount. Each memory type has its own pools;
+// large requests get a dedicated allocation.
+class AQUA_API MemoryAllocator {
+public:
+  static MemoryAllocator &Instance();
+
+  static constexpr VkDeviceSize DEFAULT_BLOCK_SIZE = 64ull * 1024 * 1024;
+  static constexpr VkDeviceSize MIN_BUDDY_SIZE = 256;
+
+  bool Initialize(VkDevice device, VkPhysicalDevice physicalDevice);
+  void Shutdown();
+  bool IsInitialized() const { return m_device != VK_NULL_HANDLE; }
+
+  // Allocate memory satisfying the requirements. Memory types with all of
+  // `required` and `preferred` flags are tried first, then `required` only.
+  bool Allocate(const VkMemoryRequirements &requirements,
+                VkMemoryPropertyFlags required, MemoryAllocation &allocation,
+                AllocationResource resource = AllocationResource::Buffer,
+                AllocationStrategy strategy = AllocationStrategy::Buddy,
+                VkMemoryPropertyFlags preferred = 0);
+  void Free(MemoryAllocation &allocation);
+
+  // Allocate and bind memory for an existing resource
+  bool AllocateForBuffer(VkBuffer buffer, VkMemoryPropertyFlags required,
+                         MemoryAllocation &allocation,
+                         AllocationStrategy strategy = AllocationStrategy::Buddy,
+                         VkMemoryPropertyFlags preferred = 0);
+  bool AllocateForImage(VkImage image, VkMemoryPropertyFlags required,
+                        MemoryAllocation &allocation,
+                        VkMemoryPropertyFlags preferred = 0);
+
+  // Map host-visible memory. The owning block is mapped once and shared by
+  // all of its allocations; returns the address of this allocation.
+  void *Map(const MemoryAllocation &allocation);
+  void Unmap(const MemoryAllocation &allocation);
+
+  // Make CPU writes visible to the device / device writes visible to the CPU
+  // for a range of a mapped allocation. No-op on host-coherent memory; the
+  // range is widened to nonCoherentAtomSize.
+  bool Flush(const MemoryAllocation &allocation, VkDeviceSize offset = 0,
+             VkDeviceSize size = VK_WHOLE_SIZE);
+  bool Invalidate(const MemoryAllocation &allocation, VkDeviceSize offset = 0,
+                  VkDeviceSize size = VK_WHOLE_SIZE);
+  bool IsHostCoherent(const MemoryAllocation &allocation) const {
+    return (GetMemoryProperties(allocation) &
+            VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0;
+  }
+
+  VkMemoryPropertyFlags
+  GetMemoryProperties(const MemoryAllocation &allocation) const;
+  MemoryAllocatorStats GetStats() const;
+  void PrintStats() const;
+
+private:
+  MemoryAllocator();
+  ~MemoryAllocator();
+  MemoryAllocator(const MemoryAllocator &) = delete;
+  MemoryAllocator &operator=(const MemoryAllocator &) = delete;
+
+  struct MemoryPool;
+
+  uint32_t FindMemoryType(uint32_t typeFilter,
+                          VkMemoryPropertyFlags properties) const;
+  bool GetMappedRange(const MemoryAllocation &allocation, VkDeviceSize offset,
+                      VkDeviceSize size, VkMappedMemoryRange &range) const;
+  bool AllocateFromType(uint32_t memoryTypeIndex,
+                        const VkMemoryRequirements &requirements,
+                        AllocationResource resource,
+                        AllocationStrategy strategy,
+                        MemoryAllocation &allocation);
+  MemoryPool &GetPool(uint32_t memoryTypeIndex, AllocationResource resource,
+                      AllocationStrategy strategy);
+  VkDeviceSize GetBlockSize(uint32_t memoryTypeIndex) const;
+  MemoryBlock *CreateBlock(MemoryPool *pool, uint32_t memoryTypeIndex,
+                           VkDeviceSize size, AllocationStrategy strategy,
+                           bool dedicated);
+  void DestroyBlock(MemoryBlock *block);
+
+  VkDevice m_device = VK_NULL_HANDLE;
+  VkPhysicalDevice m_physicalDevice = VK_NULL_HANDLE;
+  VkPhysicalDeviceMemoryProperties m_memoryProperties{};
+  uint32_t m_maxAllocationCount = 0;
+  VkDeviceSize m_nonCoherentAtomSize = 1;
+
+  std::vector<std::unique_ptr<MemoryPool>> m_pools;
+  std::vector<std::unique_ptr<MemoryBlock>> m_dedicatedBlocks;
+
+  uint32_t m_deviceMemoryCount = 0;
+  uint64_t m_allocationCount = 0;
+  uint64_t m_totalAllocations = 0;
+  uint64_t m_totalFrees = 0;
+  VkDeviceSize m_reservedBytes = 0;
+  VkDeviceSize m_usedBytes = 0;
+
+  mutable std::mutex m_mutex;
+};
+
+} // namespace AquaVisual
@@ -0,0 +1,122 @@
+#pragma once
+
+#include "Common.h"
+#include "MemoryAllocator.h"
+#include "../Resources/Mesh.h"
+#include "../Resources/VertexPacking.h"
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+namespace AquaVisual {
+
+// GPU-resident copy of a mesh. LOD index lists follow the base indices in
+// the same index buffer.
+struct MeshGpuData {
+  VkBuffer vertexBuffer = VK_NULL_HANDLE;
+  MemoryAllocation vertexAllocation;
+  VkBuffer indexBuffer = VK_NULL_HANDLE;
+  MemoryAllocation indexAllocation;
+  uint32_t vertexCount = 0;
+  uint32_t indexCount = 0;
+  uint32_t lodCount = 0;
+  uint32_t lodFirstIndex[Mesh::MAX_LODS] = {};
+  uint32_t lodIndexCount[Mesh::MAX_LODS] = {};
+  VkDeviceSize sizeInBytes = 0;
+  uint64_t version = 0;
+  uint64_t lastUsedFrame = 0;
+};
+
+// Mesh cache statistics
+struct MeshCacheStats {
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  uint64_t uploads = 0;
+  uint64_t evictions = 0;
+  size_t residentMeshes = 0;
+  VkDeviceSize residentBytes = 0;
+  VkDeviceSize budgetBytes = 0;
+};
+
+// Keeps meshes resident in device-local memory across frames.
+// Entries are keyed by Mesh::GetId() and re-uploaded through UploadManager
+// when Mesh::GetVersion() changes. Least recently used entries are evicted when
+// the memory budget is exceeded; buffers still referenced by frames in flight
+// are destroyed only once those frames have completed. Vertices are uploaded
+// in the VertexFormat given at initialization.
+class AQUA_API MeshCache {
+public:
+  static constexpr VkDeviceSize DEFAULT_BUDGET = 256ull * 1024 * 1024;
+
+  MeshCache();
+  ~MeshCache();
+
+  bool Initialize(VkDevice device, VkPhysicalDevice physicalDevice,
+                  uint32_t framesInFlight,
+                  VkDeviceSize budget = DEFAULT_BUDGET,
+                  VertexFormat vertexFormat = VertexFormat::Float32);
+  void Shutdown();
+
+  // Advance frame counter and release buffers no longer in use by the GPU.
+  // Call after waiting on the frame fence.
+  void BeginFrame();
+
+  // Get GPU buffers for a mesh, uploading it on first use or after a change
+  const MeshGpuData *Acquire(const Mesh &mesh);
+
+  // Explicit eviction
+  bool Evict(const Mesh &mesh);
+  bool Evict(uint64_t meshId);
+  void Clear();
+
+  // Memory budget
+  void SetMemoryBudget(VkDeviceSize budget);
+  VkDeviceSize GetMemoryBudget() const { return m_budget; }
+  VkDeviceSize GetMemoryUsage() const { return m_residentBytes; }
+
+  bool IsResident(const Mesh &mesh) const;
+  MeshCacheStats GetStats() const;
+
+private:
+  struct Entry {
+    MeshGpuData data;
+    std::list<uint64_t>::iterator lruIt;
+  };
+
+  struct PendingRelease {
+    MeshGpuData data;
+    uint64_t releaseFrame;
+  };
+
+  bool Upload(const Mesh &mesh, MeshGpuData &out);
+  bool CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage,
+                    VkBuffer &buffer, MemoryAllocation &allocation);
+
+  void EvictEntry(std::unordered_map<uint64_t, Entry>::iterator it);
+  void EnforceBudget();
+  void DestroyGpuData(MeshGpuData &data);
+  void ReleaseCompleted(bool force);
+
+  VkDevice m_device = VK_NULL_HANDLE;
+  uint32_t m_framesInFlight = 2;
+  VertexFormat m_vertexFormat = VertexFormat::Float32;
+
+  std::unordered_map<uint64_t, Entry> m_entries;
+  std::list<uint64_t> m_lru; // front = most recently used
+  std::vector<PendingRelease> m_pendingReleases;
+  std::vector<PackedVertex> m_packedVertices; // scratch for packed uploads
+
+  uint64_t m_frameNumber = 0;
+  VkDeviceSize m_budget = DEFAULT_BUDGET;
+  VkDeviceSize m_residentBytes = 0;
+
+  uint64_t m_hits = 0;
+  uint64_t m_misses = 0;
+  uint64_t m_uploads = 0;
+  uint64_t m_evictions = 0;
+};
+
+} // namespace AquaVisual
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "../Math/Geometry.h"
+#include "Common.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace AquaVisual {
+
+// Software occlusion culling on the CPU.
+//
+// A few large occluder meshes are rasterized, depth only, into a small depth
+// buffer; object bounds are then tested against it so objects hidden behind
+// walls or terrain are never submitted. Nothing is read back from the GPU.
+//
+// Each frame: BeginFrame(), AddOccluder() for every occluder, Rasterize(),
+// then any number of IsVisible() / CullAABBs() calls, which are safe to run
+// concurrently. AddOccluder() sets the triangles up and bins them into
+// screen tiles; Rasterize() renders the tiles in parallel on the JobSystem,
+// Simd::WIDTH pixels at a time, and reduces each 8x8 block to its farthest
+// depth so most tests never look at single pixels.
+//
+// Both sides err towards visible: occluders write the farthest depth their
+// plane reaches inside each covered pixel, triangles crossing the near plane
+// are dropped, boxes are tested over one extra pixel around their screen
+// rectangle, and boxes reaching in front of the near plane always pass.
+class AQUA_API OcclusionCuller {
+public:
+  static constexpr uint32_t TILE_WIDTH = 32;
+  static constexpr uint32_t TILE_HEIGHT = 16;
+  static constexpr uint32_t BLOCK_SIZE = 8;
+
+  // The buffer is rounded up to whole tiles
+  explicit OcclusionCuller(uint32_t width = 320, uint32_t height = 192);
+
+  void Resize(uint32_t width, uint32_t height);
+  uint32_t GetWidth() const { return m_width; }
+  uint32_t GetHeight() const { return m_height; }
+
+  // Clear the buffer and drop last frame's occluders
+  void BeginFrame(const Matrix4 &viewProjection);
+  // stride is the byte distance between consecutive positions, so vertex
+  // arrays can be passed without copying
+  void AddOccluder(const Vector3 *positions, size_t vertexCount,
+                   const uint32_t *indices, size_t indexCount,
+                   const Matrix4 &model, size_t stride = sizeof(Vector3));
+  void Rasterize();
+
+  // False only when the box is certainly hidden by the occluders
+  bool IsVisible(const AABB &bounds) const;
+  // Bit i of visibleMask (word i / 32) is set when boxes[i] is visible;
+  // returns the visible count
+  size_t CullAABBs(const AABB *boxes, size_t count,
+                   uint32_t *visibleMask) const;
+
+  uint32_t GetOccluderTriangleCount() const {
+    return static_cast<uint32_t>(m_triangles.size());
+  }
+  // Normalized device depth per pixel, rows from the bottom of the screen
+  const float *GetDepthBuffer() const { return m_depth.data(); }
+
+private:
+  // Edge functions and depth plane in pixel coordinates, oriented so the
+  // inside is where all three edges are non-negative
+  struct Triangle {
+    float edgeA[3], edgeB[3], edgeC[3];
+    float depthA, depthB, depthC;
+    float maxDepth;
+    int32_t minX, minY, maxX, maxY; // inclusive pixel bounds
+  };
+
+  void RasterizeTile(uint32_t tile);
+
+  uint32_t m_width = 0;
+  uint32_t m_height = 0;
+  uint32_t m_tilesX = 0;
+  uint32_t m_tilesY = 0;
+
+  Matrix4 m_viewProjection;
+  std::vector<Triangle> m_triangles;
+  std::vector<Vector4> m_clip; // scratch for AddOccluder
+  std::vector<std::vector<uint32_t>> m_bins; // triangle indices per tile
+  std::vector<float> m_depth;
+  std::vector<float> m_blockMaxDepth; // farthest depth per 8x8 block
+  bool m_empty = true;                // no occluder since BeginFrame
+};
+
+} // namespace AquaVisual
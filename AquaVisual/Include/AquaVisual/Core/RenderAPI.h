@@ -11,7 +11,7 @@ namespace AquaVisual {
 class Texture;
 class Shader;
 class Mesh;
-struct Transform;
+class Transform;
 struct Vector2;
 struct Vector3;
 class Matrix4;
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "Common.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace AquaVisual {
+
+class Mesh;
+
+// Render passes, drawn in this order
+enum class RenderPass : uint8_t {
+  Opaque = 0,
+  Transparent = 1,
+  Overlay = 2
+};
+
+// One queued draw. The mesh must stay alive until the queue is flushed.
+struct DrawItem {
+  uint64_t sortKey = 0;
+  const Mesh *mesh = nullptr;
+  uint32_t pipeline = 0;
+  uint32_t material = 0;
+  uint32_t dynamicOffset = 0; // per-object uniform block
+  uint32_t instanceOffset = 0; // byte offset of the instance data
+  uint32_t instanceCount = 1;
+  uint32_t lod = 0; // 0 for the full mesh, i + 1 for Mesh::GetLods()[i]
+  // Visible meshlet index ranges in a list kept by the backend; a count of
+  // 0 draws the whole LOD
+  uint32_t firstRange = 0;
+  uint32_t rangeCount = 0;
+};
+
+// Render queue statistics for the last flushed frame
+struct RenderQueueStats {
+  uint32_t submitted = 0;
+  uint32_t drawCalls = 0;
+  uint32_t indirectCommands = 0; // draws issued through indirect calls
+  uint32_t instances = 0;
+  uint32_t pipelineBinds = 0;
+  uint32_t descriptorBinds = 0;
+  uint32_t vertexBufferBinds = 0;
+  uint32_t instanceBufferBinds = 0;
+  uint32_t indexBufferBinds = 0;
+  uint32_t culledClusters = 0; // meshlets rejected on the CPU
+};
+
+// Collects draws for a frame and orders them by a 64-bit sort key so the
+// backend can skip redundant state changes when recording.
+//
+// Key layout, most significant bits first:
+//   opaque / overlay : pass:4 | pipeline:10 | material:14 | mesh:16 | depth:20
+//   transparent      : pass:4 | ~depth:20 | pipeline:10 | material:14 | mesh:16
+// Opaque draws are grouped by state and go front to back inside a group;
+// transparent draws go back to front regardless of state.
+class AQUA_API RenderQueue {
+public:
+  static constexpr uint32_t PASS_BITS = 4;
+  static constexpr uint32_t PIPELINE_BITS = 10;
+  static constexpr uint32_t MATERIAL_BITS = 14;
+  static constexpr uint32_t MESH_BITS = 16;
+  static constexpr uint32_t DEPTH_BITS = 20;
+
+  // depth is the normalized view distance in [0, 1]; ids wider than their
+  // field are truncated, which only weakens grouping
+  static uint64_t MakeSortKey(RenderPass pass, uint32_t pipeline,
+                              uint32_t material, uint32_t mesh, float depth);
+
+  void Reserve(size_t count);
+  void Submit(const DrawItem &item);
+
+  // Radix sort the submitted draws by key. Draws with equal keys keep their
+  // submission order.
+  void Sort();
+
+  void Clear();
+
+  size_t Size() const { return m_items.size(); }
+  bool Empty() const { return m_items.empty(); }
+
+  // i-th draw in key order, valid after Sort()
+  const DrawItem &GetSorted(size_t index) const {
+    return m_items[m_order[index].index];
+  }
+
+  // Bind counters are filled in by the backend that records the queue
+  RenderQueueStats &GetStats() { return m_stats; }
+  const RenderQueueStats &GetStats() const { return m_stats; }
+
+private:
+  struct SortEntry {
+    uint64_t key;
+    uint32_t index;
+  };
+
+  std::vector<DrawItem> m_items;
+  std::vector<SortEntry> m_order;
+  std::vector<SortEntry> m_scratch;
+  RenderQueueStats m_stats;
+};
+
+} // namespace AquaVisual
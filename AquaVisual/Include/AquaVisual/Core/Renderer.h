@@ -8,6 +8,7 @@ namespace AquaVisual {
 
 class Window;
 class Camera;
+class Matrix4;
 class Mesh;
 class Texture;
 
@@ -19,6 +20,14 @@ enum class FrameRateMode {
   FPS_120
 };
 
+// Per-instance attributes for instanced draws
+struct InstanceData {
+  float modelMatrix[16] = {1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f,
+                           0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f};
+  float color[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+  float material[4] = {0.0f, 0.5f, 0.5f, 0.0f}; // metallic, roughness, specular
+};
+
 struct RendererConfig {
   uint32_t width = 800;
   uint32_t height = 600;
@@ -26,6 +35,18 @@ struct RendererConfig {
   bool enableValidation = true;
   bool enableVSync = true;
   uint32_t maxFramesInFlight = 2;
+  uint64_t meshCacheBudget = 256ull * 1024 * 1024; // GPU bytes for meshes
+  uint64_t stagingBufferSize = 16ull * 1024 * 1024; // upload ring bytes
+  uint64_t frameUniformSize = 4ull * 1024 * 1024; // per-frame uniform bytes
+  bool enableIndirectDraw = true; // shared geometry arena + indirect draws
+  uint64_t geometryArenaVertexBytes = 64ull * 1024 * 1024;
+  uint64_t geometryArenaIndexBytes = 32ull * 1024 * 1024;
+  bool enableGpuCulling = true; // compute frustum culling of arena draws
+  bool enableOcclusionCulling = true; // plus Hi-Z test with last frame's depth
+  uint32_t maxCulledDraws = 128 * 1024; // indirect commands per frame
+  float lodPixelError = 1.0f; // allowed LOD error on screen, 0 disables LOD
+  bool enableClusterCulling = true; // per-meshlet frustum and back-face tests
+  bool packedVertices = false; // 16-byte quantized vertices (VertexPacking)
 };
 
 class Renderer {
@@ -39,7 +60,22 @@ public:
   virtual bool BeginFrame() = 0;
   virtual void EndFrame() = 0;
   virtual void SetCamera(const Camera &camera) = 0;
+  // Draws may be queued until EndFrame, so the mesh must outlive the frame
   virtual void RenderMesh(const Mesh &mesh, const Texture *texture = nullptr) = 0;
+  // Draw with a per-object transform; renderers without per-object uniforms
+  // ignore the model matrix
+  virtual void RenderMesh(const Mesh &mesh, const Matrix4 &modelMatrix,
+                          const Texture *texture = nullptr) {
+    (void)modelMatrix;
+    RenderMesh(mesh, texture);
+  }
+  // Draw `count` copies of a mesh with one draw call. The instance data is
+  // copied, the array may be reused right away. Renderers without instancing
+  // fall back to one RenderMesh per instance.
+  virtual void RenderMeshInstanced(const Mesh &mesh,
+                                   const InstanceData *instances,
+                                   uint32_t count,
+                                   const Texture *texture = nullptr);
   virtual void Clear(float r = 0.0f, float g = 0.0f, float b = 0.0f, float a = 1.0f) = 0;
   virtual bool ShouldClose() const = 0;
   virtual void PollEvents() = 0;
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "SpatialIndex.h"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace AquaVisual {
+
+// Uniform grid over unbounded space, hashed so only occupied cells cost
+// memory. Each object lives in the one cell holding its center, which makes
+// updates O(1): moving within a cell only rewrites the bounds, crossing into
+// another is a swap-remove and an append. Objects at most half a cell across
+// stay inside their cell grown by half a cell on every side, which is the box
+// queries test; larger objects go to a separate list that every query scans.
+//
+// Box and sphere queries visit the cells under the query volume and rays
+// walk the cells they cross. Frustum queries scan the occupied cells, so they
+// are O(cells) rather than O(log n); prefer DynamicBVH for scenes that are
+// mostly queried.
+class AQUA_API SpatialHashGrid : public SpatialIndex {
+public:
+  // Around twice the typical object size works well
+  explicit SpatialHashGrid(float cellSize = 4.0f);
+
+  std::unique_ptr<SpatialIndex> Clone() const override;
+
+  int32_t Insert(const AABB &bounds, void *userData) override;
+  void Remove(int32_t proxy) override;
+  bool Update(int32_t proxy, const AABB &bounds,
+              const Vector3 &displacement = Vector3(0.0f)) override;
+  void Clear() override;
+
+  uint32_t GetProxyCount() const override { return m_proxyCount; }
+  void *GetUserData(int32_t proxy) const override {
+    return m_proxies[proxy].userData;
+  }
+  float GetCellSize() const { return m_cellSize; }
+  size_t GetOccupiedCellCount() const { return m_cells.size(); }
+
+  void QueryFrustum(const Frustum &frustum,
+                    std::vector<void *> &results) const override;
+  void QueryAABB(const AABB &box, std::vector<void *> &results) const override;
+  void QuerySphere(const BoundingSphere &sphere,
+                   std::vector<void *> &results) const override;
+  void *Raycast(const Ray &ray, float maxDistance, const RayTest &test = {},
+                float *distance = nullptr) const override;
+
+private:
+  // Key of the list holding objects too large for a cell
+  static constexpr uint64_t OVERSIZED = ~0ull;
+
+  struct Proxy {
+    AABB bounds;
+    void *userData = nullptr;
+    uint64_t cell = 0;
+    uint32_t slot = 0;             // position in the cell's list
+    int32_t nextFree = NULL_PROXY; // while on the free list
+  };
+
+  struct Cell {
+    int32_t x = 0, y = 0, z = 0;
+    std::vector<int32_t> proxies;
+  };
+
+  uint64_t CellFor(const AABB &bounds, int32_t cell[3]) const;
+  AABB GetLooseBounds(const Cell &cell) const;
+  void Link(int32_t proxy);
+  void Unlink(int32_t proxy);
+
+  // Visit every cell whose loose bounds can overlap box
+  template <typename Visitor>
+  void ForEachCell(const AABB &box, Visitor &&visit) const;
+
+  std::vector<Proxy> m_proxies;
+  int32_t m_freeList = NULL_PROXY;
+  uint32_t m_proxyCount = 0;
+
+  std::unordered_map<uint64_t, Cell> m_cells;
+  std::vector<int32_t> m_oversized;
+  // Range of cell coordinates ever occupied since the last Clear, bounds
+  // the cells a ray has to walk
+  int32_t m_cellMin[3] = {0, 0, 0};
+  int32_t m_cellMax[3] = {-1, -1, -1};
+
+  float m_cellSize;
+  float m_inverseCellSize;
+};
+
+} // namespace AquaVisual
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "../Math/Geometry.h"
+#include "Common.h"
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace AquaVisual {
+
+// Common interface of the scene spatial indexes. Each object is a proxy with
+// world bounds and an opaque user pointer.
+//
+// DynamicBVH      few moving objects, fastest queries
+// SpatialHashGrid many objects moving every frame, objects of similar size
+// LooseOctree     many moving objects of mixed sizes in a bounded world
+//
+// Queries may be conservative (an index can test looser bounds than the ones
+// given), report each proxy once and append results in no particular order.
+class AQUA_API SpatialIndex {
+public:
+  static constexpr int32_t NULL_PROXY = -1;
+
+  // Refines a hit on a proxy's bounds: return true and set distance when
+  // the object itself is hit closer than maxDistance
+  using RayTest =
+      std::function<bool(void *userData, float maxDistance, float &distance)>;
+
+  virtual ~SpatialIndex() = default;
+
+  virtual std::unique_ptr<SpatialIndex> Clone() const = 0;
+
+  // Returns the proxy id for Update and Remove
+  virtual int32_t Insert(const AABB &bounds, void *userData) = 0;
+  virtual void Remove(int32_t proxy) = 0;
+  // Move a proxy to new bounds; displacement is the expected movement before
+  // the next update, which indexes may use to avoid restructuring. Returns
+  // true when the index had to restructure.
+  virtual bool Update(int32_t proxy, const AABB &bounds,
+                      const Vector3 &displacement = Vector3(0.0f)) = 0;
+  virtual void Clear() = 0;
+
+  virtual uint32_t GetProxyCount() const = 0;
+  virtual void *GetUserData(int32_t proxy) const = 0;
+
+  virtual void QueryFrustum(const Frustum &frustum,
+                            std::vector<void *> &results) const = 0;
+  virtual void QueryAABB(const AABB &box,
+                         std::vector<void *> &results) const = 0;
+  virtual void QuerySphere(const BoundingSphere &sphere,
+                           std::vector<void *> &results) const = 0;
+  // Closest proxy hit within maxDistance, or nullptr. Without a test the
+  // proxy bounds themselves are the hit shapes.
+  virtual void *Raycast(const Ray &ray, float maxDistance,
+                        const RayTest &test = {},
+                        float *distance = nullptr) const = 0;
+};
+
+} // namespace AquaVisual
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "Common.h"
+#include "MemoryAllocator.h"
+#include <cstdint>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+namespace AquaVisual {
+
+// Upload statistics
+struct UploadManagerStats {
+  uint64_t uploadedBytes = 0;
+  uint64_t copyRegions = 0;
+  uint64_t submissions = 0;
+  uint64_t stalls = 0; // ring was full and the CPU had to wait
+  VkDeviceSize ringSize = 0;
+  bool dedicatedTransferQueue = false;
+};
+
+// Batched uploads into device-local buffers.
+// Data is written into a persistently mapped staging ring and the copies are
+// recorded in one command buffer per frame in flight, submitted by Flush()
+// right before the frame's graphics submission. When the device exposes a
+// transfer-only queue family the copies run there and the graphics submit
+// waits on the returned semaphore; destination buffers are then created with
+// concurrent sharing (see ApplySharingMode) so no ownership transfer is
+// needed.
+class AQUA_API UploadManager {
+public:
+  static UploadManager &Instance();
+
+  static constexpr VkDeviceSize DEFAULT_RING_SIZE = 16ull * 1024 * 1024;
+
+  bool Initialize(VkDevice device, VkPhysicalDevice physicalDevice,
+                  VkQueue graphicsQueue, uint32_t graphicsQueueFamily,
+                  VkQueue transferQueue, uint32_t transferQueueFamily,
+                  uint32_t framesInFlight,
+                  VkDeviceSize ringSize = DEFAULT_RING_SIZE);
+  void Shutdown();
+  bool IsInitialized() const { return m_device != VK_NULL_HANDLE; }
+
+  // Wait until the uploads last submitted for this frame slot have completed
+  // and reclaim their staging space
+  void BeginFrame(uint32_t frameIndex);
+
+  // Queue a copy of `size` bytes into `dstBuffer` at `dstOffset`. The data is
+  // copied into the staging ring immediately, so the caller may reuse it.
+  bool Upload(VkBuffer dstBuffer, const void *data, VkDeviceSize size,
+              VkDeviceSize dstOffset = 0);
+
+  // Drop queued copies targeting a buffer that is about to be destroyed
+  void Discard(VkBuffer dstBuffer);
+
+  // Submit queued copies. Returns a semaphore the graphics submission must
+  // wait on, or VK_NULL_HANDLE if none is needed.
+  VkSemaphore Flush();
+
+  // Submit queued copies and block until all uploads have completed
+  void FlushAndWait();
+
+  // Set sharing mode on buffers that are written by Upload()
+  void ApplySharingMode(VkBufferCreateInfo &createInfo) const;
+
+  bool HasDedicatedTransferQueue() const {
+    return m_transferQueueFamily != m_graphicsQueueFamily;
+  }
+  bool HasPendingUploads() const { return !m_pendingCopies.empty(); }
+  UploadManagerStats GetStats() const;
+
+private:
+  UploadManager() = default;
+  ~UploadManager() = default;
+  UploadManager(const UploadManager &) = delete;
+  UploadManager &operator=(const UploadManager &) = delete;
+
+  struct PendingCopy {
+    VkBuffer dstBuffer;
+    VkDeviceSize srcOffset;
+    VkDeviceSize dstOffset;
+    VkDeviceSize size;
+  };
+
+  struct FrameSlot {
+    VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+    VkFence fence = VK_NULL_HANDLE;
+    VkSemaphore semaphore = VK_NULL_HANDLE;
+    bool submitted = false;
+    uint64_t ringBegin = 0; // ring range read by the submitted copies
+    uint64_t ringEnd = 0;
+  };
+
+  bool Reserve(VkDeviceSize size, VkDeviceSize &offset);
+  bool Submit(FrameSlot &slot, bool signalSemaphore);
+  void RetireCompleted(bool wait);
+  uint64_t GetRingTail() const;
+
+  VkDevice m_device = VK_NULL_HANDLE;
+  VkQueue m_graphicsQueue = VK_NULL_HANDLE;
+  VkQueue m_transferQueue = VK_NULL_HANDLE;
+  uint32_t m_graphicsQueueFamily = UINT32_MAX;
+  uint32_t m_transferQueueFamily = UINT32_MAX;
+  uint32_t m_queueFamilies[2] = {UINT32_MAX, UINT32_MAX};
+  VkCommandPool m_commandPool = VK_NULL_HANDLE;
+
+  // Staging ring. Positions grow monotonically, the physical offset is
+  // position % m_ringSize.
+  VkBuffer m_ringBuffer = VK_NULL_HANDLE;
+  MemoryAllocation m_ringAllocation;
+  char *m_ringData = nullptr;
+  VkDeviceSize m_ringSize = 0;
+  uint64_t m_ringHead = 0;
+  uint64_t m_batchBegin = 0;
+
+  std::vector<FrameSlot> m_slots;
+  uint32_t m_frameIndex = 0;
+  std::vector<PendingCopy> m_pendingCopies;
+
+  uint64_t m_uploadedBytes = 0;
+  uint64_t m_copyRegions = 0;
+  uint64_t m_submissions = 0;
+  uint64_t m_stalls = 0;
+};
+
+} // namespace AquaVisual
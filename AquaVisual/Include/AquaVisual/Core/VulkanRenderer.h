@@ -1,9 +1,12 @@
 #pragma once
 
+#include "MemoryAllocator.h"
 #include "Renderer.h"
+#include "RenderQueue.h"
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <chrono>
 
@@ -17,8 +20,16 @@ namespace AquaVisual {
 
 // Forward declarations
 class Camera;
+class FrameAllocator;
+class GeometryArena;
+class GpuCuller;
+class Matrix4;
 class Mesh;
+class MeshCache;
 class Texture;
+struct CullCandidate;
+struct MeshGpuData;
+struct VertexQuantization;
 
 struct QueueFamilyIndices {
   uint32_t graphicsFamily = UINT32_MAX;
@@ -47,6 +58,11 @@ public:
   void EndFrame() override;
   void SetCamera(const Camera &camera) override;
   void RenderMesh(const Mesh &mesh, const Texture *texture = nullptr) override;
+  void RenderMesh(const Mesh &mesh, const Matrix4 &modelMatrix,
+                  const Texture *texture = nullptr) override;
+  void RenderMeshInstanced(const Mesh &mesh, const InstanceData *instances,
+                           uint32_t count,
+                           const Texture *texture = nullptr) override;
   void Clear(float r = 0.0f, float g = 0.0f, float b = 0.0f,
              float a = 1.0f) override;
   bool ShouldClose() const override;
@@ -57,6 +73,19 @@ public:
   // Configuration methods
   void SetConfig(const RendererConfig &config);
 
+  // GPU mesh residency cache (explicit eviction, budget, statistics)
+  MeshCache *GetMeshCache() const { return m_meshCache.get(); }
+
+  // Shared vertex/index buffers drawn with indirect commands; null when
+  // indirect drawing is disabled or unsupported
+  GeometryArena *GetGeometryArena() const { return m_geometryArena.get(); }
+
+  // Compute culling of indirect draws; null when disabled or unsupported
+  GpuCuller *GetGpuCuller() const { return m_gpuCuller.get(); }
+
+  // Draws queued for the current frame and bind statistics of the last flush
+  const RenderQueue &GetRenderQueue() const { return m_renderQueue; }
+
   // Internal initialization method
   bool Initialize(void *windowHandle);
 
@@ -85,18 +114,59 @@ public:
   bool HasStencilComponent(uint32_t format);
   bool CreateImage(uint32_t width, uint32_t height, uint32_t format,
                    uint32_t tiling, uint32_t usage, uint32_t properties,
-                   void *&image, void *&imageMemory);
+                   void *&image, MemoryAllocation &imageAllocation);
   void *CreateImageView(void *image, uint32_t format, uint32_t aspectFlags);
-  uint32_t FindMemoryType(uint32_t typeFilter, uint32_t properties);
 
   // Uniform buffer methods
   bool CreateUniformBuffers();
   bool CreateDescriptorSetLayout();
   bool CreateDescriptorPool();
   bool CreateDescriptorSets();
-  void UpdateUniformBuffer(uint32_t currentImage);
+  bool WriteObjectUniforms(const Matrix4 &modelMatrix,
+                           uint32_t &dynamicOffset,
+                           const VertexQuantization *quantization = nullptr);
+  bool AcquireUniformBlock(const Mesh &mesh, uint32_t &dynamicOffset);
+  uint32_t SelectLod(const Mesh &mesh, const InstanceData *instances,
+                     uint32_t count) const;
+  bool CullClusters(const Mesh &mesh, const InstanceData *instances,
+                    uint32_t count, DrawItem &item);
+  bool ClusterCullingOnGpu() const;
+  void QueueDraw(const Mesh &mesh, const InstanceData *instances,
+                 uint32_t instanceOffset, uint32_t instanceCount,
+                 const Texture *texture);
+
+  // Draws with more instances than this skip CPU cluster culling, the
+  // cost grows with meshlets times instances
+  static constexpr uint32_t MAX_CLUSTER_CULLED_INSTANCES = 16;
+
+  struct IndexRange {
+    uint32_t firstIndex = 0; // relative to the mesh's base indices
+    uint32_t indexCount = 0;
+  };
+
+  // Draws resolved before the render pass, recorded inside it
+  struct DrawOp {
+    uint32_t pipeline = 0;
+    uint32_t dynamicOffset = 0;
+    const Mesh *mesh = nullptr; // null for indirect batches
+    const MeshGpuData *gpuMesh = nullptr;
+    uint32_t firstIndex = 0; // index range of the selected LOD
+    uint32_t indexCount = 0;
+    uint32_t instanceOffset = 0;
+    uint32_t instanceCount = 0;
+    uint32_t firstCommand = 0; // range in m_indirectCommands
+    uint32_t commandCount = 0;
+    uint32_t batch = 0; // draw count slot of the culling pass
+  };
+
+  void BeginRenderPass(VkCommandBuffer commandBuffer);
+  void PrepareDraws(VkCommandBuffer commandBuffer);
+  void RecordDraws(VkCommandBuffer commandBuffer);
+  void RecordIndirectBatch(VkCommandBuffer commandBuffer,
+                           const DrawOp &op);
   bool CreateBuffer(uint64_t size, uint32_t usage, uint32_t properties,
-                    void *&buffer, void *&bufferMemory);
+                    void *&buffer, MemoryAllocation &bufferAllocation);
+  void DestroyBuffer(void *&buffer, MemoryAllocation &bufferAllocation);
 
   // Texture methods
   bool CreateTextureImage();
@@ -116,6 +186,10 @@ private:
   bool CreateCommandPool();
   bool CreateCommandBuffers();
   bool CreateSyncObjects();
+  bool CreateUploadManager();
+  bool CreateMeshCache();
+  bool CreateGeometryArena();
+  bool CreateGpuCuller();
 
   // Basic member variables
   std::unique_ptr<class Window> m_window;
@@ -126,6 +200,9 @@ private:
   void *m_device = nullptr;
   void *m_graphicsQueue = nullptr;
   void *m_presentQueue = nullptr;
+  uint32_t m_graphicsQueueFamily = UINT32_MAX;
+  void *m_transferQueue = nullptr; // null when there is no transfer-only family
+  uint32_t m_transferQueueFamily = UINT32_MAX;
   void *m_swapChain = nullptr;
   void *m_renderPass = nullptr;
 
@@ -140,7 +217,7 @@ private:
 
   // Depth buffer
   void *m_depthImage;
-  void *m_depthImageMemory;
+  MemoryAllocation m_depthImageAllocation;
   void *m_depthImageView;
   uint32_t m_depthFormat;
 
@@ -172,13 +249,40 @@ private:
     float projectionMatrix[16];
   };
 
+  // Uniform block at binding 0 (dynamic offset), written once per camera.
+  // Per-object transforms travel in the instance stream, the model matrix
+  // here applies to every draw using the block. Camera matrices come first so
+  // shaders declaring only view and projection still match.
+  struct ObjectUBO {
+    float viewMatrix[16];
+    float projectionMatrix[16];
+    float modelMatrix[16];
+    float positionOffset[4]; // packed vertex dequantization, xyz
+    float positionScale[4];
+  };
+
   // Current camera data
   CameraUBO m_currentCameraUBO;
 
-  // Uniform buffers for camera matrices
-  std::vector<void *> m_uniformBuffers;
-  std::vector<void *> m_uniformBuffersMemory;
-  std::vector<void *> m_uniformBuffersMapped;
+  // Per-frame linear allocator for uniform blocks
+  std::unique_ptr<FrameAllocator> m_frameAllocator;
+
+  // Draws collected between BeginFrame and EndFrame
+  RenderQueue m_renderQueue;
+  float m_cameraFarPlane = 100.0f; // normalizes sort key depth
+  float m_cameraPosition[3] = {};  // LOD selection distance
+
+  // Camera block shared by the draws queued since the last SetCamera
+  uint32_t m_cameraBlockOffset = UINT32_MAX;
+
+  // Packed vertices need their mesh's dequantization, so each mesh gets
+  // its own block per camera
+  struct MeshBlock {
+    uint64_t version = 0;
+    uint32_t offset = UINT32_MAX;
+  };
+  std::unordered_map<uint64_t, MeshBlock> m_meshBlocks;
+  uint64_t m_cameraVersion = 0; // Camera::GetVersion() of the last SetCamera
 
   // Descriptor sets for uniform buffers
   void *m_descriptorSetLayout = nullptr;
@@ -187,10 +291,37 @@ private:
 
   // Texture and sampler
   void *m_textureImage = nullptr;
-  void *m_textureImageMemory = nullptr;
+  MemoryAllocation m_textureImageAllocation;
   void *m_textureImageView = nullptr;
   void *m_textureSampler = nullptr;
 
+  // Meshes resident in device-local memory
+  std::unique_ptr<MeshCache> m_meshCache;
+
+  // Static meshes packed into shared buffers for indirect drawing
+  std::unique_ptr<GeometryArena> m_geometryArena;
+  std::vector<VkDrawIndexedIndirectCommand> m_indirectCommands;
+  VkBuffer m_indirectBuffer = VK_NULL_HANDLE; // commands when not culled
+  VkDeviceSize m_indirectOffset = 0;
+
+  std::vector<DrawOp> m_drawOps; // resolved before the render pass
+  std::vector<IndexRange> m_clusterRanges; // DrawItem ranges of this frame
+
+  // Visibility culling of the indirect batches
+  std::unique_ptr<GpuCuller> m_gpuCuller;
+  std::vector<CullCandidate> m_cullCandidates;
+  bool m_indirectCulled = false; // this frame's batches read culled output
+  float m_viewProjection[16] = {};
+  bool m_hasViewProjection = false;
+  bool m_depthSampled = false; // depth buffer feeds the occlusion pyramid
+
+  // Indirect draw capabilities of the device
+  bool m_multiDrawIndirect = false;
+  bool m_drawIndirectFirstInstance = false;
+  bool m_graphicsQueueCompute = false;
+  PFN_vkCmdDrawIndexedIndirectCountKHR m_cmdDrawIndexedIndirectCount =
+      nullptr;
+
   // Helper methods
   std::vector<char> ReadFile(const std::string &filename);
   VkShaderModule CreateShaderModule(const std::vector<char> &code);
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <AquaVisual/Core/MemoryAllocator.h>
 #include <AquaVisual/Math/Vector.h>
 #include <memory>
 #include <vector>
@@ -124,7 +125,7 @@ struct DirectionalLight {
         VkDevice m_device = VK_NULL_HANDLE;
         VkPhysicalDevice m_physicalDevice = VK_NULL_HANDLE;
         VkBuffer m_uniformBuffer = VK_NULL_HANDLE;
-        VkDeviceMemory m_uniformBufferMemory = VK_NULL_HANDLE;
+        MemoryAllocation m_uniformBufferAllocation;
         void* m_uniformBufferMapped = nullptr;
         
         VkDescriptorSetLayout m_descriptorSetLayout = VK_NULL_HANDLE;
@@ -139,8 +140,6 @@ struct DirectionalLight {
         bool CreateDescriptorPool();
         bool CreateDescriptorSet();
         void UpdateDescriptorSet();
-        
-        uint32_t FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
     };
 
 } // namespace Lighting
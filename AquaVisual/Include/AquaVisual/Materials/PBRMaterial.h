@@ -1,5 +1,6 @@
 #pragma once
 
+#include "AquaVisual/Core/MemoryAllocator.h"
 #include "AquaVisual/Math/Vector.h"
 #include <vulkan/vulkan.h>
 #include <memory>
@@ -93,7 +94,7 @@ namespace Materials {
         // Vulkan resources
         VkDevice m_device;
         VkBuffer m_uniformBuffer;
-        VkDeviceMemory m_uniformBufferMemory;
+        MemoryAllocation m_uniformBufferAllocation;
         void* m_uniformBufferMapped;
         
         VkDescriptorSetLayout m_descriptorSetLayout;
@@ -110,8 +111,6 @@ namespace Materials {
         bool CreateDescriptorPool();
         bool CreateDescriptorSet();
         void UpdateDescriptorSet();
-        
-        uint32_t FindMemoryType(VkPhysicalDevice physicalDevice, uint32_t typeFilter, VkMemoryPropertyFlags properties);
     };
 
 } // namespace Materials
@@ -2,29 +2,68 @@
 
 #include "Math/Vector.h"
 #include "Math/Matrix.h"
+#include "Math/Quaternion.h"
 
 namespace AquaVisual {
 
-// Forward declaration - Matrix4 is defined in Math/Matrix.h
-class Matrix4;
-
 /**
  * @brief Transform component
+ *
+ * Rotation is stored as a quaternion. The local matrix T * R * S is cached
+ * and only rebuilt after a setter changed the transform, so objects that do
+ * not move cost nothing per frame. Euler setters (radians, applied X, Y,
+ * then Z) are kept for convenience.
  */
-struct Transform {
-  Vector3 position = Vector3::Zero();
-  Vector3 rotation = Vector3::Zero(); // Euler angles in radians
-  Vector3 scale = Vector3::One();
-
+class Transform {
+public:
   Transform() = default;
-  Transform(const Vector3 &pos) : position(pos) {}
+  Transform(const Vector3 &pos) : m_position(pos) {}
   Transform(const Vector3 &pos, const Vector3 &rot)
-      : position(pos), rotation(rot) {}
+      : m_position(pos), m_rotation(Quaternion::FromEuler(rot)) {}
   Transform(const Vector3 &pos, const Vector3 &rot, const Vector3 &scl)
-      : position(pos), rotation(rot), scale(scl) {}
+      : m_position(pos), m_rotation(Quaternion::FromEuler(rot)),
+        m_scale(scl) {}
+  Transform(const Vector3 &pos, const Quaternion &rot, const Vector3 &scl)
+      : m_position(pos), m_rotation(rot), m_scale(scl) {}
+
+  const Vector3 &GetPosition() const { return m_position; }
+  const Quaternion &GetRotation() const { return m_rotation; }
+  const Vector3 &GetScale() const { return m_scale; }
+  Vector3 GetEulerAngles() const { return m_rotation.ToEuler(); }
+
+  void SetPosition(const Vector3 &position) {
+    m_position = position;
+    m_dirty = true;
+  }
+  void SetRotation(const Quaternion &rotation) {
+    m_rotation = rotation;
+    m_dirty = true;
+  }
+  void SetEulerAngles(const Vector3 &radians) {
+    SetRotation(Quaternion::FromEuler(radians));
+  }
+  void SetScale(const Vector3 &scale) {
+    m_scale = scale;
+    m_dirty = true;
+  }
+
+  void Translate(const Vector3 &offset) { SetPosition(m_position + offset); }
+  // Apply a rotation in local space, after the current one
+  void Rotate(const Quaternion &rotation) {
+    SetRotation((m_rotation * rotation).Normalize());
+  }
+
+  // Local matrix T * R * S, rebuilt only when the transform changed
+  const Matrix4 &GetMatrix() const;
+  bool IsDirty() const { return m_dirty; }
+
+private:
+  Vector3 m_position = Vector3::Zero();
+  Quaternion m_rotation;
+  Vector3 m_scale = Vector3::One();
 
-  // GetMatrix() implementation moved to source file to avoid circular dependency
-  Matrix4 GetMatrix() const;
+  mutable Matrix4 m_matrix;
+  mutable bool m_dirty = true;
 };
 
 /**
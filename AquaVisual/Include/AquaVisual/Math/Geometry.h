@@ -0,0 +1,135 @@
+#pragma once
+
+#include "Matrix.h"
+#include "Vector.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace AquaVisual {
+
+// Axis-aligned bounding box. A default-constructed box is empty (minimum
+// above maximum) and becomes valid once a point or box is merged in.
+struct AABB {
+    Vector3 minimum;
+    Vector3 maximum;
+
+    AABB();
+    AABB(const Vector3& minimum, const Vector3& maximum);
+    static AABB FromCenterExtents(const Vector3& center,
+                                  const Vector3& extents);
+
+    bool IsValid() const;
+    Vector3 GetCenter() const;
+    Vector3 GetExtents() const; // half the size on each axis
+    float GetSurfaceArea() const;
+
+    void Expand(const Vector3& point);
+    void Merge(const AABB& other);
+
+    bool Contains(const Vector3& point) const;
+    bool Contains(const AABB& other) const;
+    bool Intersects(const AABB& other) const;
+
+    // Box enclosing this one after an affine transform
+    AABB Transformed(const Matrix4& transform) const;
+};
+
+struct BoundingSphere {
+    Vector3 center;
+    float radius;
+
+    BoundingSphere();
+    BoundingSphere(const Vector3& center, float radius);
+    static BoundingSphere FromAABB(const AABB& box);
+
+    bool Contains(const Vector3& point) const;
+    bool Intersects(const BoundingSphere& other) const;
+    bool Intersects(const AABB& box) const;
+
+    // Sphere enclosing this one after an affine transform; non-uniform scale
+    // uses the largest axis
+    BoundingSphere Transformed(const Matrix4& transform) const;
+};
+
+// Plane dot(normal, p) + distance = 0; points on the normal's side are in
+// front (positive signed distance)
+struct Plane {
+    Vector3 normal;
+    float distance;
+
+    Plane();
+    Plane(const Vector3& normal, float distance);
+    static Plane FromPointNormal(const Vector3& point, const Vector3& normal);
+    // Counter-clockwise a, b, c face the front side
+    static Plane FromPoints(const Vector3& a, const Vector3& b,
+                            const Vector3& c);
+
+    float SignedDistance(const Vector3& point) const;
+    Plane Normalize() const;
+};
+
+// Where a volume lies relative to a frustum
+enum class Containment {
+    Outside,
+    Intersecting,
+    Inside
+};
+
+// Six inward-facing planes of a view volume: left, right, bottom, top, near,
+// far
+class Frustum {
+public:
+    static constexpr int PLANE_COUNT = 6;
+
+    Frustum();
+    // Planes of a column-major view-projection matrix such as
+    // Camera::GetViewProjectionMatrix(), normalized
+    static Frustum FromMatrix(const Matrix4& viewProjection);
+
+    const Plane& GetPlane(int index) const { return m_planes[index]; }
+
+    bool Contains(const Vector3& point) const;
+    bool Intersects(const BoundingSphere& sphere) const;
+    bool Intersects(const AABB& box) const;
+    // Like Intersects, but also reports boxes entirely inside so hierarchies
+    // can accept a whole subtree without testing its children
+    Containment Classify(const AABB& box) const;
+
+    // Batched tests over Simd::WIDTH objects at a time. Bit i of
+    // visibleMask[i / 32] is set when object i is at least partly inside;
+    // visibleMask must hold (count + 31) / 32 words. Returns the number of
+    // visible objects.
+    size_t CullSpheres(const BoundingSphere* spheres, size_t count,
+                       uint32_t* visibleMask) const;
+    size_t CullAABBs(const AABB* boxes, size_t count,
+                     uint32_t* visibleMask) const;
+
+private:
+    Plane m_planes[PLANE_COUNT];
+};
+
+struct Ray {
+    Vector3 origin;
+    Vector3 direction;
+
+    Ray();
+    Ray(const Vector3& origin, const Vector3& direction);
+
+    // Picking ray through a point in normalized device coordinates, from the
+    // near to the far plane; direction is normalized
+    static Ray FromScreenPoint(float ndcX, float ndcY,
+                               const Matrix4& inverseViewProjection);
+
+    Vector3 GetPoint(float t) const { return origin + direction * t; }
+
+    // Hits in front of the origin. distance receives t of the first hit, in
+    // units of the direction's length.
+    bool Intersects(const AABB& box, float* distance = nullptr) const;
+    bool Intersects(const BoundingSphere& sphere,
+                    float* distance = nullptr) const;
+    bool Intersects(const Plane& plane, float* distance = nullptr) const;
+    bool IntersectsTriangle(const Vector3& a, const Vector3& b,
+                            const Vector3& c, float* distance = nullptr) const;
+};
+
+} // namespace AquaVisual
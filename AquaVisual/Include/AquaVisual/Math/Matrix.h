@@ -1,11 +1,15 @@
 #pragma once
 
-namespace AquaVisual {
+#include "Simd.h"
+#include "Vector.h"
+#include <cstring>
 
-class Vector3;
-class Vector4;
+namespace AquaVisual {
 
-class Matrix4 {
+// 4x4 float matrix stored column-major: m[column][row], matching GLSL mat4 so
+// Data() can be copied into uniform and instance buffers unchanged. Products
+// follow the usual column-vector convention, (A * B) * v == A * (B * v).
+class alignas(16) Matrix4 {
 public:
     float m[4][4];
 
@@ -17,6 +21,11 @@ public:
     Vector4 operator*(const Vector4& vec) const;
     Matrix4& operator*=(const Matrix4& other);
 
+    // Transform a position (w = 1) or a direction (w = 0), ignoring the
+    // projective row
+    Vector3 TransformPoint(const Vector3& point) const;
+    Vector3 TransformVector(const Vector3& vector) const;
+
     float* Data();
     const float* Data() const;
 
@@ -31,7 +40,119 @@ public:
     static Matrix4 LookAt(const Vector3& eye, const Vector3& center, const Vector3& up);
 
     Matrix4 Transpose() const;
+
+    // General inverse; returns identity for a singular matrix
     Matrix4 Inverse() const;
+    // Inverse of a matrix whose last row is (0, 0, 0, 1), such as any
+    // translate/rotate/scale model matrix
+    Matrix4 InverseAffine() const;
+    // Inverse of a rotation plus translation without scale, such as a view
+    // matrix from LookAt
+    Matrix4 InverseRigid() const;
+
+private:
+    Simd::Float4 Column(int index) const { return Simd::Load(m[index]); }
 };
 
-}
\ No newline at end of file
+inline Matrix4::Matrix4() : Matrix4(1.0f) {}
+
+inline Matrix4::Matrix4(float diagonal) {
+    const Simd::Float4 zero = Simd::Splat(0.0f);
+    Simd::Store(m[0], zero);
+    Simd::Store(m[1], zero);
+    Simd::Store(m[2], zero);
+    Simd::Store(m[3], zero);
+    m[0][0] = m[1][1] = m[2][2] = m[3][3] = diagonal;
+}
+
+inline Matrix4::Matrix4(const float matrix[16]) {
+    std::memcpy(m, matrix, sizeof(m));
+}
+
+inline Matrix4 Matrix4::operator*(const Matrix4& other) const {
+    Matrix4 result(0.0f);
+#if defined(AQUA_SIMD_AVX)
+    // Two result columns per 256-bit register: each half combines the same
+    // columns of this matrix with the entries of one column of other
+    const __m128 c0 = Column(0), c1 = Column(1), c2 = Column(2),
+                 c3 = Column(3);
+    const __m256 a0 = _mm256_insertf128_ps(_mm256_castps128_ps256(c0), c0, 1);
+    const __m256 a1 = _mm256_insertf128_ps(_mm256_castps128_ps256(c1), c1, 1);
+    const __m256 a2 = _mm256_insertf128_ps(_mm256_castps128_ps256(c2), c2, 1);
+    const __m256 a3 = _mm256_insertf128_ps(_mm256_castps128_ps256(c3), c3, 1);
+    for (int column = 0; column < 4; column += 2) {
+        const __m256 b = _mm256_loadu_ps(other.m[column]);
+        __m256 r = _mm256_mul_ps(a0, _mm256_permute_ps(b, 0x00));
+#if defined(AQUA_SIMD_FMA)
+        r = _mm256_fmadd_ps(a1, _mm256_permute_ps(b, 0x55), r);
+        r = _mm256_fmadd_ps(a2, _mm256_permute_ps(b, 0xAA), r);
+        r = _mm256_fmadd_ps(a3, _mm256_permute_ps(b, 0xFF), r);
+#else
+        r = _mm256_add_ps(r, _mm256_mul_ps(a1, _mm256_permute_ps(b, 0x55)));
+        r = _mm256_add_ps(r, _mm256_mul_ps(a2, _mm256_permute_ps(b, 0xAA)));
+        r = _mm256_add_ps(r, _mm256_mul_ps(a3, _mm256_permute_ps(b, 0xFF)));
+#endif
+        _mm256_storeu_ps(result.m[column], r);
+    }
+#else
+    const Simd::Float4 c0 = Column(0), c1 = Column(1), c2 = Column(2),
+                       c3 = Column(3);
+    for (int column = 0; column < 4; column++) {
+        Simd::Store(result.m[column],
+                    Simd::Combine(other.Column(column), c0, c1, c2, c3));
+    }
+#endif
+    return result;
+}
+
+inline Vector4 Matrix4::operator*(const Vector4& vec) const {
+    Vector4 result;
+    Simd::Store(&result.x, Simd::Combine(Simd::Load(&vec.x), Column(0),
+                                         Column(1), Column(2), Column(3)));
+    return result;
+}
+
+inline Matrix4& Matrix4::operator*=(const Matrix4& other) {
+    *this = *this * other;
+    return *this;
+}
+
+inline Vector3 Matrix4::TransformPoint(const Vector3& point) const {
+    return Vector3(
+        m[0][0] * point.x + m[1][0] * point.y + m[2][0] * point.z + m[3][0],
+        m[0][1] * point.x + m[1][1] * point.y + m[2][1] * point.z + m[3][1],
+        m[0][2] * point.x + m[1][2] * point.y + m[2][2] * point.z + m[3][2]);
+}
+
+inline Vector3 Matrix4::TransformVector(const Vector3& vector) const {
+    return Vector3(
+        m[0][0] * vector.x + m[1][0] * vector.y + m[2][0] * vector.z,
+        m[0][1] * vector.x + m[1][1] * vector.y + m[2][1] * vector.z,
+        m[0][2] * vector.x + m[1][2] * vector.y + m[2][2] * vector.z);
+}
+
+inline float* Matrix4::Data() {
+    return &m[0][0];
+}
+
+inline const float* Matrix4::Data() const {
+    return &m[0][0];
+}
+
+inline Matrix4 Matrix4::Identity() {
+    return Matrix4(1.0f);
+}
+
+inline Matrix4 Matrix4::Transpose() const {
+    Simd::Float4 c0 = Column(0), c1 = Column(1), c2 = Column(2),
+                 c3 = Column(3);
+    Simd::Transpose(c0, c1, c2, c3);
+    Matrix4 result(0.0f);
+    Simd::Store(result.m[0], c0);
+    Simd::Store(result.m[1], c1);
+    Simd::Store(result.m[2], c2);
+    Simd::Store(result.m[3], c3);
+    return result;
+}
+
+}
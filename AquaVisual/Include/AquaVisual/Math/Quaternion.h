@@ -0,0 +1,213 @@
+#pragma once
+
+#include "Matrix.h"
+#include "Simd.h"
+#include "Vector.h"
+#include <cmath>
+
+namespace AquaVisual {
+
+// Unit quaternion rotation (x, y, z) * sin(angle / 2), w = cos(angle / 2),
+// laid out as one SIMD register. Euler angles are radians applied X, then Y,
+// then Z, the same order as Transform and Matrix4::RotateX/Y/Z.
+class alignas(16) Quaternion {
+public:
+    float x, y, z, w;
+
+    Quaternion();
+    Quaternion(float x, float y, float z, float w);
+
+    static Quaternion Identity();
+    static Quaternion FromAxisAngle(const Vector3& axis, float angle);
+    static Quaternion FromEuler(const Vector3& radians);
+
+    // Rotation by other followed by this one
+    Quaternion operator*(const Quaternion& other) const;
+    Quaternion& operator*=(const Quaternion& other);
+
+    float Dot(const Quaternion& other) const;
+    float Length() const;
+    Quaternion Normalize() const;
+    Quaternion Conjugate() const;
+    Quaternion Inverse() const;
+
+    Vector3 Rotate(const Vector3& vector) const;
+    Vector3 ToEuler() const;
+    Matrix4 ToMatrix() const;
+
+    // Shortest-path interpolation; Nlerp is cheaper and close enough for
+    // small steps such as animation frames
+    static Quaternion Slerp(const Quaternion& a, const Quaternion& b, float t);
+    static Quaternion Nlerp(const Quaternion& a, const Quaternion& b, float t);
+
+private:
+    Simd::Float4 Load() const { return Simd::Load(&x); }
+    static Quaternion FromRegister(Simd::Float4 value);
+};
+
+inline Quaternion::Quaternion() : x(0.0f), y(0.0f), z(0.0f), w(1.0f) {}
+
+inline Quaternion::Quaternion(float x, float y, float z, float w)
+    : x(x), y(y), z(z), w(w) {}
+
+inline Quaternion Quaternion::FromRegister(Simd::Float4 value) {
+    Quaternion result;
+    Simd::Store(&result.x, value);
+    return result;
+}
+
+inline Quaternion Quaternion::Identity() {
+    return Quaternion();
+}
+
+inline Quaternion Quaternion::FromAxisAngle(const Vector3& axis, float angle) {
+    const Vector3 unit = axis.Normalize();
+    const float s = std::sin(angle * 0.5f);
+    return Quaternion(unit.x * s, unit.y * s, unit.z * s,
+                      std::cos(angle * 0.5f));
+}
+
+inline Quaternion Quaternion::FromEuler(const Vector3& radians) {
+    // qz * qy * qx expanded
+    const float cx = std::cos(radians.x * 0.5f);
+    const float sx = std::sin(radians.x * 0.5f);
+    const float cy = std::cos(radians.y * 0.5f);
+    const float sy = std::sin(radians.y * 0.5f);
+    const float cz = std::cos(radians.z * 0.5f);
+    const float sz = std::sin(radians.z * 0.5f);
+
+    return Quaternion(sx * cy * cz - cx * sy * sz,
+                      cx * sy * cz + sx * cy * sz,
+                      cx * cy * sz - sx * sy * cz,
+                      cx * cy * cz + sx * sy * sz);
+}
+
+inline Quaternion Quaternion::operator*(const Quaternion& other) const {
+    // Hamilton product as four broadcast lanes of this times sign-flipped
+    // swizzles of other
+    const Simd::Float4 a = Load();
+    const Simd::Float4 b = other.Load();
+
+    const Simd::Float4 signsX = Simd::Set(1.0f, -1.0f, 1.0f, -1.0f);
+    const Simd::Float4 signsY = Simd::Set(1.0f, 1.0f, -1.0f, -1.0f);
+    const Simd::Float4 signsZ = Simd::Set(-1.0f, 1.0f, 1.0f, -1.0f);
+
+    Simd::Float4 result = Simd::Mul(Simd::SplatLane<3>(a), b);
+    result = Simd::MulAdd(Simd::SplatLane<0>(a),
+                          Simd::Mul(Simd::Swizzle<3, 2, 1, 0>(b), signsX),
+                          result);
+    result = Simd::MulAdd(Simd::SplatLane<1>(a),
+                          Simd::Mul(Simd::Swizzle<2, 3, 0, 1>(b), signsY),
+                          result);
+    result = Simd::MulAdd(Simd::SplatLane<2>(a),
+                          Simd::Mul(Simd::Swizzle<1, 0, 3, 2>(b), signsZ),
+                          result);
+    return FromRegister(result);
+}
+
+inline Quaternion& Quaternion::operator*=(const Quaternion& other) {
+    *this = *this * other;
+    return *this;
+}
+
+inline float Quaternion::Dot(const Quaternion& other) const {
+    return Simd::GetX(Simd::Dot4(Load(), other.Load()));
+}
+
+inline float Quaternion::Length() const {
+    return std::sqrt(Dot(*this));
+}
+
+inline Quaternion Quaternion::Normalize() const {
+    const Simd::Float4 q = Load();
+    const float lengthSquared = Simd::GetX(Simd::Dot4(q, q));
+    if (lengthSquared > 0.0f) {
+        return FromRegister(
+            Simd::Div(q, Simd::Splat(std::sqrt(lengthSquared))));
+    }
+    return Quaternion();
+}
+
+inline Quaternion Quaternion::Conjugate() const {
+    return FromRegister(
+        Simd::Mul(Load(), Simd::Set(-1.0f, -1.0f, -1.0f, 1.0f)));
+}
+
+inline Quaternion Quaternion::Inverse() const {
+    const float lengthSquared = Dot(*this);
+    if (lengthSquared > 0.0f) {
+        return FromRegister(Simd::Div(Conjugate().Load(),
+                                      Simd::Splat(lengthSquared)));
+    }
+    return Quaternion();
+}
+
+inline Vector3 Quaternion::Rotate(const Vector3& vector) const {
+    // v + 2w (q x v) + 2 q x (q x v)
+    const Vector3 axis(x, y, z);
+    const Vector3 t = axis.Cross(vector) * 2.0f;
+    return vector + t * w + axis.Cross(t);
+}
+
+inline Vector3 Quaternion::ToEuler() const {
+    // Angles of Rz * Ry * Rx read back from the rotation matrix entries
+    const float sinY =
+        std::fmax(-1.0f, std::fmin(1.0f, -2.0f * (x * z - w * y)));
+    const float angleX = std::atan2(2.0f * (y * z + w * x),
+                                    1.0f - 2.0f * (x * x + y * y));
+    const float angleZ = std::atan2(2.0f * (x * y + w * z),
+                                    1.0f - 2.0f * (y * y + z * z));
+    return Vector3(angleX, std::asin(sinY), angleZ);
+}
+
+inline Matrix4 Quaternion::ToMatrix() const {
+    const float xx = x * x, yy = y * y, zz = z * z;
+    const float xy = x * y, xz = x * z, yz = y * z;
+    const float wx = w * x, wy = w * y, wz = w * z;
+
+    Matrix4 result(1.0f);
+    result.m[0][0] = 1.0f - 2.0f * (yy + zz);
+    result.m[0][1] = 2.0f * (xy + wz);
+    result.m[0][2] = 2.0f * (xz - wy);
+    result.m[1][0] = 2.0f * (xy - wz);
+    result.m[1][1] = 1.0f - 2.0f * (xx + zz);
+    result.m[1][2] = 2.0f * (yz + wx);
+    result.m[2][0] = 2.0f * (xz + wy);
+    result.m[2][1] = 2.0f * (yz - wx);
+    result.m[2][2] = 1.0f - 2.0f * (xx + yy);
+    return result;
+}
+
+inline Quaternion Quaternion::Nlerp(const Quaternion& a, const Quaternion& b,
+                                    float t) {
+    // Flip b onto a's hemisphere so the blend takes the short way round
+    const float sign = a.Dot(b) < 0.0f ? -1.0f : 1.0f;
+    const Simd::Float4 from = a.Load();
+    const Simd::Float4 to = Simd::Mul(b.Load(), Simd::Splat(sign));
+    const Simd::Float4 blend =
+        Simd::MulAdd(Simd::Sub(to, from), Simd::Splat(t), from);
+    return FromRegister(blend).Normalize();
+}
+
+inline Quaternion Quaternion::Slerp(const Quaternion& a, const Quaternion& b,
+                                    float t) {
+    float cosine = a.Dot(b);
+    const float sign = cosine < 0.0f ? -1.0f : 1.0f;
+    cosine *= sign;
+
+    // Nearly parallel: the sine below loses precision, and lerp is exact
+    // enough
+    if (cosine > 0.9995f) {
+        return Nlerp(a, b, t);
+    }
+
+    const float angle = std::acos(cosine);
+    const float inverseSine = 1.0f / std::sin(angle);
+    const float weightA = std::sin((1.0f - t) * angle) * inverseSine;
+    const float weightB = std::sin(t * angle) * inverseSine * sign;
+    return FromRegister(Simd::MulAdd(a.Load(), Simd::Splat(weightA),
+                                     Simd::Mul(b.Load(),
+                                               Simd::Splat(weightB))));
+}
+
+} // namespace AquaVisual
@@ -0,0 +1,415 @@
+#pragma once
+
+#include <cstddef>
+
+// Four-wide float vector used by the math library. The instruction set is
+// picked at compile time from the compiler's target flags:
+//   AQUA_SIMD_SSE    x86 with SSE2, plus SSE4.1 / AVX / FMA when enabled
+//   AQUA_SIMD_NEON   ARMv8 (AArch64) NEON
+//   AQUA_SIMD_SCALAR portable fallback, or forced with AQUA_SIMD_DISABLE
+// Everything is inline so the math headers compile to straight-line code in
+// the caller.
+
+#if !defined(AQUA_SIMD_DISABLE) &&                                            \
+    (defined(__SSE2__) || defined(_M_X64) ||                                  \
+     (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define AQUA_SIMD_SSE 1
+#include <immintrin.h>
+#if defined(__AVX__)
+#define AQUA_SIMD_AVX 1
+#endif
+#if defined(__FMA__) || defined(__AVX2__)
+#define AQUA_SIMD_FMA 1
+#endif
+#if defined(__SSE4_1__) || defined(__AVX__)
+#define AQUA_SIMD_SSE41 1
+#endif
+#elif !defined(AQUA_SIMD_DISABLE) && (defined(__aarch64__) || defined(_M_ARM64))
+#define AQUA_SIMD_NEON 1
+#include <arm_neon.h>
+#else
+#define AQUA_SIMD_SCALAR 1
+#endif
+
+namespace AquaVisual {
+namespace Simd {
+
+#if defined(AQUA_SIMD_SSE)
+
+using Float4 = __m128;
+
+inline Float4 Load(const float *p) { return _mm_loadu_ps(p); }
+inline void Store(float *p, Float4 v) { _mm_storeu_ps(p, v); }
+inline Float4 Set(float x, float y, float z, float w) {
+    return _mm_setr_ps(x, y, z, w);
+}
+inline Float4 Splat(float s) { return _mm_set1_ps(s); }
+template <int Lane> inline Float4 SplatLane(Float4 v) {
+    return _mm_shuffle_ps(v, v, _MM_SHUFFLE(Lane, Lane, Lane, Lane));
+}
+inline float GetX(Float4 v) { return _mm_cvtss_f32(v); }
+
+// (a[X], a[Y], b[Z], b[W])
+template <int X, int Y, int Z, int W>
+inline Float4 Shuffle(Float4 a, Float4 b) {
+    return _mm_shuffle_ps(a, b, _MM_SHUFFLE(W, Z, Y, X));
+}
+
+inline Float4 Add(Float4 a, Float4 b) { return _mm_add_ps(a, b); }
+inline Float4 Sub(Float4 a, Float4 b) { return _mm_sub_ps(a, b); }
+inline Float4 Mul(Float4 a, Float4 b) { return _mm_mul_ps(a, b); }
+inline Float4 Div(Float4 a, Float4 b) { return _mm_div_ps(a, b); }
+
+// a * b + c
+inline Float4 MulAdd(Float4 a, Float4 b, Float4 c) {
+#if defined(AQUA_SIMD_FMA)
+    return _mm_fmadd_ps(a, b, c);
+#else
+    return _mm_add_ps(_mm_mul_ps(a, b), c);
+#endif
+}
+
+// Horizontal sum of a * b, broadcast to every lane
+inline Float4 Dot4(Float4 a, Float4 b) {
+#if defined(AQUA_SIMD_SSE41)
+    return _mm_dp_ps(a, b, 0xFF);
+#else
+    Float4 product = _mm_mul_ps(a, b);
+    Float4 swapped = _mm_shuffle_ps(product, product, _MM_SHUFFLE(2, 3, 0, 1));
+    Float4 sums = _mm_add_ps(product, swapped);
+    swapped = _mm_shuffle_ps(sums, sums, _MM_SHUFFLE(1, 0, 3, 2));
+    return _mm_add_ps(sums, swapped);
+#endif
+}
+
+inline void Transpose(Float4 &r0, Float4 &r1, Float4 &r2, Float4 &r3) {
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+}
+
+inline Float4 Min(Float4 a, Float4 b) { return _mm_min_ps(a, b); }
+inline Float4 Max(Float4 a, Float4 b) { return _mm_max_ps(a, b); }
+inline Float4 Abs(Float4 v) {
+    return _mm_andnot_ps(_mm_set1_ps(-0.0f), v);
+}
+
+// Per-lane comparison results
+using Mask4 = __m128;
+
+inline Mask4 Less(Float4 a, Float4 b) { return _mm_cmplt_ps(a, b); }
+inline Mask4 Or(Mask4 a, Mask4 b) { return _mm_or_ps(a, b); }
+// Bit i set when lane i is true
+inline int MoveMask(Mask4 m) { return _mm_movemask_ps(m); }
+// Lane-wise m ? a : b
+inline Float4 Select(Mask4 m, Float4 a, Float4 b) {
+#if defined(AQUA_SIMD_SSE41)
+    return _mm_blendv_ps(b, a, m);
+#else
+    return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b));
+#endif
+}
+
+#elif defined(AQUA_SIMD_NEON)
+
+using Float4 = float32x4_t;
+
+inline Float4 Load(const float *p) { return vld1q_f32(p); }
+inline void Store(float *p, Float4 v) { vst1q_f32(p, v); }
+inline Float4 Set(float x, float y, float z, float w) {
+    const float values[4] = {x, y, z, w};
+    return vld1q_f32(values);
+}
+inline Float4 Splat(float s) { return vdupq_n_f32(s); }
+template <int Lane> inline Float4 SplatLane(Float4 v) {
+    return vdupq_laneq_f32(v, Lane);
+}
+inline float GetX(Float4 v) { return vgetq_lane_f32(v, 0); }
+
+template <int X, int Y, int Z, int W>
+inline Float4 Shuffle(Float4 a, Float4 b) {
+    Float4 result = vdupq_laneq_f32(a, X);
+    result = vcopyq_laneq_f32(result, 1, a, Y);
+    result = vcopyq_laneq_f32(result, 2, b, Z);
+    return vcopyq_laneq_f32(result, 3, b, W);
+}
+
+inline Float4 Add(Float4 a, Float4 b) { return vaddq_f32(a, b); }
+inline Float4 Sub(Float4 a, Float4 b) { return vsubq_f32(a, b); }
+inline Float4 Mul(Float4 a, Float4 b) { return vmulq_f32(a, b); }
+inline Float4 Div(Float4 a, Float4 b) { return vdivq_f32(a, b); }
+
+inline Float4 MulAdd(Float4 a, Float4 b, Float4 c) {
+    return vfmaq_f32(c, a, b);
+}
+
+inline Float4 Dot4(Float4 a, Float4 b) {
+    return vdupq_n_f32(vaddvq_f32(vmulq_f32(a, b)));
+}
+
+inline void Transpose(Float4 &r0, Float4 &r1, Float4 &r2, Float4 &r3) {
+    float32x4x2_t t01 = vtrnq_f32(r0, r1);
+    float32x4x2_t t23 = vtrnq_f32(r2, r3);
+    r0 = vcombine_f32(vget_low_f32(t01.val[0]), vget_low_f32(t23.val[0]));
+    r1 = vcombine_f32(vget_low_f32(t01.val[1]), vget_low_f32(t23.val[1]));
+    r2 = vcombine_f32(vget_high_f32(t01.val[0]), vget_high_f32(t23.val[0]));
+    r3 = vcombine_f32(vget_high_f32(t01.val[1]), vget_high_f32(t23.val[1]));
+}
+
+inline Float4 Min(Float4 a, Float4 b) { return vminq_f32(a, b); }
+inline Float4 Max(Float4 a, Float4 b) { return vmaxq_f32(a, b); }
+inline Float4 Abs(Float4 v) { return vabsq_f32(v); }
+
+using Mask4 = uint32x4_t;
+
+inline Mask4 Less(Float4 a, Float4 b) { return vcltq_f32(a, b); }
+inline Mask4 Or(Mask4 a, Mask4 b) { return vorrq_u32(a, b); }
+inline int MoveMask(Mask4 m) {
+    const int32_t shifts[4] = {0, 1, 2, 3};
+    const uint32x4_t bits = vshlq_u32(vshrq_n_u32(m, 31), vld1q_s32(shifts));
+    return static_cast<int>(vaddvq_u32(bits));
+}
+inline Float4 Select(Mask4 m, Float4 a, Float4 b) {
+    return vbslq_f32(m, a, b);
+}
+
+#else
+
+struct Float4 {
+    float v[4];
+};
+
+inline Float4 Load(const float *p) { return {{p[0], p[1], p[2], p[3]}}; }
+inline void Store(float *p, Float4 a) {
+    p[0] = a.v[0];
+    p[1] = a.v[1];
+    p[2] = a.v[2];
+    p[3] = a.v[3];
+}
+inline Float4 Set(float x, float y, float z, float w) { return {{x, y, z, w}}; }
+inline Float4 Splat(float s) { return {{s, s, s, s}}; }
+template <int Lane> inline Float4 SplatLane(Float4 a) {
+    return Splat(a.v[Lane]);
+}
+inline float GetX(Float4 a) { return a.v[0]; }
+
+template <int X, int Y, int Z, int W>
+inline Float4 Shuffle(Float4 a, Float4 b) {
+    return {{a.v[X], a.v[Y], b.v[Z], b.v[W]}};
+}
+
+inline Float4 Add(Float4 a, Float4 b) {
+    return {{a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2],
+             a.v[3] + b.v[3]}};
+}
+inline Float4 Sub(Float4 a, Float4 b) {
+    return {{a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2],
+             a.v[3] - b.v[3]}};
+}
+inline Float4 Mul(Float4 a, Float4 b) {
+    return {{a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2],
+             a.v[3] * b.v[3]}};
+}
+inline Float4 Div(Float4 a, Float4 b) {
+    return {{a.v[0] / b.v[0], a.v[1] / b.v[1], a.v[2] / b.v[2],
+             a.v[3] / b.v[3]}};
+}
+inline Float4 MulAdd(Float4 a, Float4 b, Float4 c) {
+    return Add(Mul(a, b), c);
+}
+inline Float4 Dot4(Float4 a, Float4 b) {
+    return Splat(a.v[0] * b.v[0] + a.v[1] * b.v[1] + a.v[2] * b.v[2] +
+                 a.v[3] * b.v[3]);
+}
+inline void Transpose(Float4 &r0, Float4 &r1, Float4 &r2, Float4 &r3) {
+    Float4 c0 = {{r0.v[0], r1.v[0], r2.v[0], r3.v[0]}};
+    Float4 c1 = {{r0.v[1], r1.v[1], r2.v[1], r3.v[1]}};
+    Float4 c2 = {{r0.v[2], r1.v[2], r2.v[2], r3.v[2]}};
+    Float4 c3 = {{r0.v[3], r1.v[3], r2.v[3], r3.v[3]}};
+    r0 = c0;
+    r1 = c1;
+    r2 = c2;
+    r3 = c3;
+}
+
+inline Float4 Min(Float4 a, Float4 b) {
+    Float4 result;
+    for (int i = 0; i < 4; i++) {
+        result.v[i] = a.v[i] < b.v[i] ? a.v[i] : b.v[i];
+    }
+    return result;
+}
+inline Float4 Max(Float4 a, Float4 b) {
+    Float4 result;
+    for (int i = 0; i < 4; i++) {
+        result.v[i] = a.v[i] > b.v[i] ? a.v[i] : b.v[i];
+    }
+    return result;
+}
+inline Float4 Abs(Float4 a) {
+    Float4 result;
+    for (int i = 0; i < 4; i++) {
+        result.v[i] = a.v[i] < 0.0f ? -a.v[i] : a.v[i];
+    }
+    return result;
+}
+
+struct Mask4 {
+    bool v[4];
+};
+
+inline Mask4 Less(Float4 a, Float4 b) {
+    return {{a.v[0] < b.v[0], a.v[1] < b.v[1], a.v[2] < b.v[2],
+             a.v[3] < b.v[3]}};
+}
+inline Mask4 Or(Mask4 a, Mask4 b) {
+    return {{a.v[0] || b.v[0], a.v[1] || b.v[1], a.v[2] || b.v[2],
+             a.v[3] || b.v[3]}};
+}
+inline int MoveMask(Mask4 m) {
+    return (m.v[0] ? 1 : 0) | (m.v[1] ? 2 : 0) | (m.v[2] ? 4 : 0) |
+           (m.v[3] ? 8 : 0);
+}
+inline Float4 Select(Mask4 m, Float4 a, Float4 b) {
+    Float4 result;
+    for (int i = 0; i < 4; i++) {
+        result.v[i] = m.v[i] ? a.v[i] : b.v[i];
+    }
+    return result;
+}
+
+#endif
+
+// (v[X], v[Y], v[Z], v[W])
+template <int X, int Y, int Z, int W> inline Float4 Swizzle(Float4 v) {
+    return Shuffle<X, Y, Z, W>(v, v);
+}
+
+// Cross product of the xyz lanes; w becomes 0 when both w lanes are finite
+inline Float4 Cross3(Float4 a, Float4 b) {
+    const Float4 left = Mul(Swizzle<1, 2, 0, 3>(a), Swizzle<2, 0, 1, 3>(b));
+    const Float4 right = Mul(Swizzle<2, 0, 1, 3>(a), Swizzle<1, 2, 0, 3>(b));
+    return Sub(left, right);
+}
+
+// Linear combination of four columns: c0 * v.x + c1 * v.y + c2 * v.z +
+// c3 * v.w. This is the column-major matrix * vector kernel.
+inline Float4 Combine(Float4 v, Float4 c0, Float4 c1, Float4 c2, Float4 c3) {
+    Float4 result = Mul(c0, SplatLane<0>(v));
+    result = MulAdd(c1, SplatLane<1>(v), result);
+    result = MulAdd(c2, SplatLane<2>(v), result);
+    return MulAdd(c3, SplatLane<3>(v), result);
+}
+
+// Round to the nearest integer, ties to even
+inline Float4 Round(Float4 v) {
+#if defined(AQUA_SIMD_SSE41)
+    return _mm_round_ps(v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+#elif defined(AQUA_SIMD_NEON)
+    return vrndnq_f32(v);
+#else
+    // Adding and removing 1.5 * 2^23 drops the fraction bits; exact for
+    // |v| < 2^22
+    const Float4 magic = Splat(12582912.0f);
+    return Sub(Add(v, magic), magic);
+#endif
+}
+
+// Store lane i of (a, b, c, d) as four consecutive floats at out + i * stride
+inline void StoreInterleaved(float *out, size_t stride, Float4 a, Float4 b,
+                             Float4 c, Float4 d) {
+    Transpose(a, b, c, d);
+    Store(out, a);
+    Store(out + stride, b);
+    Store(out + 2 * stride, c);
+    Store(out + 3 * stride, d);
+}
+
+// Inverse of StoreInterleaved: lane i of (a, b, c, d) takes the four floats
+// at in + i * stride
+inline void LoadInterleaved(const float *in, size_t stride, Float4 &a,
+                            Float4 &b, Float4 &c, Float4 &d) {
+    a = Load(in);
+    b = Load(in + stride);
+    c = Load(in + 2 * stride);
+    d = Load(in + 3 * stride);
+    Transpose(a, b, c, d);
+}
+
+// Widest register for structure-of-arrays batch kernels: eight lanes with
+// AVX, otherwise Float4. Batch kernels are written once against FloatN and
+// the overloads below.
+#if defined(AQUA_SIMD_AVX)
+
+using FloatN = __m256;
+constexpr size_t WIDTH = 8;
+
+inline FloatN LoadN(const float *p) { return _mm256_loadu_ps(p); }
+inline void StoreN(float *p, FloatN v) { _mm256_storeu_ps(p, v); }
+inline FloatN SplatN(float s) { return _mm256_set1_ps(s); }
+
+inline FloatN Add(FloatN a, FloatN b) { return _mm256_add_ps(a, b); }
+inline FloatN Sub(FloatN a, FloatN b) { return _mm256_sub_ps(a, b); }
+inline FloatN Mul(FloatN a, FloatN b) { return _mm256_mul_ps(a, b); }
+inline FloatN MulAdd(FloatN a, FloatN b, FloatN c) {
+#if defined(AQUA_SIMD_FMA)
+    return _mm256_fmadd_ps(a, b, c);
+#else
+    return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+#endif
+}
+inline FloatN Round(FloatN v) {
+    return _mm256_round_ps(v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+}
+
+inline void StoreInterleaved(float *out, size_t stride, FloatN a, FloatN b,
+                             FloatN c, FloatN d) {
+    StoreInterleaved(out, stride, _mm256_castps256_ps128(a),
+                     _mm256_castps256_ps128(b), _mm256_castps256_ps128(c),
+                     _mm256_castps256_ps128(d));
+    StoreInterleaved(out + 4 * stride, stride, _mm256_extractf128_ps(a, 1),
+                     _mm256_extractf128_ps(b, 1), _mm256_extractf128_ps(c, 1),
+                     _mm256_extractf128_ps(d, 1));
+}
+
+inline void LoadInterleaved(const float *in, size_t stride, FloatN &a,
+                            FloatN &b, FloatN &c, FloatN &d) {
+    Float4 a0, b0, c0, d0, a1, b1, c1, d1;
+    LoadInterleaved(in, stride, a0, b0, c0, d0);
+    LoadInterleaved(in + 4 * stride, stride, a1, b1, c1, d1);
+    a = _mm256_insertf128_ps(_mm256_castps128_ps256(a0), a1, 1);
+    b = _mm256_insertf128_ps(_mm256_castps128_ps256(b0), b1, 1);
+    c = _mm256_insertf128_ps(_mm256_castps128_ps256(c0), c1, 1);
+    d = _mm256_insertf128_ps(_mm256_castps128_ps256(d0), d1, 1);
+}
+
+inline FloatN Min(FloatN a, FloatN b) { return _mm256_min_ps(a, b); }
+inline FloatN Max(FloatN a, FloatN b) { return _mm256_max_ps(a, b); }
+inline FloatN Abs(FloatN v) {
+    return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), v);
+}
+
+using MaskN = __m256;
+
+inline MaskN Less(FloatN a, FloatN b) {
+    return _mm256_cmp_ps(a, b, _CMP_LT_OQ);
+}
+inline MaskN Or(MaskN a, MaskN b) { return _mm256_or_ps(a, b); }
+inline int MoveMask(MaskN m) { return _mm256_movemask_ps(m); }
+inline FloatN Select(MaskN m, FloatN a, FloatN b) {
+    return _mm256_blendv_ps(b, a, m);
+}
+
+#else
+
+using FloatN = Float4;
+constexpr size_t WIDTH = 4;
+
+inline FloatN LoadN(const float *p) { return Load(p); }
+inline void StoreN(float *p, FloatN v) { Store(p, v); }
+inline FloatN SplatN(float s) { return Splat(s); }
+
+using MaskN = Mask4;
+
+#endif
+
+} // namespace Simd
+} // namespace AquaVisual
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "../Math.h"
+#include <cstddef>
+#include <vector>
+
+namespace AquaVisual {
+
+// Structure-of-arrays view of transforms: one stream per component, each
+// holding at least `count` floats. Rotations are Euler angles in radians as
+// in Transform.
+struct TransformStreams {
+    const float* positionX = nullptr;
+    const float* positionY = nullptr;
+    const float* positionZ = nullptr;
+    const float* rotationX = nullptr;
+    const float* rotationY = nullptr;
+    const float* rotationZ = nullptr;
+    const float* scaleX = nullptr;
+    const float* scaleY = nullptr;
+    const float* scaleZ = nullptr;
+
+    // View of the same streams starting at element `offset`
+    TransformStreams Offset(size_t offset) const;
+};
+
+// Owning structure-of-arrays transform storage. Rotations are kept as Euler
+// angles for the batch kernel; Set() converts from the quaternion.
+class TransformArray {
+public:
+    size_t Size() const { return m_streams[0].size(); }
+    void Resize(size_t count);
+    void Clear();
+
+    size_t Add(const Transform& transform);
+    void Set(size_t index, const Transform& transform);
+    Transform Get(size_t index) const;
+
+    TransformStreams GetStreams() const;
+
+private:
+    enum Stream {
+        POSITION_X, POSITION_Y, POSITION_Z,
+        ROTATION_X, ROTATION_Y, ROTATION_Z,
+        SCALE_X, SCALE_Y, SCALE_Z,
+        STREAM_COUNT
+    };
+
+    std::vector<float> m_streams[STREAM_COUNT];
+};
+
+namespace Math {
+
+// Write `count` world matrices T * Rz * Ry * Rx * S, the matrix that
+// Transform::GetMatrix() caches, processing Simd::WIDTH transforms per
+// iteration with polynomial sine and cosine. Angles keep full accuracy up to
+// a few thousand radians.
+void ComposeTransforms(const TransformStreams& transforms, size_t count,
+                       Matrix4* out);
+
+// ComposeTransforms split across the JobSystem worker threads
+void ComposeTransformsParallel(const TransformStreams& transforms,
+                               size_t count, Matrix4* out);
+
+} // namespace Math
+
+} // namespace AquaVisual
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "Simd.h"
 #include <cmath>
 
 namespace AquaVisual {
@@ -65,7 +66,7 @@ public:
     static Vector3 Forward() { return Vector3(0, 0, -1); }
 };
 
-class Vector4 {
+class alignas(16) Vector4 {
 public:
     float x, y, z, w;
 
@@ -98,6 +99,276 @@ Vector2 operator*(float scalar, const Vector2& vec);
 Vector3 operator*(float scalar, const Vector3& vec);
 Vector4 operator*(float scalar, const Vector4& vec);
 
+// Vector2 implementation
+inline Vector2::Vector2() : x(0.0f), y(0.0f) {}
+
+inline Vector2::Vector2(float x, float y) : x(x), y(y) {}
+
+inline Vector2::Vector2(float value) : x(value), y(value) {}
+
+inline Vector2 Vector2::operator+(const Vector2& other) const {
+    return Vector2(x + other.x, y + other.y);
+}
+
+inline Vector2 Vector2::operator-(const Vector2& other) const {
+    return Vector2(x - other.x, y - other.y);
+}
+
+inline Vector2 Vector2::operator*(float scalar) const {
+    return Vector2(x * scalar, y * scalar);
+}
+
+inline Vector2 Vector2::operator/(float scalar) const {
+    return Vector2(x / scalar, y / scalar);
+}
+
+inline Vector2& Vector2::operator+=(const Vector2& other) {
+    x += other.x;
+    y += other.y;
+    return *this;
+}
+
+inline Vector2& Vector2::operator-=(const Vector2& other) {
+    x -= other.x;
+    y -= other.y;
+    return *this;
+}
+
+inline Vector2& Vector2::operator*=(float scalar) {
+    x *= scalar;
+    y *= scalar;
+    return *this;
+}
+
+inline Vector2& Vector2::operator/=(float scalar) {
+    x /= scalar;
+    y /= scalar;
+    return *this;
+}
+
+inline float Vector2::Dot(const Vector2& other) const {
+    return x * other.x + y * other.y;
+}
+
+inline float Vector2::Length() const {
+    return std::sqrt(x * x + y * y);
+}
+
+inline float Vector2::LengthSquared() const {
+    return x * x + y * y;
+}
+
+inline Vector2 Vector2::Normalize() const {
+    float len = Length();
+    if (len > 0.0f) {
+        return *this / len;
+    }
+    return Vector2();
+}
+
+inline void Vector2::NormalizeInPlace() {
+    *this = Normalize();
+}
+
+inline Vector2 Vector2::xy() const {
+    return *this;
+}
+
+// Vector3 implementation. Three floats do not fill a SIMD register, and
+// loading them as one would read past the object, so these stay scalar and
+// rely on inlining.
+inline Vector3::Vector3() : x(0.0f), y(0.0f), z(0.0f) {}
+
+inline Vector3::Vector3(float x, float y, float z) : x(x), y(y), z(z) {}
+
+inline Vector3::Vector3(float value) : x(value), y(value), z(value) {}
+
+inline Vector3 Vector3::operator+(const Vector3& other) const {
+    return Vector3(x + other.x, y + other.y, z + other.z);
+}
+
+inline Vector3 Vector3::operator-(const Vector3& other) const {
+    return Vector3(x - other.x, y - other.y, z - other.z);
+}
+
+inline Vector3 Vector3::operator*(float scalar) const {
+    return Vector3(x * scalar, y * scalar, z * scalar);
+}
+
+inline Vector3 Vector3::operator/(float scalar) const {
+    return Vector3(x / scalar, y / scalar, z / scalar);
+}
+
+inline Vector3& Vector3::operator+=(const Vector3& other) {
+    x += other.x;
+    y += other.y;
+    z += other.z;
+    return *this;
+}
+
+inline Vector3& Vector3::operator-=(const Vector3& other) {
+    x -= other.x;
+    y -= other.y;
+    z -= other.z;
+    return *this;
+}
+
+inline Vector3& Vector3::operator*=(float scalar) {
+    x *= scalar;
+    y *= scalar;
+    z *= scalar;
+    return *this;
+}
+
+inline Vector3& Vector3::operator/=(float scalar) {
+    x /= scalar;
+    y /= scalar;
+    z /= scalar;
+    return *this;
+}
+
+inline float Vector3::Dot(const Vector3& other) const {
+    return x * other.x + y * other.y + z * other.z;
+}
+
+inline Vector3 Vector3::Cross(const Vector3& other) const {
+    return Vector3(
+        y * other.z - z * other.y,
+        z * other.x - x * other.z,
+        x * other.y - y * other.x
+    );
+}
+
+inline float Vector3::Length() const {
+    return std::sqrt(x * x + y * y + z * z);
+}
+
+inline float Vector3::LengthSquared() const {
+    return x * x + y * y + z * z;
+}
+
+inline Vector3 Vector3::Normalize() const {
+    float lengthSquared = LengthSquared();
+    if (lengthSquared > 0.0f) {
+        return *this * (1.0f / std::sqrt(lengthSquared));
+    }
+    return Vector3();
+}
+
+inline void Vector3::NormalizeInPlace() {
+    *this = Normalize();
+}
+
+inline Vector2 Vector3::xy() const {
+    return Vector2(x, y);
+}
+
+inline Vector3 Vector3::xyz() const {
+    return *this;
+}
+
+// Vector4 implementation, one SIMD register per vector
+inline Vector4::Vector4() : x(0.0f), y(0.0f), z(0.0f), w(0.0f) {}
+
+inline Vector4::Vector4(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) {}
+
+inline Vector4::Vector4(const Vector3& xyz, float w) : x(xyz.x), y(xyz.y), z(xyz.z), w(w) {}
+
+inline Vector4::Vector4(float value) : x(value), y(value), z(value), w(value) {}
+
+inline Vector4 Vector4::operator+(const Vector4& other) const {
+    Vector4 result;
+    Simd::Store(&result.x, Simd::Add(Simd::Load(&x), Simd::Load(&other.x)));
+    return result;
+}
+
+inline Vector4 Vector4::operator-(const Vector4& other) const {
+    Vector4 result;
+    Simd::Store(&result.x, Simd::Sub(Simd::Load(&x), Simd::Load(&other.x)));
+    return result;
+}
+
+inline Vector4 Vector4::operator*(float scalar) const {
+    Vector4 result;
+    Simd::Store(&result.x, Simd::Mul(Simd::Load(&x), Simd::Splat(scalar)));
+    return result;
+}
+
+inline Vector4 Vector4::operator/(float scalar) const {
+    Vector4 result;
+    Simd::Store(&result.x, Simd::Div(Simd::Load(&x), Simd::Splat(scalar)));
+    return result;
+}
+
+inline Vector4& Vector4::operator+=(const Vector4& other) {
+    return *this = *this + other;
+}
+
+inline Vector4& Vector4::operator-=(const Vector4& other) {
+    return *this = *this - other;
+}
+
+inline Vector4& Vector4::operator*=(float scalar) {
+    return *this = *this * scalar;
+}
+
+inline Vector4& Vector4::operator/=(float scalar) {
+    return *this = *this / scalar;
+}
+
+inline float Vector4::Dot(const Vector4& other) const {
+    return Simd::GetX(Simd::Dot4(Simd::Load(&x), Simd::Load(&other.x)));
+}
+
+inline float Vector4::Length() const {
+    return std::sqrt(LengthSquared());
+}
+
+inline float Vector4::LengthSquared() const {
+    return Dot(*this);
+}
+
+inline Vector4 Vector4::Normalize() const {
+    const Simd::Float4 v = Simd::Load(&x);
+    const float lengthSquared = Simd::GetX(Simd::Dot4(v, v));
+    if (lengthSquared > 0.0f) {
+        Vector4 result;
+        Simd::Store(&result.x,
+                    Simd::Div(v, Simd::Splat(std::sqrt(lengthSquared))));
+        return result;
+    }
+    return Vector4();
+}
+
+inline void Vector4::NormalizeInPlace() {
+    *this = Normalize();
+}
+
+inline Vector3 Vector4::xyz() const {
+    return Vector3(x, y, z);
+}
+
+inline Vector2 Vector4::xy() const {
+    return Vector2(x, y);
+}
+
+inline Vector4 Vector4::xyzw() const {
+    return *this;
+}
+
+// Global operator overloads
+inline Vector2 operator*(float scalar, const Vector2& vec) {
+    return vec * scalar;
+}
+
+inline Vector3 operator*(float scalar, const Vector3& vec) {
+    return vec * scalar;
+}
+
+inline Vector4 operator*(float scalar, const Vector4& vec) {
+    return vec * scalar;
+}
+
 // Type aliases for convenience
 using Vec2 = Vector2;
 using Vec3 = Vector3;
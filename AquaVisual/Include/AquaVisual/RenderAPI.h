@@ -12,7 +12,7 @@ namespace AquaVisual {
 class Texture;
 class Shader;
 class Mesh;
-struct Transform;
+class Transform;
 class Matrix4;
 
 /**
@@ -1,6 +1,9 @@
 #pragma once
 
+#include "../Math/Geometry.h"
 #include "../Math/Vector.h"
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
@@ -21,11 +24,84 @@ struct Vertex {
       : position(pos), normal(norm), texCoord(uv) {}
 };
 
+/**
+ * @brief Read-only view of a contiguous array owned by someone else
+ */
+template <typename T> class ArrayView {
+public:
+  ArrayView() = default;
+  ArrayView(const T *data, size_t size) : m_data(data), m_size(size) {}
+  ArrayView(const std::vector<T> &vector)
+      : m_data(vector.data()), m_size(vector.size()) {}
+
+  const T *data() const { return m_data; }
+  size_t size() const { return m_size; }
+  bool empty() const { return m_size == 0; }
+  const T *begin() const { return m_data; }
+  const T *end() const { return m_data + m_size; }
+  const T &operator[](size_t index) const { return m_data[index]; }
+
+  std::vector<T> ToVector() const { return std::vector<T>(begin(), end()); }
+
+private:
+  const T *m_data = nullptr;
+  size_t m_size = 0;
+};
+
+/**
+ * @brief Range of the index buffer drawn with one material
+ */
+struct Submesh {
+  uint32_t indexOffset = 0;
+  uint32_t indexCount = 0;
+  uint32_t materialIndex = 0;
+};
+
+/**
+ * @brief Simplified level of detail, a range of the LOD index stream
+ *
+ * error is the largest distance, in object space, between the level's
+ * surface and the full resolution mesh.
+ */
+struct MeshLod {
+  uint32_t indexOffset = 0;
+  uint32_t indexCount = 0;
+  float error = 0.0f;
+};
+
+/**
+ * @brief Cluster of at most 64 vertices and 124 triangles, a range of the
+ * base index buffer
+ *
+ * 32 bytes laid out for std430 storage buffers. The cone packs a snorm8
+ * axis in x, y, z and the sine of its half angle in w (rounded up); a
+ * camera at c sees only back faces when
+ * dot(center - c, axis) >= w * length(center - c) + radius.
+ * A cone of 0 never culls.
+ */
+struct Meshlet {
+  float boundingSphere[4] = {0.0f, 0.0f, 0.0f, 0.0f}; // center, radius
+  uint32_t cone = 0;
+  uint32_t firstIndex = 0;
+  uint32_t indexCount = 0;
+  uint32_t vertexCount = 0;
+};
+
 /**
  * @brief Mesh class - MVP version
+ *
+ * Vertex and index streams are normally owned by the mesh. A mesh loaded
+ * from a binary cache file (see MeshFile) instead points straight into the
+ * file mapping, which it keeps alive; modifying such a mesh first copies
+ * the streams into memory it owns.
  */
 class Mesh {
 public:
+  /**
+   * @brief Most LOD levels renderers keep resident per mesh
+   */
+  static constexpr uint32_t MAX_LODS = 8;
+
   /**
    * @brief Constructor
    * @param vertices Vertex data
@@ -34,34 +110,168 @@ public:
   Mesh(const std::vector<Vertex> &vertices,
        const std::vector<uint32_t> &indices);
 
+  /**
+   * @brief Constructor taking over the vertex and index buffers
+   * @param vertices Vertex data
+   * @param indices Index data
+   */
+  Mesh(std::vector<Vertex> &&vertices, std::vector<uint32_t> &&indices);
+
+  /**
+   * @brief Constructor referencing streams the mesh does not own
+   * @param storage Keeps the memory behind the views alive
+   * @param vertices Vertex data inside storage
+   * @param indices Index data inside storage
+   * @param bounds Bounds of the vertex positions
+   */
+  Mesh(std::shared_ptr<const void> storage, ArrayView<Vertex> vertices,
+       ArrayView<uint32_t> indices, const AABB &bounds);
+
+  /**
+   * @brief Copy constructor - the copy receives its own identity
+   */
+  Mesh(const Mesh &other);
+
+  /**
+   * @brief Copy assignment - keeps this mesh's identity, bumps its version
+   */
+  Mesh &operator=(const Mesh &other);
+
   /**
    * @brief Destructor
    */
   virtual ~Mesh() = default;
 
+  /**
+   * @brief Get unique mesh identifier
+   * @return Identifier that stays stable for the lifetime of this mesh
+   */
+  uint64_t GetId() const { return m_id; }
+
+  /**
+   * @brief Get content version
+   * @return Version number, incremented whenever vertex or index data changes
+   */
+  uint64_t GetVersion() const { return m_version; }
+
+  /**
+   * @brief Replace vertex data, dropping the LOD chain and meshlets
+   * @param vertices New vertex data
+   */
+  void SetVertices(const std::vector<Vertex> &vertices);
+
+  /**
+   * @brief Replace index data, dropping the LOD chain and meshlets
+   *
+   * The submesh table is kept only while every range still fits.
+   * @param indices New index data
+   */
+  void SetIndices(const std::vector<uint32_t> &indices);
+
+  /**
+   * @brief Replace the submesh table
+   * @param submeshes Index ranges; empty means one range covering everything
+   */
+  void SetSubmeshes(const std::vector<Submesh> &submeshes);
+
+  /**
+   * @brief Replace the LOD chain
+   * @param lods Levels ordered from most to least detailed
+   * @param lodIndices Index stream the levels' ranges refer to
+   */
+  void SetLods(const std::vector<MeshLod> &lods,
+               const std::vector<uint32_t> &lodIndices);
+
+  /**
+   * @brief Replace the meshlet table
+   * @param meshlets Clusters covering the base index buffer
+   */
+  void SetMeshlets(const std::vector<Meshlet> &meshlets);
+
+  /**
+   * @brief Mark mesh content as modified so GPU copies get refreshed
+   */
+  void MarkDirty() { ++m_version; }
+
   /**
    * @brief Get vertex data
-   * @return Vertex data reference
+   * @return View valid until the vertex data changes
    */
-  const std::vector<Vertex> &GetVertices() const { return m_vertices; }
+  ArrayView<Vertex> GetVertices() const {
+    return m_storage ? m_externalVertices : ArrayView<Vertex>(m_vertices);
+  }
 
   /**
    * @brief Get index data
-   * @return Index data reference
+   * @return View valid until the index data changes
    */
-  const std::vector<uint32_t> &GetIndices() const { return m_indices; }
+  ArrayView<uint32_t> GetIndices() const {
+    return m_storage ? m_externalIndices : ArrayView<uint32_t>(m_indices);
+  }
 
   /**
    * @brief Get vertex count
    * @return Vertex count
    */
-  size_t GetVertexCount() const { return m_vertices.size(); }
+  size_t GetVertexCount() const { return GetVertices().size(); }
 
   /**
    * @brief Get index count
    * @return Index count
    */
-  size_t GetIndexCount() const { return m_indices.size(); }
+  size_t GetIndexCount() const { return GetIndices().size(); }
+
+  /**
+   * @brief Get the bounds of the vertex positions
+   * @return Bounding box, invalid for a mesh without vertices
+   */
+  const AABB &GetBounds() const { return m_bounds; }
+
+  /**
+   * @brief Get the submesh table
+   * @return Index ranges; empty means one range covering everything
+   */
+  const std::vector<Submesh> &GetSubmeshes() const { return m_submeshes; }
+
+  /**
+   * @brief Get the LOD chain
+   *
+   * LOD indices refer to the current vertices and are simplified from the
+   * current indices, so replacing either drops the chain.
+   * @return Levels ordered from most to least detailed, may be empty
+   */
+  const std::vector<MeshLod> &GetLods() const { return m_lods; }
+
+  /**
+   * @brief Get the meshlet table
+   *
+   * Meshlets describe the current vertices and index order, so replacing
+   * either drops them.
+   * @return Clusters of the base index buffer, may be empty
+   */
+  const std::vector<Meshlet> &GetMeshlets() const { return m_meshlets; }
+
+  /**
+   * @brief Pick the coarsest LOD level within an error limit
+   * @param maxError Largest acceptable object space error
+   * @return 0 for the full mesh, i + 1 for GetLods()[i]
+   */
+  uint32_t SelectLod(float maxError) const;
+
+  /**
+   * @brief Get the index stream the LOD ranges refer to
+   * @return View valid until the LOD chain changes
+   */
+  ArrayView<uint32_t> GetLodIndices() const {
+    return m_storage ? m_externalLodIndices
+                     : ArrayView<uint32_t>(m_lodIndices);
+  }
+
+  /**
+   * @brief Check whether the streams live in memory the mesh does not own
+   * @return True for meshes mapped from a cache file
+   */
+  bool IsExternal() const { return m_storage != nullptr; }
 
   /**
    * @brief Create cube mesh
@@ -87,15 +297,46 @@ public:
   static std::unique_ptr<Mesh> CreateTriangle(float size = 1.0f);
 
   /**
-   * @brief Load mesh from file (simple OBJ format)
+   * @brief Load mesh from a Wavefront OBJ file (see ObjLoader) or, for the
+   * .aqmesh extension, map a binary cache file (see MeshFile)
+   *
+   * OBJ files go through MeshFile::LoadCached, so the cache next to the
+   * source (filepath + MeshFile::EXTENSION) is mapped while it matches and
+   * rebuilt otherwise. A rebuild gives the mesh a LOD chain from
+   * MeshSimplifier, reorders it with MeshOptimizer::Optimize and, from
+   * MeshletBuilder::MIN_MESH_TRIANGLES on, splits it into meshlets.
    * @param filepath File path
-   * @return Mesh object
+   * @return Mesh object, or nullptr if the file cannot be loaded
    */
   static std::unique_ptr<Mesh> LoadFromFile(const std::string &filepath);
 
 protected:
   std::vector<Vertex> m_vertices;
   std::vector<uint32_t> m_indices;
+
+private:
+  friend class MeshFile;
+
+  static uint64_t NextId();
+  // Parse and preprocess an OBJ file, bypassing the cache
+  static std::unique_ptr<Mesh> BuildFromObj(const std::string &filepath);
+  // Copy external streams into owned storage before they are modified
+  void Detach();
+
+  // Non-null when the streams below point into memory owned by it
+  std::shared_ptr<const void> m_storage;
+  ArrayView<Vertex> m_externalVertices;
+  ArrayView<uint32_t> m_externalIndices;
+  ArrayView<uint32_t> m_externalLodIndices;
+
+  std::vector<uint32_t> m_lodIndices;
+  std::vector<Submesh> m_submeshes;
+  std::vector<MeshLod> m_lods;
+  std::vector<Meshlet> m_meshlets;
+  AABB m_bounds;
+
+  uint64_t m_id;
+  uint64_t m_version = 1;
 };
 
 } // namespace AquaVisual
\ No newline at end of file
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "Mesh.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace AquaVisual {
+
+/**
+ * @brief Binary mesh cache container
+ *
+ * A fixed header followed by the vertex, index, submesh, LOD and LOD index
+ * sections, each starting on an ALIGNMENT byte boundary. Streams are stored
+ * in the in-memory layout, in native byte order, so Load() maps the file
+ * and hands the mesh pointers into the mapping without copying a vertex.
+ *
+ * The header records a hash of the source file the cache was built from;
+ * LoadCached() rebuilds the cache whenever the source no longer matches.
+ */
+class MeshFile {
+public:
+  static constexpr uint32_t MAGIC = 0x48534D41; // "AMSH" in little endian
+  static constexpr uint32_t VERSION = 4; // 2: streams stored optimized
+                                         // 3: LOD chain generated
+                                         // 4: meshlets
+  static constexpr uint32_t ALIGNMENT = 64;
+  static constexpr const char *EXTENSION = ".aqmesh";
+
+  /**
+   * @brief Byte offset and element count of one section
+   */
+  struct Section {
+    uint64_t offset;
+    uint64_t count;
+  };
+
+  /**
+   * @brief File header, at offset 0
+   */
+  struct Header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t vertexSize; // sizeof(Vertex) when written
+    uint32_t flags;      // reserved, 0
+    uint64_t fileSize;
+    uint64_t sourceHash;
+    uint64_t sourceSize;
+    float boundsMin[3];
+    float boundsMax[3];
+    Section vertices;
+    Section indices;
+    Section submeshes;
+    Section lods;
+    Section lodIndices;
+    Section meshlets;
+  };
+
+  /**
+   * @brief Write a mesh to a cache file
+   *
+   * The file is written next to its final name and renamed into place, so
+   * readers never see a partial file.
+   * @param path Destination path
+   * @param mesh Mesh to store
+   * @param sourceHash Hash of the source file (see HashFile)
+   * @param sourceSize Size of the source file in bytes
+   * @return False if the file cannot be written
+   */
+  static bool Save(const std::string &path, const Mesh &mesh,
+                   uint64_t sourceHash = 0, uint64_t sourceSize = 0);
+
+  /**
+   * @brief Map a cache file and create a mesh pointing into it
+   * @param path Cache file path
+   * @return Mesh object, or nullptr if the file is missing or invalid
+   */
+  static std::unique_ptr<Mesh> Load(const std::string &path);
+
+  /**
+   * @brief Read and validate the header of a cache file
+   * @param path Cache file path
+   * @param header Receives the header
+   * @return False if the file is missing or not a current cache file
+   */
+  static bool ReadHeader(const std::string &path, Header &header);
+
+  /**
+   * @brief Load a mesh through its cache file
+   *
+   * Maps the cache when its recorded hash matches the source, otherwise
+   * parses the OBJ source and rewrites the cache. When the source is
+   * missing, any valid cache is used as is.
+   * @param sourcePath Source mesh path
+   * @param cachePath Cache path; empty means sourcePath + EXTENSION
+   * @return Mesh object, or nullptr if neither file can be loaded
+   */
+  static std::unique_ptr<Mesh>
+  LoadCached(const std::string &sourcePath,
+             const std::string &cachePath = std::string());
+
+  /**
+   * @brief Hash a file's contents
+   *
+   * Fixed size blocks are hashed in parallel on the JobSystem and then
+   * combined, so the result does not depend on the worker count.
+   * @param path File path
+   * @param hash Receives the hash
+   * @param size Receives the file size
+   * @return False if the file cannot be read
+   */
+  static bool HashFile(const std::string &path, uint64_t &hash,
+                       uint64_t &size);
+
+  /**
+   * @brief Hash a block of memory
+   * @param data Bytes to hash
+   * @param size Byte count
+   * @param seed Initial value
+   * @return 64-bit hash
+   */
+  static uint64_t Hash(const void *data, size_t size, uint64_t seed = 0);
+};
+
+} // namespace AquaVisual
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "Mesh.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace AquaVisual {
+
+/**
+ * @brief Index and vertex reordering that reduces GPU vertex work
+ *
+ * Optimize() runs three passes over a mesh:
+ *  - vertex cache: triangles are reordered with Tom Forsyth's greedy
+ *    scoring so recently transformed vertices are reused
+ *  - overdraw: the cache-ordered triangles are cut into clusters at points
+ *    where the cache is cold anyway, and clusters facing away from the mesh
+ *    center are drawn first so they occlude the rest
+ *  - vertex fetch: vertices are renumbered in first-use order and unused
+ *    ones dropped, so vertex fetches walk memory forwards
+ *
+ * Index arrays passed to the functions below must hold whole triangles and
+ * reference only vertices below vertexCount.
+ */
+namespace MeshOptimizer {
+
+/**
+ * @brief FIFO post-transform cache size used for the statistics
+ */
+constexpr uint32_t DEFAULT_CACHE_SIZE = 16;
+
+/**
+ * @brief Post-transform vertex cache statistics
+ */
+struct VertexCacheStats {
+  uint32_t vertexTransforms = 0; // cache misses
+  float acmr = 0.0f; // transforms per triangle; 0.5 is ideal, 3 the worst
+  float atvr = 0.0f; // transforms per referenced vertex; 1 is ideal
+};
+
+/**
+ * @brief Result of Optimize()
+ */
+struct Report {
+  VertexCacheStats before;
+  VertexCacheStats after;
+  size_t vertexCountBefore = 0;
+  size_t vertexCountAfter = 0;
+};
+
+/**
+ * @brief Simulate a FIFO vertex cache over an index buffer
+ * @param indices Triangle list
+ * @param vertexCount Number of vertices the indices refer to
+ * @param cacheSize Cache entries
+ * @return Cache statistics
+ */
+VertexCacheStats AnalyzeVertexCache(ArrayView<uint32_t> indices,
+                                    size_t vertexCount,
+                                    uint32_t cacheSize = DEFAULT_CACHE_SIZE);
+
+/**
+ * @brief Reorder triangles for the post-transform vertex cache
+ * @param indices Triangle list
+ * @param vertexCount Number of vertices the indices refer to
+ * @return The same triangles in cache friendly order
+ */
+std::vector<uint32_t> OptimizeVertexCache(ArrayView<uint32_t> indices,
+                                          size_t vertexCount);
+
+/**
+ * @brief Reorder cache-optimized triangles to reduce overdraw
+ * @param indices Triangle list, ideally from OptimizeVertexCache()
+ * @param vertices Vertices the indices refer to
+ * @param threshold How much worse than the input the ACMR may get
+ * @return The same triangles in clustered, outside-in order
+ */
+std::vector<uint32_t> OptimizeOverdraw(ArrayView<uint32_t> indices,
+                                       ArrayView<Vertex> vertices,
+                                       float threshold = 1.05f);
+
+/**
+ * @brief Renumber vertices in first-use order and drop unused ones
+ * @param vertices Vertex data, reordered in place
+ * @param indices Triangle list, remapped in place
+ * @return New vertex count
+ */
+size_t OptimizeVertexFetch(std::vector<Vertex> &vertices,
+                           std::vector<uint32_t> &indices);
+
+/**
+ * @brief Run all passes on a mesh
+ *
+ * Each submesh and each LOD level is reordered on its own, so ranges keep
+ * their offsets and sizes. Meshes with out-of-range indices are left
+ * untouched.
+ * @param mesh Mesh to optimize
+ * @return Statistics for the base index buffer before and after
+ */
+Report Optimize(Mesh &mesh);
+
+} // namespace MeshOptimizer
+
+} // namespace AquaVisual
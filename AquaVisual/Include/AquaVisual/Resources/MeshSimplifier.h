@@ -0,0 +1,64 @@
+#pragma once
+
+#include "Mesh.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace AquaVisual {
+
+/**
+ * @brief Quadric error metric mesh simplification and LOD generation
+ *
+ * Edges are collapsed cheapest first, the cost being the squared distance
+ * of the moved vertex to the planes of the triangles merged into it.
+ * Vertices only ever move onto a neighbor, so attributes stay exact.
+ *
+ * Vertices sharing a position with different normals or texture
+ * coordinates form attribute seams. A vertex on a seam with one partner
+ * only collapses along the seam, together with its partner, so texture
+ * and shading discontinuities keep their shape; open borders only collapse
+ * along the border; corners where more than two attribute sets meet are
+ * never moved. Collapses that would flip a triangle are rejected.
+ */
+namespace MeshSimplifier {
+
+/**
+ * @brief Settings for GenerateLods()
+ */
+struct LodOptions {
+  uint32_t maxLevels = 4;    // at most Mesh::MAX_LODS
+  float reduction = 0.5f;    // triangle ratio between consecutive levels
+  size_t minTriangles = 16;  // no level below this many triangles
+  float maxError = 0.05f;    // largest error, relative to the bounds size
+};
+
+/**
+ * @brief Simplify a triangle list
+ * @param vertices Vertices the indices refer to
+ * @param indices Triangle list
+ * @param targetIndexCount Stop once the list is this small
+ * @param targetError Stop before an object space error this large
+ * @param resultError Receives the error reached, may be null
+ * @return Triangle list using a subset of the same vertices
+ */
+std::vector<uint32_t> Simplify(ArrayView<Vertex> vertices,
+                               ArrayView<uint32_t> indices,
+                               size_t targetIndexCount, float targetError,
+                               float *resultError = nullptr);
+
+/**
+ * @brief Build a LOD chain and store it on the mesh
+ *
+ * Each level simplifies the previous one; the error recorded for a level
+ * is the sum of the errors of all steps from the full mesh. Meshes with
+ * several submeshes are not supported.
+ * @param mesh Mesh to receive the chain
+ * @param options Level count and limits
+ * @return False if no level could be built
+ */
+bool GenerateLods(Mesh &mesh, const LodOptions &options = LodOptions());
+
+} // namespace MeshSimplifier
+
+} // namespace AquaVisual
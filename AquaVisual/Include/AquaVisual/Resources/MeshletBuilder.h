@@ -0,0 +1,64 @@
+#pragma once
+
+#include "Mesh.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace AquaVisual {
+
+/**
+ * @brief Splitting of meshes into small clusters for per-cluster culling
+ *
+ * Triangles are grown greedily into clusters: each step adds the
+ * neighboring triangle that brings in the fewest new vertices, ties going
+ * to the one closest to the cluster center, which keeps clusters compact
+ * and their bounding spheres tight. The index buffer is reordered so every
+ * meshlet is a contiguous range and can be drawn on its own.
+ *
+ * Normal cones are only built for closed meshes: the pipeline draws both
+ * faces, so a cluster facing away is only guaranteed hidden when the rest
+ * of the surface is in front of it. Facing follows the vertex normals
+ * rather than the winding.
+ */
+namespace MeshletBuilder {
+
+constexpr uint32_t MAX_VERTICES = 64;
+constexpr uint32_t MAX_TRIANGLES = 124;
+
+/**
+ * @brief Meshes smaller than this are drawn whole by Mesh::LoadFromFile
+ */
+constexpr size_t MIN_MESH_TRIANGLES = 4096;
+
+/**
+ * @brief Build meshlets over a triangle list
+ * @param vertices Vertices the indices refer to
+ * @param indices Triangle list, reordered in place meshlet by meshlet
+ * @param firstIndex Offset of indices within the mesh index buffer
+ * @param cones Whether to compute normal cones
+ * @return Meshlets in index order
+ */
+std::vector<Meshlet> Build(ArrayView<Vertex> vertices,
+                           std::vector<uint32_t> &indices,
+                           uint32_t firstIndex = 0, bool cones = true);
+
+/**
+ * @brief Split a mesh into meshlets, one set per submesh
+ * @param mesh Mesh whose index buffer is reordered
+ * @return False for meshes without triangles or with out-of-range indices
+ */
+bool Build(Mesh &mesh);
+
+/**
+ * @brief Unpack a meshlet's normal cone
+ * @param meshlet Meshlet to read
+ * @param axis Receives the unit cone axis
+ * @param cutoff Receives the sine of the cone half angle
+ * @return False if the meshlet has no cone
+ */
+bool DecodeCone(const Meshlet &meshlet, Vec3 &axis, float &cutoff);
+
+} // namespace MeshletBuilder
+
+} // namespace AquaVisual
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "Mesh.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace AquaVisual {
+
+/**
+ * @brief Wavefront OBJ geometry loader used by Mesh::LoadFromFile
+ *
+ * Reads v, vt, vn and f records; other records (groups, materials, lines)
+ * are skipped. Polygons are fan-triangulated, negative (relative) indices
+ * are supported, and each distinct v/vt/vn combination becomes one vertex.
+ * Normals are generated, area weighted, when the file has none.
+ *
+ * The file is memory-mapped and split at line boundaries into chunks that
+ * are parsed on the JobSystem workers with a hand-written number parser.
+ */
+namespace ObjLoader {
+
+/**
+ * @brief Load an OBJ file
+ * @param filepath File path
+ * @param vertices Receives the deduplicated vertices
+ * @param indices Receives the triangle list
+ * @return False if the file cannot be read or is malformed
+ */
+bool Load(const std::string &filepath, std::vector<Vertex> &vertices,
+          std::vector<uint32_t> &indices);
+
+/**
+ * @brief Parse OBJ text already in memory
+ * @param data Text, not necessarily null terminated
+ * @param size Text size in bytes
+ * @param vertices Receives the deduplicated vertices
+ * @param indices Receives the triangle list
+ * @return False if the text is malformed
+ */
+bool Parse(const char *data, size_t size, std::vector<Vertex> &vertices,
+           std::vector<uint32_t> &indices);
+
+} // namespace ObjLoader
+
+} // namespace AquaVisual
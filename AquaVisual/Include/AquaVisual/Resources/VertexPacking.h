@@ -0,0 +1,93 @@
+#pragma once
+
+#include "Mesh.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace AquaVisual {
+
+/**
+ * @brief Layout of vertex streams in GPU memory
+ */
+enum class VertexFormat : uint8_t {
+  Float32 = 0, // Vertex as is, 32 bytes
+  Packed = 1   // PackedVertex, 16 bytes
+};
+
+/**
+ * @brief Quantized vertex, half the size of Vertex
+ *
+ * Vertex input formats: position R16G16B16A16_UNORM, normal R16G16_SNORM,
+ * texCoord R16G16_SFLOAT. Positions are fractions of the mesh bounds (see
+ * VertexQuantization), normals are octahedral encoded and texture
+ * coordinates are half floats.
+ */
+struct PackedVertex {
+  uint16_t position[4]; // w unused, 0
+  int16_t normal[2];
+  uint16_t texCoord[2];
+};
+
+/**
+ * @brief Maps quantized positions back to object space:
+ * position = offset + unorm * scale
+ */
+struct VertexQuantization {
+  float offset[3] = {0.0f, 0.0f, 0.0f};
+  float scale[3] = {1.0f, 1.0f, 1.0f};
+};
+
+/**
+ * @brief Conversion of vertices to PackedVertex
+ *
+ * Within the bounds, positions are off by at most half a step of
+ * 1/65535 of the bounds on each axis. Normals are within 0.05 degrees.
+ * Texture coordinates keep 11 significant bits, which is exact up to 2048
+ * texels across a [0, 1] range.
+ */
+namespace VertexPacking {
+
+/**
+ * @brief Bytes per vertex of a format
+ */
+constexpr uint32_t GetStride(VertexFormat format) {
+  return format == VertexFormat::Packed ? sizeof(PackedVertex)
+                                        : sizeof(Vertex);
+}
+
+/**
+ * @brief Quantization spanning a mesh's bounds
+ * @param bounds Object space bounds, usually Mesh::GetBounds()
+ */
+VertexQuantization ComputeQuantization(const AABB &bounds);
+
+/**
+ * @brief Pack vertices
+ * @param vertices Vertices to convert
+ * @param quantization Position mapping, positions outside are clamped
+ * @param out Receives vertices.size() packed vertices
+ */
+void Pack(ArrayView<Vertex> vertices, const VertexQuantization &quantization,
+          PackedVertex *out);
+
+/**
+ * @brief Decode a packed vertex the way the vertex shaders do
+ */
+Vertex Unpack(const PackedVertex &vertex,
+              const VertexQuantization &quantization);
+
+/**
+ * @brief Octahedral encoding of a unit vector into two snorm16 values
+ */
+void EncodeOctahedral(const Vec3 &normal, int16_t out[2]);
+Vec3 DecodeOctahedral(const int16_t encoded[2]);
+
+/**
+ * @brief IEEE 754 binary16 conversion, rounding to nearest even
+ */
+uint16_t FloatToHalf(float value);
+float HalfToFloat(uint16_t value);
+
+} // namespace VertexPacking
+
+} // namespace AquaVisual
@@ -8,7 +8,12 @@
  * 创建和渲染具有光照效果的3D场景。
  */
 
-#include "AquaVisual/Math/Vector.h"
+#include "AquaVisual/Core/DynamicBVH.h"
+#include "AquaVisual/Core/LooseOctree.h"
+#include "AquaVisual/Core/OcclusionCuller.h"
+#include "AquaVisual/Core/SpatialHashGrid.h"
+#include "AquaVisual/Math.h"
+#include <cstdint>
 #include <memory>
 #include <vector>
 #include <string>
@@ -59,22 +64,21 @@ struct Material {
 
 /**
  * @brief 变换信息
+ *
+ * 旋转以四元数保存，模型矩阵按需重建并缓存 (见 AquaVisual::Transform)；
+ * 这里的构造函数接受欧拉角 (度)
  */
-struct Transform {
-    Vector3 position;
-    Vector3 rotation;  // 欧拉角 (度)
-    Vector3 scale;
-    
+struct Transform : public AquaVisual::Transform {
     Transform(const Vector3& pos = Vector3(0, 0, 0),
-              const Vector3& rot = Vector3(0, 0, 0),
+              const Vector3& rot = Vector3(0, 0, 0),  // 欧拉角 (度)
               const Vector3& scl = Vector3(1, 1, 1))
-        : position(pos), rotation(rot), scale(scl) {}
+        : AquaVisual::Transform(pos, rot * (Math::PI / 180.0f), scl) {}
 };
 
 /**
  * @brief 简单的3D对象
  */
-class SimpleObject {
+class SimpleObject : public std::enable_shared_from_this<SimpleObject> {
 public:
     SimpleObject(ObjectType type, const Transform& transform = Transform(), 
                  const Material& material = Material());
@@ -82,7 +86,7 @@ public:
     
     // 设置变换
     void SetPosition(const Vector3& position);
-    void SetRotation(const Vector3& rotation);
+    void SetRotation(const Vector3& rotation);  // 欧拉角 (度)
     void SetScale(const Vector3& scale);
     void SetTransform(const Transform& transform);
     
@@ -95,6 +99,14 @@ public:
     const Material& GetMaterial() const { return m_material; }
     ObjectType GetType() const { return m_type; }
     
+    // 世界空间包围盒（网格局部包围盒经过模型矩阵变换）
+    AABB GetWorldBounds() const;
+    
+    // 遮挡体：开启遮挡剔除时，可见的遮挡体先写入软件深度缓冲，
+    // 被它们完全挡住的其他对象不会提交。适合墙、地形等大而简单的对象
+    void SetOccluder(bool occluder) { m_occluder = occluder; }
+    bool IsOccluder() const { return m_occluder; }
+    
     // 动画支持
     void SetAnimationEnabled(bool enabled) { m_animationEnabled = enabled; }
     void SetRotationSpeed(const Vector3& speed) { m_rotationSpeed = speed; }
@@ -105,6 +117,11 @@ private:
     Material m_material;
     bool m_animationEnabled;
     Vector3 m_rotationSpeed;
+    bool m_occluder;
+    
+    // 变换版本，每次修改变换时递增；对象可以被多个场景共享，
+    // 各场景据此判断自己索引中的代理是否需要更新
+    uint64_t m_transformVersion;
     
     friend class SimpleScene;
 };
@@ -149,6 +166,8 @@ private:
 class SimpleScene {
 public:
     SimpleScene();
+    SimpleScene(const SimpleScene& other);
+    SimpleScene& operator=(const SimpleScene& other);
     ~SimpleScene();
     
     // 对象管理
@@ -181,8 +200,44 @@ public:
     // 更新场景（处理动画等）
     void Update(float deltaTime);
     
+    /**
+     * @brief 空间查询
+     *
+     * 对象默认保存在动态包围体层次 (DynamicBVH) 中，查询代价约为 O(log n)；
+     * 大量对象每帧移动时可用 SetSpatialIndex 换成 SpatialHashGrid 或
+     * LooseOctree。
+     * 查询前会刷新移动过的对象；结果以对象的宽松包围盒为准，会追加到
+     * results 中，顺序不定
+     */
+    void QueryFrustum(const Frustum& frustum, std::vector<SimpleObject*>& results) const;
+    void QueryBox(const AABB& box, std::vector<SimpleObject*>& results) const;
+    void QuerySphere(const BoundingSphere& sphere, std::vector<SimpleObject*>& results) const;
+    
+    /**
+     * @brief 拾取射线最先击中的对象（按世界包围盒），没有则返回空
+     * @param distance 可选，输出击中距离
+     */
+    std::shared_ptr<SimpleObject> Pick(const Ray& ray, float* distance = nullptr) const;
+    
+    /**
+     * @brief 更换空间索引，现有对象会重新插入新索引
+     */
+    void SetSpatialIndex(std::unique_ptr<SpatialIndex> index);
+    const SpatialIndex& GetSpatialIndex() const;
+    
 private:
+    // 把变换改变过的对象同步到空间索引
+    void RefreshSpatialIndex() const;
+    
+    // 对象在本场景索引中的代理和已同步的变换版本
+    struct ObjectProxy {
+        int32_t proxy;
+        uint64_t version;
+    };
+    
     std::vector<std::shared_ptr<SimpleObject>> m_objects;
+    // 与 m_objects 一一对应
+    mutable std::vector<ObjectProxy> m_proxies;
     std::vector<std::shared_ptr<SimpleLight>> m_lights;
     Vector3 m_ambientColor;
     float m_ambientIntensity;
@@ -191,6 +246,8 @@ private:
     Vector3 m_cameraTarget;
     float m_cameraFOV;
     
+    std::unique_ptr<SpatialIndex> m_spatialIndex;
+    
     friend class SimpleRenderer;
 };
 
@@ -210,11 +267,21 @@ public:
         bool vsync = true;
         bool enableValidation = false;
         
-        Config() = default;
+        Config() {}
         Config(int w, int h, const std::string& t = "AquaVisual Simple Renderer")
             : width(w), height(h), title(t) {}
     };
     
+    /**
+     * @brief 上一次 RenderScene 的统计
+     */
+    struct Stats {
+        uint32_t totalObjects = 0;
+        uint32_t visibleObjects = 0;   // 通过剔除并提交的对象
+        uint32_t culledObjects = 0;    // 视锥外的对象
+        uint32_t occludedObjects = 0;  // 视锥内但被遮挡体挡住的对象
+    };
+    
     SimpleRenderer();
     ~SimpleRenderer();
     
@@ -234,13 +301,32 @@ public:
     // 实用方法
     bool IsInitialized() const { return m_initialized; }
     
+    /**
+     * @brief 视锥剔除（默认开启）
+     *
+     * 先通过场景的空间索引查询相机视锥内的候选对象，再用 FrustumCuller
+     * 在工作线程上测试候选对象的世界包围盒，只提交可见对象
+     */
+    void SetCullingEnabled(bool enabled);
+    bool IsCullingEnabled() const;
+    
+    /**
+     * @brief 遮挡剔除（默认关闭）
+     *
+     * 在CPU上把标记为遮挡体的对象光栅化到低分辨率深度缓冲
+     * (见 OcclusionCuller)，再用对象包围盒测试，不需要GPU回读
+     */
+    void SetOcclusionCullingEnabled(bool enabled);
+    bool IsOcclusionCullingEnabled() const;
+    const Stats& GetStats() const;
+    
     /**
      * @brief 一键渲染场景（简化版本）
-     * @param scene 要渲染的场景
+     * @param scene 要渲染的场景，每帧在原场景上调用 Update
      * @param maxFrames 最大帧数，0表示无限制
      * @return 是否成功完成渲染
      */
-    bool RenderSceneLoop(const SimpleScene& scene, int maxFrames = 0);
+    bool RenderSceneLoop(SimpleScene& scene, int maxFrames = 0);
     
 private:
     class Impl;
@@ -260,11 +346,11 @@ namespace QuickStart {
     
     /**
      * @brief 快速显示场景
-     * @param scene 要显示的场景
+     * @param scene 要显示的场景，动画会更新到场景本身
      * @param config 渲染器配置
      * @param duration 显示时长（秒），0表示直到用户关闭窗口
      */
-    bool ShowScene(const SimpleScene& scene, 
+    bool ShowScene(SimpleScene& scene, 
                    const SimpleRenderer::Config& config = SimpleRenderer::Config(),
                    float duration = 0.0f);
     
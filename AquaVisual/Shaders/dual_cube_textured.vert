@@ -1,8 +1,11 @@
 #version 450
 
+// Camera block, bound with a dynamic offset; per-object transforms come
+// from the instance stream
 layout(binding = 0) uniform UniformBufferObject {
     mat4 view;
     mat4 proj;
+    mat4 model;
 } ubo;
 
 layout(push_constant) uniform PushConstants {
@@ -14,6 +17,10 @@ layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec3 inColor;
 layout(location = 2) in vec2 inTexCoord;
 
+// Per-instance attributes (binding 1)
+layout(location = 3) in mat4 inInstanceModel;
+layout(location = 7) in vec4 inInstanceColor;
+
 layout(location = 0) out vec3 fragColor;
 layout(location = 1) out vec2 fragTexCoord;
 
@@ -56,7 +63,7 @@ void main() {
         worldPos = rotatedPos + cubeCenter;
         
         // 左边立方体：根据法线设置颜色
-        fragColor = inColor;
+        fragColor = inColor * inInstanceColor.rgb;
     } else {
         // 右边立方体：先移到原点，旋转，再移回原位置
         vec3 cubeCenter = vec3(2.0, 0.0, 0.0);
@@ -69,10 +76,10 @@ void main() {
         worldPos = rotatedPos + cubeCenter;
         
         // 右边立方体：使用白色作为基色，让纹理显示
-        fragColor = vec3(1.0, 1.0, 1.0);
+        fragColor = inInstanceColor.rgb;
     }
     
     fragTexCoord = inTexCoord;
     
-    gl_Position = ubo.proj * ubo.view * vec4(worldPos, 1.0);
+    gl_Position = ubo.proj * ubo.view * ubo.model * inInstanceModel * vec4(worldPos, 1.0);
 }
\ No newline at end of file
@@ -0,0 +1,100 @@
+#version 450
+
+// Packed vertex variant of dual_cube_textured.vert (VertexFormat::Packed).
+// The block bound for each mesh carries its position dequantization;
+// per-object transforms come from the instance stream
+layout(binding = 0) uniform UniformBufferObject {
+    mat4 view;
+    mat4 proj;
+    mat4 model;
+    vec4 positionOffset; // xyz, unused
+    vec4 positionScale;  // xyz, unused
+} ubo;
+
+layout(push_constant) uniform PushConstants {
+    float time;
+    float aspectRatio;
+} pc;
+
+layout(location = 0) in vec4 inQuantizedPosition; // unorm16 within bounds
+layout(location = 1) in vec2 inOctahedralNormal;  // snorm16
+layout(location = 2) in vec2 inTexCoord;          // half floats
+
+// Per-instance attributes (binding 1)
+layout(location = 3) in mat4 inInstanceModel;
+layout(location = 7) in vec4 inInstanceColor;
+
+layout(location = 0) out vec3 fragColor;
+layout(location = 1) out vec2 fragTexCoord;
+
+// Inverse of the octahedral mapping in VertexPacking::EncodeOctahedral
+vec3 decodeOctahedral(vec2 e) {
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.x += n.x >= 0.0 ? -t : t;
+    n.y += n.y >= 0.0 ? -t : t;
+    return normalize(n);
+}
+
+// 旋转矩阵函数
+mat4 rotationY(float angle) {
+    float c = cos(angle);
+    float s = sin(angle);
+    return mat4(
+        c,  0.0, s,  0.0,
+        0.0, 1.0, 0.0, 0.0,
+        -s, 0.0, c,  0.0,
+        0.0, 0.0, 0.0, 1.0
+    );
+}
+
+mat4 rotationX(float angle) {
+    float c = cos(angle);
+    float s = sin(angle);
+    return mat4(
+        1.0, 0.0, 0.0, 0.0,
+        0.0, c,  -s,  0.0,
+        0.0, s,   c,  0.0,
+        0.0, 0.0, 0.0, 1.0
+    );
+}
+
+void main() {
+    vec3 inPosition = ubo.positionOffset.xyz +
+                      inQuantizedPosition.xyz * ubo.positionScale.xyz;
+    vec3 inColor = decodeOctahedral(inOctahedralNormal);
+    vec3 localPos = inPosition;
+    vec3 worldPos;
+    
+    // 根据X坐标判断是左边还是右边的立方体
+    if (inPosition.x < 0.0) {
+        // 左边立方体：先移到原点，旋转，再移回原位置
+        vec3 cubeCenter = vec3(-2.0, 0.0, 0.0);
+        vec3 relativePos = localPos - cubeCenter;
+        
+        // 绕Y轴旋转
+        mat4 rotation = rotationY(pc.time);
+        vec3 rotatedPos = (rotation * vec4(relativePos, 1.0)).xyz;
+        worldPos = rotatedPos + cubeCenter;
+        
+        // 左边立方体：根据法线设置颜色
+        fragColor = inColor * inInstanceColor.rgb;
+    } else {
+        // 右边立方体：先移到原点，旋转，再移回原位置
+        vec3 cubeCenter = vec3(2.0, 0.0, 0.0);
+        vec3 relativePos = localPos - cubeCenter;
+        
+        // 绕Y轴和X轴旋转
+        mat4 rotationYMat = rotationY(pc.time);
+        mat4 rotationXMat = rotationX(pc.time * 0.7);
+        vec3 rotatedPos = (rotationYMat * rotationXMat * vec4(relativePos, 1.0)).xyz;
+        worldPos = rotatedPos + cubeCenter;
+        
+        // 右边立方体：使用白色作为基色，让纹理显示
+        fragColor = inInstanceColor.rgb;
+    }
+    
+    fragTexCoord = inTexCoord;
+    
+    gl_Position = ubo.proj * ubo.view * ubo.model * inInstanceModel * vec4(worldPos, 1.0);
+}
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "../Include/AquaVisual/AquaVisual.h"
+#include "../Include/AquaVisual/Core/JobSystem.h"
 #include <iostream>
 #include <memory>
 
@@ -13,6 +14,10 @@ bool Initialize() {
     }
     
     std::cout << "Initializing AquaVisual..." << std::endl;
+    
+    // Worker threads for parallel culling and transform batches
+    JobSystem::Instance().Initialize();
+    
     g_initialized = true;
     std::cout << "AquaVisual initialized successfully" << std::endl;
     return true;
@@ -24,6 +29,7 @@ void Shutdown() {
     }
     
     std::cout << "Shutting down AquaVisual..." << std::endl;
+    JobSystem::Instance().Shutdown();
     g_initialized = false;
     std::cout << "AquaVisual shutdown complete" << std::endl;
 }
@@ -1,5 +1,7 @@
 #include "AquaVisual/Core/BufferManager.h"
+#include "AquaVisual/Core/UploadManager.h"
 #include <algorithm>
+#include <cstring>
 #include <iostream>
 
 #ifdef AQUA_HAS_VULKAN
@@ -62,13 +64,30 @@ bool VulkanBuffer::UpdateData(const void *data, size_t size, size_t offset) {
   }
 
 #ifdef AQUA_HAS_VULKAN
-  if (m_device != VK_NULL_HANDLE && m_memory != VK_NULL_HANDLE) {
-    void *mappedData;
-    VkResult result =
-        vkMapMemory(m_device, m_memory, offset, size, 0, &mappedData);
-    if (result == VK_SUCCESS) {
-      memcpy(mappedData, data, size);
-      vkUnmapMemory(m_device, m_memory);
+  if (m_device != VK_NULL_HANDLE && m_deviceLocal) {
+    // Staged and copied on the transfer queue before the next frame's draws
+    if (UploadManager::Instance().Upload(m_buffer, data, size, offset)) {
+      return true;
+    }
+    std::cerr << "Failed to stage Vulkan buffer upload" << std::endl;
+    return false;
+  }
+
+  // Mapped buffers take the hot path: no driver call on coherent memory
+  if (m_mappedData) {
+    memcpy(static_cast<char *>(m_mappedData) + offset, data, size);
+    return m_coherent || Flush(size, offset);
+  }
+
+  if (m_device != VK_NULL_HANDLE && m_allocation.IsValid()) {
+    MemoryAllocator &allocator = MemoryAllocator::Instance();
+    void *mappedData = allocator.Map(m_allocation);
+    if (mappedData) {
+      memcpy(static_cast<char *>(mappedData) + offset, data, size);
+      if (!m_coherent) {
+        allocator.Flush(m_allocation, offset, size);
+      }
+      allocator.Unmap(m_allocation);
       std::cout << "Updated Vulkan buffer data: " << size << " bytes at offset "
                 << offset << std::endl;
       return true;
@@ -90,10 +109,15 @@ void *VulkanBuffer::Map() {
     return m_mappedData;
   }
 
-  if (m_device != VK_NULL_HANDLE && m_memory != VK_NULL_HANDLE) {
-    VkResult result =
-        vkMapMemory(m_device, m_memory, 0, m_size, 0, &m_mappedData);
-    if (result == VK_SUCCESS) {
+  if (m_deviceLocal) {
+    std::cerr << "Device-local buffers cannot be mapped, use UpdateData"
+              << std::endl;
+    return nullptr;
+  }
+
+  if (m_device != VK_NULL_HANDLE && m_allocation.IsValid()) {
+    m_mappedData = MemoryAllocator::Instance().Map(m_allocation);
+    if (m_mappedData) {
       return m_mappedData;
     }
   }
@@ -105,9 +129,13 @@ void *VulkanBuffer::Map() {
 
 void VulkanBuffer::Unmap() {
 #ifdef AQUA_HAS_VULKAN
-  if (m_device != VK_NULL_HANDLE && m_memory != VK_NULL_HANDLE &&
-      m_mappedData) {
-    vkUnmapMemory(m_device, m_memory);
+  // Persistent mappings are only released when the buffer is destroyed
+  if (m_persistent) {
+    return;
+  }
+
+  if (m_device != VK_NULL_HANDLE && m_allocation.IsValid() && m_mappedData) {
+    MemoryAllocator::Instance().Unmap(m_allocation);
     m_mappedData = nullptr;
   }
 #endif
@@ -115,6 +143,34 @@ void VulkanBuffer::Unmap() {
   std::cout << "Unmapping buffer memory (placeholder)" << std::endl;
 }
 
+bool VulkanBuffer::IsPersistentlyMapped() const {
+#ifdef AQUA_HAS_VULKAN
+  return m_persistent && m_mappedData != nullptr;
+#else
+  return false;
+#endif
+}
+
+bool VulkanBuffer::Flush(size_t size, size_t offset) {
+#ifdef AQUA_HAS_VULKAN
+  if (!m_coherent && m_mappedData) {
+    return MemoryAllocator::Instance().Flush(
+        m_allocation, offset, size == WHOLE_SIZE ? VK_WHOLE_SIZE : size);
+  }
+#endif
+  return true;
+}
+
+bool VulkanBuffer::Invalidate(size_t size, size_t offset) {
+#ifdef AQUA_HAS_VULKAN
+  if (!m_coherent && m_mappedData) {
+    return MemoryAllocator::Instance().Invalidate(
+        m_allocation, offset, size == WHOLE_SIZE ? VK_WHOLE_SIZE : size);
+  }
+#endif
+  return true;
+}
+
 #ifdef AQUA_HAS_VULKAN
 bool VulkanBuffer::CreateVulkanBuffer(VkDevice device,
                                       VkPhysicalDevice physicalDevice) {
@@ -137,75 +193,93 @@ bool VulkanBuffer::CreateVulkanBuffer(VkDevice device,
     break;
   }
 
+  // Geometry that is rarely rewritten is worth a staging copy; the GPU then
+  // fetches it from VRAM instead of over PCIe
+  UploadManager &uploader = UploadManager::Instance();
+  m_deviceLocal = (m_usage & BUFFER_USAGE_STATIC) &&
+                  (m_type == BufferType::Vertex ||
+                   m_type == BufferType::Index) &&
+                  uploader.IsInitialized();
+
+  // Buffers rewritten every frame are mapped once instead of per update
+  m_persistent = !m_deviceLocal &&
+                 (m_type == BufferType::Uniform ||
+                  (m_usage & (BUFFER_USAGE_DYNAMIC | BUFFER_USAGE_STREAM |
+                              BUFFER_USAGE_PERSISTENT)));
+
   // Create buffer
   VkBufferCreateInfo bufferInfo{};
   bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
   bufferInfo.size = m_size;
   bufferInfo.usage = bufferUsage;
   bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+  if (m_deviceLocal) {
+    bufferInfo.usage |= VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    uploader.ApplySharingMode(bufferInfo);
+  }
 
   if (vkCreateBuffer(device, &bufferInfo, nullptr, &m_buffer) != VK_SUCCESS) {
     std::cerr << "Failed to create Vulkan buffer!" << std::endl;
     return false;
   }
 
-  // Get memory requirements
-  VkMemoryRequirements memRequirements;
-  vkGetBufferMemoryRequirements(device, m_buffer, &memRequirements);
-
-  // Allocate memory
-  VkMemoryAllocateInfo allocInfo{};
-  allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-  allocInfo.allocationSize = memRequirements.size;
-  allocInfo.memoryTypeIndex =
-      FindMemoryType(physicalDevice, memRequirements.memoryTypeBits,
-                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
-                         VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-
-  if (vkAllocateMemory(device, &allocInfo, nullptr, &m_memory) != VK_SUCCESS) {
+  // Sub-allocate and bind memory
+  MemoryAllocator &allocator = MemoryAllocator::Instance();
+  // Host-visible memory need not be coherent, writes are flushed instead
+  const VkMemoryPropertyFlags memoryProperties =
+      m_deviceLocal ? VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+                    : VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+  const VkMemoryPropertyFlags preferredProperties =
+      m_deviceLocal ? 0 : VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+  if (!allocator.Initialize(device, physicalDevice) ||
+      !allocator.AllocateForBuffer(m_buffer, memoryProperties, m_allocation,
+                                   AllocationStrategy::Buddy,
+                                   preferredProperties)) {
     std::cerr << "Failed to allocate buffer memory!" << std::endl;
     vkDestroyBuffer(device, m_buffer, nullptr);
     m_buffer = VK_NULL_HANDLE;
+    m_deviceLocal = false;
+    m_persistent = false;
     return false;
   }
 
-  // Bind buffer memory
-  vkBindBufferMemory(device, m_buffer, m_memory, 0);
+  m_coherent = allocator.IsHostCoherent(m_allocation);
+  if (m_persistent) {
+    m_mappedData = allocator.Map(m_allocation);
+    if (m_mappedData == nullptr) {
+      std::cerr << "Failed to persistently map buffer memory!" << std::endl;
+      m_persistent = false;
+    }
+  }
 
-  std::cout << "Created Vulkan buffer: " << m_size << " bytes" << std::endl;
+  std::cout << "Created Vulkan buffer: " << m_size << " bytes"
+            << (m_deviceLocal  ? " (device-local)"
+                : m_persistent ? " (persistently mapped)"
+                               : "")
+            << std::endl;
   return true;
 }
 
 void VulkanBuffer::DestroyVulkanBuffer(VkDevice device) {
   if (m_buffer != VK_NULL_HANDLE) {
+    UploadManager::Instance().Discard(m_buffer);
     vkDestroyBuffer(device, m_buffer, nullptr);
     m_buffer = VK_NULL_HANDLE;
   }
 
-  if (m_memory != VK_NULL_HANDLE) {
-    vkFreeMemory(device, m_memory, nullptr);
-    m_memory = VK_NULL_HANDLE;
+  if (m_allocation.IsValid()) {
+    if (m_mappedData) {
+      MemoryAllocator::Instance().Unmap(m_allocation);
+    }
+    MemoryAllocator::Instance().Free(m_allocation);
   }
 
   m_mappedData = nullptr;
+  m_deviceLocal = false;
+  m_persistent = false;
+  m_coherent = true;
 }
 
-uint32_t VulkanBuffer::FindMemoryType(VkPhysicalDevice physicalDevice,
-                                      uint32_t typeFilter,
-                                      VkMemoryPropertyFlags properties) {
-  VkPhysicalDeviceMemoryProperties memProperties;
-  vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memProperties);
-
-  for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++) {
-    if ((typeFilter & (1 << i)) && (memProperties.memoryTypes[i].propertyFlags &
-                                    properties) == properties) {
-      return i;
-    }
-  }
-
-  std::cerr << "Failed to find suitable memory type" << std::endl;
-  return 0;
-}
 #endif
 
 // VertexBuffer Implementation
@@ -425,6 +499,10 @@ BufferManager::CreateBuffer(size_t size, BufferType type, uint32_t usage) {
 }
 
 void BufferManager::DestroyAllBuffers() {
+  // Release GPU resources even if buffers are still referenced elsewhere
+  for (auto &buffer : m_buffers) {
+    buffer->Destroy();
+  }
   m_buffers.clear();
   std::cout << "Destroyed all buffers" << std::endl;
 }
@@ -1,16 +1,27 @@
 #include "AquaVisual/Core/Camera.h"
 #include <algorithm>
+#include <atomic>
 #include <cmath>
 
 namespace AquaVisual {
 
+namespace {
+
+// Shared by all cameras so versions never repeat between them
+std::atomic<uint64_t> g_nextCameraVersion{1};
+
+uint64_t NextCameraVersion() { return g_nextCameraVersion++; }
+
+} // namespace
+
 Camera::Camera()
     : m_position(0.0f, 0.0f, 3.0f), m_target(0.0f, 0.0f, 0.0f),
       m_up(0.0f, 1.0f, 0.0f), m_fov(45.0f), m_aspectRatio(16.0f / 9.0f),
       m_nearPlane(0.1f), m_farPlane(100.0f),
       m_projectionType(ProjectionType::Perspective), m_left(-1.0f),
       m_right(1.0f), m_bottom(-1.0f), m_top(1.0f), m_viewMatrixDirty(true),
-      m_projectionMatrixDirty(true) {}
+      m_projectionMatrixDirty(true), m_viewProjectionDirty(true),
+      m_inverseViewProjectionDirty(true), m_version(NextCameraVersion()) {}
 
 Camera::Camera(const Vector3 &position, const Vector3 &target,
                const Vector3 &up)
@@ -18,46 +29,47 @@ Camera::Camera(const Vector3 &position, const Vector3 &target,
       m_aspectRatio(16.0f / 9.0f), m_nearPlane(0.1f), m_farPlane(100.0f),
       m_projectionType(ProjectionType::Perspective), m_left(-1.0f),
       m_right(1.0f), m_bottom(-1.0f), m_top(1.0f), m_viewMatrixDirty(true),
-      m_projectionMatrixDirty(true) {}
+      m_projectionMatrixDirty(true), m_viewProjectionDirty(true),
+      m_inverseViewProjectionDirty(true), m_version(NextCameraVersion()) {}
 
 void Camera::SetPosition(const Vector3 &position) {
   m_position = position;
-  m_viewMatrixDirty = true;
+  MarkViewDirty();
 }
 
 void Camera::SetTarget(const Vector3 &target) {
   m_target = target;
-  m_viewMatrixDirty = true;
+  MarkViewDirty();
 }
 
 void Camera::SetUp(const Vector3 &up) {
   m_up = up;
-  m_viewMatrixDirty = true;
+  MarkViewDirty();
 }
 
 void Camera::SetFOV(float fov) {
   m_fov = std::max(1.0f, std::min(179.0f, fov));
-  m_projectionMatrixDirty = true;
+  MarkProjectionDirty();
 }
 
 void Camera::SetAspectRatio(float aspectRatio) {
   m_aspectRatio = aspectRatio;
-  m_projectionMatrixDirty = true;
+  MarkProjectionDirty();
 }
 
 void Camera::SetNearPlane(float nearPlane) {
   m_nearPlane = nearPlane;
-  m_projectionMatrixDirty = true;
+  MarkProjectionDirty();
 }
 
 void Camera::SetFarPlane(float farPlane) {
   m_farPlane = farPlane;
-  m_projectionMatrixDirty = true;
+  MarkProjectionDirty();
 }
 
 void Camera::SetProjectionType(ProjectionType type) {
   m_projectionType = type;
-  m_projectionMatrixDirty = true;
+  MarkProjectionDirty();
 }
 
 void Camera::SetPerspective(float fov, float aspect, float nearPlane,
@@ -67,7 +79,7 @@ void Camera::SetPerspective(float fov, float aspect, float nearPlane,
   m_nearPlane = nearPlane;
   m_farPlane = farPlane;
   m_projectionType = ProjectionType::Perspective;
-  m_projectionMatrixDirty = true;
+  MarkProjectionDirty();
 }
 
 void Camera::SetOrthographic(float left, float right, float bottom, float top,
@@ -79,7 +91,7 @@ void Camera::SetOrthographic(float left, float right, float bottom, float top,
   m_nearPlane = nearPlane;
   m_farPlane = farPlane;
   m_projectionType = ProjectionType::Orthographic;
-  m_projectionMatrixDirty = true;
+  MarkProjectionDirty();
 }
 
 void Camera::SetOrthographicBounds(float left, float right, float bottom,
@@ -88,7 +100,7 @@ void Camera::SetOrthographicBounds(float left, float right, float bottom,
   m_right = right;
   m_bottom = bottom;
   m_top = top;
-  m_projectionMatrixDirty = true;
+  MarkProjectionDirty();
 }
 
 const Vector3 &Camera::GetPosition() const { return m_position; }
@@ -144,8 +156,40 @@ const Matrix4 &Camera::GetProjectionMatrix() const {
   return m_projectionMatrix;
 }
 
-Matrix4 Camera::GetViewProjectionMatrix() const {
-  return GetProjectionMatrix() * GetViewMatrix();
+const Matrix4 &Camera::GetViewProjectionMatrix() const {
+  if (m_viewProjectionDirty) {
+    m_viewProjectionMatrix = GetProjectionMatrix() * GetViewMatrix();
+    m_frustum = Frustum::FromMatrix(m_viewProjectionMatrix);
+    m_viewProjectionDirty = false;
+  }
+  return m_viewProjectionMatrix;
+}
+
+const Matrix4 &Camera::GetInverseViewProjectionMatrix() const {
+  if (m_inverseViewProjectionDirty) {
+    m_inverseViewProjectionMatrix = GetViewProjectionMatrix().Inverse();
+    m_inverseViewProjectionDirty = false;
+  }
+  return m_inverseViewProjectionMatrix;
+}
+
+const Frustum &Camera::GetFrustum() const {
+  GetViewProjectionMatrix();
+  return m_frustum;
+}
+
+void Camera::MarkViewDirty() {
+  m_viewMatrixDirty = true;
+  m_viewProjectionDirty = true;
+  m_inverseViewProjectionDirty = true;
+  m_version = NextCameraVersion();
+}
+
+void Camera::MarkProjectionDirty() {
+  m_projectionMatrixDirty = true;
+  m_viewProjectionDirty = true;
+  m_inverseViewProjectionDirty = true;
+  m_version = NextCameraVersion();
 }
 
 void Camera::LookAt(const Vector3 &position, const Vector3 &target,
@@ -153,34 +197,34 @@ void Camera::LookAt(const Vector3 &position, const Vector3 &target,
   m_position = position;
   m_target = target;
   m_up = up;
-  m_viewMatrixDirty = true;
+  MarkViewDirty();
 }
 
 void Camera::Move(const Vector3 &offset) {
   m_position += offset;
   m_target += offset;
-  m_viewMatrixDirty = true;
+  MarkViewDirty();
 }
 
 void Camera::MoveForward(float distance) {
   Vector3 forward = GetForward();
   m_position += forward * distance;
   m_target += forward * distance;
-  m_viewMatrixDirty = true;
+  MarkViewDirty();
 }
 
 void Camera::MoveRight(float distance) {
   Vector3 right = GetRight();
   m_position += right * distance;
   m_target += right * distance;
-  m_viewMatrixDirty = true;
+  MarkViewDirty();
 }
 
 void Camera::MoveUp(float distance) {
   Vector3 up = GetUpVector();
   m_position += up * distance;
   m_target += up * distance;
-  m_viewMatrixDirty = true;
+  MarkViewDirty();
 }
 
 void Camera::Rotate(float yaw, float pitch) {
@@ -201,7 +245,7 @@ void Camera::Rotate(float yaw, float pitch) {
   direction.z = std::cos(currentPitch) * std::sin(currentYaw);
 
   m_target = m_position + direction * distance;
-  m_viewMatrixDirty = true;
+  MarkViewDirty();
 }
 
 void Camera::Orbit(const Vector3 &center, float yaw, float pitch) {
@@ -223,7 +267,7 @@ void Camera::Orbit(const Vector3 &center, float yaw, float pitch) {
 
   m_position = center + positionOffset * distance;
   m_target = center;
-  m_viewMatrixDirty = true;
+  MarkViewDirty();
 }
 
 void Camera::Zoom(float factor) {
@@ -0,0 +1,414 @@
+#include "AquaVisual/Core/DynamicBVH.h"
+#include <algorithm>
+#include <limits>
+
+namespace AquaVisual {
+
+namespace {
+
+AABB Union(const AABB &a, const AABB &b) {
+  AABB result = a;
+  result.Merge(b);
+  return result;
+}
+
+// Fat boxes this much larger than margin on any side are refitted so a
+// proxy that stopped moving does not keep a stretched box
+constexpr float SHRINK_FACTOR = 4.0f;
+
+// Displacement is predicted this many updates ahead
+constexpr float DISPLACEMENT_MULTIPLIER = 2.0f;
+
+} // namespace
+
+DynamicBVH::DynamicBVH(float margin) : m_margin(margin) {}
+
+std::unique_ptr<SpatialIndex> DynamicBVH::Clone() const {
+  return std::make_unique<DynamicBVH>(*this);
+}
+
+int32_t DynamicBVH::AllocateNode() {
+  if (m_freeList == NULL_NODE) {
+    m_nodes.emplace_back();
+    return static_cast<int32_t>(m_nodes.size() - 1);
+  }
+  const int32_t node = m_freeList;
+  m_freeList = m_nodes[node].parent;
+  m_nodes[node] = Node();
+  return node;
+}
+
+void DynamicBVH::FreeNode(int32_t node) {
+  m_nodes[node].parent = m_freeList;
+  m_nodes[node].height = -1;
+  m_nodes[node].userData = nullptr;
+  m_freeList = node;
+}
+
+int32_t DynamicBVH::Insert(const AABB &bounds, void *userData) {
+  const int32_t proxy = AllocateNode();
+  const Vector3 margin(m_margin);
+  m_nodes[proxy].bounds =
+      AABB(bounds.minimum - margin, bounds.maximum + margin);
+  m_nodes[proxy].userData = userData;
+  m_nodes[proxy].height = 0;
+  InsertLeaf(proxy);
+  m_proxyCount++;
+  return proxy;
+}
+
+void DynamicBVH::Remove(int32_t proxy) {
+  if (!IsLeafProxy(proxy)) {
+    return;
+  }
+  RemoveLeaf(proxy);
+  FreeNode(proxy);
+  m_proxyCount--;
+}
+
+bool DynamicBVH::Update(int32_t proxy, const AABB &bounds,
+                        const Vector3 &displacement) {
+  if (!IsLeafProxy(proxy)) {
+    return false;
+  }
+  const Vector3 margin(m_margin);
+  AABB fat(bounds.minimum - margin, bounds.maximum + margin);
+
+  const AABB &current = m_nodes[proxy].bounds;
+  if (current.Contains(bounds)) {
+    // Keep the box unless it has grown far larger than needed
+    const Vector3 limit(SHRINK_FACTOR * m_margin);
+    const AABB huge(fat.minimum - limit, fat.maximum + limit);
+    if (huge.Contains(current)) {
+      return false;
+    }
+  }
+
+  // Stretch the box along the predicted motion
+  const Vector3 ahead = displacement * DISPLACEMENT_MULTIPLIER;
+  float *lower = &fat.minimum.x;
+  float *upper = &fat.maximum.x;
+  const float *step = &ahead.x;
+  for (int axis = 0; axis < 3; axis++) {
+    if (step[axis] < 0.0f) {
+      lower[axis] += step[axis];
+    } else {
+      upper[axis] += step[axis];
+    }
+  }
+
+  RemoveLeaf(proxy);
+  m_nodes[proxy].bounds = fat;
+  InsertLeaf(proxy);
+  return true;
+}
+
+bool DynamicBVH::IsLeafProxy(int32_t proxy) const {
+  return proxy >= 0 && proxy < static_cast<int32_t>(m_nodes.size()) &&
+         m_nodes[proxy].height == 0;
+}
+
+void DynamicBVH::Clear() {
+  m_nodes.clear();
+  m_root = NULL_NODE;
+  m_freeList = NULL_NODE;
+  m_proxyCount = 0;
+  m_flat.clear();
+  m_flatDirty = true;
+}
+
+int32_t DynamicBVH::GetHeight() const {
+  return m_root == NULL_NODE ? 0 : m_nodes[m_root].height;
+}
+
+void DynamicBVH::InsertLeaf(int32_t leaf) {
+  m_flatDirty = true;
+  if (m_root == NULL_NODE) {
+    m_root = leaf;
+    m_nodes[leaf].parent = NULL_NODE;
+    return;
+  }
+
+  // Descend towards the sibling that adds the least surface area, counting
+  // the growth every ancestor inherits
+  const AABB leafBounds = m_nodes[leaf].bounds;
+  int32_t index = m_root;
+  while (!m_nodes[index].IsLeaf()) {
+    const Node &node = m_nodes[index];
+    const float area = node.bounds.GetSurfaceArea();
+    const float combinedArea = Union(node.bounds, leafBounds).GetSurfaceArea();
+
+    // Cost of making a new parent for this node and the leaf
+    const float cost = 2.0f * combinedArea;
+    // Minimum cost of pushing the leaf further down
+    const float inheritanceCost = 2.0f * (combinedArea - area);
+
+    auto descendCost = [&](int32_t child) {
+      const Node &childNode = m_nodes[child];
+      const float grown = Union(leafBounds, childNode.bounds).GetSurfaceArea();
+      if (childNode.IsLeaf()) {
+        return grown + inheritanceCost;
+      }
+      return grown - childNode.bounds.GetSurfaceArea() + inheritanceCost;
+    };
+    const float cost1 = descendCost(node.child1);
+    const float cost2 = descendCost(node.child2);
+
+    if (cost < cost1 && cost < cost2) {
+      break;
+    }
+    index = cost1 < cost2 ? node.child1 : node.child2;
+  }
+
+  const int32_t sibling = index;
+  const int32_t oldParent = m_nodes[sibling].parent;
+  const int32_t newParent = AllocateNode();
+  m_nodes[newParent].parent = oldParent;
+  m_nodes[newParent].bounds = Union(leafBounds, m_nodes[sibling].bounds);
+  m_nodes[newParent].height = m_nodes[sibling].height + 1;
+  m_nodes[newParent].child1 = sibling;
+  m_nodes[newParent].child2 = leaf;
+  m_nodes[sibling].parent = newParent;
+  m_nodes[leaf].parent = newParent;
+
+  if (oldParent == NULL_NODE) {
+    m_root = newParent;
+  } else if (m_nodes[oldParent].child1 == sibling) {
+    m_nodes[oldParent].child1 = newParent;
+  } else {
+    m_nodes[oldParent].child2 = newParent;
+  }
+
+  Refit(oldParent);
+}
+
+void DynamicBVH::RemoveLeaf(int32_t leaf) {
+  m_flatDirty = true;
+  if (leaf == m_root) {
+    m_root = NULL_NODE;
+    return;
+  }
+
+  const int32_t parent = m_nodes[leaf].parent;
+  const int32_t grandParent = m_nodes[parent].parent;
+  const int32_t sibling = m_nodes[parent].child1 == leaf
+                              ? m_nodes[parent].child2
+                              : m_nodes[parent].child1;
+
+  // The sibling takes the parent's place
+  m_nodes[sibling].parent = grandParent;
+  FreeNode(parent);
+  if (grandParent == NULL_NODE) {
+    m_root = sibling;
+    return;
+  }
+  if (m_nodes[grandParent].child1 == parent) {
+    m_nodes[grandParent].child1 = sibling;
+  } else {
+    m_nodes[grandParent].child2 = sibling;
+  }
+  Refit(grandParent);
+}
+
+void DynamicBVH::Refit(int32_t node) {
+  while (node != NULL_NODE) {
+    node = Balance(node);
+    Node &current = m_nodes[node];
+    const Node &child1 = m_nodes[current.child1];
+    const Node &child2 = m_nodes[current.child2];
+    current.height = 1 + std::max(child1.height, child2.height);
+    current.bounds = Union(child1.bounds, child2.bounds);
+    node = current.parent;
+  }
+}
+
+int32_t DynamicBVH::Balance(int32_t indexA) {
+  Node &a = m_nodes[indexA];
+  if (a.IsLeaf() || a.height < 2) {
+    return indexA;
+  }
+
+  const int32_t indexB = a.child1;
+  const int32_t indexC = a.child2;
+  Node &b = m_nodes[indexB];
+  Node &c = m_nodes[indexC];
+  const int32_t balance = c.height - b.height;
+  if (balance >= -1 && balance <= 1) {
+    return indexA;
+  }
+
+  // Rotate the taller child up into A's place; A keeps the shorter child and
+  // takes the shorter grandchild, the taller grandchild stays with the
+  // promoted node
+  const bool promoteC = balance > 1;
+  const int32_t indexUp = promoteC ? indexC : indexB;
+  const int32_t indexKept = promoteC ? indexB : indexC;
+  Node &up = m_nodes[indexUp];
+  const Node &kept = m_nodes[indexKept];
+
+  const int32_t indexF = up.child1;
+  const int32_t indexG = up.child2;
+  Node &f = m_nodes[indexF];
+  Node &g = m_nodes[indexG];
+
+  up.child1 = indexA;
+  up.parent = a.parent;
+  a.parent = indexUp;
+  if (up.parent == NULL_NODE) {
+    m_root = indexUp;
+  } else if (m_nodes[up.parent].child1 == indexA) {
+    m_nodes[up.parent].child1 = indexUp;
+  } else {
+    m_nodes[up.parent].child2 = indexUp;
+  }
+
+  const bool fTaller = f.height > g.height;
+  const int32_t indexTall = fTaller ? indexF : indexG;
+  const int32_t indexShort = fTaller ? indexG : indexF;
+  Node &tall = fTaller ? f : g;
+  Node &shortNode = fTaller ? g : f;
+
+  up.child2 = indexTall;
+  if (promoteC) {
+    a.child2 = indexShort;
+  } else {
+    a.child1 = indexShort;
+  }
+  shortNode.parent = indexA;
+
+  a.bounds = Union(kept.bounds, shortNode.bounds);
+  up.bounds = Union(a.bounds, tall.bounds);
+  a.height = 1 + std::max(kept.height, shortNode.height);
+  up.height = 1 + std::max(a.height, tall.height);
+  return indexUp;
+}
+
+void DynamicBVH::Flatten() const {
+  if (!m_flatDirty) {
+    return;
+  }
+  m_flat.clear();
+  m_flat.reserve(m_proxyCount == 0 ? 0 : 2 * m_proxyCount - 1);
+  if (m_root != NULL_NODE) {
+    FlattenNode(m_root);
+  }
+  m_flatDirty = false;
+}
+
+uint32_t DynamicBVH::FlattenNode(int32_t node) const {
+  const uint32_t index = static_cast<uint32_t>(m_flat.size());
+  const Node &source = m_nodes[node];
+  m_flat.push_back(
+      {source.bounds, 0, source.IsLeaf() ? node : NULL_NODE});
+  if (!source.IsLeaf()) {
+    FlattenNode(source.child1);
+    FlattenNode(source.child2);
+  }
+  m_flat[index].skip = static_cast<uint32_t>(m_flat.size());
+  return index;
+}
+
+void DynamicBVH::AppendLeaves(uint32_t begin, uint32_t end,
+                              std::vector<void *> &results) const {
+  for (uint32_t i = begin; i < end; i++) {
+    if (m_flat[i].proxy != NULL_NODE) {
+      results.push_back(m_nodes[m_flat[i].proxy].userData);
+    }
+  }
+}
+
+void DynamicBVH::QueryFrustum(const Frustum &frustum,
+                              std::vector<void *> &results) const {
+  Flatten();
+  const uint32_t count = static_cast<uint32_t>(m_flat.size());
+  uint32_t i = 0;
+  while (i < count) {
+    const FlatNode &node = m_flat[i];
+    const Containment containment = frustum.Classify(node.bounds);
+    if (containment == Containment::Outside) {
+      i = node.skip;
+    } else if (containment == Containment::Inside) {
+      // Everything below is visible without further tests
+      AppendLeaves(i, node.skip, results);
+      i = node.skip;
+    } else {
+      if (node.proxy != NULL_NODE) {
+        results.push_back(m_nodes[node.proxy].userData);
+      }
+      i++;
+    }
+  }
+}
+
+void DynamicBVH::QueryAABB(const AABB &box,
+                           std::vector<void *> &results) const {
+  Flatten();
+  const uint32_t count = static_cast<uint32_t>(m_flat.size());
+  uint32_t i = 0;
+  while (i < count) {
+    const FlatNode &node = m_flat[i];
+    if (!node.bounds.Intersects(box)) {
+      i = node.skip;
+      continue;
+    }
+    if (node.proxy != NULL_NODE) {
+      results.push_back(m_nodes[node.proxy].userData);
+    }
+    i++;
+  }
+}
+
+void DynamicBVH::QuerySphere(const BoundingSphere &sphere,
+                             std::vector<void *> &results) const {
+  Flatten();
+  const uint32_t count = static_cast<uint32_t>(m_flat.size());
+  uint32_t i = 0;
+  while (i < count) {
+    const FlatNode &node = m_flat[i];
+    if (!sphere.Intersects(node.bounds)) {
+      i = node.skip;
+      continue;
+    }
+    if (node.proxy != NULL_NODE) {
+      results.push_back(m_nodes[node.proxy].userData);
+    }
+    i++;
+  }
+}
+
+void *DynamicBVH::Raycast(const Ray &ray, float maxDistance,
+                          const RayTest &test, float *distance) const {
+  Flatten();
+  void *closest = nullptr;
+  float closestDistance = maxDistance;
+
+  const uint32_t count = static_cast<uint32_t>(m_flat.size());
+  uint32_t i = 0;
+  while (i < count) {
+    const FlatNode &node = m_flat[i];
+    float entry = 0.0f;
+    // Boxes entered beyond the closest hit so far cannot improve on it
+    if (!ray.Intersects(node.bounds, &entry) || entry > closestDistance) {
+      i = node.skip;
+      continue;
+    }
+    if (node.proxy != NULL_NODE) {
+      void *userData = m_nodes[node.proxy].userData;
+      float hit = entry;
+      if (!test || test(userData, closestDistance, hit)) {
+        if (hit <= closestDistance) {
+          closest = userData;
+          closestDistance = hit;
+        }
+      }
+    }
+    i++;
+  }
+
+  if (closest && distance) {
+    *distance = closestDistance;
+  }
+  return closest;
+}
+
+} // namespace AquaVisual
@@ -0,0 +1,147 @@
+#include "AquaVisual/Core/FrameAllocator.h"
+#include <algorithm>
+#include <iostream>
+
+namespace AquaVisual {
+
+FrameAllocator::FrameAllocator() = default;
+
+FrameAllocator::~FrameAllocator() { Shutdown(); }
+
+bool FrameAllocator::Initialize(VkDevice device,
+                                VkPhysicalDevice physicalDevice,
+                                uint32_t framesInFlight,
+                                VkDeviceSize frameSize) {
+  MemoryAllocator &allocator = MemoryAllocator::Instance();
+  if (!allocator.Initialize(device, physicalDevice)) {
+    return false;
+  }
+
+  m_device = device;
+  m_framesInFlight = std::max(framesInFlight, 1u);
+
+  // Dynamic offsets must honour both uniform and storage alignment
+  VkPhysicalDeviceProperties properties;
+  vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+  m_alignment = std::max<VkDeviceSize>(
+      {properties.limits.minUniformBufferOffsetAlignment,
+       properties.limits.minStorageBufferOffsetAlignment, 16});
+  m_frameSize = (frameSize + m_alignment - 1) / m_alignment * m_alignment;
+
+  VkBufferCreateInfo bufferInfo{};
+  bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+  bufferInfo.size = m_frameSize * m_framesInFlight;
+  bufferInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT |
+                     VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                     VK_BUFFER_USAGE_VERTEX_BUFFER_BIT |
+                     VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
+  bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+  if (vkCreateBuffer(m_device, &bufferInfo, nullptr, &m_buffer) !=
+      VK_SUCCESS) {
+    std::cerr << "FrameAllocator: Failed to create buffer" << '\n';
+    Shutdown();
+    return false;
+  }
+
+  if (!allocator.AllocateForBuffer(m_buffer,
+                                   VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
+                                   m_allocation, AllocationStrategy::Buddy,
+                                   VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)) {
+    std::cerr << "FrameAllocator: Failed to allocate memory" << '\n';
+    Shutdown();
+    return false;
+  }
+
+  m_coherent = allocator.IsHostCoherent(m_allocation);
+  m_mapped = static_cast<char *>(allocator.Map(m_allocation));
+  if (m_mapped == nullptr) {
+    std::cerr << "FrameAllocator: Failed to map memory" << '\n';
+    Shutdown();
+    return false;
+  }
+
+  std::cout << "FrameAllocator initialized: " << m_framesInFlight << " x "
+            << (m_frameSize / 1024) << " KB, alignment " << m_alignment
+            << '\n';
+  return true;
+}
+
+void FrameAllocator::Shutdown() {
+  if (m_device == VK_NULL_HANDLE) {
+    return;
+  }
+
+  MemoryAllocator &allocator = MemoryAllocator::Instance();
+  if (m_mapped != nullptr) {
+    allocator.Unmap(m_allocation);
+    m_mapped = nullptr;
+  }
+  if (m_buffer != VK_NULL_HANDLE) {
+    vkDestroyBuffer(m_device, m_buffer, nullptr);
+    m_buffer = VK_NULL_HANDLE;
+  }
+  allocator.Free(m_allocation);
+
+  m_device = VK_NULL_HANDLE;
+}
+
+void FrameAllocator::BeginFrame(uint32_t frameIndex) {
+  m_frameBegin = (frameIndex % std::max(m_framesInFlight, 1u)) * m_frameSize;
+  m_frameOffset = 0;
+  m_allocationCount = 0;
+}
+
+void FrameAllocator::EndFrame() {
+  if (!m_coherent && m_mapped != nullptr && m_frameOffset > 0) {
+    MemoryAllocator::Instance().Flush(m_allocation, m_frameBegin,
+                                      m_frameOffset);
+  }
+}
+
+FrameAllocation FrameAllocator::Allocate(VkDeviceSize size) {
+  return Allocate(size, m_alignment);
+}
+
+FrameAllocation FrameAllocator::Allocate(VkDeviceSize size,
+                                         VkDeviceSize alignment) {
+  FrameAllocation result;
+  if (m_mapped == nullptr || size == 0 || alignment == 0) {
+    return result;
+  }
+
+  // Align the absolute buffer offset; frame regions start at multiples of
+  // the device alignment only
+  const VkDeviceSize current = m_frameBegin + m_frameOffset;
+  const VkDeviceSize offset = (current + alignment - 1) / alignment * alignment;
+  const VkDeviceSize end = offset + size;
+  if (end - m_frameBegin > m_frameSize) {
+    if (m_overflows++ == 0) {
+      std::cerr << "FrameAllocator: Frame region of " << m_frameSize
+                << " bytes exhausted" << '\n';
+    }
+    return result;
+  }
+
+  m_frameOffset = end - m_frameBegin;
+  m_peakBytes = std::max(m_peakBytes, m_frameOffset);
+  ++m_allocationCount;
+
+  result.data = m_mapped + offset;
+  result.buffer = m_buffer;
+  result.offset = static_cast<uint32_t>(offset);
+  result.size = size;
+  return result;
+}
+
+FrameAllocatorStats FrameAllocator::GetStats() const {
+  FrameAllocatorStats stats;
+  stats.frameSize = m_frameSize;
+  stats.usedBytes = m_frameOffset;
+  stats.peakBytes = m_peakBytes;
+  stats.allocations = m_allocationCount;
+  stats.overflows = m_overflows;
+  return stats;
+}
+
+} // namespace AquaVisual
@@ -0,0 +1,57 @@
+#include "AquaVisual/Core/FrustumCuller.h"
+#include "AquaVisual/Core/JobSystem.h"
+#include <algorithm>
+
+namespace AquaVisual {
+
+namespace {
+
+// Mask words (32 boxes each) per parallel chunk. Workers write disjoint words,
+// so chunks never share one.
+constexpr size_t WORDS_PER_CHUNK = 64;
+
+} // namespace
+
+void FrustumCuller::Resize(size_t count) {
+  m_bounds.resize(count);
+  m_visibleMask.assign((count + 31) / 32, 0u);
+}
+
+void FrustumCuller::Clear() {
+  m_bounds.clear();
+  m_visibleMask.clear();
+  m_visible.clear();
+  m_stats = CullingStats();
+}
+
+size_t FrustumCuller::Cull(const Frustum &frustum) {
+  const size_t count = m_bounds.size();
+  const size_t words = (count + 31) / 32;
+  m_visibleMask.resize(words);
+
+  JobSystem::Instance().ParallelFor(
+      words, WORDS_PER_CHUNK, [&](size_t begin, size_t end) {
+        const size_t first = begin * 32;
+        const size_t last = std::min(end * 32, count);
+        frustum.CullAABBs(m_bounds.data() + first, last - first,
+                          m_visibleMask.data() + begin);
+      });
+
+  // Compact in order; most words are zero when most objects are off-screen
+  m_visible.clear();
+  for (size_t word = 0; word < words; word++) {
+    uint32_t bits = m_visibleMask[word];
+    for (uint32_t bit = 0; bits != 0; bit++, bits >>= 1) {
+      if (bits & 1u) {
+        m_visible.push_back(static_cast<uint32_t>(word * 32 + bit));
+      }
+    }
+  }
+
+  m_stats.tested = static_cast<uint32_t>(count);
+  m_stats.visible = static_cast<uint32_t>(m_visible.size());
+  m_stats.culled = m_stats.tested - m_stats.visible;
+  return m_visible.size();
+}
+
+} // namespace AquaVisual
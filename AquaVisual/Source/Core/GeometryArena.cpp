@@ -0,0 +1,396 @@
+#include "AquaVisual/Core/GeometryArena.h"
+#include "AquaVisual/Core/UploadManager.h"
+#include "AquaVisual/Resources/Mesh.h"
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+#include <numeric>
+
+namespace AquaVisual {
+
+void GeometryArena::RangeAllocator::Reset(uint32_t capacity) {
+  m_freeRanges.clear();
+  m_capacity = capacity;
+  m_used = 0;
+  if (capacity > 0) {
+    m_freeRanges[0] = capacity;
+  }
+}
+
+bool GeometryArena::RangeAllocator::Allocate(uint32_t count,
+                                             uint32_t &offset) {
+  for (auto it = m_freeRanges.begin(); it != m_freeRanges.end(); ++it) {
+    if (it->second < count) {
+      continue;
+    }
+
+    offset = it->first;
+    const uint32_t remaining = it->second - count;
+    m_freeRanges.erase(it);
+    if (remaining > 0) {
+      m_freeRanges[offset + count] = remaining;
+    }
+    m_used += count;
+    return true;
+  }
+  return false;
+}
+
+void GeometryArena::RangeAllocator::Free(uint32_t offset, uint32_t count) {
+  if (count == 0) {
+    return;
+  }
+  m_used -= count;
+
+  auto next = m_freeRanges.lower_bound(offset);
+
+  // Merge with the preceding free range
+  if (next != m_freeRanges.begin()) {
+    auto prev = std::prev(next);
+    if (prev->first + prev->second == offset) {
+      offset = prev->first;
+      count += prev->second;
+      m_freeRanges.erase(prev);
+    }
+  }
+
+  // Merge with the following free range
+  if (next != m_freeRanges.end() && offset + count == next->first) {
+    count += next->second;
+    m_freeRanges.erase(next);
+  }
+
+  m_freeRanges[offset] = count;
+}
+
+GeometryArena::GeometryArena() = default;
+
+GeometryArena::~GeometryArena() { Shutdown(); }
+
+bool GeometryArena::Initialize(VkDevice device,
+                               VkPhysicalDevice physicalDevice,
+                               uint32_t framesInFlight,
+                               VkDeviceSize vertexBytes,
+                               VkDeviceSize indexBytes,
+                               VertexFormat vertexFormat) {
+  if (!MemoryAllocator::Instance().Initialize(device, physicalDevice)) {
+    return false;
+  }
+
+  m_device = device;
+  m_framesInFlight = std::max(framesInFlight, 1u);
+  m_vertexFormat = vertexFormat;
+
+  const uint32_t vertexStride = VertexPacking::GetStride(vertexFormat);
+  const uint32_t vertexCapacity =
+      static_cast<uint32_t>(std::min<VkDeviceSize>(
+          vertexBytes / vertexStride, UINT32_MAX));
+  const uint32_t indexCapacity = static_cast<uint32_t>(
+      std::min<VkDeviceSize>(indexBytes / sizeof(uint32_t), UINT32_MAX));
+
+  if (vertexCapacity == 0 || indexCapacity == 0 ||
+      !CreateBuffer(static_cast<VkDeviceSize>(vertexCapacity) * vertexStride,
+                    VK_BUFFER_USAGE_VERTEX_BUFFER_BIT |
+                        VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                    m_vertexBuffer, m_vertexAllocation) ||
+      !CreateBuffer(static_cast<VkDeviceSize>(indexCapacity) *
+                        sizeof(uint32_t),
+                    VK_BUFFER_USAGE_INDEX_BUFFER_BIT |
+                        VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                    m_indexBuffer, m_indexAllocation)) {
+    std::cerr << "GeometryArena: Failed to create arena buffers" << '\n';
+    Shutdown();
+    return false;
+  }
+
+  m_vertexRanges.Reset(vertexCapacity);
+  m_indexRanges.Reset(indexCapacity);
+
+  std::cout << "GeometryArena initialized: " << vertexCapacity
+            << " vertices, " << indexCapacity << " indices" << '\n';
+  return true;
+}
+
+void GeometryArena::Shutdown() {
+  if (m_device == VK_NULL_HANDLE) {
+    return;
+  }
+
+  // Callers wait for the device to be idle before shutting down
+  m_entries.clear();
+  m_lru.clear();
+  m_pendingReleases.clear();
+
+  UploadManager &uploader = UploadManager::Instance();
+  MemoryAllocator &allocator = MemoryAllocator::Instance();
+  if (m_vertexBuffer != VK_NULL_HANDLE) {
+    uploader.Discard(m_vertexBuffer);
+    vkDestroyBuffer(m_device, m_vertexBuffer, nullptr);
+    m_vertexBuffer = VK_NULL_HANDLE;
+  }
+  allocator.Free(m_vertexAllocation);
+  if (m_indexBuffer != VK_NULL_HANDLE) {
+    uploader.Discard(m_indexBuffer);
+    vkDestroyBuffer(m_device, m_indexBuffer, nullptr);
+    m_indexBuffer = VK_NULL_HANDLE;
+  }
+  allocator.Free(m_indexAllocation);
+
+  m_vertexRanges.Reset(0);
+  m_indexRanges.Reset(0);
+  m_device = VK_NULL_HANDLE;
+}
+
+void GeometryArena::BeginFrame() {
+  ++m_frameNumber;
+  ReleaseCompleted(false);
+}
+
+const ArenaMesh *GeometryArena::Acquire(const Mesh &mesh) {
+  if (m_device == VK_NULL_HANDLE || mesh.GetVertexCount() == 0) {
+    return nullptr;
+  }
+
+  auto it = m_entries.find(mesh.GetId());
+  if (it != m_entries.end()) {
+    if (it->second.data.version == mesh.GetVersion()) {
+      it->second.data.lastUsedFrame = m_frameNumber;
+      m_lru.splice(m_lru.begin(), m_lru, it->second.lruIt);
+      return &it->second.data;
+    }
+
+    // Content changed since upload, drop the stale copy
+    EvictEntry(it);
+  }
+
+  const uint32_t vertexCount = static_cast<uint32_t>(mesh.GetVertexCount());
+  const uint32_t indexCount = mesh.GetIndexCount() > 0
+                                  ? static_cast<uint32_t>(mesh.GetIndexCount())
+                                  : vertexCount;
+  const uint32_t lodIndexCount =
+      static_cast<uint32_t>(mesh.GetLodIndices().size());
+
+  ArenaMesh data;
+  if (!AllocateRanges(vertexCount, indexCount + lodIndexCount, data)) {
+    ++m_failedAllocations;
+    return nullptr;
+  }
+
+  const uint32_t *indices = mesh.GetIndices().data();
+  if (mesh.GetIndexCount() == 0) {
+    if (m_sequentialIndices.size() < vertexCount) {
+      m_sequentialIndices.resize(vertexCount);
+      std::iota(m_sequentialIndices.begin(), m_sequentialIndices.end(), 0u);
+    }
+    indices = m_sequentialIndices.data();
+  }
+
+  const void *vertices = mesh.GetVertices().data();
+  if (m_vertexFormat == VertexFormat::Packed) {
+    m_packedVertices.resize(vertexCount);
+    VertexPacking::Pack(mesh.GetVertices(),
+                        VertexPacking::ComputeQuantization(mesh.GetBounds()),
+                        m_packedVertices.data());
+    vertices = m_packedVertices.data();
+  }
+  const uint32_t vertexStride = VertexPacking::GetStride(m_vertexFormat);
+
+  // Copies are batched by the upload manager and submitted ahead of this
+  // frame's draws
+  UploadManager &uploader = UploadManager::Instance();
+  const bool uploaded =
+      uploader.Upload(m_vertexBuffer, vertices,
+                      static_cast<VkDeviceSize>(vertexCount) * vertexStride,
+                      static_cast<VkDeviceSize>(data.vertexOffset) *
+                          vertexStride) &&
+      uploader.Upload(m_indexBuffer, indices,
+                      static_cast<VkDeviceSize>(indexCount) * sizeof(uint32_t),
+                      static_cast<VkDeviceSize>(data.firstIndex) *
+                          sizeof(uint32_t)) &&
+      (lodIndexCount == 0 ||
+       uploader.Upload(m_indexBuffer, mesh.GetLodIndices().data(),
+                       static_cast<VkDeviceSize>(lodIndexCount) *
+                           sizeof(uint32_t),
+                       static_cast<VkDeviceSize>(data.firstIndex +
+                                                 indexCount) *
+                           sizeof(uint32_t)));
+  if (!uploaded) {
+    std::cerr << "GeometryArena: Failed to upload mesh " << mesh.GetId()
+              << '\n';
+    FreeRanges(data);
+    return nullptr;
+  }
+
+  data.indexCount = indexCount;
+  if (lodIndexCount > 0) {
+    const std::vector<MeshLod> &lods = mesh.GetLods();
+    data.lodCount = static_cast<uint32_t>(
+        std::min<size_t>(lods.size(), Mesh::MAX_LODS));
+    for (uint32_t i = 0; i < data.lodCount; i++) {
+      data.lodFirstIndex[i] =
+          data.firstIndex + indexCount + lods[i].indexOffset;
+      data.lodIndexCount[i] = lods[i].indexCount;
+    }
+  }
+  ComputeBoundingSphere(mesh, data);
+  data.version = mesh.GetVersion();
+  data.lastUsedFrame = m_frameNumber;
+  ++m_uploads;
+
+  m_lru.push_front(mesh.GetId());
+  Entry &entry = m_entries[mesh.GetId()];
+  entry.data = data;
+  entry.lruIt = m_lru.begin();
+  return &entry.data;
+}
+
+bool GeometryArena::Evict(uint64_t meshId) {
+  auto it = m_entries.find(meshId);
+  if (it == m_entries.end()) {
+    return false;
+  }
+
+  EvictEntry(it);
+  return true;
+}
+
+void GeometryArena::Clear() {
+  while (!m_entries.empty()) {
+    EvictEntry(m_entries.begin());
+  }
+}
+
+GeometryArenaStats GeometryArena::GetStats() const {
+  GeometryArenaStats stats;
+  stats.residentMeshes = m_entries.size();
+  stats.uploads = m_uploads;
+  stats.evictions = m_evictions;
+  stats.failedAllocations = m_failedAllocations;
+  stats.usedVertices = m_vertexRanges.GetUsed();
+  stats.vertexCapacity = m_vertexRanges.GetCapacity();
+  stats.usedIndices = m_indexRanges.GetUsed();
+  stats.indexCapacity = m_indexRanges.GetCapacity();
+  return stats;
+}
+
+bool GeometryArena::CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage,
+                                 VkBuffer &buffer,
+                                 MemoryAllocation &allocation) {
+  VkBufferCreateInfo bufferInfo{};
+  bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+  bufferInfo.size = size;
+  bufferInfo.usage = usage;
+  UploadManager::Instance().ApplySharingMode(bufferInfo);
+
+  if (vkCreateBuffer(m_device, &bufferInfo, nullptr, &buffer) != VK_SUCCESS) {
+    return false;
+  }
+
+  if (!MemoryAllocator::Instance().AllocateForBuffer(
+          buffer, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, allocation)) {
+    vkDestroyBuffer(m_device, buffer, nullptr);
+    buffer = VK_NULL_HANDLE;
+    return false;
+  }
+  return true;
+}
+
+bool GeometryArena::AllocateRanges(uint32_t vertexCount, uint32_t indexCount,
+                                   ArenaMesh &out) {
+  if (vertexCount > m_vertexRanges.GetCapacity() ||
+      indexCount > m_indexRanges.GetCapacity()) {
+    return false;
+  }
+
+  for (;;) {
+    uint32_t vertexOffset = 0;
+    uint32_t firstIndex = 0;
+    if (m_vertexRanges.Allocate(vertexCount, vertexOffset)) {
+      if (m_indexRanges.Allocate(indexCount, firstIndex)) {
+        out.vertexOffset = static_cast<int32_t>(vertexOffset);
+        out.vertexCount = vertexCount;
+        out.firstIndex = firstIndex;
+        out.indexCount = indexCount;
+        out.allocatedIndices = indexCount;
+        return true;
+      }
+      m_vertexRanges.Free(vertexOffset, vertexCount);
+    }
+
+    if (!EvictLeastRecentlyUsed()) {
+      return false;
+    }
+  }
+}
+
+bool GeometryArena::EvictLeastRecentlyUsed() {
+  // Ranges evicted earlier may already be safe to reuse
+  const size_t pending = m_pendingReleases.size();
+  ReleaseCompleted(false);
+  if (m_pendingReleases.size() != pending) {
+    return true;
+  }
+
+  if (m_lru.empty()) {
+    return false;
+  }
+
+  auto it = m_entries.find(m_lru.back());
+  const uint64_t lastUsed = it->second.data.lastUsedFrame;
+
+  // Meshes drawn by frames still in flight cannot be overwritten
+  if (lastUsed + m_framesInFlight > m_frameNumber) {
+    return false;
+  }
+
+  FreeRanges(it->second.data);
+  m_lru.erase(it->second.lruIt);
+  m_entries.erase(it);
+  ++m_evictions;
+  return true;
+}
+
+void GeometryArena::EvictEntry(
+    std::unordered_map<uint64_t, Entry>::iterator it) {
+  // The ranges may still be read by command buffers in flight
+  PendingRelease pending;
+  pending.data = it->second.data;
+  pending.releaseFrame = it->second.data.lastUsedFrame;
+  m_pendingReleases.push_back(pending);
+
+  m_lru.erase(it->second.lruIt);
+  m_entries.erase(it);
+  ++m_evictions;
+}
+
+void GeometryArena::FreeRanges(const ArenaMesh &data) {
+  m_vertexRanges.Free(static_cast<uint32_t>(data.vertexOffset),
+                      data.vertexCount);
+  m_indexRanges.Free(data.firstIndex, data.allocatedIndices);
+}
+
+void GeometryArena::ComputeBoundingSphere(const Mesh &mesh, ArenaMesh &out) {
+  // Sphere around the cached bounds, the same box packed positions are
+  // quantized in; looser than a minimal sphere but free
+  const AABB &bounds = mesh.GetBounds();
+  const Vec3 center = bounds.GetCenter();
+  out.boundingSphere[0] = center.x;
+  out.boundingSphere[1] = center.y;
+  out.boundingSphere[2] = center.z;
+  out.boundingSphere[3] = (bounds.maximum - bounds.minimum).Length() * 0.5f;
+}
+
+void GeometryArena::ReleaseCompleted(bool force) {
+  auto it = m_pendingReleases.begin();
+  while (it != m_pendingReleases.end()) {
+    // Frame N has completed once frame N + framesInFlight has started
+    if (force || it->releaseFrame + m_framesInFlight <= m_frameNumber) {
+      FreeRanges(it->data);
+      it = m_pendingReleases.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+} // namespace AquaVisual
@@ -0,0 +1,886 @@
+#include "AquaVisual/Core/GpuCuller.h"
+#include "AquaVisual/Core/FrameAllocator.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace AquaVisual {
+
+namespace {
+
+constexpr uint32_t CULL_FRUSTUM = 1u;
+constexpr uint32_t CULL_OCCLUSION = 2u;
+constexpr uint32_t CULL_COMPACT = 4u;
+
+constexpr uint32_t CULL_GROUP_SIZE = 64;
+constexpr uint32_t PYRAMID_GROUP_SIZE = 8;
+
+const char *const CULL_SHADER_PATH =
+    "AquaVisual/Shaders/cull_instances_comp.spv";
+const char *const PYRAMID_SHADER_PATH =
+    "AquaVisual/Shaders/hiz_downsample_comp.spv";
+
+// Push constants of hiz_downsample.comp
+struct PyramidPushConstants {
+  int32_t sourceSize[2];
+  int32_t destinationSize[2];
+};
+
+} // namespace
+
+GpuCuller::GpuCuller() = default;
+
+GpuCuller::~GpuCuller() { Shutdown(); }
+
+bool GpuCuller::Initialize(VkDevice device, VkPhysicalDevice physicalDevice,
+                           uint32_t framesInFlight, VkBuffer frameBuffer,
+                           uint32_t maxDraws, bool enableOcclusion) {
+  if (!MemoryAllocator::Instance().Initialize(device, physicalDevice)) {
+    return false;
+  }
+
+  m_device = device;
+  m_physicalDevice = physicalDevice;
+  m_framesInFlight = std::max(framesInFlight, 1u);
+  m_maxDraws = std::max(maxDraws, 1u);
+  m_occlusionRequested = enableOcclusion;
+
+  if (!CreateCullPipeline()) {
+    Shutdown();
+    return false;
+  }
+
+  // Without the downsample shader the frustum test still works
+  if (m_occlusionRequested && !CreatePyramidPipeline()) {
+    std::cerr << "GpuCuller: Depth pyramid unavailable, occlusion culling "
+                 "disabled"
+              << '\n';
+    m_occlusionRequested = false;
+  }
+
+  VkSamplerCreateInfo samplerInfo{};
+  samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+  samplerInfo.magFilter = VK_FILTER_NEAREST;
+  samplerInfo.minFilter = VK_FILTER_NEAREST;
+  samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+  samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+  samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+  samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+  samplerInfo.minLod = 0.0f;
+  samplerInfo.maxLod = 16.0f;
+
+  // The culling shader always reads a pyramid; a 1x1 placeholder stands in
+  // until a depth source is set
+  if (vkCreateSampler(m_device, &samplerInfo, nullptr, &m_sampler) !=
+          VK_SUCCESS ||
+      !CreatePyramid(1, 1) || !CreateFrameResources(frameBuffer)) {
+    std::cerr << "GpuCuller: Failed to create culling resources" << '\n';
+    Shutdown();
+    return false;
+  }
+  WritePyramidDescriptors();
+
+  std::cout << "GpuCuller initialized: " << m_maxDraws << " draws per frame"
+            << '\n';
+  return true;
+}
+
+void GpuCuller::Shutdown() {
+  if (m_device == VK_NULL_HANDLE) {
+    return;
+  }
+
+  // Callers wait for the device to be idle before shutting down
+  DestroyPyramid();
+
+  MemoryAllocator &allocator = MemoryAllocator::Instance();
+  for (FrameResources &frame : m_frames) {
+    if (frame.commandBuffer != VK_NULL_HANDLE) {
+      vkDestroyBuffer(m_device, frame.commandBuffer, nullptr);
+    }
+    allocator.Free(frame.commandAllocation);
+    if (frame.counts != nullptr) {
+      allocator.Unmap(frame.countAllocation);
+    }
+    if (frame.countBuffer != VK_NULL_HANDLE) {
+      vkDestroyBuffer(m_device, frame.countBuffer, nullptr);
+    }
+    allocator.Free(frame.countAllocation);
+  }
+  m_frames.clear();
+
+  if (m_cullDescriptorPool != VK_NULL_HANDLE) {
+    vkDestroyDescriptorPool(m_device, m_cullDescriptorPool, nullptr);
+    m_cullDescriptorPool = VK_NULL_HANDLE;
+  }
+  if (m_sampler != VK_NULL_HANDLE) {
+    vkDestroySampler(m_device, m_sampler, nullptr);
+    m_sampler = VK_NULL_HANDLE;
+  }
+
+  VkPipeline pipelines[] = {m_cullPipeline, m_pyramidPipeline};
+  for (VkPipeline pipeline : pipelines) {
+    if (pipeline != VK_NULL_HANDLE) {
+      vkDestroyPipeline(m_device, pipeline, nullptr);
+    }
+  }
+  VkPipelineLayout layouts[] = {m_cullPipelineLayout, m_pyramidPipelineLayout};
+  for (VkPipelineLayout layout : layouts) {
+    if (layout != VK_NULL_HANDLE) {
+      vkDestroyPipelineLayout(m_device, layout, nullptr);
+    }
+  }
+  VkDescriptorSetLayout setLayouts[] = {m_cullSetLayout, m_pyramidSetLayout};
+  for (VkDescriptorSetLayout layout : setLayouts) {
+    if (layout != VK_NULL_HANDLE) {
+      vkDestroyDescriptorSetLayout(m_device, layout, nullptr);
+    }
+  }
+  m_cullPipeline = VK_NULL_HANDLE;
+  m_pyramidPipeline = VK_NULL_HANDLE;
+  m_cullPipelineLayout = VK_NULL_HANDLE;
+  m_pyramidPipelineLayout = VK_NULL_HANDLE;
+  m_cullSetLayout = VK_NULL_HANDLE;
+  m_pyramidSetLayout = VK_NULL_HANDLE;
+
+  m_depthImage = VK_NULL_HANDLE;
+  m_depthView = VK_NULL_HANDLE;
+  m_stats = GpuCullingStats();
+  m_device = VK_NULL_HANDLE;
+}
+
+bool GpuCuller::SetDepthSource(VkImage depthImage, VkImageView depthView,
+                               VkFormat depthFormat, uint32_t width,
+                               uint32_t height) {
+  if (m_device == VK_NULL_HANDLE) {
+    return false;
+  }
+
+  if (!m_occlusionRequested || width == 0 || height == 0) {
+    depthImage = VK_NULL_HANDLE;
+    depthView = VK_NULL_HANDLE;
+  }
+
+  m_depthImage = depthImage;
+  m_depthView = depthView;
+  m_depthWidth = width;
+  m_depthHeight = height;
+
+  // Layout transitions of combined formats must name both aspects
+  m_depthAspects = VK_IMAGE_ASPECT_DEPTH_BIT;
+  if (depthFormat == VK_FORMAT_D32_SFLOAT_S8_UINT ||
+      depthFormat == VK_FORMAT_D24_UNORM_S8_UINT) {
+    m_depthAspects |= VK_IMAGE_ASPECT_STENCIL_BIT;
+  }
+
+  // Level 0 is half the depth resolution, every texel covering 2x2 or more
+  DestroyPyramid();
+  const bool created =
+      m_depthView != VK_NULL_HANDLE
+          ? CreatePyramid(std::max(width / 2, 1u), std::max(height / 2, 1u))
+          : CreatePyramid(1, 1);
+  if (!created) {
+    std::cerr << "GpuCuller: Failed to create depth pyramid" << '\n';
+    m_depthImage = VK_NULL_HANDLE;
+    m_depthView = VK_NULL_HANDLE;
+    return false;
+  }
+
+  WritePyramidDescriptors();
+  return true;
+}
+
+void GpuCuller::BeginFrame(uint32_t frameIndex) {
+  if (m_frames.empty()) {
+    return;
+  }
+
+  m_frameIndex = frameIndex % m_framesInFlight;
+  FrameResources &frame = m_frames[m_frameIndex];
+
+  // Counts written by the last culling pass of this slot are final now
+  if (frame.batchCount > 0) {
+    MemoryAllocator &allocator = MemoryAllocator::Instance();
+    if (!allocator.IsHostCoherent(frame.countAllocation)) {
+      allocator.Invalidate(frame.countAllocation, 0,
+                           frame.batchCount * sizeof(uint32_t));
+    }
+
+    uint32_t visible = 0;
+    for (uint32_t i = 0; i < frame.batchCount; ++i) {
+      visible += frame.counts[i];
+    }
+    m_stats.completedCandidates = frame.candidateCount;
+    m_stats.completedVisible = visible;
+  }
+
+  frame.candidateCount = 0;
+  frame.batchCount = 0;
+  m_stats.candidates = 0;
+  m_stats.batches = 0;
+  m_stats.occlusion = false;
+}
+
+bool GpuCuller::Dispatch(VkCommandBuffer commandBuffer,
+                         FrameAllocator &allocator,
+                         const std::vector<CullCandidate> &candidates,
+                         uint32_t batchCount, const float viewProjection[16],
+                         const float cameraPosition[3], bool compact) {
+  if (m_frames.empty() || candidates.empty() || batchCount == 0 ||
+      candidates.size() > m_maxDraws || batchCount > MAX_BATCHES) {
+    return false;
+  }
+
+  const uint32_t candidateCount = static_cast<uint32_t>(candidates.size());
+  FrameAllocation candidateBlock =
+      allocator.Allocate(sizeof(CullCandidate) * candidateCount);
+  FrameAllocation paramsBlock = allocator.Allocate(sizeof(CullParams));
+  if (!candidateBlock.IsValid() || !paramsBlock.IsValid()) {
+    std::cerr << "GpuCuller: Out of per-frame memory, culling skipped" << '\n';
+    return false;
+  }
+  std::memcpy(candidateBlock.data, candidates.data(),
+              sizeof(CullCandidate) * candidateCount);
+
+  const bool occlusion = m_depthView != VK_NULL_HANDLE && m_pyramidValid;
+
+  CullParams params{};
+  ExtractFrustumPlanes(viewProjection, params.frustumPlanes);
+  std::memcpy(params.previousViewProjection, m_pyramidViewProjection,
+              sizeof(params.previousViewProjection));
+  params.depthPyramidSize[0] = static_cast<float>(m_pyramidWidth);
+  params.depthPyramidSize[1] = static_cast<float>(m_pyramidHeight);
+  params.depthPyramidSize[2] =
+      static_cast<float>(m_pyramidLevelViews.size());
+  std::memcpy(params.cameraPosition, cameraPosition, 3 * sizeof(float));
+  params.candidateCount = candidateCount;
+  params.flags = CULL_FRUSTUM | (occlusion ? CULL_OCCLUSION : 0u) |
+                 (compact ? CULL_COMPACT : 0u);
+  std::memcpy(paramsBlock.data, &params, sizeof(params));
+
+  FrameResources &frame = m_frames[m_frameIndex];
+  InitializePyramidLayout(commandBuffer);
+
+  // Start every batch at zero visible draws
+  vkCmdFillBuffer(commandBuffer, frame.countBuffer, 0,
+                  batchCount * sizeof(uint32_t), 0);
+
+  VkMemoryBarrier clearBarrier{};
+  clearBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+  clearBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  clearBarrier.dstAccessMask =
+      VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+  vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                       VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1,
+                       &clearBarrier, 0, nullptr, 0, nullptr);
+
+  // Dynamic offsets in binding order: candidates, parameters
+  const uint32_t dynamicOffsets[] = {candidateBlock.offset,
+                                     paramsBlock.offset};
+  vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+                    m_cullPipeline);
+  vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+                          m_cullPipelineLayout, 0, 1, &frame.descriptorSet, 2,
+                          dynamicOffsets);
+  vkCmdDispatch(commandBuffer,
+                (candidateCount + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE, 1, 1);
+
+  // Draws consume the commands and counts, the CPU reads the counts after
+  // the frame fence
+  VkMemoryBarrier outputBarrier{};
+  outputBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+  outputBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+  outputBarrier.dstAccessMask =
+      VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_HOST_READ_BIT;
+  vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                       VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT |
+                           VK_PIPELINE_STAGE_HOST_BIT,
+                       0, 1, &outputBarrier, 0, nullptr, 0, nullptr);
+
+  frame.candidateCount = candidateCount;
+  frame.batchCount = batchCount;
+  m_stats.candidates = candidateCount;
+  m_stats.batches = batchCount;
+  m_stats.occlusion = occlusion;
+  return true;
+}
+
+void GpuCuller::BuildDepthPyramid(VkCommandBuffer commandBuffer,
+                                  const float viewProjection[16]) {
+  if (m_depthView == VK_NULL_HANDLE || m_pyramidSets.empty()) {
+    return;
+  }
+
+  InitializePyramidLayout(commandBuffer);
+
+  // Depth writes must land before sampling, and this frame's culling reads
+  // of the pyramid before it is overwritten
+  VkImageMemoryBarrier depthBarrier{};
+  depthBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+  depthBarrier.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+  depthBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+  depthBarrier.oldLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+  depthBarrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+  depthBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  depthBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  depthBarrier.image = m_depthImage;
+  depthBarrier.subresourceRange.aspectMask = m_depthAspects;
+  depthBarrier.subresourceRange.baseMipLevel = 0;
+  depthBarrier.subresourceRange.levelCount = 1;
+  depthBarrier.subresourceRange.baseArrayLayer = 0;
+  depthBarrier.subresourceRange.layerCount = 1;
+  vkCmdPipelineBarrier(commandBuffer,
+                       VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT |
+                           VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT |
+                           VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                       VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0,
+                       nullptr, 1, &depthBarrier);
+
+  vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+                    m_pyramidPipeline);
+
+  uint32_t sourceWidth = m_depthWidth;
+  uint32_t sourceHeight = m_depthHeight;
+  uint32_t width = m_pyramidWidth;
+  uint32_t height = m_pyramidHeight;
+
+  for (size_t level = 0; level < m_pyramidSets.size(); ++level) {
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+                            m_pyramidPipelineLayout, 0, 1,
+                            &m_pyramidSets[level], 0, nullptr);
+
+    PyramidPushConstants pushConstants;
+    pushConstants.sourceSize[0] = static_cast<int32_t>(sourceWidth);
+    pushConstants.sourceSize[1] = static_cast<int32_t>(sourceHeight);
+    pushConstants.destinationSize[0] = static_cast<int32_t>(width);
+    pushConstants.destinationSize[1] = static_cast<int32_t>(height);
+    vkCmdPushConstants(commandBuffer, m_pyramidPipelineLayout,
+                       VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pushConstants),
+                       &pushConstants);
+
+    vkCmdDispatch(commandBuffer,
+                  (width + PYRAMID_GROUP_SIZE - 1) / PYRAMID_GROUP_SIZE,
+                  (height + PYRAMID_GROUP_SIZE - 1) / PYRAMID_GROUP_SIZE, 1);
+
+    // The next level and next frame's culling pass read this one
+    VkImageMemoryBarrier levelBarrier{};
+    levelBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    levelBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    levelBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    levelBarrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+    levelBarrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+    levelBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    levelBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    levelBarrier.image = m_pyramidImage;
+    levelBarrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    levelBarrier.subresourceRange.baseMipLevel = static_cast<uint32_t>(level);
+    levelBarrier.subresourceRange.levelCount = 1;
+    levelBarrier.subresourceRange.baseArrayLayer = 0;
+    levelBarrier.subresourceRange.layerCount = 1;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr,
+                         0, nullptr, 1, &levelBarrier);
+
+    sourceWidth = width;
+    sourceHeight = height;
+    width = std::max(width / 2, 1u);
+    height = std::max(height / 2, 1u);
+  }
+
+  std::memcpy(m_pyramidViewProjection, viewProjection,
+              sizeof(m_pyramidViewProjection));
+  m_pyramidValid = true;
+}
+
+VkBuffer GpuCuller::GetCommandBuffer() const {
+  return m_frames.empty() ? VK_NULL_HANDLE
+                          : m_frames[m_frameIndex].commandBuffer;
+}
+
+VkBuffer GpuCuller::GetCountBuffer() const {
+  return m_frames.empty() ? VK_NULL_HANDLE
+                          : m_frames[m_frameIndex].countBuffer;
+}
+
+bool GpuCuller::CreateFrameResources(VkBuffer frameBuffer) {
+  MemoryAllocator &allocator = MemoryAllocator::Instance();
+  m_frames.resize(m_framesInFlight);
+
+  for (FrameResources &frame : m_frames) {
+    VkBufferCreateInfo bufferInfo{};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = static_cast<VkDeviceSize>(m_maxDraws) *
+                      sizeof(VkDrawIndexedIndirectCommand);
+    bufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                       VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    if (vkCreateBuffer(m_device, &bufferInfo, nullptr, &frame.commandBuffer) !=
+            VK_SUCCESS ||
+        !allocator.AllocateForBuffer(frame.commandBuffer,
+                                     VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                     frame.commandAllocation)) {
+      return false;
+    }
+
+    // Counts are read back by the CPU for statistics
+    bufferInfo.size = MAX_BATCHES * sizeof(uint32_t);
+    bufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                       VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+                       VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    if (vkCreateBuffer(m_device, &bufferInfo, nullptr, &frame.countBuffer) !=
+            VK_SUCCESS ||
+        !allocator.AllocateForBuffer(frame.countBuffer,
+                                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
+                                     frame.countAllocation,
+                                     AllocationStrategy::Buddy,
+                                     VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)) {
+      return false;
+    }
+
+    frame.counts =
+        static_cast<const uint32_t *>(allocator.Map(frame.countAllocation));
+    if (frame.counts == nullptr) {
+      return false;
+    }
+  }
+
+  std::array<VkDescriptorPoolSize, 4> poolSizes{};
+  poolSizes[0].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+  poolSizes[0].descriptorCount = m_framesInFlight;
+  poolSizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+  poolSizes[1].descriptorCount = 3 * m_framesInFlight;
+  poolSizes[2].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+  poolSizes[2].descriptorCount = m_framesInFlight;
+  poolSizes[3].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+  poolSizes[3].descriptorCount = m_framesInFlight;
+
+  VkDescriptorPoolCreateInfo poolInfo{};
+  poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+  poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+  poolInfo.pPoolSizes = poolSizes.data();
+  poolInfo.maxSets = m_framesInFlight;
+
+  if (vkCreateDescriptorPool(m_device, &poolInfo, nullptr,
+                             &m_cullDescriptorPool) != VK_SUCCESS) {
+    return false;
+  }
+
+  std::vector<VkDescriptorSetLayout> layouts(m_framesInFlight, m_cullSetLayout);
+  std::vector<VkDescriptorSet> sets(m_framesInFlight);
+
+  VkDescriptorSetAllocateInfo allocInfo{};
+  allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+  allocInfo.descriptorPool = m_cullDescriptorPool;
+  allocInfo.descriptorSetCount = m_framesInFlight;
+  allocInfo.pSetLayouts = layouts.data();
+  if (vkAllocateDescriptorSets(m_device, &allocInfo, sets.data()) !=
+      VK_SUCCESS) {
+    return false;
+  }
+
+  for (uint32_t i = 0; i < m_framesInFlight; ++i) {
+    FrameResources &frame = m_frames[i];
+    frame.descriptorSet = sets[i];
+
+    // Candidates and parameters are selected with dynamic offsets; instance
+    // records are indexed by firstInstance from the start of the buffer
+    std::array<VkDescriptorBufferInfo, 5> bufferInfos{};
+    bufferInfos[0] = {frameBuffer, 0, VK_WHOLE_SIZE};
+    bufferInfos[1] = {frameBuffer, 0, VK_WHOLE_SIZE};
+    bufferInfos[2] = {frameBuffer, 0, sizeof(CullParams)};
+    bufferInfos[3] = {frame.commandBuffer, 0, VK_WHOLE_SIZE};
+    bufferInfos[4] = {frame.countBuffer, 0, VK_WHOLE_SIZE};
+
+    const VkDescriptorType types[] = {
+        VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC,
+        VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+        VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
+        VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER};
+
+    std::array<VkWriteDescriptorSet, 5> writes{};
+    for (uint32_t binding = 0; binding < writes.size(); ++binding) {
+      writes[binding].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+      writes[binding].dstSet = frame.descriptorSet;
+      writes[binding].dstBinding = binding;
+      writes[binding].descriptorCount = 1;
+      writes[binding].descriptorType = types[binding];
+      writes[binding].pBufferInfo = &bufferInfos[binding];
+    }
+    vkUpdateDescriptorSets(m_device, static_cast<uint32_t>(writes.size()),
+                           writes.data(), 0, nullptr);
+  }
+
+  return true;
+}
+
+bool GpuCuller::CreateCullPipeline() {
+  std::array<VkDescriptorSetLayoutBinding, 6> bindings{};
+  const VkDescriptorType types[] = {
+      VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC,  // candidates
+      VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,          // instances
+      VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,  // parameters
+      VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,          // output commands
+      VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,          // draw counts
+      VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER}; // depth pyramid
+  for (uint32_t i = 0; i < bindings.size(); ++i) {
+    bindings[i].binding = i;
+    bindings[i].descriptorType = types[i];
+    bindings[i].descriptorCount = 1;
+    bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+  }
+
+  VkDescriptorSetLayoutCreateInfo layoutInfo{};
+  layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+  layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+  layoutInfo.pBindings = bindings.data();
+  if (vkCreateDescriptorSetLayout(m_device, &layoutInfo, nullptr,
+                                  &m_cullSetLayout) != VK_SUCCESS) {
+    std::cerr << "GpuCuller: Failed to create descriptor set layout" << '\n';
+    return false;
+  }
+
+  VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+  pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+  pipelineLayoutInfo.setLayoutCount = 1;
+  pipelineLayoutInfo.pSetLayouts = &m_cullSetLayout;
+  if (vkCreatePipelineLayout(m_device, &pipelineLayoutInfo, nullptr,
+                             &m_cullPipelineLayout) != VK_SUCCESS) {
+    std::cerr << "GpuCuller: Failed to create pipeline layout" << '\n';
+    return false;
+  }
+
+  VkShaderModule shader = LoadShader(CULL_SHADER_PATH);
+  if (shader == VK_NULL_HANDLE) {
+    return false;
+  }
+
+  VkComputePipelineCreateInfo pipelineInfo{};
+  pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+  pipelineInfo.stage.sType =
+      VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+  pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+  pipelineInfo.stage.module = shader;
+  pipelineInfo.stage.pName = "main";
+  pipelineInfo.layout = m_cullPipelineLayout;
+
+  const VkResult result = vkCreateComputePipelines(
+      m_device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_cullPipeline);
+  vkDestroyShaderModule(m_device, shader, nullptr);
+  if (result != VK_SUCCESS) {
+    std::cerr << "GpuCuller: Failed to create culling pipeline" << '\n';
+    return false;
+  }
+  return true;
+}
+
+bool GpuCuller::CreatePyramidPipeline() {
+  std::array<VkDescriptorSetLayoutBinding, 2> bindings{};
+  bindings[0].binding = 0;
+  bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+  bindings[0].descriptorCount = 1;
+  bindings[0].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+  bindings[1].binding = 1;
+  bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+  bindings[1].descriptorCount = 1;
+  bindings[1].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+  VkDescriptorSetLayoutCreateInfo layoutInfo{};
+  layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+  layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+  layoutInfo.pBindings = bindings.data();
+  if (vkCreateDescriptorSetLayout(m_device, &layoutInfo, nullptr,
+                                  &m_pyramidSetLayout) != VK_SUCCESS) {
+    return false;
+  }
+
+  VkPushConstantRange pushConstantRange{};
+  pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+  pushConstantRange.offset = 0;
+  pushConstantRange.size = sizeof(PyramidPushConstants);
+
+  VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+  pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+  pipelineLayoutInfo.setLayoutCount = 1;
+  pipelineLayoutInfo.pSetLayouts = &m_pyramidSetLayout;
+  pipelineLayoutInfo.pushConstantRangeCount = 1;
+  pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+  if (vkCreatePipelineLayout(m_device, &pipelineLayoutInfo, nullptr,
+                             &m_pyramidPipelineLayout) != VK_SUCCESS) {
+    return false;
+  }
+
+  VkShaderModule shader = LoadShader(PYRAMID_SHADER_PATH);
+  if (shader == VK_NULL_HANDLE) {
+    return false;
+  }
+
+  VkComputePipelineCreateInfo pipelineInfo{};
+  pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+  pipelineInfo.stage.sType =
+      VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+  pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+  pipelineInfo.stage.module = shader;
+  pipelineInfo.stage.pName = "main";
+  pipelineInfo.layout = m_pyramidPipelineLayout;
+
+  const VkResult result = vkCreateComputePipelines(
+      m_device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_pyramidPipeline);
+  vkDestroyShaderModule(m_device, shader, nullptr);
+  return result == VK_SUCCESS;
+}
+
+bool GpuCuller::CreatePyramid(uint32_t width, uint32_t height) {
+  uint32_t levels = 1;
+  while ((std::max(width, height) >> levels) > 0) {
+    ++levels;
+  }
+
+  VkImageCreateInfo imageInfo{};
+  imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+  imageInfo.imageType = VK_IMAGE_TYPE_2D;
+  imageInfo.extent.width = width;
+  imageInfo.extent.height = height;
+  imageInfo.extent.depth = 1;
+  imageInfo.mipLevels = levels;
+  imageInfo.arrayLayers = 1;
+  imageInfo.format = VK_FORMAT_R32_SFLOAT;
+  imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+  imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+  imageInfo.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_STORAGE_BIT;
+  imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+  imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+  if (vkCreateImage(m_device, &imageInfo, nullptr, &m_pyramidImage) !=
+          VK_SUCCESS ||
+      !MemoryAllocator::Instance().AllocateForImage(
+          m_pyramidImage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+          m_pyramidAllocation)) {
+    return false;
+  }
+
+  VkImageViewCreateInfo viewInfo{};
+  viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+  viewInfo.image = m_pyramidImage;
+  viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+  viewInfo.format = VK_FORMAT_R32_SFLOAT;
+  viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+  viewInfo.subresourceRange.baseMipLevel = 0;
+  viewInfo.subresourceRange.levelCount = levels;
+  viewInfo.subresourceRange.baseArrayLayer = 0;
+  viewInfo.subresourceRange.layerCount = 1;
+  if (vkCreateImageView(m_device, &viewInfo, nullptr, &m_pyramidView) !=
+      VK_SUCCESS) {
+    return false;
+  }
+
+  m_pyramidWidth = width;
+  m_pyramidHeight = height;
+  m_pyramidInitialized = false;
+  m_pyramidValid = false;
+
+  // Per-level views and downsample sets are only needed with a depth source
+  if (m_depthView == VK_NULL_HANDLE) {
+    return true;
+  }
+
+  m_pyramidLevelViews.assign(levels, VK_NULL_HANDLE);
+  for (uint32_t level = 0; level < levels; ++level) {
+    viewInfo.subresourceRange.baseMipLevel = level;
+    viewInfo.subresourceRange.levelCount = 1;
+    if (vkCreateImageView(m_device, &viewInfo, nullptr,
+                          &m_pyramidLevelViews[level]) != VK_SUCCESS) {
+      return false;
+    }
+  }
+
+  std::array<VkDescriptorPoolSize, 2> poolSizes{};
+  poolSizes[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+  poolSizes[0].descriptorCount = levels;
+  poolSizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+  poolSizes[1].descriptorCount = levels;
+
+  VkDescriptorPoolCreateInfo poolInfo{};
+  poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+  poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+  poolInfo.pPoolSizes = poolSizes.data();
+  poolInfo.maxSets = levels;
+  if (vkCreateDescriptorPool(m_device, &poolInfo, nullptr,
+                             &m_pyramidDescriptorPool) != VK_SUCCESS) {
+    return false;
+  }
+
+  std::vector<VkDescriptorSetLayout> layouts(levels, m_pyramidSetLayout);
+  VkDescriptorSetAllocateInfo allocInfo{};
+  allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+  allocInfo.descriptorPool = m_pyramidDescriptorPool;
+  allocInfo.descriptorSetCount = levels;
+  allocInfo.pSetLayouts = layouts.data();
+  m_pyramidSets.resize(levels);
+  if (vkAllocateDescriptorSets(m_device, &allocInfo, m_pyramidSets.data()) !=
+      VK_SUCCESS) {
+    m_pyramidSets.clear();
+    return false;
+  }
+  return true;
+}
+
+void GpuCuller::DestroyPyramid() {
+  if (m_pyramidDescriptorPool != VK_NULL_HANDLE) {
+    vkDestroyDescriptorPool(m_device, m_pyramidDescriptorPool, nullptr);
+    m_pyramidDescriptorPool = VK_NULL_HANDLE;
+  }
+  m_pyramidSets.clear();
+
+  for (VkImageView view : m_pyramidLevelViews) {
+    if (view != VK_NULL_HANDLE) {
+      vkDestroyImageView(m_device, view, nullptr);
+    }
+  }
+  m_pyramidLevelViews.clear();
+
+  if (m_pyramidView != VK_NULL_HANDLE) {
+    vkDestroyImageView(m_device, m_pyramidView, nullptr);
+    m_pyramidView = VK_NULL_HANDLE;
+  }
+  if (m_pyramidImage != VK_NULL_HANDLE) {
+    vkDestroyImage(m_device, m_pyramidImage, nullptr);
+    m_pyramidImage = VK_NULL_HANDLE;
+  }
+  MemoryAllocator::Instance().Free(m_pyramidAllocation);
+
+  m_pyramidWidth = 0;
+  m_pyramidHeight = 0;
+  m_pyramidInitialized = false;
+  m_pyramidValid = false;
+}
+
+void GpuCuller::WritePyramidDescriptors() {
+  std::vector<VkDescriptorImageInfo> imageInfos;
+  std::vector<VkWriteDescriptorSet> writes;
+  imageInfos.reserve(m_frames.size() + 2 * m_pyramidSets.size());
+
+  VkWriteDescriptorSet write{};
+  write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+  write.descriptorCount = 1;
+
+  // Culling reads every level
+  for (const FrameResources &frame : m_frames) {
+    imageInfos.push_back(
+        {m_sampler, m_pyramidView, VK_IMAGE_LAYOUT_GENERAL});
+    write.dstSet = frame.descriptorSet;
+    write.dstBinding = 5;
+    write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    write.pImageInfo = &imageInfos.back();
+    writes.push_back(write);
+  }
+
+  // Level 0 reduces the depth buffer, every other level its predecessor
+  for (size_t level = 0; level < m_pyramidSets.size(); ++level) {
+    if (level == 0) {
+      imageInfos.push_back({m_sampler, m_depthView,
+                            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL});
+    } else {
+      imageInfos.push_back({m_sampler, m_pyramidLevelViews[level - 1],
+                            VK_IMAGE_LAYOUT_GENERAL});
+    }
+    write.dstSet = m_pyramidSets[level];
+    write.dstBinding = 0;
+    write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    write.pImageInfo = &imageInfos.back();
+    writes.push_back(write);
+
+    imageInfos.push_back(
+        {VK_NULL_HANDLE, m_pyramidLevelViews[level], VK_IMAGE_LAYOUT_GENERAL});
+    write.dstBinding = 1;
+    write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    write.pImageInfo = &imageInfos.back();
+    writes.push_back(write);
+  }
+
+  vkUpdateDescriptorSets(m_device, static_cast<uint32_t>(writes.size()),
+                         writes.data(), 0, nullptr);
+}
+
+void GpuCuller::InitializePyramidLayout(VkCommandBuffer commandBuffer) {
+  if (m_pyramidInitialized || m_pyramidImage == VK_NULL_HANDLE) {
+    return;
+  }
+
+  VkImageMemoryBarrier barrier{};
+  barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+  barrier.srcAccessMask = 0;
+  barrier.dstAccessMask =
+      VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+  barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+  barrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+  barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.image = m_pyramidImage;
+  barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+  barrier.subresourceRange.baseMipLevel = 0;
+  barrier.subresourceRange.levelCount = VK_REMAINING_MIP_LEVELS;
+  barrier.subresourceRange.baseArrayLayer = 0;
+  barrier.subresourceRange.layerCount = 1;
+  vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                       VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0,
+                       nullptr, 1, &barrier);
+  m_pyramidInitialized = true;
+}
+
+VkShaderModule GpuCuller::LoadShader(const char *path) {
+  std::ifstream file(path, std::ios::ate | std::ios::binary);
+  if (!file.is_open()) {
+    std::cerr << "GpuCuller: Failed to open shader " << path << '\n';
+    return VK_NULL_HANDLE;
+  }
+
+  const size_t size = static_cast<size_t>(file.tellg());
+  std::vector<uint32_t> code((size + 3) / 4);
+  file.seekg(0);
+  file.read(reinterpret_cast<char *>(code.data()), size);
+
+  VkShaderModuleCreateInfo createInfo{};
+  createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+  createInfo.codeSize = size;
+  createInfo.pCode = code.data();
+
+  VkShaderModule module = VK_NULL_HANDLE;
+  if (size == 0 || vkCreateShaderModule(m_device, &createInfo, nullptr,
+                                        &module) != VK_SUCCESS) {
+    std::cerr << "GpuCuller: Failed to create shader module " << path << '\n';
+    return VK_NULL_HANDLE;
+  }
+  return module;
+}
+
+void GpuCuller::ExtractFrustumPlanes(const float viewProjection[16],
+                                     float planes[6][4]) {
+  // Rows of the column-major matrix combined as in Gribb & Hartmann; the
+  // near plane uses the OpenGL clip range, which is the wider of the two
+  const float *m = viewProjection;
+  for (int axis = 0; axis < 3; ++axis) {
+    for (int k = 0; k < 4; ++k) {
+      const float w = m[k * 4 + 3];
+      const float v = m[k * 4 + axis];
+      planes[axis * 2][k] = w + v;
+      planes[axis * 2 + 1][k] = w - v;
+    }
+  }
+
+  for (int i = 0; i < 6; ++i) {
+    const float length =
+        std::sqrt(planes[i][0] * planes[i][0] + planes[i][1] * planes[i][1] +
+                  planes[i][2] * planes[i][2]);
+    if (length > 0.0f) {
+      for (int k = 0; k < 4; ++k) {
+        planes[i][k] /= length;
+      }
+    }
+  }
+}
+
+} // namespace AquaVisual
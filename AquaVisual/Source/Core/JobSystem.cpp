@@ -0,0 +1,152 @@
+#include "AquaVisual/Core/JobSystem.h"
+#include <algorithm>
+#include <iostream>
+
+namespace AquaVisual {
+
+namespace {
+
+// Set on worker threads and while the caller runs its share of a loop, so
+// nested loops run inline instead of deadlocking on the pool
+thread_local bool t_insideLoop = false;
+
+} // namespace
+
+JobSystem &JobSystem::Instance() {
+  static JobSystem instance;
+  return instance;
+}
+
+JobSystem::~JobSystem() { Shutdown(); }
+
+bool JobSystem::Initialize(uint32_t workerCount) {
+  if (!m_workers.empty()) {
+    return true;
+  }
+
+  if (workerCount == 0) {
+    const uint32_t cores = std::thread::hardware_concurrency();
+    workerCount = cores > 1 ? cores - 1 : 0;
+  }
+  if (workerCount == 0) {
+    std::cout << "JobSystem: Single core, loops run on the calling thread"
+              << '\n';
+    return true;
+  }
+
+  m_stopping = false;
+  m_workers.reserve(workerCount);
+  for (uint32_t i = 0; i < workerCount; ++i) {
+    m_workers.emplace_back(&JobSystem::WorkerMain, this);
+  }
+
+  std::cout << "JobSystem: Started " << workerCount << " worker threads"
+            << '\n';
+  return true;
+}
+
+void JobSystem::Shutdown() {
+  if (m_workers.empty()) {
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stopping = true;
+  }
+  m_wake.notify_all();
+  for (std::thread &worker : m_workers) {
+    worker.join();
+  }
+  m_workers.clear();
+  m_loop = nullptr;
+}
+
+void JobSystem::ParallelFor(size_t count, size_t minChunk,
+                            const std::function<void(size_t, size_t)> &body) {
+  if (count == 0) {
+    return;
+  }
+  minChunk = std::max<size_t>(minChunk, 1);
+
+  const size_t threads = m_workers.size() + 1;
+  if (m_workers.empty() || t_insideLoop || count <= minChunk) {
+    body(0, count);
+    return;
+  }
+
+  std::lock_guard<std::mutex> submitLock(m_submitMutex);
+
+  // A few chunks per thread keeps the tail short when chunks run unevenly
+  Loop loop;
+  loop.body = &body;
+  loop.count = count;
+  loop.chunk = std::max(minChunk, (count + threads * 4 - 1) / (threads * 4));
+  loop.remaining = (count + loop.chunk - 1) / loop.chunk;
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_loop = &loop;
+    ++m_generation;
+  }
+  m_wake.notify_all();
+
+  t_insideLoop = true;
+  RunChunks(loop);
+  t_insideLoop = false;
+
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_done.wait(lock, [&loop] {
+    return loop.remaining.load() == 0 && loop.activeWorkers == 0;
+  });
+  m_loop = nullptr;
+}
+
+void JobSystem::RunChunks(Loop &loop) {
+  for (;;) {
+    const size_t begin = loop.next.fetch_add(loop.chunk);
+    if (begin >= loop.count) {
+      return;
+    }
+    const size_t end = std::min(begin + loop.chunk, loop.count);
+    (*loop.body)(begin, end);
+
+    if (loop.remaining.fetch_sub(1) == 1) {
+      // Last chunk: the lock orders the notify after the caller's wait check
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_done.notify_all();
+    }
+  }
+}
+
+void JobSystem::WorkerMain() {
+  t_insideLoop = true;
+  uint64_t seenGeneration = 0;
+
+  for (;;) {
+    Loop *loop = nullptr;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_wake.wait(lock, [this, seenGeneration] {
+        return m_stopping ||
+               (m_loop != nullptr && m_generation != seenGeneration);
+      });
+      if (m_stopping) {
+        return;
+      }
+      seenGeneration = m_generation;
+      loop = m_loop;
+      ++loop->activeWorkers;
+    }
+    RunChunks(*loop);
+
+    // The caller owns the loop and may not return while a worker still
+    // touches it
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (--loop->activeWorkers == 0) {
+      m_done.notify_all();
+    }
+  }
+}
+
+} // namespace AquaVisual
@@ -0,0 +1,293 @@
+#include "AquaVisual/Core/LooseOctree.h"
+#include <algorithm>
+#include <cmath>
+
+namespace AquaVisual {
+
+bool LooseOctree::Node::HasChildren() const {
+  for (int32_t child : children) {
+    if (child != NULL_NODE) {
+      return true;
+    }
+  }
+  return false;
+}
+
+LooseOctree::LooseOctree(const Vector3 &center, float halfSize, int maxDepth)
+    : m_maxDepth(maxDepth) {
+  m_nodes.emplace_back();
+  m_nodes[ROOT].center = center;
+  m_nodes[ROOT].halfSize = halfSize;
+}
+
+std::unique_ptr<SpatialIndex> LooseOctree::Clone() const {
+  return std::make_unique<LooseOctree>(*this);
+}
+
+int32_t LooseOctree::AllocateNode(int32_t parent, int octant) {
+  int32_t node;
+  if (m_freeNodes.empty()) {
+    node = static_cast<int32_t>(m_nodes.size());
+    m_nodes.emplace_back();
+  } else {
+    node = m_freeNodes.back();
+    m_freeNodes.pop_back();
+    m_nodes[node] = Node();
+  }
+
+  const Node &owner = m_nodes[parent];
+  const float quarter = 0.5f * owner.halfSize;
+  Node &child = m_nodes[node];
+  child.center = owner.center +
+                 Vector3((octant & 1) ? quarter : -quarter,
+                         (octant & 2) ? quarter : -quarter,
+                         (octant & 4) ? quarter : -quarter);
+  child.halfSize = quarter;
+  child.depth = owner.depth + 1;
+  child.parent = parent;
+  m_nodes[parent].children[octant] = node;
+  return node;
+}
+
+int32_t LooseOctree::FindNode(const AABB &bounds, bool create) {
+  const Vector3 center = bounds.GetCenter();
+  const Vector3 extents = bounds.GetExtents();
+  const float size = std::max(extents.x, std::max(extents.y, extents.z));
+
+  int32_t node = ROOT;
+  const Node &root = m_nodes[ROOT];
+  const Vector3 offset = center - root.center;
+  if (std::max(std::abs(offset.x),
+               std::max(std::abs(offset.y), std::abs(offset.z))) >
+      root.halfSize) {
+    return ROOT;
+  }
+
+  while (m_nodes[node].depth < m_maxDepth &&
+         0.5f * m_nodes[node].halfSize >= size) {
+    const Node &current = m_nodes[node];
+    const int octant = (center.x >= current.center.x ? 1 : 0) |
+                       (center.y >= current.center.y ? 2 : 0) |
+                       (center.z >= current.center.z ? 4 : 0);
+    int32_t child = current.children[octant];
+    if (child == NULL_NODE) {
+      if (!create) {
+        return NULL_NODE;
+      }
+      child = AllocateNode(node, octant);
+    }
+    node = child;
+  }
+  return node;
+}
+
+void LooseOctree::Link(int32_t proxy, int32_t node) {
+  std::vector<int32_t> &list = m_nodes[node].proxies;
+  m_proxies[proxy].node = node;
+  m_proxies[proxy].slot = static_cast<uint32_t>(list.size());
+  list.push_back(proxy);
+}
+
+void LooseOctree::Unlink(int32_t proxy) {
+  int32_t node = m_proxies[proxy].node;
+  std::vector<int32_t> &list = m_nodes[node].proxies;
+  const int32_t last = list.back();
+  list[m_proxies[proxy].slot] = last;
+  m_proxies[last].slot = m_proxies[proxy].slot;
+  list.pop_back();
+
+  // Release the now empty leaves so traversals never see them
+  while (node != ROOT && m_nodes[node].proxies.empty() &&
+         !m_nodes[node].HasChildren()) {
+    const int32_t parent = m_nodes[node].parent;
+    for (int32_t &child : m_nodes[parent].children) {
+      if (child == node) {
+        child = NULL_NODE;
+      }
+    }
+    m_nodes[node].proxies.shrink_to_fit();
+    m_freeNodes.push_back(node);
+    node = parent;
+  }
+}
+
+int32_t LooseOctree::Insert(const AABB &bounds, void *userData) {
+  int32_t proxy = m_freeList;
+  if (proxy == NULL_PROXY) {
+    proxy = static_cast<int32_t>(m_proxies.size());
+    m_proxies.emplace_back();
+  } else {
+    m_freeList = m_proxies[proxy].nextFree;
+  }
+
+  Proxy &entry = m_proxies[proxy];
+  entry.bounds = bounds;
+  entry.userData = userData;
+  entry.nextFree = NULL_PROXY;
+  Link(proxy, FindNode(bounds, true));
+  m_proxyCount++;
+  return proxy;
+}
+
+void LooseOctree::Remove(int32_t proxy) {
+  Unlink(proxy);
+  m_proxies[proxy].userData = nullptr;
+  m_proxies[proxy].node = NULL_NODE;
+  m_proxies[proxy].nextFree = m_freeList;
+  m_freeList = proxy;
+  m_proxyCount--;
+}
+
+bool LooseOctree::Update(int32_t proxy, const AABB &bounds,
+                         const Vector3 &displacement) {
+  (void)displacement;
+  m_proxies[proxy].bounds = bounds;
+  if (FindNode(bounds, false) == m_proxies[proxy].node) {
+    return false;
+  }
+  // Unlink first so a node it empties can be reused by the new path
+  Unlink(proxy);
+  Link(proxy, FindNode(bounds, true));
+  return true;
+}
+
+void LooseOctree::Clear() {
+  m_proxies.clear();
+  m_freeList = NULL_PROXY;
+  m_proxyCount = 0;
+
+  Node root;
+  root.center = m_nodes[ROOT].center;
+  root.halfSize = m_nodes[ROOT].halfSize;
+  m_nodes.clear();
+  m_nodes.push_back(std::move(root));
+  m_freeNodes.clear();
+}
+
+template <typename Accept, typename Visitor>
+void LooseOctree::Traverse(Accept &&accept, Visitor &&visit) const {
+  // Each level pushes at most its eight children
+  std::vector<int32_t> stack;
+  stack.reserve(8 * static_cast<size_t>(m_maxDepth) + 1);
+  visit(ROOT);
+  for (int32_t child : m_nodes[ROOT].children) {
+    if (child != NULL_NODE) {
+      stack.push_back(child);
+    }
+  }
+
+  while (!stack.empty()) {
+    const int32_t node = stack.back();
+    stack.pop_back();
+    if (!accept(m_nodes[node].GetLooseBounds())) {
+      continue;
+    }
+    if (!visit(node)) {
+      continue;
+    }
+    for (int32_t child : m_nodes[node].children) {
+      if (child != NULL_NODE) {
+        stack.push_back(child);
+      }
+    }
+  }
+}
+
+void LooseOctree::AppendSubtree(int32_t node,
+                                std::vector<void *> &results) const {
+  for (int32_t proxy : m_nodes[node].proxies) {
+    results.push_back(m_proxies[proxy].userData);
+  }
+  for (int32_t child : m_nodes[node].children) {
+    if (child != NULL_NODE) {
+      AppendSubtree(child, results);
+    }
+  }
+}
+
+void LooseOctree::QueryFrustum(const Frustum &frustum,
+                               std::vector<void *> &results) const {
+  Traverse([](const AABB &) { return true; },
+           [&](int32_t node) {
+             // The root may hold objects outside its loose bounds
+             if (node != ROOT) {
+               const Containment containment =
+                   frustum.Classify(m_nodes[node].GetLooseBounds());
+               if (containment == Containment::Outside) {
+                 return false;
+               }
+               if (containment == Containment::Inside) {
+                 AppendSubtree(node, results);
+                 return false;
+               }
+             }
+             for (int32_t proxy : m_nodes[node].proxies) {
+               if (frustum.Intersects(m_proxies[proxy].bounds)) {
+                 results.push_back(m_proxies[proxy].userData);
+               }
+             }
+             return true;
+           });
+}
+
+void LooseOctree::QueryAABB(const AABB &box,
+                            std::vector<void *> &results) const {
+  Traverse([&](const AABB &bounds) { return bounds.Intersects(box); },
+           [&](int32_t node) {
+             for (int32_t proxy : m_nodes[node].proxies) {
+               if (m_proxies[proxy].bounds.Intersects(box)) {
+                 results.push_back(m_proxies[proxy].userData);
+               }
+             }
+             return true;
+           });
+}
+
+void LooseOctree::QuerySphere(const BoundingSphere &sphere,
+                              std::vector<void *> &results) const {
+  Traverse([&](const AABB &bounds) { return sphere.Intersects(bounds); },
+           [&](int32_t node) {
+             for (int32_t proxy : m_nodes[node].proxies) {
+               if (sphere.Intersects(m_proxies[proxy].bounds)) {
+                 results.push_back(m_proxies[proxy].userData);
+               }
+             }
+             return true;
+           });
+}
+
+void *LooseOctree::Raycast(const Ray &ray, float maxDistance,
+                           const RayTest &test, float *distance) const {
+  void *closest = nullptr;
+  float closestDistance = maxDistance;
+
+  // Nodes starting beyond the closest hit so far cannot improve on it
+  Traverse(
+      [&](const AABB &bounds) {
+        float entry = 0.0f;
+        return ray.Intersects(bounds, &entry) && entry <= closestDistance;
+      },
+      [&](int32_t node) {
+        for (int32_t proxy : m_nodes[node].proxies) {
+          float hit = 0.0f;
+          if (!ray.Intersects(m_proxies[proxy].bounds, &hit) ||
+              hit > closestDistance) {
+            continue;
+          }
+          void *userData = m_proxies[proxy].userData;
+          if ((!test || test(userData, closestDistance, hit)) &&
+              hit <= closestDistance) {
+            closest = userData;
+            closestDistance = hit;
+          }
+        }
+        return true;
+      });
+
+  if (closest && distance) {
+    *distance = closestDistance;
+  }
+  return closest;
+}
+
+} // namespace AquaVisual
@@ -0,0 +1,119 @@
+#include "AquaVisual/Core/MappedFile.h"
+#include <iostream>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace AquaVisual {
+
+MappedFile::~MappedFile() { Close(); }
+
+#ifdef _WIN32
+
+bool MappedFile::Open(const std::string &path) {
+  Close();
+  HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                            nullptr, OPEN_EXISTING,
+                            FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    std::cerr << "MappedFile: cannot open " << path << std::endl;
+    return false;
+  }
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size)) {
+    std::cerr << "MappedFile: cannot get the size of " << path << std::endl;
+    CloseHandle(file);
+    return false;
+  }
+  m_file = file;
+  m_size = static_cast<size_t>(size.QuadPart);
+  m_open = true;
+  if (m_size == 0) {
+    return true; // nothing to map
+  }
+
+  m_mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  const void *view =
+      m_mapping ? MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+  if (!view) {
+    std::cerr << "MappedFile: cannot map " << path << std::endl;
+    Close();
+    return false;
+  }
+  m_data = static_cast<const char *>(view);
+  return true;
+}
+
+void MappedFile::Close() {
+  if (m_data) {
+    UnmapViewOfFile(m_data);
+  }
+  if (m_mapping) {
+    CloseHandle(m_mapping);
+  }
+  if (m_file) {
+    CloseHandle(m_file);
+  }
+  m_data = nullptr;
+  m_mapping = nullptr;
+  m_file = nullptr;
+  m_size = 0;
+  m_open = false;
+}
+
+#else
+
+bool MappedFile::Open(const std::string &path) {
+  Close();
+  const int file = open(path.c_str(), O_RDONLY);
+  if (file < 0) {
+    std::cerr << "MappedFile: cannot open " << path << std::endl;
+    return false;
+  }
+  struct stat info;
+  if (fstat(file, &info) != 0) {
+    std::cerr << "MappedFile: cannot get the size of " << path << std::endl;
+    close(file);
+    return false;
+  }
+
+  const size_t size = static_cast<size_t>(info.st_size);
+  if (size > 0) {
+    void *view = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+    if (view == MAP_FAILED) {
+      std::cerr << "MappedFile: cannot map " << path << std::endl;
+      close(file);
+      return false;
+    }
+    // Parsers read front to back
+    madvise(view, size, MADV_SEQUENTIAL);
+    m_data = static_cast<const char *>(view);
+  }
+  // The mapping keeps the file referenced
+  close(file);
+  m_size = size;
+  m_open = true;
+  return true;
+}
+
+void MappedFile::Close() {
+  if (m_data) {
+    munmap(const_cast<char *>(m_data), m_size);
+  }
+  m_data = nullptr;
+  m_size = 0;
+  m_open = false;
+}
+
+#endif
+
+} // namespace AquaVisual
@@ -0,0 +1,623 @@
+#include "AquaVisual/Core/MemoryAllocator.h"
+#include <algorithm>
+#include <iostream>
+#include <set>
+
+namespace AquaVisual {
+
+namespace {
+
+VkDeviceSize AlignUp(VkDeviceSize value, VkDeviceSize alignment) {
+  return alignment > 1 ? (value + alignment - 1) & ~(alignment - 1) : value;
+}
+
+VkDeviceSize NextPowerOfTwo(VkDeviceSize value) {
+  VkDeviceSize result = 1;
+  while (result < value) {
+    result <<= 1;
+  }
+  return result;
+}
+
+uint32_t Log2(VkDeviceSize value) {
+  uint32_t result = 0;
+  while (value > 1) {
+    value >>= 1;
+    ++result;
+  }
+  return result;
+}
+
+} // namespace
+
+// A single VkDeviceMemory object and the sub-allocations made from it
+class MemoryBlock {
+public:
+  MemoryBlock(VkDeviceMemory memory, VkDeviceSize size,
+              uint32_t memoryTypeIndex, uint32_t poolIndex,
+              AllocationStrategy strategy, bool dedicated)
+      : memory(memory), size(size), memoryTypeIndex(memoryTypeIndex),
+        poolIndex(poolIndex), strategy(strategy), dedicated(dedicated) {
+    if (strategy == AllocationStrategy::Buddy) {
+      m_maxOrder = Log2(size / MemoryAllocator::MIN_BUDDY_SIZE);
+      m_freeLists.resize(m_maxOrder + 1);
+      m_freeLists[m_maxOrder].insert(0);
+    }
+  }
+
+  bool Allocate(VkDeviceSize requestSize, VkDeviceSize alignment,
+                VkDeviceSize &offset, uint32_t &order) {
+    if (strategy == AllocationStrategy::Linear) {
+      VkDeviceSize alignedOffset = AlignUp(m_linearOffset, alignment);
+      if (alignedOffset + requestSize > size) {
+        return false;
+      }
+      offset = alignedOffset;
+      order = 0;
+      m_linearOffset = alignedOffset + requestSize;
+      ++allocationCount;
+      return true;
+    }
+
+    // Buddy blocks are naturally aligned to their own size
+    VkDeviceSize blockSize = NextPowerOfTwo(std::max(
+        {requestSize, alignment, MemoryAllocator::MIN_BUDDY_SIZE}));
+    uint32_t wanted = Log2(blockSize / MemoryAllocator::MIN_BUDDY_SIZE);
+    if (wanted > m_maxOrder) {
+      return false;
+    }
+
+    uint32_t current = wanted;
+    while (current <= m_maxOrder && m_freeLists[current].empty()) {
+      ++current;
+    }
+    if (current > m_maxOrder) {
+      return false;
+    }
+
+    VkDeviceSize found = *m_freeLists[current].begin();
+    m_freeLists[current].erase(m_freeLists[current].begin());
+
+    // Split down to the requested order, returning upper halves to the lists
+    while (current > wanted) {
+      --current;
+      m_freeLists[current].insert(found +
+                                  (MemoryAllocator::MIN_BUDDY_SIZE << current));
+    }
+
+    offset = found;
+    order = wanted;
+    ++allocationCount;
+    return true;
+  }
+
+  void Free(VkDeviceSize offset, uint32_t order) {
+    --allocationCount;
+
+    if (strategy == AllocationStrategy::Linear) {
+      if (allocationCount == 0) {
+        m_linearOffset = 0;
+      }
+      return;
+    }
+
+    // Merge with free buddies as far up as possible
+    while (order < m_maxOrder) {
+      VkDeviceSize buddy = offset ^ (MemoryAllocator::MIN_BUDDY_SIZE << order);
+      auto it = m_freeLists[order].find(buddy);
+      if (it == m_freeLists[order].end()) {
+        break;
+      }
+      m_freeLists[order].erase(it);
+      offset = std::min(offset, buddy);
+      ++order;
+    }
+    m_freeLists[order].insert(offset);
+  }
+
+  bool IsEmpty() const { return allocationCount == 0; }
+
+  VkDeviceMemory memory;
+  VkDeviceSize size;
+  uint32_t memoryTypeIndex;
+  uint32_t poolIndex;
+  AllocationStrategy strategy;
+  bool dedicated;
+
+  uint32_t allocationCount = 0;
+  void *mapped = nullptr;
+  uint32_t mapCount = 0;
+
+private:
+  // Buddy strategy: free offsets per order, order 0 = MIN_BUDDY_SIZE
+  std::vector<std::set<VkDeviceSize>> m_freeLists;
+  uint32_t m_maxOrder = 0;
+
+  // Linear strategy
+  VkDeviceSize m_linearOffset = 0;
+};
+
+struct MemoryAllocator::MemoryPool {
+  uint32_t memoryTypeIndex;
+  AllocationResource resource;
+  AllocationStrategy strategy;
+  std::vector<std::unique_ptr<MemoryBlock>> blocks;
+};
+
+MemoryAllocator &MemoryAllocator::Instance() {
+  static MemoryAllocator instance;
+  return instance;
+}
+
+MemoryAllocator::MemoryAllocator() = default;
+
+MemoryAllocator::~MemoryAllocator() { Shutdown(); }
+
+bool MemoryAllocator::Initialize(VkDevice device,
+                                 VkPhysicalDevice physicalDevice) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  if (m_device == device) {
+    return true;
+  }
+
+  if (m_device != VK_NULL_HANDLE) {
+    std::cerr << "MemoryAllocator: Already initialized with another device"
+              << '\n';
+    return false;
+  }
+
+  m_device = device;
+  m_physicalDevice = physicalDevice;
+  vkGetPhysicalDeviceMemoryProperties(physicalDevice, &m_memoryProperties);
+
+  VkPhysicalDeviceProperties properties;
+  vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+  m_maxAllocationCount = properties.limits.maxMemoryAllocationCount;
+  m_nonCoherentAtomSize =
+      std::max<VkDeviceSize>(properties.limits.nonCoherentAtomSize, 1);
+
+  std::cout << "MemoryAllocator initialized: "
+            << m_memoryProperties.memoryTypeCount << " memory types, "
+            << m_memoryProperties.memoryHeapCount << " heaps, "
+            << "maxMemoryAllocationCount = " << m_maxAllocationCount << '\n';
+  return true;
+}
+
+void MemoryAllocator::Shutdown() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  if (m_device == VK_NULL_HANDLE) {
+    return;
+  }
+
+  if (m_allocationCount > 0) {
+    std::cerr << "MemoryAllocator: " << m_allocationCount
+              << " allocations still alive at shutdown" << '\n';
+  }
+
+  for (auto &pool : m_pools) {
+    for (auto &block : pool->blocks) {
+      if (block->mapped) {
+        vkUnmapMemory(m_device, block->memory);
+      }
+      vkFreeMemory(m_device, block->memory, nullptr);
+    }
+  }
+  for (auto &block : m_dedicatedBlocks) {
+    if (block->mapped) {
+      vkUnmapMemory(m_device, block->memory);
+    }
+    vkFreeMemory(m_device, block->memory, nullptr);
+  }
+
+  m_pools.clear();
+  m_dedicatedBlocks.clear();
+  m_deviceMemoryCount = 0;
+  m_allocationCount = 0;
+  m_reservedBytes = 0;
+  m_usedBytes = 0;
+  m_device = VK_NULL_HANDLE;
+  m_physicalDevice = VK_NULL_HANDLE;
+}
+
+bool MemoryAllocator::Allocate(const VkMemoryRequirements &requirements,
+                               VkMemoryPropertyFlags required,
+                               MemoryAllocation &allocation,
+                               AllocationResource resource,
+                               AllocationStrategy strategy,
+                               VkMemoryPropertyFlags preferred) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  if (m_device == VK_NULL_HANDLE) {
+    std::cerr << "MemoryAllocator: Not initialized" << '\n';
+    return false;
+  }
+
+  uint32_t preferredType =
+      FindMemoryType(requirements.memoryTypeBits, required | preferred);
+  if (preferredType != UINT32_MAX &&
+      AllocateFromType(preferredType, requirements, resource, strategy,
+                       allocation)) {
+    return true;
+  }
+
+  uint32_t requiredType = FindMemoryType(requirements.memoryTypeBits, required);
+  if (requiredType != UINT32_MAX && requiredType != preferredType &&
+      AllocateFromType(requiredType, requirements, resource, strategy,
+                       allocation)) {
+    return true;
+  }
+
+  std::cerr << "MemoryAllocator: Failed to allocate " << requirements.size
+            << " bytes (memory type bits 0x" << std::hex
+            << requirements.memoryTypeBits << ", flags 0x" << required
+            << std::dec << ")" << '\n';
+  return false;
+}
+
+void MemoryAllocator::Free(MemoryAllocation &allocation) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  MemoryBlock *block = allocation.block;
+  if (block == nullptr || m_device == VK_NULL_HANDLE) {
+    allocation = MemoryAllocation();
+    return;
+  }
+
+  block->Free(allocation.offset, allocation.order);
+  --m_allocationCount;
+  ++m_totalFrees;
+  m_usedBytes -= allocation.size;
+
+  if (block->dedicated) {
+    DestroyBlock(block);
+  } else if (block->IsEmpty()) {
+    // Keep one empty block per pool around to avoid allocation churn
+    MemoryPool &pool = *m_pools[block->poolIndex];
+    size_t emptyBlocks = 0;
+    for (const auto &poolBlock : pool.blocks) {
+      if (poolBlock->IsEmpty()) {
+        ++emptyBlocks;
+      }
+    }
+    if (emptyBlocks > 1) {
+      DestroyBlock(block);
+    }
+  }
+
+  allocation = MemoryAllocation();
+}
+
+bool MemoryAllocator::AllocateForBuffer(VkBuffer buffer,
+                                        VkMemoryPropertyFlags required,
+                                        MemoryAllocation &allocation,
+                                        AllocationStrategy strategy,
+                                        VkMemoryPropertyFlags preferred) {
+  VkMemoryRequirements memRequirements;
+  vkGetBufferMemoryRequirements(m_device, buffer, &memRequirements);
+
+  if (!Allocate(memRequirements, required, allocation,
+                AllocationResource::Buffer, strategy, preferred)) {
+    return false;
+  }
+
+  if (vkBindBufferMemory(m_device, buffer, allocation.memory,
+                         allocation.offset) != VK_SUCCESS) {
+    std::cerr << "MemoryAllocator: Failed to bind buffer memory" << '\n';
+    Free(allocation);
+    return false;
+  }
+  return true;
+}
+
+bool MemoryAllocator::AllocateForImage(VkImage image,
+                                       VkMemoryPropertyFlags required,
+                                       MemoryAllocation &allocation,
+                                       VkMemoryPropertyFlags preferred) {
+  VkMemoryRequirements memRequirements;
+  vkGetImageMemoryRequirements(m_device, image, &memRequirements);
+
+  if (!Allocate(memRequirements, required, allocation,
+                AllocationResource::Image, AllocationStrategy::Buddy,
+                preferred)) {
+    return false;
+  }
+
+  if (vkBindImageMemory(m_device, image, allocation.memory,
+                        allocation.offset) != VK_SUCCESS) {
+    std::cerr << "MemoryAllocator: Failed to bind image memory" << '\n';
+    Free(allocation);
+    return false;
+  }
+  return true;
+}
+
+void *MemoryAllocator::Map(const MemoryAllocation &allocation) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  MemoryBlock *block = allocation.block;
+  if (block == nullptr || m_device == VK_NULL_HANDLE) {
+    return nullptr;
+  }
+
+  if ((m_memoryProperties.memoryTypes[block->memoryTypeIndex].propertyFlags &
+       VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) == 0) {
+    std::cerr << "MemoryAllocator: Cannot map memory that is not host visible"
+              << '\n';
+    return nullptr;
+  }
+
+  // A VkDeviceMemory can only be mapped once, so the whole block is mapped
+  // and shared between its allocations
+  if (block->mapped == nullptr) {
+    if (vkMapMemory(m_device, block->memory, 0, VK_WHOLE_SIZE, 0,
+                    &block->mapped) != VK_SUCCESS) {
+      std::cerr << "MemoryAllocator: Failed to map memory block" << '\n';
+      block->mapped = nullptr;
+      return nullptr;
+    }
+  }
+
+  ++block->mapCount;
+  return static_cast<char *>(block->mapped) + allocation.offset;
+}
+
+void MemoryAllocator::Unmap(const MemoryAllocation &allocation) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  MemoryBlock *block = allocation.block;
+  if (block == nullptr || block->mapCount == 0) {
+    return;
+  }
+
+  if (--block->mapCount == 0) {
+    vkUnmapMemory(m_device, block->memory);
+    block->mapped = nullptr;
+  }
+}
+
+bool MemoryAllocator::Flush(const MemoryAllocation &allocation,
+                            VkDeviceSize offset, VkDeviceSize size) {
+  VkMappedMemoryRange range{};
+  if (!GetMappedRange(allocation, offset, size, range)) {
+    return true;
+  }
+  return vkFlushMappedMemoryRanges(m_device, 1, &range) == VK_SUCCESS;
+}
+
+bool MemoryAllocator::Invalidate(const MemoryAllocation &allocation,
+                                 VkDeviceSize offset, VkDeviceSize size) {
+  VkMappedMemoryRange range{};
+  if (!GetMappedRange(allocation, offset, size, range)) {
+    return true;
+  }
+  return vkInvalidateMappedMemoryRanges(m_device, 1, &range) == VK_SUCCESS;
+}
+
+VkMemoryPropertyFlags
+MemoryAllocator::GetMemoryProperties(const MemoryAllocation &allocation) const {
+  if (allocation.memoryTypeIndex >= m_memoryProperties.memoryTypeCount) {
+    return 0;
+  }
+  return m_memoryProperties.memoryTypes[allocation.memoryTypeIndex]
+      .propertyFlags;
+}
+
+MemoryAllocatorStats MemoryAllocator::GetStats() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  MemoryAllocatorStats stats;
+  stats.deviceMemoryCount = m_deviceMemoryCount;
+  stats.maxDeviceMemoryCount = m_maxAllocationCount;
+  for (const auto &pool : m_pools) {
+    stats.blockCount += static_cast<uint32_t>(pool->blocks.size());
+  }
+  stats.dedicatedCount = static_cast<uint32_t>(m_dedicatedBlocks.size());
+  stats.allocationCount = m_allocationCount;
+  stats.totalAllocations = m_totalAllocations;
+  stats.totalFrees = m_totalFrees;
+  stats.reservedBytes = m_reservedBytes;
+  stats.usedBytes = m_usedBytes;
+  return stats;
+}
+
+void MemoryAllocator::PrintStats() const {
+  MemoryAllocatorStats stats = GetStats();
+  std::cout << "=== GPU Memory Allocator ===" << '\n';
+  std::cout << "Device memory objects: " << stats.deviceMemoryCount << " / "
+            << stats.maxDeviceMemoryCount << " (" << stats.blockCount
+            << " blocks, " << stats.dedicatedCount << " dedicated)" << '\n';
+  std::cout << "Live allocations: " << stats.allocationCount << " (total "
+            << stats.totalAllocations << ", freed " << stats.totalFrees << ")"
+            << '\n';
+  std::cout << "Used / reserved: " << stats.usedBytes << " / "
+            << stats.reservedBytes << " bytes" << '\n';
+}
+
+bool MemoryAllocator::GetMappedRange(const MemoryAllocation &allocation,
+                                     VkDeviceSize offset, VkDeviceSize size,
+                                     VkMappedMemoryRange &range) const {
+  MemoryBlock *block = allocation.block;
+  if (block == nullptr || block->mapped == nullptr ||
+      IsHostCoherent(allocation) || offset >= allocation.size) {
+    return false;
+  }
+
+  if (size == VK_WHOLE_SIZE || offset + size > allocation.size) {
+    size = allocation.size - offset;
+  }
+
+  // Ranges must start and end on nonCoherentAtomSize multiples (or the end
+  // of the memory object)
+  const VkDeviceSize begin = (allocation.offset + offset) /
+                             m_nonCoherentAtomSize * m_nonCoherentAtomSize;
+  const VkDeviceSize end =
+      std::min(AlignUp(allocation.offset + offset + size, m_nonCoherentAtomSize),
+               block->size);
+
+  range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+  range.memory = block->memory;
+  range.offset = begin;
+  range.size = end - begin;
+  return true;
+}
+
+uint32_t MemoryAllocator::FindMemoryType(
+    uint32_t typeFilter, VkMemoryPropertyFlags properties) const {
+  for (uint32_t i = 0; i < m_memoryProperties.memoryTypeCount; i++) {
+    if ((typeFilter & (1 << i)) &&
+        (m_memoryProperties.memoryTypes[i].propertyFlags & properties) ==
+            properties) {
+      return i;
+    }
+  }
+  return UINT32_MAX;
+}
+
+bool MemoryAllocator::AllocateFromType(uint32_t memoryTypeIndex,
+                                       const VkMemoryRequirements &requirements,
+                                       AllocationResource resource,
+                                       AllocationStrategy strategy,
+                                       MemoryAllocation &allocation) {
+  VkDeviceSize offset = 0;
+  uint32_t order = 0;
+  MemoryBlock *target = nullptr;
+
+  VkDeviceSize blockSize = GetBlockSize(memoryTypeIndex);
+  if (requirements.size > blockSize / 2) {
+    // Large resources get their own device memory
+    target = CreateBlock(nullptr, memoryTypeIndex, requirements.size,
+                         AllocationStrategy::Linear, true);
+    if (target == nullptr ||
+        !target->Allocate(requirements.size, 1, offset, order)) {
+      return false;
+    }
+  } else {
+    MemoryPool &pool = GetPool(memoryTypeIndex, resource, strategy);
+    for (auto &block : pool.blocks) {
+      if (block->Allocate(requirements.size, requirements.alignment, offset,
+                          order)) {
+        target = block.get();
+        break;
+      }
+    }
+
+    if (target == nullptr) {
+      target = CreateBlock(&pool, memoryTypeIndex, blockSize, strategy, false);
+      if (target == nullptr ||
+          !target->Allocate(requirements.size, requirements.alignment, offset,
+                            order)) {
+        return false;
+      }
+    }
+  }
+
+  allocation.memory = target->memory;
+  allocation.offset = offset;
+  allocation.size = requirements.size;
+  allocation.memoryTypeIndex = memoryTypeIndex;
+  allocation.block = target;
+  allocation.order = order;
+
+  ++m_allocationCount;
+  ++m_totalAllocations;
+  m_usedBytes += requirements.size;
+  return true;
+}
+
+MemoryAllocator::MemoryPool &
+MemoryAllocator::GetPool(uint32_t memoryTypeIndex, AllocationResource resource,
+                         AllocationStrategy strategy) {
+  for (auto &pool : m_pools) {
+    if (pool->memoryTypeIndex == memoryTypeIndex &&
+        pool->resource == resource && pool->strategy == strategy) {
+      return *pool;
+    }
+  }
+
+  auto pool = std::make_unique<MemoryPool>();
+  pool->memoryTypeIndex = memoryTypeIndex;
+  pool->resource = resource;
+  pool->strategy = strategy;
+  m_pools.push_back(std::move(pool));
+  return *m_pools.back();
+}
+
+VkDeviceSize MemoryAllocator::GetBlockSize(uint32_t memoryTypeIndex) const {
+  const uint32_t heapIndex =
+      m_memoryProperties.memoryTypes[memoryTypeIndex].heapIndex;
+  const VkDeviceSize heapSize = m_memoryProperties.memoryHeaps[heapIndex].size;
+
+  // Small heaps (e.g. the 256 MB BAR window) get proportionally smaller blocks
+  VkDeviceSize blockSize = DEFAULT_BLOCK_SIZE;
+  while (blockSize > heapSize / 8 && blockSize > 1024 * 1024) {
+    blockSize /= 2;
+  }
+  return blockSize;
+}
+
+MemoryBlock *MemoryAllocator::CreateBlock(MemoryPool *pool,
+                                          uint32_t memoryTypeIndex,
+                                          VkDeviceSize size,
+                                          AllocationStrategy strategy,
+                                          bool dedicated) {
+  if (m_maxAllocationCount != 0 &&
+      m_deviceMemoryCount >= m_maxAllocationCount) {
+    std::cerr << "MemoryAllocator: maxMemoryAllocationCount reached" << '\n';
+    return nullptr;
+  }
+
+  VkMemoryAllocateInfo allocInfo{};
+  allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+  allocInfo.allocationSize = size;
+  allocInfo.memoryTypeIndex = memoryTypeIndex;
+
+  VkDeviceMemory memory;
+  if (vkAllocateMemory(m_device, &allocInfo, nullptr, &memory) != VK_SUCCESS) {
+    return nullptr;
+  }
+
+  ++m_deviceMemoryCount;
+  m_reservedBytes += size;
+
+  uint32_t poolIndex = UINT32_MAX;
+  if (pool != nullptr) {
+    for (uint32_t i = 0; i < m_pools.size(); i++) {
+      if (m_pools[i].get() == pool) {
+        poolIndex = i;
+        break;
+      }
+    }
+  }
+
+  auto block = std::make_unique<MemoryBlock>(memory, size, memoryTypeIndex,
+                                             poolIndex, strategy, dedicated);
+  MemoryBlock *result = block.get();
+  if (pool != nullptr) {
+    pool->blocks.push_back(std::move(block));
+  } else {
+    m_dedicatedBlocks.push_back(std::move(block));
+  }
+  return result;
+}
+
+void MemoryAllocator::DestroyBlock(MemoryBlock *block) {
+  if (block->mapped) {
+    vkUnmapMemory(m_device, block->memory);
+  }
+  vkFreeMemory(m_device, block->memory, nullptr);
+
+  --m_deviceMemoryCount;
+  m_reservedBytes -= block->size;
+
+  auto &owner = block->dedicated ? m_dedicatedBlocks
+                                 : m_pools[block->poolIndex]->blocks;
+  owner.erase(std::remove_if(owner.begin(), owner.end(),
+                             [block](const std::unique_ptr<MemoryBlock> &b) {
+                               return b.get() == block;
+                             }),
+              owner.end());
+}
+
+} // namespace AquaVisual
@@ -0,0 +1,270 @@
+#include "AquaVisual/Core/MeshCache.h"
+#include "AquaVisual/Core/UploadManager.h"
+#include "AquaVisual/Resources/Mesh.h"
+#include <algorithm>
+#include <iostream>
+
+namespace AquaVisual {
+
+MeshCache::MeshCache() = default;
+
+MeshCache::~MeshCache() { Shutdown(); }
+
+bool MeshCache::Initialize(VkDevice device, VkPhysicalDevice physicalDevice,
+                           uint32_t framesInFlight, VkDeviceSize budget,
+                           VertexFormat vertexFormat) {
+  m_device = device;
+  m_framesInFlight = std::max(framesInFlight, 1u);
+  m_budget = budget;
+  m_vertexFormat = vertexFormat;
+
+  if (!MemoryAllocator::Instance().Initialize(device, physicalDevice)) {
+    m_device = VK_NULL_HANDLE;
+    return false;
+  }
+
+  std::cout << "MeshCache initialized with budget "
+            << (m_budget / (1024 * 1024)) << " MB" << '\n';
+  return true;
+}
+
+void MeshCache::Shutdown() {
+  if (m_device == VK_NULL_HANDLE) {
+    return;
+  }
+
+  // Callers wait for the device to be idle before shutting down
+  Clear();
+  ReleaseCompleted(true);
+
+  m_device = VK_NULL_HANDLE;
+}
+
+void MeshCache::BeginFrame() {
+  ++m_frameNumber;
+  ReleaseCompleted(false);
+}
+
+const MeshGpuData *MeshCache::Acquire(const Mesh &mesh) {
+  if (m_device == VK_NULL_HANDLE || mesh.GetVertexCount() == 0) {
+    return nullptr;
+  }
+
+  auto it = m_entries.find(mesh.GetId());
+  if (it != m_entries.end()) {
+    if (it->second.data.version == mesh.GetVersion()) {
+      ++m_hits;
+      it->second.data.lastUsedFrame = m_frameNumber;
+      m_lru.splice(m_lru.begin(), m_lru, it->second.lruIt);
+      return &it->second.data;
+    }
+
+    // Content changed since upload, drop the stale copy
+    EvictEntry(it);
+  }
+
+  ++m_misses;
+
+  MeshGpuData data;
+  if (!Upload(mesh, data)) {
+    return nullptr;
+  }
+
+  data.lastUsedFrame = m_frameNumber;
+  m_residentBytes += data.sizeInBytes;
+
+  m_lru.push_front(mesh.GetId());
+  Entry &entry = m_entries[mesh.GetId()];
+  entry.data = data;
+  entry.lruIt = m_lru.begin();
+
+  EnforceBudget();
+  return &entry.data;
+}
+
+bool MeshCache::Evict(const Mesh &mesh) { return Evict(mesh.GetId()); }
+
+bool MeshCache::Evict(uint64_t meshId) {
+  auto it = m_entries.find(meshId);
+  if (it == m_entries.end()) {
+    return false;
+  }
+
+  EvictEntry(it);
+  return true;
+}
+
+void MeshCache::Clear() {
+  while (!m_entries.empty()) {
+    EvictEntry(m_entries.begin());
+  }
+}
+
+void MeshCache::SetMemoryBudget(VkDeviceSize budget) {
+  m_budget = budget;
+  EnforceBudget();
+}
+
+bool MeshCache::IsResident(const Mesh &mesh) const {
+  auto it = m_entries.find(mesh.GetId());
+  return it != m_entries.end() && it->second.data.version == mesh.GetVersion();
+}
+
+MeshCacheStats MeshCache::GetStats() const {
+  MeshCacheStats stats;
+  stats.hits = m_hits;
+  stats.misses = m_misses;
+  stats.uploads = m_uploads;
+  stats.evictions = m_evictions;
+  stats.residentMeshes = m_entries.size();
+  stats.residentBytes = m_residentBytes;
+  stats.budgetBytes = m_budget;
+  return stats;
+}
+
+bool MeshCache::Upload(const Mesh &mesh, MeshGpuData &out) {
+  const VkDeviceSize vertexBytes =
+      mesh.GetVertexCount() * VertexPacking::GetStride(m_vertexFormat);
+  const void *vertices = mesh.GetVertices().data();
+  if (m_vertexFormat == VertexFormat::Packed) {
+    m_packedVertices.resize(mesh.GetVertexCount());
+    VertexPacking::Pack(mesh.GetVertices(),
+                        VertexPacking::ComputeQuantization(mesh.GetBounds()),
+                        m_packedVertices.data());
+    vertices = m_packedVertices.data();
+  }
+  const VkDeviceSize baseIndexBytes = mesh.GetIndexCount() * sizeof(uint32_t);
+  const VkDeviceSize lodIndexBytes =
+      mesh.GetLodIndices().size() * sizeof(uint32_t);
+  const VkDeviceSize indexBytes = baseIndexBytes + lodIndexBytes;
+
+  // Copies are batched by the upload manager and submitted ahead of this
+  // frame's draws
+  UploadManager &uploader = UploadManager::Instance();
+
+  bool success =
+      CreateBuffer(vertexBytes,
+                   VK_BUFFER_USAGE_VERTEX_BUFFER_BIT |
+                       VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                   out.vertexBuffer, out.vertexAllocation) &&
+      uploader.Upload(out.vertexBuffer, vertices, vertexBytes);
+
+  if (success && indexBytes > 0) {
+    success = CreateBuffer(indexBytes,
+                           VK_BUFFER_USAGE_INDEX_BUFFER_BIT |
+                               VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                           out.indexBuffer, out.indexAllocation) &&
+              uploader.Upload(out.indexBuffer, mesh.GetIndices().data(),
+                              baseIndexBytes) &&
+              (lodIndexBytes == 0 ||
+               uploader.Upload(out.indexBuffer, mesh.GetLodIndices().data(),
+                               lodIndexBytes, baseIndexBytes));
+  }
+
+  if (!success) {
+    std::cerr << "MeshCache: Failed to upload mesh " << mesh.GetId() << '\n';
+    DestroyGpuData(out);
+    return false;
+  }
+
+  out.vertexCount = static_cast<uint32_t>(mesh.GetVertexCount());
+  out.indexCount = static_cast<uint32_t>(mesh.GetIndexCount());
+  if (lodIndexBytes > 0) {
+    const std::vector<MeshLod> &lods = mesh.GetLods();
+    out.lodCount = static_cast<uint32_t>(
+        std::min<size_t>(lods.size(), Mesh::MAX_LODS));
+    for (uint32_t i = 0; i < out.lodCount; i++) {
+      out.lodFirstIndex[i] = out.indexCount + lods[i].indexOffset;
+      out.lodIndexCount[i] = lods[i].indexCount;
+    }
+  }
+  out.sizeInBytes = vertexBytes + indexBytes;
+  out.version = mesh.GetVersion();
+  ++m_uploads;
+
+  std::cout << "MeshCache: Uploaded mesh " << mesh.GetId() << " ("
+            << out.vertexCount << " vertices, " << out.indexCount
+            << " indices, " << out.sizeInBytes << " bytes)" << '\n';
+  return true;
+}
+
+bool MeshCache::CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage,
+                             VkBuffer &buffer, MemoryAllocation &allocation) {
+  VkBufferCreateInfo bufferInfo{};
+  bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+  bufferInfo.size = size;
+  bufferInfo.usage = usage;
+  UploadManager::Instance().ApplySharingMode(bufferInfo);
+
+  if (vkCreateBuffer(m_device, &bufferInfo, nullptr, &buffer) != VK_SUCCESS) {
+    return false;
+  }
+
+  if (!MemoryAllocator::Instance().AllocateForBuffer(
+          buffer, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, allocation)) {
+    vkDestroyBuffer(m_device, buffer, nullptr);
+    buffer = VK_NULL_HANDLE;
+    return false;
+  }
+  return true;
+}
+
+void MeshCache::EvictEntry(std::unordered_map<uint64_t, Entry>::iterator it) {
+  MeshGpuData &data = it->second.data;
+
+  // The buffers may still be referenced by command buffers in flight
+  PendingRelease pending;
+  pending.data = data;
+  pending.releaseFrame = data.lastUsedFrame;
+  m_pendingReleases.push_back(pending);
+
+  m_residentBytes -= data.sizeInBytes;
+  m_lru.erase(it->second.lruIt);
+  m_entries.erase(it);
+  ++m_evictions;
+}
+
+void MeshCache::EnforceBudget() {
+  while (m_residentBytes > m_budget && !m_lru.empty()) {
+    auto it = m_entries.find(m_lru.back());
+
+    // Never evict meshes drawn this frame; they would be uploaded again
+    // immediately on the next draw
+    if (it->second.data.lastUsedFrame == m_frameNumber) {
+      break;
+    }
+
+    EvictEntry(it);
+  }
+}
+
+void MeshCache::DestroyGpuData(MeshGpuData &data) {
+  UploadManager &uploader = UploadManager::Instance();
+  if (data.vertexBuffer != VK_NULL_HANDLE) {
+    uploader.Discard(data.vertexBuffer);
+    vkDestroyBuffer(m_device, data.vertexBuffer, nullptr);
+    data.vertexBuffer = VK_NULL_HANDLE;
+  }
+  MemoryAllocator::Instance().Free(data.vertexAllocation);
+  if (data.indexBuffer != VK_NULL_HANDLE) {
+    uploader.Discard(data.indexBuffer);
+    vkDestroyBuffer(m_device, data.indexBuffer, nullptr);
+    data.indexBuffer = VK_NULL_HANDLE;
+  }
+  MemoryAllocator::Instance().Free(data.indexAllocation);
+}
+
+void MeshCache::ReleaseCompleted(bool force) {
+  auto it = m_pendingReleases.begin();
+  while (it != m_pendingReleases.end()) {
+    // Frame N has completed once frame N + framesInFlight has started
+    if (force || it->releaseFrame + m_framesInFlight <= m_frameNumber) {
+      DestroyGpuData(it->data);
+      it = m_pendingReleases.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+} // namespace AquaVisual
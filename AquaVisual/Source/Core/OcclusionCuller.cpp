@@ -0,0 +1,368 @@
+#include "AquaVisual/Core/OcclusionCuller.h"
+#include "AquaVisual/Core/JobSystem.h"
+#include "AquaVisual/Math/Simd.h"
+#include <algorithm>
+#include <bitset>
+#include <cmath>
+#include <limits>
+
+namespace AquaVisual {
+
+namespace {
+
+constexpr float FAR_DEPTH = std::numeric_limits<float>::max();
+
+// Mask words (32 boxes each) per parallel chunk of CullAABBs
+constexpr size_t WORDS_PER_CHUNK = 4;
+
+// Pixel centers of one SIMD run, relative to its first pixel
+alignas(32) constexpr float LANE_CENTERS[8] = {0.5f, 1.5f, 2.5f, 3.5f,
+                                               4.5f, 5.5f, 6.5f, 7.5f};
+
+static_assert(OcclusionCuller::TILE_WIDTH % Simd::WIDTH == 0,
+              "tile rows must be whole SIMD runs");
+static_assert(OcclusionCuller::TILE_WIDTH % OcclusionCuller::BLOCK_SIZE ==
+                      0 &&
+                  OcclusionCuller::TILE_HEIGHT % OcclusionCuller::BLOCK_SIZE ==
+                      0,
+              "tiles must be whole blocks");
+
+uint32_t RoundUp(uint32_t value, uint32_t multiple) {
+  return std::max((value + multiple - 1) / multiple, 1u) * multiple;
+}
+
+} // namespace
+
+OcclusionCuller::OcclusionCuller(uint32_t width, uint32_t height) {
+  Resize(width, height);
+}
+
+void OcclusionCuller::Resize(uint32_t width, uint32_t height) {
+  m_width = RoundUp(width, TILE_WIDTH);
+  m_height = RoundUp(height, TILE_HEIGHT);
+  m_tilesX = m_width / TILE_WIDTH;
+  m_tilesY = m_height / TILE_HEIGHT;
+  m_bins.assign(static_cast<size_t>(m_tilesX) * m_tilesY, {});
+  m_depth.assign(static_cast<size_t>(m_width) * m_height, FAR_DEPTH);
+  m_blockMaxDepth.assign(static_cast<size_t>(m_width / BLOCK_SIZE) *
+                             (m_height / BLOCK_SIZE),
+                         FAR_DEPTH);
+  m_triangles.clear();
+  m_empty = true;
+}
+
+void OcclusionCuller::BeginFrame(const Matrix4 &viewProjection) {
+  m_viewProjection = viewProjection;
+  m_triangles.clear();
+  for (auto &bin : m_bins) {
+    bin.clear();
+  }
+  if (!m_empty) {
+    std::fill(m_depth.begin(), m_depth.end(), FAR_DEPTH);
+    std::fill(m_blockMaxDepth.begin(), m_blockMaxDepth.end(), FAR_DEPTH);
+  }
+  m_empty = true;
+}
+
+void OcclusionCuller::AddOccluder(const Vector3 *positions,
+                                  size_t vertexCount, const uint32_t *indices,
+                                  size_t indexCount, const Matrix4 &model,
+                                  size_t stride) {
+  const Matrix4 modelViewProjection = m_viewProjection * model;
+  const auto *bytes = reinterpret_cast<const unsigned char *>(positions);
+  m_clip.resize(vertexCount);
+  for (size_t i = 0; i < vertexCount; i++) {
+    const auto &position =
+        *reinterpret_cast<const Vector3 *>(bytes + i * stride);
+    m_clip[i] = modelViewProjection * Vector4(position, 1.0f);
+  }
+
+  const float width = static_cast<float>(m_width);
+  const float height = static_cast<float>(m_height);
+  for (size_t i = 0; i + 2 < indexCount; i += 3) {
+    float x[3], y[3], z[3];
+    bool clipped = false;
+    for (int corner = 0; corner < 3; corner++) {
+      const uint32_t index = indices[i + corner];
+      if (index >= vertexCount) {
+        clipped = true;
+        break;
+      }
+      const Vector4 &clip = m_clip[index];
+      // Dropping a triangle only hides less, so no near plane clipping
+      if (clip.w <= 0.0f || clip.z < -clip.w) {
+        clipped = true;
+        break;
+      }
+      const float inverseW = 1.0f / clip.w;
+      x[corner] = (clip.x * inverseW * 0.5f + 0.5f) * width;
+      y[corner] = (clip.y * inverseW * 0.5f + 0.5f) * height;
+      z[corner] = clip.z * inverseW;
+    }
+    if (clipped) {
+      continue;
+    }
+
+    // Either winding occludes; orient counter-clockwise
+    float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+    if (std::abs(area) < 1e-6f) {
+      continue;
+    }
+    if (area < 0.0f) {
+      std::swap(x[1], x[2]);
+      std::swap(y[1], y[2]);
+      std::swap(z[1], z[2]);
+      area = -area;
+    }
+
+    // Pixels whose centers can be inside
+    Triangle triangle;
+    triangle.minX = std::max(
+        static_cast<int32_t>(
+            std::ceil(std::min(x[0], std::min(x[1], x[2])) - 0.5f)),
+        0);
+    triangle.maxX = std::min(
+        static_cast<int32_t>(
+            std::floor(std::max(x[0], std::max(x[1], x[2])) - 0.5f)),
+        static_cast<int32_t>(m_width) - 1);
+    triangle.minY = std::max(
+        static_cast<int32_t>(
+            std::ceil(std::min(y[0], std::min(y[1], y[2])) - 0.5f)),
+        0);
+    triangle.maxY = std::min(
+        static_cast<int32_t>(
+            std::floor(std::max(y[0], std::max(y[1], y[2])) - 0.5f)),
+        static_cast<int32_t>(m_height) - 1);
+    if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY) {
+      continue;
+    }
+
+    for (int edge = 0; edge < 3; edge++) {
+      const int next = (edge + 1) % 3;
+      triangle.edgeA[edge] = y[edge] - y[next];
+      triangle.edgeB[edge] = x[next] - x[edge];
+      triangle.edgeC[edge] =
+          (y[next] - y[edge]) * x[edge] - (x[next] - x[edge]) * y[edge];
+    }
+
+    // Evaluated at a pixel center the plane gives the farthest depth it
+    // reaches inside that pixel
+    triangle.depthA =
+        ((z[1] - z[0]) * (y[2] - y[0]) - (z[2] - z[0]) * (y[1] - y[0])) /
+        area;
+    triangle.depthB =
+        ((x[1] - x[0]) * (z[2] - z[0]) - (x[2] - x[0]) * (z[1] - z[0])) /
+        area;
+    triangle.depthC = z[0] - triangle.depthA * x[0] -
+                      triangle.depthB * y[0] +
+                      0.5f * (std::abs(triangle.depthA) +
+                              std::abs(triangle.depthB));
+    triangle.maxDepth = std::max(z[0], std::max(z[1], z[2]));
+
+    const uint32_t index = static_cast<uint32_t>(m_triangles.size());
+    m_triangles.push_back(triangle);
+    for (int32_t tileY = triangle.minY / static_cast<int32_t>(TILE_HEIGHT);
+         tileY <= triangle.maxY / static_cast<int32_t>(TILE_HEIGHT);
+         tileY++) {
+      for (int32_t tileX = triangle.minX / static_cast<int32_t>(TILE_WIDTH);
+           tileX <= triangle.maxX / static_cast<int32_t>(TILE_WIDTH);
+           tileX++) {
+        m_bins[tileY * m_tilesX + tileX].push_back(index);
+      }
+    }
+  }
+}
+
+void OcclusionCuller::Rasterize() {
+  if (m_triangles.empty()) {
+    return;
+  }
+  m_empty = false;
+  JobSystem::Instance().ParallelFor(
+      m_bins.size(), 1, [this](size_t begin, size_t end) {
+        for (size_t tile = begin; tile < end; tile++) {
+          RasterizeTile(static_cast<uint32_t>(tile));
+        }
+      });
+}
+
+void OcclusionCuller::RasterizeTile(uint32_t tile) {
+  const std::vector<uint32_t> &bin = m_bins[tile];
+  if (bin.empty()) {
+    return;
+  }
+  const int32_t tileX = static_cast<int32_t>((tile % m_tilesX) * TILE_WIDTH);
+  const int32_t tileY = static_cast<int32_t>((tile / m_tilesX) * TILE_HEIGHT);
+  const Simd::FloatN zero = Simd::SplatN(0.0f);
+  const Simd::FloatN lanes = Simd::LoadN(LANE_CENTERS);
+
+  for (uint32_t index : bin) {
+    const Triangle &triangle = m_triangles[index];
+    const int32_t beginY = std::max(triangle.minY, tileY);
+    const int32_t endY =
+        std::min(triangle.maxY, tileY + static_cast<int32_t>(TILE_HEIGHT) - 1);
+    // Whole SIMD runs; tiles start on a run boundary
+    const int32_t beginX =
+        tileX + (std::max(triangle.minX, tileX) - tileX) /
+                    static_cast<int32_t>(Simd::WIDTH) *
+                    static_cast<int32_t>(Simd::WIDTH);
+    const int32_t endX =
+        std::min(triangle.maxX, tileX + static_cast<int32_t>(TILE_WIDTH) - 1);
+
+    const Simd::FloatN edgeA0 = Simd::SplatN(triangle.edgeA[0]);
+    const Simd::FloatN edgeA1 = Simd::SplatN(triangle.edgeA[1]);
+    const Simd::FloatN edgeA2 = Simd::SplatN(triangle.edgeA[2]);
+    const Simd::FloatN depthA = Simd::SplatN(triangle.depthA);
+    const Simd::FloatN maxDepth = Simd::SplatN(triangle.maxDepth);
+
+    for (int32_t pixelY = beginY; pixelY <= endY; pixelY++) {
+      const float centerY = static_cast<float>(pixelY) + 0.5f;
+      const Simd::FloatN rowEdge0 = Simd::SplatN(
+          triangle.edgeB[0] * centerY + triangle.edgeC[0]);
+      const Simd::FloatN rowEdge1 = Simd::SplatN(
+          triangle.edgeB[1] * centerY + triangle.edgeC[1]);
+      const Simd::FloatN rowEdge2 = Simd::SplatN(
+          triangle.edgeB[2] * centerY + triangle.edgeC[2]);
+      const Simd::FloatN rowDepth =
+          Simd::SplatN(triangle.depthB * centerY + triangle.depthC);
+      float *row = m_depth.data() + static_cast<size_t>(pixelY) * m_width;
+
+      for (int32_t pixelX = beginX; pixelX <= endX;
+           pixelX += static_cast<int32_t>(Simd::WIDTH)) {
+        const Simd::FloatN centerX =
+            Simd::Add(Simd::SplatN(static_cast<float>(pixelX)), lanes);
+        const Simd::MaskN outside = Simd::Or(
+            Simd::Or(Simd::Less(Simd::MulAdd(edgeA0, centerX, rowEdge0), zero),
+                     Simd::Less(Simd::MulAdd(edgeA1, centerX, rowEdge1), zero)),
+            Simd::Less(Simd::MulAdd(edgeA2, centerX, rowEdge2), zero));
+        const Simd::FloatN depth =
+            Simd::Min(Simd::MulAdd(depthA, centerX, rowDepth), maxDepth);
+        const Simd::FloatN current = Simd::LoadN(row + pixelX);
+        Simd::StoreN(row + pixelX,
+                     Simd::Select(outside, current, Simd::Min(current, depth)));
+      }
+    }
+  }
+
+  // Farthest depth of each block in the tile
+  const uint32_t blocksX = m_width / BLOCK_SIZE;
+  for (int32_t blockY = tileY;
+       blockY < tileY + static_cast<int32_t>(TILE_HEIGHT);
+       blockY += BLOCK_SIZE) {
+    for (int32_t blockX = tileX;
+         blockX < tileX + static_cast<int32_t>(TILE_WIDTH);
+         blockX += BLOCK_SIZE) {
+      Simd::FloatN farthest = Simd::SplatN(-FAR_DEPTH);
+      for (int32_t y = blockY; y < blockY + static_cast<int32_t>(BLOCK_SIZE);
+           y++) {
+        const float *row =
+            m_depth.data() + static_cast<size_t>(y) * m_width + blockX;
+        for (uint32_t x = 0; x < BLOCK_SIZE; x += Simd::WIDTH) {
+          farthest = Simd::Max(farthest, Simd::LoadN(row + x));
+        }
+      }
+      alignas(32) float lanesOut[Simd::WIDTH];
+      Simd::StoreN(lanesOut, farthest);
+      m_blockMaxDepth[(blockY / BLOCK_SIZE) * blocksX + blockX / BLOCK_SIZE] =
+          *std::max_element(lanesOut, lanesOut + Simd::WIDTH);
+    }
+  }
+}
+
+bool OcclusionCuller::IsVisible(const AABB &bounds) const {
+  if (m_empty) {
+    return true;
+  }
+
+  float minX = FAR_DEPTH, minY = FAR_DEPTH, minZ = FAR_DEPTH;
+  float maxX = -FAR_DEPTH, maxY = -FAR_DEPTH;
+  for (int corner = 0; corner < 8; corner++) {
+    const Vector3 point((corner & 1) ? bounds.maximum.x : bounds.minimum.x,
+                        (corner & 2) ? bounds.maximum.y : bounds.minimum.y,
+                        (corner & 4) ? bounds.maximum.z : bounds.minimum.z);
+    const Vector4 clip = m_viewProjection * Vector4(point, 1.0f);
+    // Reaches in front of the near plane: the camera may be inside it
+    if (clip.w <= 0.0f || clip.z < -clip.w) {
+      return true;
+    }
+    const float inverseW = 1.0f / clip.w;
+    minX = std::min(minX, clip.x * inverseW);
+    maxX = std::max(maxX, clip.x * inverseW);
+    minY = std::min(minY, clip.y * inverseW);
+    maxY = std::max(maxY, clip.y * inverseW);
+    minZ = std::min(minZ, clip.z * inverseW);
+  }
+
+  // Pixels the screen rectangle touches
+  const float width = static_cast<float>(m_width);
+  const float height = static_cast<float>(m_height);
+  const float left = (minX * 0.5f + 0.5f) * width;
+  const float right = (maxX * 0.5f + 0.5f) * width;
+  const float bottom = (minY * 0.5f + 0.5f) * height;
+  const float top = (maxY * 0.5f + 0.5f) * height;
+  if (right < 0.0f || left >= width || top < 0.0f || bottom >= height) {
+    return true; // off screen, for the frustum test to decide
+  }
+  // Occluder coverage is sampled at pixel centers, so an occluder edge can
+  // overhang by part of a pixel; one more pixel on each side covers that
+  const int32_t beginX =
+      std::max(static_cast<int32_t>(std::floor(left)) - 1, 0);
+  const int32_t endX = std::min(static_cast<int32_t>(std::floor(right)) + 1,
+                                static_cast<int32_t>(m_width) - 1);
+  const int32_t beginY =
+      std::max(static_cast<int32_t>(std::floor(bottom)) - 1, 0);
+  const int32_t endY = std::min(static_cast<int32_t>(std::floor(top)) + 1,
+                                static_cast<int32_t>(m_height) - 1);
+
+  // Hidden only when every pixel is at least as near as the box's nearest
+  // point; blocks that are entirely nearer are skipped whole
+  const uint32_t blocksX = m_width / BLOCK_SIZE;
+  const int32_t block = static_cast<int32_t>(BLOCK_SIZE);
+  for (int32_t blockY = beginY / block; blockY <= endY / block; blockY++) {
+    for (int32_t blockX = beginX / block; blockX <= endX / block; blockX++) {
+      if (m_blockMaxDepth[blockY * blocksX + blockX] <= minZ) {
+        continue;
+      }
+      const int32_t rowBegin = std::max(beginY, blockY * block);
+      const int32_t rowEnd = std::min(endY, blockY * block + block - 1);
+      const int32_t columnBegin = std::max(beginX, blockX * block);
+      const int32_t columnEnd = std::min(endX, blockX * block + block - 1);
+      for (int32_t y = rowBegin; y <= rowEnd; y++) {
+        const float *row = m_depth.data() + static_cast<size_t>(y) * m_width;
+        for (int32_t x = columnBegin; x <= columnEnd; x++) {
+          if (row[x] > minZ) {
+            return true;
+          }
+        }
+      }
+    }
+  }
+  return false;
+}
+
+size_t OcclusionCuller::CullAABBs(const AABB *boxes, size_t count,
+                                  uint32_t *visibleMask) const {
+  const size_t words = (count + 31) / 32;
+  JobSystem::Instance().ParallelFor(
+      words, WORDS_PER_CHUNK, [&](size_t begin, size_t end) {
+        for (size_t word = begin; word < end; word++) {
+          uint32_t bits = 0;
+          const size_t first = word * 32;
+          const size_t last = std::min(first + 32, count);
+          for (size_t i = first; i < last; i++) {
+            if (IsVisible(boxes[i])) {
+              bits |= 1u << (i - first);
+            }
+          }
+          visibleMask[word] = bits;
+        }
+      });
+
+  size_t visible = 0;
+  for (size_t word = 0; word < words; word++) {
+    visible += std::bitset<32>(visibleMask[word]).count();
+  }
+  return visible;
+}
+
+} // namespace AquaVisual
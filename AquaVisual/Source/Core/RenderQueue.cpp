@@ -0,0 +1,100 @@
+#include "AquaVisual/Core/RenderQueue.h"
+#include <algorithm>
+
+namespace AquaVisual {
+
+namespace {
+
+constexpr uint64_t FieldMask(uint32_t bits) { return (1ull << bits) - 1; }
+
+} // namespace
+
+uint64_t RenderQueue::MakeSortKey(RenderPass pass, uint32_t pipeline,
+                                  uint32_t material, uint32_t mesh,
+                                  float depth) {
+  const float clamped = std::min(std::max(depth, 0.0f), 1.0f);
+  const uint64_t depthBits =
+      static_cast<uint64_t>(clamped * static_cast<float>(FieldMask(DEPTH_BITS)));
+
+  const uint64_t passBits = static_cast<uint64_t>(pass) & FieldMask(PASS_BITS);
+  const uint64_t state =
+      ((pipeline & FieldMask(PIPELINE_BITS))
+       << (MATERIAL_BITS + MESH_BITS)) |
+      ((material & FieldMask(MATERIAL_BITS)) << MESH_BITS) |
+      (mesh & FieldMask(MESH_BITS));
+
+  if (pass == RenderPass::Transparent) {
+    // Farthest first for correct blending
+    const uint64_t farFirst = FieldMask(DEPTH_BITS) - depthBits;
+    return (passBits << (64 - PASS_BITS)) |
+           (farFirst << (PIPELINE_BITS + MATERIAL_BITS + MESH_BITS)) | state;
+  }
+
+  return (passBits << (64 - PASS_BITS)) | (state << DEPTH_BITS) | depthBits;
+}
+
+void RenderQueue::Reserve(size_t count) {
+  m_items.reserve(count);
+  m_order.reserve(count);
+  m_scratch.reserve(count);
+}
+
+void RenderQueue::Submit(const DrawItem &item) {
+  m_order.push_back({item.sortKey, static_cast<uint32_t>(m_items.size())});
+  m_items.push_back(item);
+  ++m_stats.submitted;
+}
+
+void RenderQueue::Sort() {
+  const size_t count = m_order.size();
+  if (count < 2) {
+    return;
+  }
+
+  // LSD radix sort, 8 bits per pass. All histograms are built in one sweep
+  // and passes where every key shares the same digit are skipped, which is
+  // the common case for the pass and pipeline bytes.
+  uint32_t histograms[8][256] = {};
+  for (const SortEntry &entry : m_order) {
+    for (uint32_t byte = 0; byte < 8; ++byte) {
+      ++histograms[byte][(entry.key >> (byte * 8)) & 0xFF];
+    }
+  }
+
+  m_scratch.resize(count);
+  SortEntry *src = m_order.data();
+  SortEntry *dst = m_scratch.data();
+
+  for (uint32_t byte = 0; byte < 8; ++byte) {
+    uint32_t *histogram = histograms[byte];
+    const uint32_t firstDigit = (src[0].key >> (byte * 8)) & 0xFF;
+    if (histogram[firstDigit] == count) {
+      continue;
+    }
+
+    uint32_t offset = 0;
+    for (uint32_t digit = 0; digit < 256; ++digit) {
+      const uint32_t bucketSize = histogram[digit];
+      histogram[digit] = offset;
+      offset += bucketSize;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+      const uint32_t digit = (src[i].key >> (byte * 8)) & 0xFF;
+      dst[histogram[digit]++] = src[i];
+    }
+    std::swap(src, dst);
+  }
+
+  if (src != m_order.data()) {
+    m_order.swap(m_scratch);
+  }
+}
+
+void RenderQueue::Clear() {
+  m_items.clear();
+  m_order.clear();
+  m_stats = RenderQueueStats();
+}
+
+} // namespace AquaVisual
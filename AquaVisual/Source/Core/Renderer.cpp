@@ -1,5 +1,6 @@
 #include "AquaVisual/Core/Renderer.h"
 #include "AquaVisual/Core/VulkanRenderer.h"
+#include "AquaVisual/Math/Matrix.h"
 #include <memory>
 
 namespace AquaVisual {
@@ -19,4 +20,12 @@ std::unique_ptr<Renderer> Renderer::Create(const RendererConfig& config) {
     return std::move(renderer);
 }
 
+void Renderer::RenderMeshInstanced(const Mesh& mesh,
+                                   const InstanceData* instances,
+                                   uint32_t count, const Texture* texture) {
+    for (uint32_t i = 0; i < count; ++i) {
+        RenderMesh(mesh, Matrix4(instances[i].modelMatrix), texture);
+    }
+}
+
 }
\ No newline at end of file
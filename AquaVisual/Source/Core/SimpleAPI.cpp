@@ -1,39 +1,101 @@
 #include "AquaVisual/SimpleAPI.h"
 #include "AquaVisual/AquaVisual.h"
-#include "AquaVisual/Core/VulkanRendererImpl.h"
+#include "AquaVisual/Core/Camera.h"
+#include "AquaVisual/Core/FrustumCuller.h"
+#include "AquaVisual/Core/JobSystem.h"
+#include "AquaVisual/Core/Renderer.h"
+#include "AquaVisual/Primitives.h"
 #include "AquaVisual/Resources/Mesh.h"
-#include "AquaVisual/Resources/Primitives.h"
-#include <iostream>
+#include <algorithm>
+#include <array>
 #include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <limits>
 
 namespace AquaVisual {
 namespace Simple {
 
+namespace {
+
+constexpr size_t kObjectTypeCount = 4;
+
+std::shared_ptr<Mesh> CreatePrimitiveMesh(ObjectType type) {
+    switch (type) {
+        case ObjectType::Cube:
+            return Primitives::CreateCube(1.0f);
+        case ObjectType::Sphere:
+            return Primitives::CreateSphere(1.0f, 16);
+        case ObjectType::Plane:
+            return Primitives::CreatePlane(1.0f, 1.0f);
+        case ObjectType::Triangle:
+            return Primitives::CreateTriangle();
+    }
+    return nullptr;
+}
+
+// 每种网格的局部包围盒，首次使用时由网格顶点计算
+const AABB& GetLocalBounds(ObjectType type) {
+    static const std::array<AABB, kObjectTypeCount> bounds = [] {
+        std::array<AABB, kObjectTypeCount> result;
+        for (size_t index = 0; index < kObjectTypeCount; ++index) {
+            auto mesh = CreatePrimitiveMesh(static_cast<ObjectType>(index));
+            if (mesh) {
+                for (const Vertex& vertex : mesh->GetVertices()) {
+                    result[index].Expand(vertex.position);
+                }
+            }
+        }
+        return result;
+    }();
+    static const AABB empty;
+    size_t index = static_cast<size_t>(type);
+    return index < kObjectTypeCount ? bounds[index] : empty;
+}
+
+void AppendObjects(const std::vector<void*>& proxies, std::vector<SimpleObject*>& results) {
+    for (void* userData : proxies) {
+        results.push_back(static_cast<SimpleObject*>(userData));
+    }
+}
+
+} // namespace
+
 // ============================================================================
 // SimpleObject Implementation
 // ============================================================================
 
 SimpleObject::SimpleObject(ObjectType type, const Transform& transform, const Material& material)
     : m_type(type), m_transform(transform), m_material(material), 
-      m_animationEnabled(false), m_rotationSpeed(0, 0, 0) {
+      m_animationEnabled(false), m_rotationSpeed(0, 0, 0), m_occluder(false),
+      m_transformVersion(0) {
 }
 
 SimpleObject::~SimpleObject() = default;
 
 void SimpleObject::SetPosition(const Vector3& position) {
-    m_transform.position = position;
+    m_transform.SetPosition(position);
+    m_transformVersion++;
 }
 
 void SimpleObject::SetRotation(const Vector3& rotation) {
-    m_transform.rotation = rotation;
+    m_transform.SetEulerAngles(rotation * (Math::PI / 180.0f));
+    m_transformVersion++;
 }
 
 void SimpleObject::SetScale(const Vector3& scale) {
-    m_transform.scale = scale;
+    m_transform.SetScale(scale);
+    m_transformVersion++;
 }
 
 void SimpleObject::SetTransform(const Transform& transform) {
     m_transform = transform;
+    m_transformVersion++;
+}
+
+AABB SimpleObject::GetWorldBounds() const {
+    return GetLocalBounds(m_type).Transformed(m_transform.GetMatrix());
 }
 
 void SimpleObject::SetMaterial(const Material& material) {
@@ -82,7 +144,36 @@ void SimpleLight::SetSpotAngle(float angle) {
 SimpleScene::SimpleScene()
     : m_ambientColor(0.1f, 0.1f, 0.1f), m_ambientIntensity(0.1f),
       m_backgroundColor(0.1f, 0.2f, 0.3f),
-      m_cameraPosition(0, 2, 5), m_cameraTarget(0, 0, 0), m_cameraFOV(45.0f) {
+      m_cameraPosition(0, 2, 5), m_cameraTarget(0, 0, 0), m_cameraFOV(45.0f),
+      m_spatialIndex(std::make_unique<DynamicBVH>()) {
+}
+
+SimpleScene::SimpleScene(const SimpleScene& other)
+    : m_objects(other.m_objects), m_proxies(other.m_proxies), m_lights(other.m_lights),
+      m_ambientColor(other.m_ambientColor), m_ambientIntensity(other.m_ambientIntensity),
+      m_backgroundColor(other.m_backgroundColor),
+      m_cameraPosition(other.m_cameraPosition), m_cameraTarget(other.m_cameraTarget),
+      m_cameraFOV(other.m_cameraFOV) {
+    // 副本与原场景共享对象，但有各自的索引；克隆出的索引保持相同的代理编号，
+    // 之后两个场景分别按对象的变换版本同步
+    m_spatialIndex = other.m_spatialIndex->Clone();
+}
+
+SimpleScene& SimpleScene::operator=(const SimpleScene& other) {
+    if (this != &other) {
+        SimpleScene copy(other);
+        m_objects = std::move(copy.m_objects);
+        m_proxies = std::move(copy.m_proxies);
+        m_lights = std::move(copy.m_lights);
+        m_ambientColor = copy.m_ambientColor;
+        m_ambientIntensity = copy.m_ambientIntensity;
+        m_backgroundColor = copy.m_backgroundColor;
+        m_cameraPosition = copy.m_cameraPosition;
+        m_cameraTarget = copy.m_cameraTarget;
+        m_cameraFOV = copy.m_cameraFOV;
+        m_spatialIndex = std::move(copy.m_spatialIndex);
+    }
+    return *this;
 }
 
 SimpleScene::~SimpleScene() = default;
@@ -91,6 +182,8 @@ std::shared_ptr<SimpleObject> SimpleScene::AddObject(ObjectType type,
                                                      const Transform& transform,
                                                      const Material& material) {
     auto object = std::make_shared<SimpleObject>(type, transform, material);
+    const int32_t proxy = m_spatialIndex->Insert(object->GetWorldBounds(), object.get());
+    m_proxies.push_back({proxy, object->m_transformVersion});
     m_objects.push_back(object);
     return object;
 }
@@ -98,12 +191,17 @@ std::shared_ptr<SimpleObject> SimpleScene::AddObject(ObjectType type,
 void SimpleScene::RemoveObject(std::shared_ptr<SimpleObject> object) {
     auto it = std::find(m_objects.begin(), m_objects.end(), object);
     if (it != m_objects.end()) {
+        const size_t index = static_cast<size_t>(it - m_objects.begin());
+        m_spatialIndex->Remove(m_proxies[index].proxy);
+        m_proxies.erase(m_proxies.begin() + index);
         m_objects.erase(it);
     }
 }
 
 void SimpleScene::ClearObjects() {
     m_objects.clear();
+    m_proxies.clear();
+    m_spatialIndex->Clear();
 }
 
 std::shared_ptr<SimpleLight> SimpleScene::AddLight(LightType type, 
@@ -150,29 +248,138 @@ void SimpleScene::Update(float deltaTime) {
     // 更新动画对象
     for (auto& object : m_objects) {
         if (object->m_animationEnabled) {
-            object->m_transform.rotation.x += object->m_rotationSpeed.x * deltaTime;
-            object->m_transform.rotation.y += object->m_rotationSpeed.y * deltaTime;
-            object->m_transform.rotation.z += object->m_rotationSpeed.z * deltaTime;
+            // 每帧的角度增量 (度/秒) 在局部空间叠加
+            const Vector3 step = object->m_rotationSpeed * (deltaTime * Math::PI / 180.0f);
+            object->m_transform.Rotate(Quaternion::FromEuler(step));
+            object->m_transformVersion++;
         }
     }
+    RefreshSpatialIndex();
+}
+
+void SimpleScene::RefreshSpatialIndex() const {
+    // 只比较版本，包围盒仍在宽松包围盒内的对象不会改动树
+    for (size_t index = 0; index < m_objects.size(); ++index) {
+        const SimpleObject& object = *m_objects[index];
+        ObjectProxy& entry = m_proxies[index];
+        if (entry.version != object.m_transformVersion) {
+            m_spatialIndex->Update(entry.proxy, object.GetWorldBounds());
+            entry.version = object.m_transformVersion;
+        }
+    }
+}
+
+void SimpleScene::QueryFrustum(const Frustum& frustum, std::vector<SimpleObject*>& results) const {
+    RefreshSpatialIndex();
+    std::vector<void*> proxies;
+    m_spatialIndex->QueryFrustum(frustum, proxies);
+    AppendObjects(proxies, results);
+}
+
+void SimpleScene::QueryBox(const AABB& box, std::vector<SimpleObject*>& results) const {
+    RefreshSpatialIndex();
+    std::vector<void*> proxies;
+    m_spatialIndex->QueryAABB(box, proxies);
+    AppendObjects(proxies, results);
+}
+
+void SimpleScene::QuerySphere(const BoundingSphere& sphere, std::vector<SimpleObject*>& results) const {
+    RefreshSpatialIndex();
+    std::vector<void*> proxies;
+    m_spatialIndex->QuerySphere(sphere, proxies);
+    AppendObjects(proxies, results);
+}
+
+std::shared_ptr<SimpleObject> SimpleScene::Pick(const Ray& ray, float* distance) const {
+    RefreshSpatialIndex();
+    // 宽松包围盒命中后再用对象的实际世界包围盒确认
+    auto test = [&ray](void* userData, float maxDistance, float& hit) {
+        const auto* object = static_cast<const SimpleObject*>(userData);
+        return ray.Intersects(object->GetWorldBounds(), &hit) && hit <= maxDistance;
+    };
+    void* userData = m_spatialIndex->Raycast(ray, std::numeric_limits<float>::max(), test, distance);
+    if (!userData) {
+        return nullptr;
+    }
+    return static_cast<SimpleObject*>(userData)->shared_from_this();
+}
+
+void SimpleScene::SetSpatialIndex(std::unique_ptr<SpatialIndex> index) {
+    if (!index) {
+        std::cerr << "SimpleScene::SetSpatialIndex: index is null" << std::endl;
+        return;
+    }
+    index->Clear();
+    for (size_t i = 0; i < m_objects.size(); ++i) {
+        const SimpleObject& object = *m_objects[i];
+        m_proxies[i].proxy = index->Insert(object.GetWorldBounds(), m_objects[i].get());
+        m_proxies[i].version = object.m_transformVersion;
+    }
+    m_spatialIndex = std::move(index);
+}
+
+const SpatialIndex& SimpleScene::GetSpatialIndex() const {
+    RefreshSpatialIndex();
+    return *m_spatialIndex;
 }
 
 // ============================================================================
 // SimpleRenderer Implementation
 // ============================================================================
 
+namespace {
+
+// 每个并行任务至少计算的包围盒数量
+constexpr size_t kBoundsChunk = 1024;
+
+// 由变换和材质生成实例数据；模型矩阵取自变换的缓存，静止物体不重新计算
+void BuildInstance(const SimpleObject& object, InstanceData& instance) {
+    std::memcpy(instance.modelMatrix, object.GetTransform().GetMatrix().Data(),
+                sizeof(instance.modelMatrix));
+
+    const Material& material = object.GetMaterial();
+    instance.color[0] = material.albedo.x;
+    instance.color[1] = material.albedo.y;
+    instance.color[2] = material.albedo.z;
+    instance.color[3] = 1.0f;
+    instance.material[0] = material.metallic;
+    instance.material[1] = material.roughness;
+    instance.material[2] = material.specular;
+    instance.material[3] = 0.0f;
+}
+
+} // namespace
+
 class SimpleRenderer::Impl {
 public:
-    VulkanRendererImpl* renderer;
-    std::vector<std::shared_ptr<Mesh>> meshCache;
+    std::unique_ptr<Renderer> renderer;
+    std::array<std::shared_ptr<Mesh>, kObjectTypeCount> meshCache;
+    // 每种网格一组实例，帧间复用以避免重新分配
+    std::array<std::vector<InstanceData>, kObjectTypeCount> instanceBatches;
+    // 帧间复用的候选对象和可见对象列表
+    std::vector<SimpleObject*> candidateObjects;
+    std::vector<SimpleObject*> visibleObjects;
+    FrustumCuller culler;
+    
+    Camera camera;
+    float aspectRatio;
+    bool cullingEnabled;
+    bool occlusionCullingEnabled;
+    OcclusionCuller occlusionCuller;
+    // 遮挡测试用的包围盒和结果位，帧间复用
+    std::vector<AABB> occlusionBounds;
+    std::vector<uint32_t> occlusionMask;
+    Stats stats;
     bool initialized;
     
-    Impl() : renderer(nullptr), initialized(false) {}
+    Impl()
+        : aspectRatio(4.0f / 3.0f), cullingEnabled(true),
+          occlusionCullingEnabled(false), initialized(false) {}
     
     ~Impl() {
         if (renderer) {
             renderer->Shutdown();
-            delete renderer;
+            renderer.reset();
         }
         AquaVisual::Shutdown();
     }
@@ -181,34 +388,11 @@ public:
         // 简单的网格缓存系统
         size_t index = static_cast<size_t>(type);
         if (index >= meshCache.size()) {
-            meshCache.resize(index + 1);
+            return nullptr;
         }
         
         if (!meshCache[index]) {
-            meshCache[index] = std::make_shared<Mesh>();
-            
-            switch (type) {
-                case ObjectType::Cube: {
-                    auto vertices = Primitives::CreateCube(1.0f);
-                    meshCache[index]->SetVertices(vertices);
-                    break;
-                }
-                case ObjectType::Sphere: {
-                    auto vertices = Primitives::CreateSphere(1.0f, 16, 16);
-                    meshCache[index]->SetVertices(vertices);
-                    break;
-                }
-                case ObjectType::Plane: {
-                    auto vertices = Primitives::CreatePlane(1.0f, 1.0f);
-                    meshCache[index]->SetVertices(vertices);
-                    break;
-                }
-                case ObjectType::Triangle: {
-                    auto vertices = Primitives::CreateTriangle();
-                    meshCache[index]->SetVertices(vertices);
-                    break;
-                }
-            }
+            meshCache[index] = CreatePrimitiveMesh(type);
         }
         
         return meshCache[index];
@@ -242,12 +426,14 @@ bool SimpleRenderer::Initialize(const Config& config) {
     rendererConfig.enableVSync = config.vsync;
     
     // Create Vulkan renderer
-    m_impl->renderer = new VulkanRendererImpl(rendererConfig);
-    if (!m_impl->renderer->Initialize()) {
+    m_impl->renderer = Renderer::Create(rendererConfig);
+    if (!m_impl->renderer) {
         std::cerr << "Failed to initialize Vulkan renderer!" << std::endl;
         return false;
     }
     
+    m_impl->aspectRatio = static_cast<float>(config.width) /
+                          static_cast<float>(std::max(config.height, 1));
     m_impl->initialized = true;
     m_initialized = true;
     
@@ -258,8 +444,7 @@ bool SimpleRenderer::Initialize(const Config& config) {
 void SimpleRenderer::Shutdown() {
     if (m_impl->renderer) {
         m_impl->renderer->Shutdown();
-        delete m_impl->renderer;
-        m_impl->renderer = nullptr;
+        m_impl->renderer.reset();
     }
     m_impl->initialized = false;
     m_initialized = false;
@@ -282,13 +467,124 @@ void SimpleRenderer::RenderScene(const SimpleScene& scene) {
     const auto& bg = scene.m_backgroundColor;
     m_impl->renderer->Clear(bg.x, bg.y, bg.z, 1.0f);
     
-    // 渲染所有对象
-    for (const auto& object : scene.GetObjects()) {
-        auto mesh = m_impl->GetOrCreateMesh(object->GetType());
+    // 同步相机；只在参数变化时修改，相机版本不变时渲染器和剔除可以跳过更新
+    Camera& camera = m_impl->camera;
+    auto differs = [](const Vector3& a, const Vector3& b) {
+        return a.x != b.x || a.y != b.y || a.z != b.z;
+    };
+    if (differs(camera.GetPosition(), scene.m_cameraPosition)) {
+        camera.SetPosition(scene.m_cameraPosition);
+    }
+    if (differs(camera.GetTarget(), scene.m_cameraTarget)) {
+        camera.SetTarget(scene.m_cameraTarget);
+    }
+    if (camera.GetFOV() != scene.m_cameraFOV) {
+        camera.SetFOV(scene.m_cameraFOV);
+    }
+    if (camera.GetAspectRatio() != m_impl->aspectRatio) {
+        camera.SetAspectRatio(m_impl->aspectRatio);
+    }
+    m_impl->renderer->SetCamera(camera);
+    
+    const auto& objects = scene.GetObjects();
+    Stats& stats = m_impl->stats;
+    stats.totalObjects = static_cast<uint32_t>(objects.size());
+    
+    // 视锥剔除：空间索引按宽松包围盒选出候选对象，再由 FrustumCuller
+    // 在工作线程上并行计算并测试它们的实际世界包围盒
+    auto& visibleObjects = m_impl->visibleObjects;
+    visibleObjects.clear();
+    if (m_impl->cullingEnabled) {
+        const Frustum& frustum = camera.GetFrustum();
+        auto& candidates = m_impl->candidateObjects;
+        candidates.clear();
+        scene.QueryFrustum(frustum, candidates);
+        
+        FrustumCuller& culler = m_impl->culler;
+        culler.Resize(candidates.size());
+        AABB* bounds = culler.GetBoundsData();
+        JobSystem::Instance().ParallelFor(
+            candidates.size(), kBoundsChunk, [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    bounds[i] = candidates[i]->GetWorldBounds();
+                }
+            });
+        culler.Cull(frustum);
+        for (uint32_t index : culler.GetVisible()) {
+            visibleObjects.push_back(candidates[index]);
+        }
+    } else {
+        for (const auto& object : objects) {
+            visibleObjects.push_back(object.get());
+        }
+    }
+    stats.culledObjects = stats.totalObjects - static_cast<uint32_t>(visibleObjects.size());
+    stats.occludedObjects = 0;
+    
+    // 遮挡剔除：先画可见的遮挡体，再测试其余对象；遮挡体本身总是提交
+    if (m_impl->occlusionCullingEnabled) {
+        OcclusionCuller& occlusion = m_impl->occlusionCuller;
+        occlusion.BeginFrame(camera.GetViewProjectionMatrix());
+        for (const SimpleObject* object : visibleObjects) {
+            if (!object->IsOccluder()) {
+                continue;
+            }
+            auto mesh = m_impl->GetOrCreateMesh(object->GetType());
+            if (!mesh || mesh->GetVertices().empty()) {
+                continue;
+            }
+            const auto& vertices = mesh->GetVertices();
+            const auto& indices = mesh->GetIndices();
+            occlusion.AddOccluder(&vertices[0].position, vertices.size(),
+                                  indices.data(), indices.size(),
+                                  object->GetTransform().GetMatrix(), sizeof(Vertex));
+        }
+        if (occlusion.GetOccluderTriangleCount() > 0) {
+            occlusion.Rasterize();
+            auto& bounds = m_impl->occlusionBounds;
+            auto& mask = m_impl->occlusionMask;
+            bounds.resize(visibleObjects.size());
+            mask.resize((visibleObjects.size() + 31) / 32);
+            for (size_t i = 0; i < visibleObjects.size(); ++i) {
+                bounds[i] = visibleObjects[i]->GetWorldBounds();
+            }
+            occlusion.CullAABBs(bounds.data(), bounds.size(), mask.data());
+            
+            // 保持原有顺序压缩
+            size_t kept = 0;
+            for (size_t i = 0; i < visibleObjects.size(); ++i) {
+                if (visibleObjects[i]->IsOccluder() || (mask[i / 32] >> (i % 32)) & 1u) {
+                    visibleObjects[kept++] = visibleObjects[i];
+                }
+            }
+            stats.occludedObjects = static_cast<uint32_t>(visibleObjects.size() - kept);
+            visibleObjects.resize(kept);
+        }
+    }
+    stats.visibleObjects = static_cast<uint32_t>(visibleObjects.size());
+    
+    // 按网格分组，每种网格一次实例化绘制
+    for (auto& batch : m_impl->instanceBatches) {
+        batch.clear();
+    }
+    for (const SimpleObject* object : visibleObjects) {
+        size_t index = static_cast<size_t>(object->GetType());
+        if (index < m_impl->instanceBatches.size()) {
+            auto& batch = m_impl->instanceBatches[index];
+            batch.emplace_back();
+            BuildInstance(*object, batch.back());
+        }
+    }
+    
+    for (size_t index = 0; index < m_impl->instanceBatches.size(); ++index) {
+        const auto& batch = m_impl->instanceBatches[index];
+        if (batch.empty()) {
+            continue;
+        }
+        auto mesh = m_impl->GetOrCreateMesh(static_cast<ObjectType>(index));
         if (mesh) {
-            // 这里应该设置变换矩阵和材质
-            // 目前使用基础渲染
-            m_impl->renderer->RenderMesh(*mesh);
+            m_impl->renderer->RenderMeshInstanced(
+                *mesh, batch.data(), static_cast<uint32_t>(batch.size()));
         }
     }
 }
@@ -299,6 +595,26 @@ void SimpleRenderer::EndFrame() {
     }
 }
 
+void SimpleRenderer::SetCullingEnabled(bool enabled) {
+    m_impl->cullingEnabled = enabled;
+}
+
+bool SimpleRenderer::IsCullingEnabled() const {
+    return m_impl->cullingEnabled;
+}
+
+void SimpleRenderer::SetOcclusionCullingEnabled(bool enabled) {
+    m_impl->occlusionCullingEnabled = enabled;
+}
+
+bool SimpleRenderer::IsOcclusionCullingEnabled() const {
+    return m_impl->occlusionCullingEnabled;
+}
+
+const SimpleRenderer::Stats& SimpleRenderer::GetStats() const {
+    return m_impl->stats;
+}
+
 bool SimpleRenderer::ShouldClose() const {
     if (!m_initialized || !m_impl->renderer) {
         return true;
@@ -312,7 +628,7 @@ void SimpleRenderer::PollEvents() {
     }
 }
 
-bool SimpleRenderer::RenderSceneLoop(const SimpleScene& scene, int maxFrames) {
+bool SimpleRenderer::RenderSceneLoop(SimpleScene& scene, int maxFrames) {
     if (!m_initialized) {
         std::cerr << "Renderer not initialized!" << std::endl;
         return false;
@@ -324,9 +640,6 @@ bool SimpleRenderer::RenderSceneLoop(const SimpleScene& scene, int maxFrames) {
     auto startTime = std::chrono::high_resolution_clock::now();
     auto lastFrameTime = startTime;
     
-    // 创建场景的可变副本用于更新
-    SimpleScene mutableScene = scene;
-    
     while (!ShouldClose() && (maxFrames == 0 || frameCount < maxFrames)) {
         auto currentTime = std::chrono::high_resolution_clock::now();
         float deltaTime = std::chrono::duration<float>(currentTime - lastFrameTime).count();
@@ -336,11 +649,11 @@ bool SimpleRenderer::RenderSceneLoop(const SimpleScene& scene, int maxFrames) {
         PollEvents();
         
         // 更新场景
-        mutableScene.Update(deltaTime);
+        scene.Update(deltaTime);
         
         // 渲染
         if (BeginFrame()) {
-            RenderScene(mutableScene);
+            RenderScene(scene);
             EndFrame();
         }
         
@@ -443,7 +756,7 @@ std::unique_ptr<SimpleScene> CreateDemoScene() {
     return scene;
 }
 
-bool ShowScene(const SimpleScene& scene, 
+bool ShowScene(SimpleScene& scene, 
                const SimpleRenderer::Config& config,
                float duration) {
     SimpleRenderer renderer;
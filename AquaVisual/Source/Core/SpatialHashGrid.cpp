@@ -0,0 +1,384 @@
+#include "AquaVisual/Core/SpatialHashGrid.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace AquaVisual {
+
+namespace {
+
+// Cell coordinates are packed 21 bits per axis, about a million cells each
+// way from the origin
+constexpr uint64_t AXIS_MASK = (1ull << 21) - 1;
+
+uint64_t PackKey(int32_t x, int32_t y, int32_t z) {
+  return ((static_cast<uint64_t>(x) & AXIS_MASK) << 42) |
+         ((static_cast<uint64_t>(y) & AXIS_MASK) << 21) |
+         (static_cast<uint64_t>(z) & AXIS_MASK);
+}
+
+// Parameter range of the ray inside box
+bool ClipRay(const Ray &ray, const AABB &box, float &nearT, float &farT) {
+  const float *origin = &ray.origin.x;
+  const float *direction = &ray.direction.x;
+  const float *minimum = &box.minimum.x;
+  const float *maximum = &box.maximum.x;
+  for (int axis = 0; axis < 3; axis++) {
+    const float inverse = 1.0f / direction[axis];
+    float t0 = (minimum[axis] - origin[axis]) * inverse;
+    float t1 = (maximum[axis] - origin[axis]) * inverse;
+    if (t0 > t1) {
+      std::swap(t0, t1);
+    }
+    nearT = t0 > nearT ? t0 : nearT;
+    farT = t1 < farT ? t1 : farT;
+    if (nearT > farT) {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+SpatialHashGrid::SpatialHashGrid(float cellSize)
+    : m_cellSize(cellSize), m_inverseCellSize(1.0f / cellSize) {}
+
+std::unique_ptr<SpatialIndex> SpatialHashGrid::Clone() const {
+  return std::make_unique<SpatialHashGrid>(*this);
+}
+
+uint64_t SpatialHashGrid::CellFor(const AABB &bounds, int32_t cell[3]) const {
+  const Vector3 extents = bounds.GetExtents();
+  if (std::max(extents.x, std::max(extents.y, extents.z)) >
+      0.5f * m_cellSize) {
+    return OVERSIZED;
+  }
+  const Vector3 center = bounds.GetCenter();
+  cell[0] = static_cast<int32_t>(std::floor(center.x * m_inverseCellSize));
+  cell[1] = static_cast<int32_t>(std::floor(center.y * m_inverseCellSize));
+  cell[2] = static_cast<int32_t>(std::floor(center.z * m_inverseCellSize));
+  return PackKey(cell[0], cell[1], cell[2]);
+}
+
+AABB SpatialHashGrid::GetLooseBounds(const Cell &cell) const {
+  const Vector3 origin(cell.x * m_cellSize, cell.y * m_cellSize,
+                       cell.z * m_cellSize);
+  const Vector3 margin(0.5f * m_cellSize);
+  return AABB(origin - margin, origin + Vector3(m_cellSize) + margin);
+}
+
+void SpatialHashGrid::Link(int32_t proxy) {
+  Proxy &entry = m_proxies[proxy];
+  int32_t coordinates[3];
+  entry.cell = CellFor(entry.bounds, coordinates);
+  std::vector<int32_t> *list = &m_oversized;
+  if (entry.cell != OVERSIZED) {
+    Cell &cell = m_cells[entry.cell];
+    if (cell.proxies.empty()) {
+      cell.x = coordinates[0];
+      cell.y = coordinates[1];
+      cell.z = coordinates[2];
+      const bool first = m_cellMin[0] > m_cellMax[0];
+      for (int axis = 0; axis < 3; axis++) {
+        m_cellMin[axis] = first ? coordinates[axis]
+                                : std::min(m_cellMin[axis], coordinates[axis]);
+        m_cellMax[axis] = first ? coordinates[axis]
+                                : std::max(m_cellMax[axis], coordinates[axis]);
+      }
+    }
+    list = &cell.proxies;
+  }
+  entry.slot = static_cast<uint32_t>(list->size());
+  list->push_back(proxy);
+}
+
+void SpatialHashGrid::Unlink(int32_t proxy) {
+  const Proxy &entry = m_proxies[proxy];
+  auto found = m_cells.end();
+  std::vector<int32_t> *list = &m_oversized;
+  if (entry.cell != OVERSIZED) {
+    found = m_cells.find(entry.cell);
+    list = &found->second.proxies;
+  }
+
+  const int32_t last = list->back();
+  (*list)[entry.slot] = last;
+  m_proxies[last].slot = entry.slot;
+  list->pop_back();
+
+  // Empty cells would only slow down the scans
+  if (found != m_cells.end() && list->empty()) {
+    m_cells.erase(found);
+  }
+}
+
+int32_t SpatialHashGrid::Insert(const AABB &bounds, void *userData) {
+  int32_t proxy = m_freeList;
+  if (proxy == NULL_PROXY) {
+    proxy = static_cast<int32_t>(m_proxies.size());
+    m_proxies.emplace_back();
+  } else {
+    m_freeList = m_proxies[proxy].nextFree;
+  }
+
+  Proxy &entry = m_proxies[proxy];
+  entry.bounds = bounds;
+  entry.userData = userData;
+  entry.nextFree = NULL_PROXY;
+  Link(proxy);
+  m_proxyCount++;
+  return proxy;
+}
+
+void SpatialHashGrid::Remove(int32_t proxy) {
+  Unlink(proxy);
+  m_proxies[proxy].userData = nullptr;
+  m_proxies[proxy].nextFree = m_freeList;
+  m_freeList = proxy;
+  m_proxyCount--;
+}
+
+bool SpatialHashGrid::Update(int32_t proxy, const AABB &bounds,
+                             const Vector3 &displacement) {
+  (void)displacement;
+  int32_t coordinates[3];
+  if (CellFor(bounds, coordinates) == m_proxies[proxy].cell) {
+    m_proxies[proxy].bounds = bounds;
+    return false;
+  }
+  Unlink(proxy);
+  m_proxies[proxy].bounds = bounds;
+  Link(proxy);
+  return true;
+}
+
+void SpatialHashGrid::Clear() {
+  m_proxies.clear();
+  m_freeList = NULL_PROXY;
+  m_proxyCount = 0;
+  m_cells.clear();
+  m_oversized.clear();
+  std::fill(m_cellMin, m_cellMin + 3, 0);
+  std::fill(m_cellMax, m_cellMax + 3, -1);
+}
+
+template <typename Visitor>
+void SpatialHashGrid::ForEachCell(const AABB &box, Visitor &&visit) const {
+  // Objects reach at most half a cell past their own
+  const float margin = 0.5f * m_cellSize;
+  const int32_t lowX = static_cast<int32_t>(
+      std::floor((box.minimum.x - margin) * m_inverseCellSize));
+  const int32_t lowY = static_cast<int32_t>(
+      std::floor((box.minimum.y - margin) * m_inverseCellSize));
+  const int32_t lowZ = static_cast<int32_t>(
+      std::floor((box.minimum.z - margin) * m_inverseCellSize));
+  const int32_t highX = static_cast<int32_t>(
+      std::floor((box.maximum.x + margin) * m_inverseCellSize));
+  const int32_t highY = static_cast<int32_t>(
+      std::floor((box.maximum.y + margin) * m_inverseCellSize));
+  const int32_t highZ = static_cast<int32_t>(
+      std::floor((box.maximum.z + margin) * m_inverseCellSize));
+
+  // Look cells up one by one while that is cheaper than scanning them all
+  const double range = (static_cast<double>(highX) - lowX + 1) *
+                       (static_cast<double>(highY) - lowY + 1) *
+                       (static_cast<double>(highZ) - lowZ + 1);
+  if (range <= static_cast<double>(m_cells.size())) {
+    for (int32_t x = lowX; x <= highX; x++) {
+      for (int32_t y = lowY; y <= highY; y++) {
+        for (int32_t z = lowZ; z <= highZ; z++) {
+          auto found = m_cells.find(PackKey(x, y, z));
+          if (found != m_cells.end()) {
+            visit(found->second);
+          }
+        }
+      }
+    }
+    return;
+  }
+  for (const auto &entry : m_cells) {
+    const Cell &cell = entry.second;
+    if (cell.x >= lowX && cell.x <= highX && cell.y >= lowY &&
+        cell.y <= highY && cell.z >= lowZ && cell.z <= highZ) {
+      visit(cell);
+    }
+  }
+}
+
+void SpatialHashGrid::QueryAABB(const AABB &box,
+                                std::vector<void *> &results) const {
+  auto test = [&](int32_t proxy) {
+    if (m_proxies[proxy].bounds.Intersects(box)) {
+      results.push_back(m_proxies[proxy].userData);
+    }
+  };
+  ForEachCell(box, [&](const Cell &cell) {
+    for (int32_t proxy : cell.proxies) {
+      test(proxy);
+    }
+  });
+  for (int32_t proxy : m_oversized) {
+    test(proxy);
+  }
+}
+
+void SpatialHashGrid::QuerySphere(const BoundingSphere &sphere,
+                                  std::vector<void *> &results) const {
+  auto test = [&](int32_t proxy) {
+    if (sphere.Intersects(m_proxies[proxy].bounds)) {
+      results.push_back(m_proxies[proxy].userData);
+    }
+  };
+  const AABB box = AABB::FromCenterExtents(sphere.center,
+                                           Vector3(sphere.radius));
+  ForEachCell(box, [&](const Cell &cell) {
+    for (int32_t proxy : cell.proxies) {
+      test(proxy);
+    }
+  });
+  for (int32_t proxy : m_oversized) {
+    test(proxy);
+  }
+}
+
+void SpatialHashGrid::QueryFrustum(const Frustum &frustum,
+                                   std::vector<void *> &results) const {
+  for (const auto &entry : m_cells) {
+    const Cell &cell = entry.second;
+    const Containment containment = frustum.Classify(GetLooseBounds(cell));
+    if (containment == Containment::Outside) {
+      continue;
+    }
+    for (int32_t proxy : cell.proxies) {
+      if (containment == Containment::Inside ||
+          frustum.Intersects(m_proxies[proxy].bounds)) {
+        results.push_back(m_proxies[proxy].userData);
+      }
+    }
+  }
+  for (int32_t proxy : m_oversized) {
+    if (frustum.Intersects(m_proxies[proxy].bounds)) {
+      results.push_back(m_proxies[proxy].userData);
+    }
+  }
+}
+
+void *SpatialHashGrid::Raycast(const Ray &ray, float maxDistance,
+                               const RayTest &test, float *distance) const {
+  void *closest = nullptr;
+  float closestDistance = maxDistance;
+
+  auto testProxy = [&](int32_t proxy) {
+    float hit = 0.0f;
+    if (!ray.Intersects(m_proxies[proxy].bounds, &hit) ||
+        hit > closestDistance) {
+      return;
+    }
+    void *userData = m_proxies[proxy].userData;
+    if ((!test || test(userData, closestDistance, hit)) &&
+        hit <= closestDistance) {
+      closest = userData;
+      closestDistance = hit;
+    }
+  };
+
+  auto testCell = [&](const Cell &cell) {
+    for (int32_t proxy : cell.proxies) {
+      testProxy(proxy);
+    }
+  };
+
+  // Part of the ray that can reach an occupied cell
+  float nearT = 0.0f;
+  float farT = maxDistance;
+  const Vector3 margin(0.5f * m_cellSize);
+  const AABB extent(Vector3(m_cellMin[0] * m_cellSize,
+                            m_cellMin[1] * m_cellSize,
+                            m_cellMin[2] * m_cellSize) -
+                        margin,
+                    Vector3((m_cellMax[0] + 1) * m_cellSize,
+                            (m_cellMax[1] + 1) * m_cellSize,
+                            (m_cellMax[2] + 1) * m_cellSize) +
+                        margin);
+  const bool crosses =
+      !m_cells.empty() && ClipRay(ray, extent, nearT, farT);
+
+  // Walking visits 27 cells per step; scan instead when that is cheaper
+  const float length = farT - nearT;
+  const double steps =
+      (std::abs(ray.direction.x) + std::abs(ray.direction.y) +
+       std::abs(ray.direction.z)) *
+          static_cast<double>(length) * m_inverseCellSize +
+      1.0;
+  if (crosses && steps * 27.0 >= static_cast<double>(m_cells.size())) {
+    for (const auto &entry : m_cells) {
+      float entryDistance = 0.0f;
+      if (ray.Intersects(GetLooseBounds(entry.second), &entryDistance) &&
+          entryDistance <= closestDistance) {
+        testCell(entry.second);
+      }
+    }
+  } else if (crosses) {
+    // 3D DDA over the cells the ray crosses. Every cell whose loose bounds
+    // the ray touches neighbours one of them, so each step also visits the
+    // 26 neighbours; objects seen twice are merely tested twice.
+    const Vector3 start = ray.GetPoint(nearT);
+    const float *origin = &ray.origin.x;
+    const float *direction = &ray.direction.x;
+    const float *point = &start.x;
+    int32_t cell[3];
+    int32_t step[3];
+    float next[3];
+    float delta[3];
+    for (int axis = 0; axis < 3; axis++) {
+      cell[axis] =
+          static_cast<int32_t>(std::floor(point[axis] * m_inverseCellSize));
+      cell[axis] = std::min(std::max(cell[axis], m_cellMin[axis] - 1),
+                            m_cellMax[axis] + 1);
+      if (direction[axis] > 0.0f) {
+        step[axis] = 1;
+        next[axis] = ((cell[axis] + 1) * m_cellSize - origin[axis]) /
+                     direction[axis];
+        delta[axis] = m_cellSize / direction[axis];
+      } else if (direction[axis] < 0.0f) {
+        step[axis] = -1;
+        next[axis] = (cell[axis] * m_cellSize - origin[axis]) / direction[axis];
+        delta[axis] = -m_cellSize / direction[axis];
+      } else {
+        step[axis] = 0;
+        next[axis] = std::numeric_limits<float>::infinity();
+        delta[axis] = std::numeric_limits<float>::infinity();
+      }
+    }
+
+    float cellEntry = nearT;
+    while (cellEntry <= farT && cellEntry <= closestDistance) {
+      for (int32_t x = cell[0] - 1; x <= cell[0] + 1; x++) {
+        for (int32_t y = cell[1] - 1; y <= cell[1] + 1; y++) {
+          for (int32_t z = cell[2] - 1; z <= cell[2] + 1; z++) {
+            auto found = m_cells.find(PackKey(x, y, z));
+            if (found != m_cells.end()) {
+              testCell(found->second);
+            }
+          }
+        }
+      }
+      const int axis = next[0] < next[1] ? (next[0] < next[2] ? 0 : 2)
+                                         : (next[1] < next[2] ? 1 : 2);
+      cellEntry = next[axis];
+      cell[axis] += step[axis];
+      next[axis] += delta[axis];
+    }
+  }
+  for (int32_t proxy : m_oversized) {
+    testProxy(proxy);
+  }
+
+  if (closest && distance) {
+    *distance = closestDistance;
+  }
+  return closest;
+}
+
+} // namespace AquaVisual
@@ -0,0 +1,462 @@
+#include "AquaVisual/Core/UploadManager.h"
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <iostream>
+
+namespace AquaVisual {
+
+namespace {
+
+// Keeps staging writes on 16 byte boundaries
+constexpr VkDeviceSize COPY_ALIGNMENT = 16;
+
+uint64_t AlignUp(uint64_t value, uint64_t alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+} // namespace
+
+UploadManager &UploadManager::Instance() {
+  static UploadManager instance;
+  return instance;
+}
+
+bool UploadManager::Initialize(VkDevice device, VkPhysicalDevice physicalDevice,
+                               VkQueue graphicsQueue,
+                               uint32_t graphicsQueueFamily,
+                               VkQueue transferQueue,
+                               uint32_t transferQueueFamily,
+                               uint32_t framesInFlight,
+                               VkDeviceSize ringSize) {
+  if (m_device != VK_NULL_HANDLE) {
+    return m_device == device;
+  }
+
+  MemoryAllocator &allocator = MemoryAllocator::Instance();
+  if (!allocator.Initialize(device, physicalDevice)) {
+    return false;
+  }
+
+  m_device = device;
+  m_graphicsQueue = graphicsQueue;
+  m_graphicsQueueFamily = graphicsQueueFamily;
+  if (transferQueue != VK_NULL_HANDLE && transferQueueFamily != UINT32_MAX) {
+    m_transferQueue = transferQueue;
+    m_transferQueueFamily = transferQueueFamily;
+  } else {
+    m_transferQueue = graphicsQueue;
+    m_transferQueueFamily = graphicsQueueFamily;
+  }
+  m_queueFamilies[0] = m_graphicsQueueFamily;
+  m_queueFamilies[1] = m_transferQueueFamily;
+  m_ringSize = AlignUp(std::max<VkDeviceSize>(ringSize, 1024 * 1024),
+                       COPY_ALIGNMENT);
+
+  // Persistently mapped staging ring
+  VkBufferCreateInfo bufferInfo{};
+  bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+  bufferInfo.size = m_ringSize;
+  bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+  bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+  if (vkCreateBuffer(m_device, &bufferInfo, nullptr, &m_ringBuffer) !=
+      VK_SUCCESS) {
+    std::cerr << "UploadManager: Failed to create staging ring" << '\n';
+    Shutdown();
+    return false;
+  }
+
+  if (!allocator.AllocateForBuffer(m_ringBuffer,
+                                   VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                                       VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                   m_ringAllocation)) {
+    std::cerr << "UploadManager: Failed to allocate staging ring" << '\n';
+    Shutdown();
+    return false;
+  }
+
+  m_ringData = static_cast<char *>(allocator.Map(m_ringAllocation));
+  if (m_ringData == nullptr) {
+    std::cerr << "UploadManager: Failed to map staging ring" << '\n';
+    Shutdown();
+    return false;
+  }
+
+  VkCommandPoolCreateInfo poolInfo{};
+  poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+  poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT |
+                   VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+  poolInfo.queueFamilyIndex = m_transferQueueFamily;
+
+  if (vkCreateCommandPool(m_device, &poolInfo, nullptr, &m_commandPool) !=
+      VK_SUCCESS) {
+    std::cerr << "UploadManager: Failed to create command pool" << '\n';
+    Shutdown();
+    return false;
+  }
+
+  m_slots.resize(std::max(framesInFlight, 1u));
+  for (FrameSlot &slot : m_slots) {
+    VkCommandBufferAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.commandPool = m_commandPool;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandBufferCount = 1;
+
+    VkFenceCreateInfo fenceInfo{};
+    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+    VkSemaphoreCreateInfo semaphoreInfo{};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+    if (vkAllocateCommandBuffers(m_device, &allocInfo, &slot.commandBuffer) !=
+            VK_SUCCESS ||
+        vkCreateFence(m_device, &fenceInfo, nullptr, &slot.fence) !=
+            VK_SUCCESS ||
+        vkCreateSemaphore(m_device, &semaphoreInfo, nullptr,
+                          &slot.semaphore) != VK_SUCCESS) {
+      std::cerr << "UploadManager: Failed to create frame resources" << '\n';
+      Shutdown();
+      return false;
+    }
+  }
+
+  std::cout << "UploadManager initialized: " << (m_ringSize / (1024 * 1024))
+            << " MB staging ring, "
+            << (HasDedicatedTransferQueue() ? "dedicated transfer queue"
+                                            : "graphics queue")
+            << '\n';
+  return true;
+}
+
+void UploadManager::Shutdown() {
+  if (m_device == VK_NULL_HANDLE) {
+    return;
+  }
+
+  RetireCompleted(true);
+  m_pendingCopies.clear();
+
+  for (FrameSlot &slot : m_slots) {
+    if (slot.semaphore != VK_NULL_HANDLE) {
+      vkDestroySemaphore(m_device, slot.semaphore, nullptr);
+    }
+    if (slot.fence != VK_NULL_HANDLE) {
+      vkDestroyFence(m_device, slot.fence, nullptr);
+    }
+  }
+  m_slots.clear();
+
+  if (m_commandPool != VK_NULL_HANDLE) {
+    vkDestroyCommandPool(m_device, m_commandPool, nullptr);
+    m_commandPool = VK_NULL_HANDLE;
+  }
+
+  if (m_ringData != nullptr) {
+    MemoryAllocator::Instance().Unmap(m_ringAllocation);
+    m_ringData = nullptr;
+  }
+  if (m_ringBuffer != VK_NULL_HANDLE) {
+    vkDestroyBuffer(m_device, m_ringBuffer, nullptr);
+    m_ringBuffer = VK_NULL_HANDLE;
+  }
+  MemoryAllocator::Instance().Free(m_ringAllocation);
+
+  std::cout << "UploadManager shutdown: " << m_uploadedBytes
+            << " bytes uploaded in " << m_submissions << " submissions, "
+            << m_stalls << " stalls" << '\n';
+
+  m_device = VK_NULL_HANDLE;
+  m_graphicsQueue = VK_NULL_HANDLE;
+  m_transferQueue = VK_NULL_HANDLE;
+  m_graphicsQueueFamily = UINT32_MAX;
+  m_transferQueueFamily = UINT32_MAX;
+  m_ringSize = 0;
+  m_ringHead = 0;
+  m_batchBegin = 0;
+  m_frameIndex = 0;
+}
+
+void UploadManager::BeginFrame(uint32_t frameIndex) {
+  if (m_device == VK_NULL_HANDLE) {
+    return;
+  }
+
+  m_frameIndex = frameIndex % static_cast<uint32_t>(m_slots.size());
+
+  FrameSlot &slot = m_slots[m_frameIndex];
+  if (slot.submitted) {
+    vkWaitForFences(m_device, 1, &slot.fence, VK_TRUE, UINT64_MAX);
+    slot.submitted = false;
+  }
+  RetireCompleted(false);
+}
+
+bool UploadManager::Upload(VkBuffer dstBuffer, const void *data,
+                           VkDeviceSize size, VkDeviceSize dstOffset) {
+  if (m_device == VK_NULL_HANDLE || dstBuffer == VK_NULL_HANDLE ||
+      data == nullptr || size == 0) {
+    return false;
+  }
+
+  const char *src = static_cast<const char *>(data);
+  VkDeviceSize remaining = size;
+
+  // Data larger than the ring is split into ring-sized chunks
+  while (remaining > 0) {
+    const VkDeviceSize chunk = std::min(remaining, m_ringSize);
+
+    if (m_pendingCopies.empty()) {
+      m_batchBegin = m_ringHead;
+    }
+
+    VkDeviceSize offset = 0;
+    if (!Reserve(chunk, offset)) {
+      RetireCompleted(false);
+      if (!Reserve(chunk, offset)) {
+        // Every byte of the ring is in flight; wait for the GPU to catch up
+        ++m_stalls;
+        FlushAndWait();
+        m_batchBegin = m_ringHead;
+        if (!Reserve(chunk, offset)) {
+          std::cerr << "UploadManager: Failed to reserve " << chunk
+                    << " bytes of staging memory" << '\n';
+          return false;
+        }
+      }
+    }
+
+    std::memcpy(m_ringData + offset, src, static_cast<size_t>(chunk));
+
+    PendingCopy copy;
+    copy.dstBuffer = dstBuffer;
+    copy.srcOffset = offset;
+    copy.dstOffset = dstOffset;
+    copy.size = chunk;
+    m_pendingCopies.push_back(copy);
+
+    src += chunk;
+    dstOffset += chunk;
+    remaining -= chunk;
+  }
+
+  m_uploadedBytes += size;
+  return true;
+}
+
+void UploadManager::Discard(VkBuffer dstBuffer) {
+  m_pendingCopies.erase(std::remove_if(m_pendingCopies.begin(),
+                                       m_pendingCopies.end(),
+                                       [dstBuffer](const PendingCopy &copy) {
+                                         return copy.dstBuffer == dstBuffer;
+                                       }),
+                        m_pendingCopies.end());
+}
+
+VkSemaphore UploadManager::Flush() {
+  if (m_device == VK_NULL_HANDLE || m_pendingCopies.empty()) {
+    return VK_NULL_HANDLE;
+  }
+
+  // Copies on the graphics queue are ordered by a pipeline barrier instead
+  const bool signal = HasDedicatedTransferQueue();
+  FrameSlot &slot = m_slots[m_frameIndex];
+  if (!Submit(slot, signal)) {
+    return VK_NULL_HANDLE;
+  }
+  return signal ? slot.semaphore : VK_NULL_HANDLE;
+}
+
+void UploadManager::FlushAndWait() {
+  if (m_device == VK_NULL_HANDLE) {
+    return;
+  }
+
+  if (!m_pendingCopies.empty()) {
+    Submit(m_slots[m_frameIndex], false);
+  }
+  RetireCompleted(true);
+}
+
+void UploadManager::ApplySharingMode(VkBufferCreateInfo &createInfo) const {
+  if (m_device != VK_NULL_HANDLE && HasDedicatedTransferQueue()) {
+    createInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+    createInfo.queueFamilyIndexCount = 2;
+    createInfo.pQueueFamilyIndices = m_queueFamilies;
+  } else {
+    createInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    createInfo.queueFamilyIndexCount = 0;
+    createInfo.pQueueFamilyIndices = nullptr;
+  }
+}
+
+UploadManagerStats UploadManager::GetStats() const {
+  UploadManagerStats stats;
+  stats.uploadedBytes = m_uploadedBytes;
+  stats.copyRegions = m_copyRegions;
+  stats.submissions = m_submissions;
+  stats.stalls = m_stalls;
+  stats.ringSize = m_ringSize;
+  stats.dedicatedTransferQueue =
+      m_device != VK_NULL_HANDLE && HasDedicatedTransferQueue();
+  return stats;
+}
+
+bool UploadManager::Reserve(VkDeviceSize size, VkDeviceSize &offset) {
+  uint64_t tail = GetRingTail();
+
+  // Nothing in flight, restart at the beginning of the ring so a full-size
+  // chunk always fits
+  if (tail == m_ringHead) {
+    m_ringHead = AlignUp(m_ringHead, m_ringSize);
+    m_batchBegin = m_ringHead;
+    tail = m_ringHead;
+  }
+
+  uint64_t position = AlignUp(m_ringHead, COPY_ALIGNMENT);
+  const VkDeviceSize physical = position % m_ringSize;
+  if (physical + size > m_ringSize) {
+    // Copies never wrap; skip the tail end of the ring
+    position += m_ringSize - physical;
+  }
+
+  if (position + size - tail > m_ringSize) {
+    return false;
+  }
+
+  m_ringHead = position + size;
+  offset = position % m_ringSize;
+  return true;
+}
+
+bool UploadManager::Submit(FrameSlot &slot, bool signalSemaphore) {
+  if (slot.submitted) {
+    vkWaitForFences(m_device, 1, &slot.fence, VK_TRUE, UINT64_MAX);
+    slot.submitted = false;
+  }
+  vkResetFences(m_device, 1, &slot.fence);
+
+  VkCommandBufferBeginInfo beginInfo{};
+  beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+  beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+  VkCommandBuffer commandBuffer = slot.commandBuffer;
+  if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
+    std::cerr << "UploadManager: Failed to begin command buffer" << '\n';
+    return false;
+  }
+
+  const bool sameQueue = !HasDedicatedTransferQueue();
+  if (sameQueue) {
+    // Earlier frames may still be reading the destination buffers
+    vkCmdPipelineBarrier(commandBuffer,
+                         VK_PIPELINE_STAGE_VERTEX_INPUT_BIT |
+                             VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0,
+                         nullptr, 0, nullptr);
+  }
+
+  // One vkCmdCopyBuffer per destination buffer
+  std::stable_sort(m_pendingCopies.begin(), m_pendingCopies.end(),
+                   [](const PendingCopy &a, const PendingCopy &b) {
+                     return std::less<VkBuffer>()(a.dstBuffer, b.dstBuffer);
+                   });
+
+  std::vector<VkBufferCopy> regions;
+  regions.reserve(m_pendingCopies.size());
+  size_t i = 0;
+  while (i < m_pendingCopies.size()) {
+    VkBuffer dstBuffer = m_pendingCopies[i].dstBuffer;
+    regions.clear();
+    for (; i < m_pendingCopies.size() &&
+           m_pendingCopies[i].dstBuffer == dstBuffer;
+         ++i) {
+      VkBufferCopy region{};
+      region.srcOffset = m_pendingCopies[i].srcOffset;
+      region.dstOffset = m_pendingCopies[i].dstOffset;
+      region.size = m_pendingCopies[i].size;
+      regions.push_back(region);
+    }
+    vkCmdCopyBuffer(commandBuffer, m_ringBuffer, dstBuffer,
+                    static_cast<uint32_t>(regions.size()), regions.data());
+  }
+
+  if (sameQueue) {
+    // Make the copies visible to vertex fetch and shader reads of later
+    // submissions
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT |
+                            VK_ACCESS_INDEX_READ_BIT |
+                            VK_ACCESS_UNIFORM_READ_BIT |
+                            VK_ACCESS_SHADER_READ_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_VERTEX_INPUT_BIT |
+                             VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
+                             VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                         0, 1, &barrier, 0, nullptr, 0, nullptr);
+  }
+
+  if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+    std::cerr << "UploadManager: Failed to record upload commands" << '\n';
+    return false;
+  }
+
+  VkSubmitInfo submitInfo{};
+  submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+  submitInfo.commandBufferCount = 1;
+  submitInfo.pCommandBuffers = &commandBuffer;
+  if (signalSemaphore) {
+    submitInfo.signalSemaphoreCount = 1;
+    submitInfo.pSignalSemaphores = &slot.semaphore;
+  }
+
+  if (vkQueueSubmit(m_transferQueue, 1, &submitInfo, slot.fence) !=
+      VK_SUCCESS) {
+    std::cerr << "UploadManager: Failed to submit uploads" << '\n';
+    return false;
+  }
+
+  slot.submitted = true;
+  slot.ringBegin = m_batchBegin;
+  slot.ringEnd = m_ringHead;
+
+  m_copyRegions += m_pendingCopies.size();
+  ++m_submissions;
+  m_pendingCopies.clear();
+  m_batchBegin = m_ringHead;
+  return true;
+}
+
+void UploadManager::RetireCompleted(bool wait) {
+  for (FrameSlot &slot : m_slots) {
+    if (!slot.submitted) {
+      continue;
+    }
+
+    if (wait) {
+      vkWaitForFences(m_device, 1, &slot.fence, VK_TRUE, UINT64_MAX);
+      slot.submitted = false;
+    } else if (vkGetFenceStatus(m_device, slot.fence) == VK_SUCCESS) {
+      slot.submitted = false;
+    }
+  }
+}
+
+uint64_t UploadManager::GetRingTail() const {
+  // Oldest ring position still read by a submitted or queued copy
+  uint64_t tail = m_ringHead;
+  for (const FrameSlot &slot : m_slots) {
+    if (slot.submitted) {
+      tail = std::min(tail, slot.ringBegin);
+    }
+  }
+  if (!m_pendingCopies.empty()) {
+    tail = std::min(tail, m_batchBegin);
+  }
+  return tail;
+}
+
+} // namespace AquaVisual
@@ -7,11 +7,21 @@
 #include "../../Include/AquaVisual/Core/VulkanRenderer.h"
 #include "../../Include/AquaVisual/Core/BufferManager.h"
 #include "../../Include/AquaVisual/Core/Camera.h"
+#include "../../Include/AquaVisual/Core/FrameAllocator.h"
+#include "../../Include/AquaVisual/Core/GeometryArena.h"
+#include "../../Include/AquaVisual/Core/GpuCuller.h"
+#include "../../Include/AquaVisual/Core/MeshCache.h"
+#include "../../Include/AquaVisual/Core/RenderQueue.h"
+#include "../../Include/AquaVisual/Core/UploadManager.h"
 #include "../../Include/AquaVisual/Core/Window.h"
 #include "../../Include/AquaVisual/Resources/Mesh.h"
+#include "../../Include/AquaVisual/Resources/MeshletBuilder.h"
 #include "../../Include/AquaVisual/Resources/Texture.h"
+#include "../../Include/AquaVisual/Resources/VertexPacking.h"
 #include <algorithm>
 #include <array>
+#include <cmath>
+#include <cstddef>
 #include <cstring>
 #include <fstream>
 #include <iostream>
@@ -34,8 +44,8 @@ VulkanRenderer::VulkanRenderer()
       m_graphicsQueue(nullptr), m_presentQueue(nullptr), m_swapChain(nullptr),
       m_renderPass(nullptr), m_pipelineLayout(nullptr),
       m_graphicsPipeline(nullptr), m_swapChainImageFormat(0), m_currentFrame(0),
-      m_currentImageIndex(0), m_depthImage(nullptr),
-      m_depthImageMemory(nullptr), m_depthImageView(nullptr), m_depthFormat(0) {
+      m_currentImageIndex(0), m_depthImage(nullptr), m_depthImageView(nullptr),
+      m_depthFormat(0) {
   m_swapChainExtent = {0, 0};
   m_commandPool = nullptr;
 
@@ -114,11 +124,7 @@ void VulkanRenderer::CleanupSwapChain() {
     m_depthImage = nullptr;
   }
 
-  if (m_depthImageMemory != nullptr) {
-    vkFreeMemory(device, static_cast<VkDeviceMemory>(m_depthImageMemory),
-                 nullptr);
-    m_depthImageMemory = nullptr;
-  }
+  MemoryAllocator::Instance().Free(m_depthImageAllocation);
 
   // Cleanup image views
   for (size_t i = 0; i < m_swapChainImageViews.size(); i++) {
@@ -224,6 +230,21 @@ bool VulkanRenderer::InitializeVulkan() {
     return false;
   }
 
+  // 12a. Create staging ring and upload scheduler
+  if (!CreateUploadManager()) {
+    return false;
+  }
+
+  // 12b. Create mesh residency cache
+  if (!CreateMeshCache()) {
+    return false;
+  }
+
+  // 12c. Create shared geometry arena for indirect drawing
+  if (!CreateGeometryArena()) {
+    return false;
+  }
+
   // 13. Create descriptor set layout
   if (!CreateDescriptorSetLayout()) {
     return false;
@@ -257,6 +278,11 @@ bool VulkanRenderer::InitializeVulkan() {
     return false;
   }
 
+  // 17a. Create compute culling stage for indirect draws
+  if (!CreateGpuCuller()) {
+    return false;
+  }
+
   // 18. Create sync objects
   if (!CreateSyncObjects()) {
     return false;
@@ -381,10 +407,19 @@ bool VulkanRenderer::CreateLogicalDevice() {
   vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount,
                                            queueFamilies.data());
 
+  // Prefer a graphics family that also runs compute, the culling pass is
+  // recorded into the frame's command buffer
   uint32_t graphicsFamily = UINT32_MAX;
   for (uint32_t i = 0; i < queueFamilies.size(); i++) {
-    if (queueFamilies[i].queueFlags & VK_QUEUE_GRAPHICS_BIT) {
+    VkQueueFlags flags = queueFamilies[i].queueFlags;
+    if (!(flags & VK_QUEUE_GRAPHICS_BIT)) {
+      continue;
+    }
+    if (graphicsFamily == UINT32_MAX || (flags & VK_QUEUE_COMPUTE_BIT)) {
       graphicsFamily = i;
+      m_graphicsQueueCompute = (flags & VK_QUEUE_COMPUTE_BIT) != 0;
+    }
+    if (m_graphicsQueueCompute) {
       break;
     }
   }
@@ -394,24 +429,71 @@ bool VulkanRenderer::CreateLogicalDevice() {
     return false;
   }
 
+  // Prefer a transfer-only family (DMA engine) for buffer uploads
+  uint32_t transferFamily = UINT32_MAX;
+  for (uint32_t i = 0; i < queueFamilies.size(); i++) {
+    VkQueueFlags flags = queueFamilies[i].queueFlags;
+    if ((flags & VK_QUEUE_TRANSFER_BIT) &&
+        !(flags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT))) {
+      transferFamily = i;
+      break;
+    }
+  }
+
+  float queuePriority = 1.0f;
+  std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
+
   VkDeviceQueueCreateInfo queueCreateInfo{};
   queueCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
   queueCreateInfo.queueFamilyIndex = graphicsFamily;
   queueCreateInfo.queueCount = 1;
-
-  float queuePriority = 1.0f;
   queueCreateInfo.pQueuePriorities = &queuePriority;
+  queueCreateInfos.push_back(queueCreateInfo);
+
+  if (transferFamily != UINT32_MAX) {
+    queueCreateInfo.queueFamilyIndex = transferFamily;
+    queueCreateInfos.push_back(queueCreateInfo);
+  }
+
+  // Indirect drawing of many meshes per call and per-draw instance ranges
+  // are optional features
+  VkPhysicalDeviceFeatures supportedFeatures{};
+  vkGetPhysicalDeviceFeatures(physicalDevice, &supportedFeatures);
 
   VkPhysicalDeviceFeatures deviceFeatures{};
+  deviceFeatures.multiDrawIndirect = supportedFeatures.multiDrawIndirect;
+  deviceFeatures.drawIndirectFirstInstance =
+      supportedFeatures.drawIndirectFirstInstance;
+
+  uint32_t extensionCount = 0;
+  vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr,
+                                       &extensionCount, nullptr);
+  std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+  vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr,
+                                       &extensionCount,
+                                       availableExtensions.data());
+
+  bool drawIndirectCount = false;
+  for (const auto &extension : availableExtensions) {
+    if (std::strcmp(extension.extensionName,
+                    VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME) == 0) {
+      drawIndirectCount = true;
+      break;
+    }
+  }
 
   VkDeviceCreateInfo createInfo{};
   createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
-  createInfo.pQueueCreateInfos = &queueCreateInfo;
-  createInfo.queueCreateInfoCount = 1;
+  createInfo.pQueueCreateInfos = queueCreateInfos.data();
+  createInfo.queueCreateInfoCount =
+      static_cast<uint32_t>(queueCreateInfos.size());
   createInfo.pEnabledFeatures = &deviceFeatures;
 
   // Device extensions
-  const std::vector<const char *> deviceExtensions = {"VK_KHR_swapchain"};
+  std::vector<const char *> deviceExtensions = {"VK_KHR_swapchain"};
+  if (drawIndirectCount) {
+    deviceExtensions.push_back(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+  }
   createInfo.enabledExtensionCount =
       static_cast<uint32_t>(deviceExtensions.size());
   createInfo.ppEnabledExtensionNames = deviceExtensions.data();
@@ -425,14 +507,32 @@ bool VulkanRenderer::CreateLogicalDevice() {
 
   m_device = static_cast<void *>(device);
 
+  m_multiDrawIndirect = deviceFeatures.multiDrawIndirect == VK_TRUE;
+  m_drawIndirectFirstInstance =
+      deviceFeatures.drawIndirectFirstInstance == VK_TRUE;
+  if (drawIndirectCount) {
+    m_cmdDrawIndexedIndirectCount =
+        reinterpret_cast<PFN_vkCmdDrawIndexedIndirectCountKHR>(
+            vkGetDeviceProcAddr(device, "vkCmdDrawIndexedIndirectCountKHR"));
+  }
+
   VkQueue graphicsQueue, presentQueue;
   vkGetDeviceQueue(device, graphicsFamily, 0, &graphicsQueue);
   vkGetDeviceQueue(device, graphicsFamily, 0, &presentQueue);
 
   m_graphicsQueue = static_cast<void *>(graphicsQueue);
   m_presentQueue = static_cast<void *>(presentQueue);
+  m_graphicsQueueFamily = graphicsFamily;
 
-  // Initialize BufferManager with Vulkan device
+  if (transferFamily != UINT32_MAX) {
+    VkQueue transferQueue;
+    vkGetDeviceQueue(device, transferFamily, 0, &transferQueue);
+    m_transferQueue = static_cast<void *>(transferQueue);
+    m_transferQueueFamily = transferFamily;
+  }
+
+  // Initialize GPU memory allocator and BufferManager with Vulkan device
+  MemoryAllocator::Instance().Initialize(device, physicalDevice);
   BufferManager::Instance().SetVulkanDevice(device, physicalDevice);
 
   std::cout << "Logical device created successfully\n";
@@ -606,7 +706,9 @@ bool VulkanRenderer::CreateRenderPass() {
   depthAttachment.format = static_cast<VkFormat>(m_depthFormat);
   depthAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
   depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-  depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+  // Kept when the occlusion culling pyramid is built from it
+  depthAttachment.storeOp = m_depthSampled ? VK_ATTACHMENT_STORE_OP_STORE
+                                           : VK_ATTACHMENT_STORE_OP_DONT_CARE;
   depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
   depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
   depthAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
@@ -630,8 +732,10 @@ bool VulkanRenderer::CreateRenderPass() {
   VkSubpassDependency dependency{};
   dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
   dependency.dstSubpass = 0;
+  // The depth pyramid build of the previous frame samples the depth buffer
   dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT |
-                            VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+                            VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT |
+                            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
   dependency.srcAccessMask = 0;
   dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT |
                             VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
@@ -667,9 +771,21 @@ bool VulkanRenderer::CreateGraphicsPipeline() {
 
   VkDevice device = static_cast<VkDevice>(m_device);
 
-  // Load shaders - using dual cube textured shaders
-  auto vertShaderCode =
-      ReadFile("AquaVisual/Shaders/dual_cube_textured_vert.spv");
+  // Load shaders - using dual cube textured shaders, the vertex stage
+  // matching the vertex format
+  std::vector<char> vertShaderCode;
+  if (m_config.packedVertices) {
+    vertShaderCode =
+        ReadFile("AquaVisual/Shaders/dual_cube_textured_packed_vert.spv");
+    if (vertShaderCode.empty()) {
+      // Runs before the mesh cache and arena pick their vertex format
+      std::cerr << "Packed vertex shader missing, using 32-byte vertices\n";
+      m_config.packedVertices = false;
+    }
+  }
+  if (!m_config.packedVertices) {
+    vertShaderCode = ReadFile("AquaVisual/Shaders/dual_cube_textured_vert.spv");
+  }
   auto fragShaderCode =
       ReadFile("AquaVisual/Shaders/dual_cube_textured_frag.spv");
 
@@ -711,14 +827,21 @@ bool VulkanRenderer::CreateGraphicsPipeline() {
                                                     fragShaderStageInfo};
 
   // Vertex input configuration for Vertex struct (position, normal, texCoord)
-  VkVertexInputBindingDescription bindingDescription{};
-  bindingDescription.binding = 0;
-  bindingDescription.stride =
-      sizeof(float) *
-      8; // Vec3 position + Vec3 normal + Vec2 texCoord = 8 floats
-  bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-
-  std::array<VkVertexInputAttributeDescription, 3> attributeDescriptions{};
+  // or its packed form
+  const VertexFormat vertexFormat = m_config.packedVertices
+                                        ? VertexFormat::Packed
+                                        : VertexFormat::Float32;
+  std::array<VkVertexInputBindingDescription, 2> bindingDescriptions{};
+  bindingDescriptions[0].binding = 0;
+  bindingDescriptions[0].stride = VertexPacking::GetStride(vertexFormat);
+  bindingDescriptions[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+  // Per-instance attributes (InstanceData), streamed from the frame allocator
+  bindingDescriptions[1].binding = 1;
+  bindingDescriptions[1].stride = sizeof(InstanceData);
+  bindingDescriptions[1].inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+
+  std::array<VkVertexInputAttributeDescription, 9> attributeDescriptions{};
 
   // Position attribute (location = 0)
   attributeDescriptions[0].binding = 0;
@@ -738,11 +861,33 @@ bool VulkanRenderer::CreateGraphicsPipeline() {
   attributeDescriptions[2].format = VK_FORMAT_R32G32_SFLOAT;
   attributeDescriptions[2].offset = sizeof(float) * 6;
 
+  // Packed: unorm16 position within the mesh bounds, octahedral snorm16
+  // normal, half float texture coordinates. Three-component 16-bit formats
+  // are rarely supported for vertex input, so the position carries a w.
+  if (vertexFormat == VertexFormat::Packed) {
+    attributeDescriptions[0].format = VK_FORMAT_R16G16B16A16_UNORM;
+    attributeDescriptions[0].offset = offsetof(PackedVertex, position);
+    attributeDescriptions[1].format = VK_FORMAT_R16G16_SNORM;
+    attributeDescriptions[1].offset = offsetof(PackedVertex, normal);
+    attributeDescriptions[2].format = VK_FORMAT_R16G16_SFLOAT;
+    attributeDescriptions[2].offset = offsetof(PackedVertex, texCoord);
+  }
+
+  // Instance model matrix columns (locations 3-6), color (7), material (8)
+  for (uint32_t i = 0; i < 6; ++i) {
+    VkVertexInputAttributeDescription &attribute = attributeDescriptions[3 + i];
+    attribute.binding = 1;
+    attribute.location = 3 + i;
+    attribute.format = VK_FORMAT_R32G32B32A32_SFLOAT;
+    attribute.offset = sizeof(float) * 4 * i;
+  }
+
   VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
   vertexInputInfo.sType =
       VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-  vertexInputInfo.vertexBindingDescriptionCount = 1;
-  vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
+  vertexInputInfo.vertexBindingDescriptionCount =
+      static_cast<uint32_t>(bindingDescriptions.size());
+  vertexInputInfo.pVertexBindingDescriptions = bindingDescriptions.data();
   vertexInputInfo.vertexAttributeDescriptionCount =
       static_cast<uint32_t>(attributeDescriptions.size());
   vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
@@ -939,24 +1084,8 @@ bool VulkanRenderer::CreateFramebuffers() {
 bool VulkanRenderer::CreateCommandPool() {
   std::cout << "Creating command pool..." << '\n';
 
-  // Find graphics queue family
-  uint32_t queueFamilyCount = 0;
-  vkGetPhysicalDeviceQueueFamilyProperties(
-      static_cast<VkPhysicalDevice>(m_physicalDevice), &queueFamilyCount,
-      nullptr);
-
-  std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
-  vkGetPhysicalDeviceQueueFamilyProperties(
-      static_cast<VkPhysicalDevice>(m_physicalDevice), &queueFamilyCount,
-      queueFamilies.data());
-
-  uint32_t graphicsFamily = UINT32_MAX;
-  for (uint32_t i = 0; i < queueFamilies.size(); i++) {
-    if (queueFamilies[i].queueFlags & VK_QUEUE_GRAPHICS_BIT) {
-      graphicsFamily = i;
-      break;
-    }
-  }
+  // Commands are submitted to the graphics queue picked with the device
+  const uint32_t graphicsFamily = m_graphicsQueueFamily;
 
   if (graphicsFamily == UINT32_MAX) {
     std::cerr << "Failed to find graphics queue family" << '\n';
@@ -1007,6 +1136,110 @@ bool VulkanRenderer::CreateCommandBuffers() {
   return true;
 }
 
+bool VulkanRenderer::CreateUploadManager() {
+  std::cout << "Creating upload manager..." << '\n';
+
+  if (!UploadManager::Instance().Initialize(
+          static_cast<VkDevice>(m_device),
+          static_cast<VkPhysicalDevice>(m_physicalDevice),
+          static_cast<VkQueue>(m_graphicsQueue), m_graphicsQueueFamily,
+          static_cast<VkQueue>(m_transferQueue), m_transferQueueFamily,
+          MAX_FRAMES_IN_FLIGHT, m_config.stagingBufferSize)) {
+    std::cerr << "Failed to create upload manager" << '\n';
+    return false;
+  }
+
+  std::cout << "Upload manager created successfully" << '\n';
+  return true;
+}
+
+bool VulkanRenderer::CreateMeshCache() {
+  std::cout << "Creating mesh cache..." << '\n';
+
+  m_meshCache = std::make_unique<MeshCache>();
+  if (!m_meshCache->Initialize(
+          static_cast<VkDevice>(m_device),
+          static_cast<VkPhysicalDevice>(m_physicalDevice),
+          MAX_FRAMES_IN_FLIGHT, m_config.meshCacheBudget,
+          m_config.packedVertices ? VertexFormat::Packed
+                                  : VertexFormat::Float32)) {
+    std::cerr << "Failed to create mesh cache" << '\n';
+    return false;
+  }
+
+  std::cout << "Mesh cache created successfully" << '\n';
+  return true;
+}
+
+bool VulkanRenderer::CreateGeometryArena() {
+  // Per-draw instance data is addressed through firstInstance, which indirect
+  // commands may only use with drawIndirectFirstInstance
+  if (!m_config.enableIndirectDraw || !m_drawIndirectFirstInstance) {
+    std::cout << "Indirect drawing disabled, meshes are drawn individually"
+              << '\n';
+    return true;
+  }
+
+  std::cout << "Creating geometry arena..." << '\n';
+
+  m_geometryArena = std::make_unique<GeometryArena>();
+  if (!m_geometryArena->Initialize(
+          static_cast<VkDevice>(m_device),
+          static_cast<VkPhysicalDevice>(m_physicalDevice),
+          MAX_FRAMES_IN_FLIGHT, m_config.geometryArenaVertexBytes,
+          m_config.geometryArenaIndexBytes,
+          m_config.packedVertices ? VertexFormat::Packed
+                                  : VertexFormat::Float32)) {
+    // Not fatal, the mesh cache still draws everything
+    std::cerr << "Failed to create geometry arena, indirect drawing disabled"
+              << '\n';
+    m_geometryArena.reset();
+    return true;
+  }
+
+  std::cout << "Geometry arena created successfully (multiDrawIndirect: "
+            << (m_multiDrawIndirect ? "yes" : "no") << ", draw count: "
+            << (m_cmdDrawIndexedIndirectCount ? "yes" : "no") << ")" << '\n';
+  return true;
+}
+
+bool VulkanRenderer::CreateGpuCuller() {
+  // Only arena draws go through indirect commands the pass can rewrite
+  if (!m_config.enableGpuCulling || !m_geometryArena ||
+      !m_graphicsQueueCompute) {
+    std::cout << "GPU culling disabled" << '\n';
+    return true;
+  }
+
+  std::cout << "Creating GPU culling stage..." << '\n';
+
+  m_gpuCuller = std::make_unique<GpuCuller>();
+  if (!m_gpuCuller->Initialize(static_cast<VkDevice>(m_device),
+                               static_cast<VkPhysicalDevice>(m_physicalDevice),
+                               MAX_FRAMES_IN_FLIGHT,
+                               m_frameAllocator->GetBuffer(),
+                               m_config.maxCulledDraws, m_depthSampled)) {
+    // Not fatal, every draw is submitted unculled
+    std::cerr << "Failed to create GPU culling stage, culling disabled"
+              << '\n';
+    m_gpuCuller.reset();
+    return true;
+  }
+
+  if (m_depthSampled) {
+    m_gpuCuller->SetDepthSource(
+        static_cast<VkImage>(m_depthImage),
+        static_cast<VkImageView>(m_depthImageView),
+        static_cast<VkFormat>(m_depthFormat), m_swapChainExtent.width,
+        m_swapChainExtent.height);
+  }
+
+  std::cout << "GPU culling stage created successfully (occlusion: "
+            << (m_gpuCuller->IsOcclusionEnabled() ? "yes" : "no") << ")"
+            << '\n';
+  return true;
+}
+
 bool VulkanRenderer::IsDeviceSuitable(void *device) {
   VkPhysicalDevice physicalDevice = static_cast<VkPhysicalDevice>(device);
 
@@ -1228,6 +1461,27 @@ void VulkanRenderer::Shutdown() {
     vkDeviceWaitIdle(static_cast<VkDevice>(m_device));
   }
 
+  // Queued uploads are dropped, their destination buffers are going away
+  UploadManager::Instance().Shutdown();
+
+  // Release culling resources
+  if (m_gpuCuller) {
+    m_gpuCuller->Shutdown();
+    m_gpuCuller.reset();
+  }
+
+  // Release shared geometry buffers
+  if (m_geometryArena) {
+    m_geometryArena->Shutdown();
+    m_geometryArena.reset();
+  }
+
+  // Release cached mesh buffers
+  if (m_meshCache) {
+    m_meshCache->Shutdown();
+    m_meshCache.reset();
+  }
+
   // Cleanup synchronization objects
   if (m_device != nullptr) {
     VkDevice device = static_cast<VkDevice>(m_device);
@@ -1312,11 +1566,7 @@ void VulkanRenderer::Shutdown() {
       m_depthImage = nullptr;
     }
 
-    if (m_depthImageMemory != nullptr) {
-      vkFreeMemory(device, static_cast<VkDeviceMemory>(m_depthImageMemory),
-                   nullptr);
-      m_depthImageMemory = nullptr;
-    }
+    MemoryAllocator::Instance().Free(m_depthImageAllocation);
   }
 
   // Cleanup image views
@@ -1338,6 +1588,42 @@ void VulkanRenderer::Shutdown() {
     m_swapChain = nullptr;
   }
 
+  // Cleanup per-frame uniform memory
+  if (m_frameAllocator) {
+    m_frameAllocator->Shutdown();
+    m_frameAllocator.reset();
+  }
+
+  // Cleanup texture resources
+  if (m_device != nullptr) {
+    VkDevice device = static_cast<VkDevice>(m_device);
+
+    if (m_textureSampler != nullptr) {
+      vkDestroySampler(device, static_cast<VkSampler>(m_textureSampler),
+                       nullptr);
+      m_textureSampler = nullptr;
+    }
+
+    if (m_textureImageView != nullptr) {
+      vkDestroyImageView(device, static_cast<VkImageView>(m_textureImageView),
+                         nullptr);
+      m_textureImageView = nullptr;
+    }
+
+    if (m_textureImage != nullptr) {
+      vkDestroyImage(device, static_cast<VkImage>(m_textureImage), nullptr);
+      m_textureImage = nullptr;
+    }
+    MemoryAllocator::Instance().Free(m_textureImageAllocation);
+  }
+
+  // Release remaining buffers and device memory blocks
+  if (m_device != nullptr) {
+    BufferManager::Instance().DestroyAllBuffers();
+    MemoryAllocator::Instance().PrintStats();
+    MemoryAllocator::Instance().Shutdown();
+  }
+
   // Cleanup logical device
   if (m_device != nullptr) {
     vkDestroyDevice(static_cast<VkDevice>(m_device), nullptr);
@@ -1379,6 +1665,30 @@ bool VulkanRenderer::BeginFrame() {
   vkWaitForFences(device, 1, &inFlightFence, VK_TRUE, UINT64_MAX);
   std::cout << "BeginFrame: Fence signaled" << '\n';
 
+  // Buffers retired by the mesh cache can be freed once their frame is done
+  if (m_meshCache) {
+    m_meshCache->BeginFrame();
+  }
+  if (m_geometryArena) {
+    m_geometryArena->BeginFrame();
+  }
+  if (m_gpuCuller) {
+    m_gpuCuller->BeginFrame(m_currentFrame);
+  }
+
+  // Staging space read by this frame slot's last uploads can be reused
+  UploadManager::Instance().BeginFrame(m_currentFrame);
+
+  // Rewind this frame's uniform region, the GPU is done reading it
+  m_frameAllocator->BeginFrame(m_currentFrame);
+  m_renderQueue.Clear();
+  m_clusterRanges.clear();
+  m_cameraBlockOffset = UINT32_MAX;
+  m_meshBlocks.clear();
+
+  // Update animation time (simple increment for smooth animation)
+  m_animationTime += 0.016f; // Approximately 60 FPS
+
   // Acquire an image from the swap chain
   VkSemaphore imageAvailableSemaphore =
       static_cast<VkSemaphore>(m_imageAvailableSemaphores[m_currentFrame]);
@@ -1438,20 +1748,26 @@ bool VulkanRenderer::BeginFrame() {
   std::cout << "BeginFrame: Command buffer recording started successfully"
             << '\n';
 
-  // Begin render pass
-  std::cout << "BeginFrame: Setting up render pass info" << '\n';
-  std::cout << "BeginFrame: Image index = " << imageIndex << '\n';
-  std::cout << "BeginFrame: Framebuffers size = "
+  // The render pass begins in EndFrame, after the culling pass
+  std::cout << "BeginFrame: Frame setup complete" << '\n';
+  return true;
+}
+
+void VulkanRenderer::BeginRenderPass(VkCommandBuffer commandBuffer) {
+  std::cout << "BeginRenderPass: Setting up render pass info" << '\n';
+  std::cout << "BeginRenderPass: Image index = " << m_currentImageIndex
+            << '\n';
+  std::cout << "BeginRenderPass: Framebuffers size = "
             << m_swapChainFramebuffers.size() << '\n';
 
   VkRenderPassBeginInfo renderPassInfo{};
   renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-  std::cout << "BeginFrame: Setting render pass" << '\n';
+  std::cout << "BeginRenderPass: Setting render pass" << '\n';
   renderPassInfo.renderPass = static_cast<VkRenderPass>(m_renderPass);
-  std::cout << "BeginFrame: Setting framebuffer" << '\n';
-  renderPassInfo.framebuffer =
-      static_cast<VkFramebuffer>(m_swapChainFramebuffers[imageIndex]);
-  std::cout << "BeginFrame: Setting render area" << '\n';
+  std::cout << "BeginRenderPass: Setting framebuffer" << '\n';
+  renderPassInfo.framebuffer = static_cast<VkFramebuffer>(
+      m_swapChainFramebuffers[m_currentImageIndex]);
+  std::cout << "BeginRenderPass: Setting render area" << '\n';
   renderPassInfo.renderArea.offset = {0, 0};
   renderPassInfo.renderArea.extent = {m_swapChainExtent.width,
                                       m_swapChainExtent.height};
@@ -1464,21 +1780,19 @@ bool VulkanRenderer::BeginFrame() {
   renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
   renderPassInfo.pClearValues = clearValues.data();
 
-  std::cout << "BeginFrame: Beginning render pass" << '\n';
-  std::cout << "BeginFrame: Render pass = " << renderPassInfo.renderPass
+  std::cout << "BeginRenderPass: Beginning render pass" << '\n';
+  std::cout << "BeginRenderPass: Render pass = " << renderPassInfo.renderPass
             << '\n';
-  std::cout << "BeginFrame: Framebuffer = " << renderPassInfo.framebuffer
+  std::cout << "BeginRenderPass: Framebuffer = " << renderPassInfo.framebuffer
             << '\n';
-  std::cout << "BeginFrame: Render area extent = "
+  std::cout << "BeginRenderPass: Render area extent = "
             << renderPassInfo.renderArea.extent.width << "x"
             << renderPassInfo.renderArea.extent.height << '\n';
 
   vkCmdBeginRenderPass(commandBuffer, &renderPassInfo,
                        VK_SUBPASS_CONTENTS_INLINE);
-  std::cout << "BeginFrame: Render pass started successfully" << '\n';
+  std::cout << "BeginRenderPass: Render pass started successfully" << '\n';
 
-  std::cout << "BeginFrame: Frame setup complete" << '\n';
-  return true;
 }
 
 void VulkanRenderer::EndFrame() {
@@ -1488,10 +1802,21 @@ void VulkanRenderer::EndFrame() {
   VkCommandBuffer commandBuffer =
       static_cast<VkCommandBuffer>(m_commandBuffers[m_currentFrame]);
 
+  // Resolve the queued draws and cull them before the render pass begins
+  PrepareDraws(commandBuffer);
+
+  BeginRenderPass(commandBuffer);
+  RecordDraws(commandBuffer);
+
   // End render pass
   std::cout << "EndFrame: Ending render pass" << '\n';
   vkCmdEndRenderPass(commandBuffer);
 
+  // Next frame's occlusion test reads this frame's depth
+  if (m_gpuCuller && m_hasViewProjection) {
+    m_gpuCuller->BuildDepthPyramid(commandBuffer, m_viewProjection);
+  }
+
   // End command buffer recording
   std::cout << "EndFrame: Ending command buffer recording" << '\n';
   if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
@@ -1505,10 +1830,21 @@ void VulkanRenderer::EndFrame() {
   submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 
   VkSemaphore waitSemaphores[] = {
-      static_cast<VkSemaphore>(m_imageAvailableSemaphores[m_currentFrame])};
+      static_cast<VkSemaphore>(m_imageAvailableSemaphores[m_currentFrame]),
+      VK_NULL_HANDLE};
   VkPipelineStageFlags waitStages[] = {
-      VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
+      VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+      VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT};
   submitInfo.waitSemaphoreCount = 1;
+
+  m_frameAllocator->EndFrame();
+
+  // Buffer uploads recorded during this frame go ahead of the draw commands
+  VkSemaphore uploadSemaphore = UploadManager::Instance().Flush();
+  if (uploadSemaphore != VK_NULL_HANDLE) {
+    waitSemaphores[1] = uploadSemaphore;
+    submitInfo.waitSemaphoreCount = 2;
+  }
   submitInfo.pWaitSemaphores = waitSemaphores;
   submitInfo.pWaitDstStageMask = waitStages;
 
@@ -1567,67 +1903,464 @@ void VulkanRenderer::EndFrame() {
 }
 
 void VulkanRenderer::SetCamera(const Camera &camera) {
+  // Unchanged camera: the matrices, frustum and the camera block already
+  // written this frame are still current
+  if (camera.GetVersion() == m_cameraVersion) {
+    return;
+  }
+  m_cameraVersion = camera.GetVersion();
+
   std::cout << "SetCamera: Updating camera matrices" << '\n';
 
-  // Get view and projection matrices from camera
   const Matrix4 &viewMatrix = camera.GetViewMatrix();
   const Matrix4 &projectionMatrix = camera.GetProjectionMatrix();
-
-  // Copy view matrix data
   const float *viewData = viewMatrix.Data();
   const float *projData = projectionMatrix.Data();
+  m_cameraFarPlane = camera.GetFarPlane();
+  const Vector3 &cameraPosition = camera.GetPosition();
+  m_cameraPosition[0] = cameraPosition.x;
+  m_cameraPosition[1] = cameraPosition.y;
+  m_cameraPosition[2] = cameraPosition.z;
+
+  // Frustum planes for culling
+  std::memcpy(m_viewProjection, camera.GetViewProjectionMatrix().Data(),
+              sizeof(m_viewProjection));
+  m_hasViewProjection = true;
+
+  // Draws queued after this point use a new camera block
+  m_cameraBlockOffset = UINT32_MAX;
+  m_meshBlocks.clear();
+
+  std::memcpy(m_currentCameraUBO.viewMatrix, viewData,
+              sizeof(m_currentCameraUBO.viewMatrix));
+  std::memcpy(m_currentCameraUBO.projectionMatrix, projData,
+              sizeof(m_currentCameraUBO.projectionMatrix));
+
+  // Debug: Print view matrix
+  std::cout << "SetCamera: View Matrix:" << '\n';
+  for (int i = 0; i < 4; i++) {
+    std::cout << "  [" << viewData[i * 4] << ", " << viewData[i * 4 + 1]
+              << ", " << viewData[i * 4 + 2] << ", " << viewData[i * 4 + 3]
+              << "]" << '\n';
+  }
+
+  // Debug: Print projection matrix
+  std::cout << "SetCamera: Projection Matrix:" << '\n';
+  for (int i = 0; i < 4; i++) {
+    std::cout << "  [" << projData[i * 4] << ", " << projData[i * 4 + 1]
+              << ", " << projData[i * 4 + 2] << ", " << projData[i * 4 + 3]
+              << "]" << '\n';
+  }
+}
+
+void VulkanRenderer::RenderMesh(const Mesh &mesh, const Texture *texture) {
+  RenderMesh(mesh, Matrix4::Identity(), texture);
+}
+
+void VulkanRenderer::RenderMesh(const Mesh &mesh, const Matrix4 &modelMatrix,
+                                const Texture *texture) {
+  // Instance records are aligned to their size so draws can address them
+  // through firstInstance
+  FrameAllocation block =
+      m_frameAllocator->Allocate(sizeof(InstanceData), sizeof(InstanceData));
+  if (!block.IsValid()) {
+    std::cerr << "RenderMesh: Out of per-frame uniform memory, skipping draw"
+              << '\n';
+    return;
+  }
+
+  InstanceData instance;
+  std::memcpy(instance.modelMatrix, modelMatrix.Data(),
+              sizeof(instance.modelMatrix));
+  std::memcpy(block.data, &instance, sizeof(InstanceData));
+
+  QueueDraw(mesh, &instance, block.offset, 1, texture);
+}
+
+void VulkanRenderer::RenderMeshInstanced(const Mesh &mesh,
+                                         const InstanceData *instances,
+                                         uint32_t count,
+                                         const Texture *texture) {
+  if (count == 0) {
+    return;
+  }
 
-  if (viewData && projData) {
-    std::memcpy(m_currentCameraUBO.viewMatrix, viewData, 16 * sizeof(float));
-    std::memcpy(m_currentCameraUBO.projectionMatrix, projData,
-                16 * sizeof(float));
-
-    // Debug: Print view matrix
-    std::cout << "SetCamera: View Matrix:" << '\n';
-    for (int i = 0; i < 4; i++) {
-      std::cout << "  [" << viewData[i * 4] << ", " << viewData[i * 4 + 1]
-                << ", " << viewData[i * 4 + 2] << ", " << viewData[i * 4 + 3]
-                << "]" << '\n';
+  FrameAllocation block = m_frameAllocator->Allocate(
+      sizeof(InstanceData) * count, sizeof(InstanceData));
+  if (!block.IsValid()) {
+    std::cerr << "RenderMeshInstanced: Out of per-frame uniform memory, "
+                 "skipping "
+              << count << " instances" << '\n';
+    return;
+  }
+  std::memcpy(block.data, instances, sizeof(InstanceData) * count);
+
+  QueueDraw(mesh, instances, block.offset, count, texture);
+}
+
+uint32_t VulkanRenderer::SelectLod(const Mesh &mesh,
+                                   const InstanceData *instances,
+                                   uint32_t count) const {
+  if (mesh.GetLods().empty() || m_config.lodPixelError <= 0.0f ||
+      !m_hasViewProjection) {
+    return 0;
+  }
+
+  // Screen pixels per world unit at distance 1, or at any distance for
+  // orthographic projections (column-major, [15] is 1 only for those)
+  const float *projection = m_currentCameraUBO.projectionMatrix;
+  const bool perspective = projection[15] == 0.0f;
+  const float pixelsPerUnit = std::abs(projection[5]) * 0.5f *
+                              static_cast<float>(m_swapChainExtent.height);
+  if (pixelsPerUnit <= 0.0f) {
+    return 0;
+  }
+
+  const AABB &bounds = mesh.GetBounds();
+  const Vector3 center = bounds.GetCenter();
+  const float radius = (bounds.maximum - bounds.minimum).Length() * 0.5f;
+
+  // The instance that magnifies the mesh most decides for the whole draw
+  float magnification = 0.0f;
+  for (uint32_t i = 0; i < count; ++i) {
+    const float *m = instances[i].modelMatrix;
+    const float scale = std::sqrt(std::max(
+        {m[0] * m[0] + m[1] * m[1] + m[2] * m[2],
+         m[4] * m[4] + m[5] * m[5] + m[6] * m[6],
+         m[8] * m[8] + m[9] * m[9] + m[10] * m[10]}));
+    if (!perspective) {
+      magnification = std::max(magnification, scale);
+      continue;
     }
 
-    // Debug: Print projection matrix
-    std::cout << "SetCamera: Projection Matrix:" << '\n';
-    for (int i = 0; i < 4; i++) {
-      std::cout << "  [" << projData[i * 4] << ", " << projData[i * 4 + 1]
-                << ", " << projData[i * 4 + 2] << ", " << projData[i * 4 + 3]
-                << "]" << '\n';
+    const Vector3 toCenter(
+        m[0] * center.x + m[4] * center.y + m[8] * center.z + m[12] -
+            m_cameraPosition[0],
+        m[1] * center.x + m[5] * center.y + m[9] * center.z + m[13] -
+            m_cameraPosition[1],
+        m[2] * center.x + m[6] * center.y + m[10] * center.z + m[14] -
+            m_cameraPosition[2]);
+    const float distance = toCenter.Length() - radius * scale;
+    if (distance <= 0.0f) {
+      return 0; // camera inside the bounds
     }
+    magnification = std::max(magnification, scale / distance);
+  }
+  if (magnification <= 0.0f) {
+    return 0;
+  }
 
-    std::cout << "SetCamera: Camera matrices updated successfully" << '\n';
-  } else {
-    std::cerr << "SetCamera: Failed to get matrix data from camera"
+  return mesh.SelectLod(m_config.lodPixelError /
+                        (pixelsPerUnit * magnification));
+}
+
+bool VulkanRenderer::ClusterCullingOnGpu() const {
+  // Meshlets become indirect commands of their own, which only pays off
+  // when a batch is a single multi-draw call
+  return m_config.enableClusterCulling && m_gpuCuller &&
+         m_hasViewProjection && m_multiDrawIndirect;
+}
+
+bool VulkanRenderer::CullClusters(const Mesh &mesh,
+                                  const InstanceData *instances,
+                                  uint32_t count, DrawItem &item) {
+  const std::vector<Meshlet> &meshlets = mesh.GetMeshlets();
+  if (meshlets.empty() || item.lod != 0 || !m_config.enableClusterCulling ||
+      !m_hasViewProjection || count > MAX_CLUSTER_CULLED_INSTANCES ||
+      ClusterCullingOnGpu()) {
+    return true;
+  }
+
+  const Frustum frustum = Frustum::FromMatrix(Matrix4(m_viewProjection));
+  const Vector3 eye(m_cameraPosition[0], m_cameraPosition[1],
+                    m_cameraPosition[2]);
+  const size_t firstRange = m_clusterRanges.size();
+  size_t visibleCount = 0;
+
+  for (const Meshlet &meshlet : meshlets) {
+    Vector3 axis;
+    float cutoff = 0.0f;
+    const bool hasCone = MeshletBuilder::DecodeCone(meshlet, axis, cutoff);
+    const float *sphere = meshlet.boundingSphere;
+
+    // Same tests as cull_instances.comp: kept if any instance sees it
+    bool visible = false;
+    for (uint32_t i = 0; i < count && !visible; ++i) {
+      const float *m = instances[i].modelMatrix;
+      const Vector3 center(
+          m[0] * sphere[0] + m[4] * sphere[1] + m[8] * sphere[2] + m[12],
+          m[1] * sphere[0] + m[5] * sphere[1] + m[9] * sphere[2] + m[13],
+          m[2] * sphere[0] + m[6] * sphere[1] + m[10] * sphere[2] + m[14]);
+      const float scales[3] = {
+          m[0] * m[0] + m[1] * m[1] + m[2] * m[2],
+          m[4] * m[4] + m[5] * m[5] + m[6] * m[6],
+          m[8] * m[8] + m[9] * m[9] + m[10] * m[10]};
+      const float scale =
+          std::sqrt(std::max({scales[0], scales[1], scales[2]}));
+      const float radius = sphere[3] * scale;
+
+      visible = frustum.Intersects(BoundingSphere(center, radius));
+
+      // Cones only survive uniform scale
+      if (visible && hasCone &&
+          std::sqrt(std::min({scales[0], scales[1], scales[2]})) >=
+              scale * 0.999f) {
+        const Vector3 worldAxis =
+            Vector3(m[0] * axis.x + m[4] * axis.y + m[8] * axis.z,
+                    m[1] * axis.x + m[5] * axis.y + m[9] * axis.z,
+                    m[2] * axis.x + m[6] * axis.y + m[10] * axis.z)
+                .Normalize();
+        const Vector3 toCenter = center - eye;
+        visible = toCenter.Dot(worldAxis) < cutoff * toCenter.Length() + radius;
+      }
+    }
+    if (!visible) {
+      continue;
+    }
+
+    // Neighboring meshlets are adjacent in the index buffer
+    ++visibleCount;
+    if (m_clusterRanges.size() > firstRange &&
+        m_clusterRanges.back().firstIndex + m_clusterRanges.back().indexCount ==
+            meshlet.firstIndex) {
+      m_clusterRanges.back().indexCount += meshlet.indexCount;
+    } else {
+      IndexRange range;
+      range.firstIndex = meshlet.firstIndex;
+      range.indexCount = meshlet.indexCount;
+      m_clusterRanges.push_back(range);
+    }
+  }
+
+  m_renderQueue.GetStats().culledClusters +=
+      static_cast<uint32_t>(meshlets.size() - visibleCount);
+  if (visibleCount == meshlets.size()) {
+    m_clusterRanges.resize(firstRange);
+    return true;
+  }
+  item.firstRange = static_cast<uint32_t>(firstRange);
+  item.rangeCount = static_cast<uint32_t>(m_clusterRanges.size() - firstRange);
+  return visibleCount > 0;
+}
+
+void VulkanRenderer::QueueDraw(const Mesh &mesh, const InstanceData *instances,
+                               uint32_t instanceOffset, uint32_t instanceCount,
+                               const Texture *texture) {
+  uint32_t dynamicOffset = UINT32_MAX;
+  if (!AcquireUniformBlock(mesh, dynamicOffset)) {
+    std::cerr << "RenderMesh: Out of per-frame uniform memory, skipping draw"
               << '\n';
+    return;
   }
+
+  // View space distance of the first instance's origin (column-major
+  // matrices)
+  const float *origin = instances[0].modelMatrix + 12;
+  const float *view = m_currentCameraUBO.viewMatrix;
+  const float viewZ = view[2] * origin[0] + view[6] * origin[1] +
+                      view[10] * origin[2] + view[14];
+  const float depth =
+      m_cameraFarPlane > 0.0f ? -viewZ / m_cameraFarPlane : 0.0f;
+
+  // Textures share the frame's descriptor set for now; the id still keeps
+  // draws with the same texture together
+  const uint32_t material = static_cast<uint32_t>(
+      reinterpret_cast<uintptr_t>(texture) >> 4);
+
+  DrawItem item;
+  item.mesh = &mesh;
+  item.pipeline = 0; // m_graphicsPipeline
+  item.material = material;
+  item.dynamicOffset = dynamicOffset;
+  item.instanceOffset = instanceOffset;
+  item.instanceCount = instanceCount;
+  item.lod = SelectLod(mesh, instances, instanceCount);
+  if (!CullClusters(mesh, instances, instanceCount, item)) {
+    return; // every meshlet is outside the view or faces away
+  }
+  item.sortKey =
+      RenderQueue::MakeSortKey(RenderPass::Opaque, item.pipeline, material,
+                               static_cast<uint32_t>(mesh.GetId()), depth);
+  m_renderQueue.Submit(item);
 }
 
-void VulkanRenderer::RenderMesh(const Mesh &mesh, const Texture *texture) {
-  std::cout << "RenderMesh: Starting mesh rendering for frame "
-            << m_currentFrame << '\n';
-  VkCommandBuffer commandBuffer =
-      static_cast<VkCommandBuffer>(m_commandBuffers[m_currentFrame]);
+void VulkanRenderer::PrepareDraws(VkCommandBuffer commandBuffer) {
+  m_drawOps.clear();
+  m_indirectCommands.clear();
+  m_cullCandidates.clear();
+  m_indirectBuffer = VK_NULL_HANDLE;
+  m_indirectOffset = 0;
+  m_indirectCulled = false;
 
-  // Update uniform buffer with current camera matrices
-  UpdateUniformBuffer(m_currentFrame);
+  if (m_renderQueue.Empty()) {
+    return;
+  }
 
-  // Bind graphics pipeline
-  std::cout << "RenderMesh: Binding graphics pipeline" << '\n';
-  vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
-                    static_cast<VkPipeline>(m_graphicsPipeline));
+  m_renderQueue.Sort();
+  RenderQueueStats &stats = m_renderQueue.GetStats();
+  const bool culling = m_gpuCuller && m_hasViewProjection;
+
+  const Mesh *lastMesh = nullptr;
+  const ArenaMesh *arenaMesh = nullptr;
+  const MeshGpuData *gpuMesh = nullptr;
+  uint32_t batchCount = 0;
+
+  for (size_t i = 0; i < m_renderQueue.Size(); ++i) {
+    const DrawItem &item = m_renderQueue.GetSorted(i);
+
+    // Resolve GPU geometry once per run of the same mesh, preferring the
+    // arena and falling back to individual buffers when it is full. Uploads
+    // land ahead of this frame's command buffer.
+    if (item.mesh != lastMesh) {
+      lastMesh = item.mesh;
+      arenaMesh =
+          m_geometryArena ? m_geometryArena->Acquire(*item.mesh) : nullptr;
+      gpuMesh = nullptr;
+      if (!arenaMesh && m_meshCache) {
+        gpuMesh = m_meshCache->Acquire(*item.mesh);
+      }
+    }
 
-  // Bind descriptor sets
-  VkDescriptorSet descriptorSet =
-      static_cast<VkDescriptorSet>(m_descriptorSets[m_currentFrame]);
-  vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
-                          static_cast<VkPipelineLayout>(m_pipelineLayout), 0, 1,
-                          &descriptorSet, 0, nullptr);
+    const uint32_t firstInstance =
+        item.instanceOffset / static_cast<uint32_t>(sizeof(InstanceData));
+    stats.instances += item.instanceCount;
+
+    if (!arenaMesh) {
+      DrawOp op;
+      op.pipeline = item.pipeline;
+      op.dynamicOffset = item.dynamicOffset;
+      op.mesh = item.mesh;
+      op.gpuMesh = gpuMesh;
+      if (gpuMesh) {
+        op.firstIndex = 0;
+        op.indexCount = gpuMesh->indexCount;
+        if (item.lod > 0 && item.lod <= gpuMesh->lodCount) {
+          op.firstIndex = gpuMesh->lodFirstIndex[item.lod - 1];
+          op.indexCount = gpuMesh->lodIndexCount[item.lod - 1];
+        }
+      }
+      op.instanceOffset = item.instanceOffset;
+      op.instanceCount = item.instanceCount;
+
+      // One draw per run of visible meshlets
+      if (gpuMesh && item.rangeCount > 0) {
+        for (uint32_t r = 0; r < item.rangeCount; ++r) {
+          const IndexRange &range = m_clusterRanges[item.firstRange + r];
+          op.firstIndex = range.firstIndex;
+          op.indexCount = range.indexCount;
+          m_drawOps.push_back(op);
+        }
+        continue;
+      }
+      m_drawOps.push_back(op);
+      continue;
+    }
+
+    // Arena draws sharing state form one indirect batch
+    if (m_drawOps.empty() || m_drawOps.back().mesh != nullptr ||
+        m_drawOps.back().pipeline != item.pipeline ||
+        m_drawOps.back().dynamicOffset != item.dynamicOffset) {
+      DrawOp op;
+      op.pipeline = item.pipeline;
+      op.dynamicOffset = item.dynamicOffset;
+      op.firstCommand = static_cast<uint32_t>(m_indirectCommands.size());
+      op.batch = batchCount++;
+      m_drawOps.push_back(op);
+    }
+    DrawOp &batch = m_drawOps.back();
+
+    auto addCommand = [&](uint32_t firstIndex, uint32_t indexCount,
+                          const float boundingSphere[4], uint32_t cone) {
+      VkDrawIndexedIndirectCommand command{};
+      command.indexCount = indexCount;
+      command.instanceCount = item.instanceCount;
+      command.firstIndex = firstIndex;
+      command.vertexOffset = arenaMesh->vertexOffset;
+      command.firstInstance = firstInstance;
+      m_indirectCommands.push_back(command);
+      ++batch.commandCount;
+
+      if (culling) {
+        CullCandidate candidate;
+        std::memcpy(candidate.boundingSphere, boundingSphere,
+                    sizeof(candidate.boundingSphere));
+        candidate.indexCount = command.indexCount;
+        candidate.instanceCount = command.instanceCount;
+        candidate.firstIndex = command.firstIndex;
+        candidate.vertexOffset = command.vertexOffset;
+        candidate.firstInstance = command.firstInstance;
+        candidate.batch = batch.batch;
+        candidate.outputBase = batch.firstCommand;
+        candidate.cone = cone;
+        m_cullCandidates.push_back(candidate);
+      }
+    };
+
+    // Meshlets are culled one by one on the GPU while they take at most
+    // half of the culling pass; past its limit the whole frame would go
+    // unculled
+    const std::vector<Meshlet> &meshlets = item.mesh->GetMeshlets();
+    if (item.rangeCount > 0) {
+      for (uint32_t r = 0; r < item.rangeCount; ++r) {
+        const IndexRange &range = m_clusterRanges[item.firstRange + r];
+        addCommand(arenaMesh->firstIndex + range.firstIndex,
+                   range.indexCount, arenaMesh->boundingSphere, 0);
+      }
+    } else if (item.lod == 0 && !meshlets.empty() && ClusterCullingOnGpu() &&
+               m_cullCandidates.size() + meshlets.size() <=
+                   m_gpuCuller->GetMaxDraws() / 2) {
+      for (const Meshlet &meshlet : meshlets) {
+        addCommand(arenaMesh->firstIndex + meshlet.firstIndex,
+                   meshlet.indexCount, meshlet.boundingSphere, meshlet.cone);
+      }
+    } else if (item.lod > 0 && item.lod <= arenaMesh->lodCount) {
+      addCommand(arenaMesh->lodFirstIndex[item.lod - 1],
+                 arenaMesh->lodIndexCount[item.lod - 1],
+                 arenaMesh->boundingSphere, 0);
+    } else {
+      addCommand(arenaMesh->firstIndex, arenaMesh->indexCount,
+                 arenaMesh->boundingSphere, 0);
+    }
+  }
+
+  if (m_indirectCommands.empty()) {
+    return;
+  }
+
+  // Culled batches are compacted when the draw count can come from the GPU
+  if (culling) {
+    const bool compact = m_multiDrawIndirect && m_cmdDrawIndexedIndirectCount;
+    m_indirectCulled =
+        m_gpuCuller->Dispatch(commandBuffer, *m_frameAllocator,
+                              m_cullCandidates, batchCount, m_viewProjection,
+                              m_cameraPosition, compact);
+  }
+  if (m_indirectCulled) {
+    return;
+  }
+
+  const VkDeviceSize commandBytes =
+      sizeof(VkDrawIndexedIndirectCommand) * m_indirectCommands.size();
+  FrameAllocation block = m_frameAllocator->Allocate(commandBytes, 4);
+  if (!block.IsValid()) {
+    std::cerr << "RenderQueue: Out of per-frame memory for indirect commands, "
+                 "skipping "
+              << m_indirectCommands.size() << " draws" << '\n';
+    return;
+  }
+  std::memcpy(block.data, m_indirectCommands.data(), commandBytes);
+  m_indirectBuffer = block.buffer;
+  m_indirectOffset = block.offset;
+}
+
+void VulkanRenderer::RecordDraws(VkCommandBuffer commandBuffer) {
+  if (m_drawOps.empty()) {
+    return;
+  }
+
+  RenderQueueStats &stats = m_renderQueue.GetStats();
 
-  // Set viewport
-  std::cout << "RenderMesh: Setting viewport" << '\n';
+  // Viewport, scissor and push constants are the same for every draw
   VkViewport viewport{};
   viewport.x = 0.0f;
   viewport.y = 0.0f;
@@ -1637,93 +2370,153 @@ void VulkanRenderer::RenderMesh(const Mesh &mesh, const Texture *texture) {
   viewport.maxDepth = 1.0f;
   vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
 
-  // Set scissor
-  std::cout << "RenderMesh: Setting scissor" << '\n';
   VkRect2D scissor{};
   scissor.offset = {0, 0};
   scissor.extent = {m_swapChainExtent.width, m_swapChainExtent.height};
   vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
 
-  // Update animation time (simple increment for smooth animation)
-  m_animationTime += 0.016f; // Approximately 60 FPS
-
-  // Calculate aspect ratio
+  VkPipelineLayout pipelineLayout =
+      static_cast<VkPipelineLayout>(m_pipelineLayout);
   float aspectRatio = static_cast<float>(m_swapChainExtent.width) /
                       static_cast<float>(m_swapChainExtent.height);
-
-  // Push time and aspect ratio constants to shader
   float pushConstants[2] = {m_animationTime, aspectRatio};
-  std::cout << "RenderMesh: Pushing constants - time: " << m_animationTime
-            << ", aspect: " << aspectRatio << '\n';
-  vkCmdPushConstants(
-      commandBuffer, static_cast<VkPipelineLayout>(m_pipelineLayout),
-      VK_SHADER_STAGE_VERTEX_BIT, 0, 2 * sizeof(float), pushConstants);
-
-  // Check if mesh has valid data
-  if (mesh.GetVertexCount() > 0) {
-    // Use actual mesh data for rendering
-    std::cout << "RenderMesh: Rendering mesh with " << mesh.GetVertexCount()
-              << " vertices and " << mesh.GetIndexCount() << " indices"
-              << '\n';
+  vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT,
+                     0, 2 * sizeof(float), pushConstants);
 
-    // Create temporary vertex buffer for this mesh
-    auto vertexBuffer = BufferManager::Instance().CreateVertexBuffer(
-        mesh.GetVertices().data(), mesh.GetVertexCount() * sizeof(Vertex));
-
-    if (vertexBuffer) {
-      // Bind vertex buffer
-      VkBuffer vulkanVertexBuffer = vertexBuffer->GetVulkanBuffer();
-      VkDeviceSize offsets[] = {0};
-      vkCmdBindVertexBuffers(commandBuffer, 0, 1, &vulkanVertexBuffer, offsets);
-
-      if (mesh.GetIndexCount() > 0) {
-        // Create temporary index buffer
-        auto indexBuffer = BufferManager::Instance().CreateIndexBuffer(
-            mesh.GetIndices().data(), mesh.GetIndexCount());
-
-        if (indexBuffer) {
-          // Bind index buffer and draw indexed
-          VkBuffer vulkanIndexBuffer = indexBuffer->GetVulkanBuffer();
-          vkCmdBindIndexBuffer(commandBuffer, vulkanIndexBuffer, 0,
+  // Instance records of all draws live in the frame allocator buffer and are
+  // selected through firstInstance
+  VkBuffer instanceBuffer = m_frameAllocator->GetBuffer();
+  VkDeviceSize instanceBase = 0;
+  vkCmdBindVertexBuffers(commandBuffer, 1, 1, &instanceBuffer, &instanceBase);
+  ++stats.instanceBufferBinds;
+
+  VkDescriptorSet descriptorSet =
+      static_cast<VkDescriptorSet>(m_descriptorSets[m_currentFrame]);
+
+  uint32_t boundPipeline = UINT32_MAX;
+  uint32_t boundDynamicOffset = UINT32_MAX;
+  VkBuffer boundVertexBuffer = VK_NULL_HANDLE;
+  VkBuffer boundIndexBuffer = VK_NULL_HANDLE;
+
+  for (const DrawOp &op : m_drawOps) {
+    if (op.pipeline != boundPipeline) {
+      vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                        static_cast<VkPipeline>(m_graphicsPipeline));
+      boundPipeline = op.pipeline;
+      ++stats.pipelineBinds;
+    }
+    if (op.dynamicOffset != boundDynamicOffset) {
+      vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                              pipelineLayout, 0, 1, &descriptorSet, 1,
+                              &op.dynamicOffset);
+      boundDynamicOffset = op.dynamicOffset;
+      ++stats.descriptorBinds;
+    }
+
+    if (!op.mesh) {
+      VkBuffer arenaVertexBuffer = m_geometryArena->GetVertexBuffer();
+      if (arenaVertexBuffer != boundVertexBuffer) {
+        VkDeviceSize offsets[] = {0};
+        vkCmdBindVertexBuffers(commandBuffer, 0, 1, &arenaVertexBuffer,
+                               offsets);
+        boundVertexBuffer = arenaVertexBuffer;
+        ++stats.vertexBufferBinds;
+      }
+      if (m_geometryArena->GetIndexBuffer() != boundIndexBuffer) {
+        boundIndexBuffer = m_geometryArena->GetIndexBuffer();
+        vkCmdBindIndexBuffer(commandBuffer, boundIndexBuffer, 0,
+                             VK_INDEX_TYPE_UINT32);
+        ++stats.indexBufferBinds;
+      }
+
+      RecordIndirectBatch(commandBuffer, op);
+      continue;
+    }
+
+    const uint32_t firstInstance =
+        op.instanceOffset / static_cast<uint32_t>(sizeof(InstanceData));
+
+    if (op.gpuMesh) {
+      const MeshGpuData *gpuMesh = op.gpuMesh;
+      if (gpuMesh->vertexBuffer != boundVertexBuffer) {
+        VkDeviceSize offsets[] = {0};
+        vkCmdBindVertexBuffers(commandBuffer, 0, 1, &gpuMesh->vertexBuffer,
+                               offsets);
+        boundVertexBuffer = gpuMesh->vertexBuffer;
+        ++stats.vertexBufferBinds;
+      }
+
+      if (gpuMesh->indexCount > 0) {
+        if (gpuMesh->indexBuffer != boundIndexBuffer) {
+          vkCmdBindIndexBuffer(commandBuffer, gpuMesh->indexBuffer, 0,
                                VK_INDEX_TYPE_UINT32);
-          vkCmdDrawIndexed(commandBuffer, mesh.GetIndexCount(), 1, 0, 0, 0);
-          std::cout << "RenderMesh: Drew " << mesh.GetIndexCount() << " indices"
-                    << '\n';
-        } else {
-          std::cerr << "RenderMesh: Failed to create index buffer, falling "
-                       "back to vertex draw"
-                    << '\n';
-          vkCmdDraw(commandBuffer, mesh.GetVertexCount(), 1, 0, 0);
+          boundIndexBuffer = gpuMesh->indexBuffer;
+          ++stats.indexBufferBinds;
         }
+        vkCmdDrawIndexed(commandBuffer, op.indexCount, op.instanceCount,
+                         op.firstIndex, 0, firstInstance);
       } else {
-        // Draw without indices
-        vkCmdDraw(commandBuffer, mesh.GetVertexCount(), 1, 0, 0);
-        std::cout << "RenderMesh: Drew " << mesh.GetVertexCount() << " vertices"
-                  << '\n';
+        vkCmdDraw(commandBuffer, gpuMesh->vertexCount, op.instanceCount, 0,
+                  firstInstance);
       }
-    } else {
-      std::cerr << "RenderMesh: Failed to create vertex buffer, using fallback"
+      ++stats.drawCalls;
+    } else if (op.mesh->GetVertexCount() > 0) {
+      std::cerr << "RenderMesh: Failed to make mesh resident, skipping draw"
                 << '\n';
-      // Fallback to hardcoded cube
-      vkCmdDraw(commandBuffer, 36, 1, 0, 0);
+    } else {
+      // Fallback: draw hardcoded cube when no mesh data is available
+      vkCmdDraw(commandBuffer, 36, op.instanceCount, 0, firstInstance);
+      ++stats.drawCalls;
     }
-  } else {
-    // Fallback: draw hardcoded cube when no mesh data is available
-    std::cout << "RenderMesh: No mesh data available, using hardcoded cube"
-              << '\n';
-    vkCmdDraw(commandBuffer, 36, 1, 0, 0);
   }
 
-  // Handle texture information
-  if (texture) {
-    std::cout << "RenderMesh: Texture provided and bound via descriptor set"
-              << '\n';
+  std::cout << "RenderQueue: " << stats.drawCalls << " draw calls ("
+            << stats.indirectCommands << " indirect commands, "
+            << stats.instances << " instances), " << stats.pipelineBinds
+            << " pipeline binds, " << stats.vertexBufferBinds
+            << " vertex buffer binds, " << stats.indexBufferBinds
+            << " index buffer binds" << '\n';
+}
+
+void VulkanRenderer::RecordIndirectBatch(VkCommandBuffer commandBuffer,
+                                         const DrawOp &op) {
+  RenderQueueStats &stats = m_renderQueue.GetStats();
+  const uint32_t stride = sizeof(VkDrawIndexedIndirectCommand);
+
+  VkBuffer buffer = m_indirectBuffer;
+  VkDeviceSize offset =
+      m_indirectOffset + static_cast<VkDeviceSize>(op.firstCommand) * stride;
+  if (m_indirectCulled) {
+    buffer = m_gpuCuller->GetCommandBuffer();
+    offset = static_cast<VkDeviceSize>(op.firstCommand) * stride;
+  }
+  if (buffer == VK_NULL_HANDLE) {
+    return;
+  }
+
+  if (m_indirectCulled && m_multiDrawIndirect &&
+      m_cmdDrawIndexedIndirectCount) {
+    // Only the surviving draws, counted by the culling pass
+    m_cmdDrawIndexedIndirectCount(
+        commandBuffer, buffer, offset, m_gpuCuller->GetCountBuffer(),
+        static_cast<VkDeviceSize>(op.batch) * sizeof(uint32_t),
+        op.commandCount, stride);
+    ++stats.drawCalls;
+  } else if (m_multiDrawIndirect) {
+    vkCmdDrawIndexedIndirect(commandBuffer, buffer, offset, op.commandCount,
+                             stride);
+    ++stats.drawCalls;
   } else {
-    std::cout << "RenderMesh: Using default texture via descriptor set"
-              << '\n';
+    // Without multiDrawIndirect every command needs its own call
+    for (uint32_t i = 0; i < op.commandCount; ++i) {
+      vkCmdDrawIndexedIndirect(
+          commandBuffer, buffer,
+          offset + static_cast<VkDeviceSize>(i) * stride, 1, stride);
+    }
+    stats.drawCalls += op.commandCount;
   }
 
-  std::cout << "RenderMesh: Mesh rendering completed" << '\n';
+  stats.indirectCommands += op.commandCount;
 }
 
 void VulkanRenderer::Clear(float r, float g, float b, float a) {
@@ -1794,11 +2587,26 @@ bool VulkanRenderer::CreateDepthResources() {
 
   m_depthFormat = FindDepthFormat();
 
+  // The occlusion culling pyramid samples the depth buffer
+  m_depthSampled = false;
+  if (m_config.enableGpuCulling && m_config.enableOcclusionCulling) {
+    VkFormatProperties props;
+    vkGetPhysicalDeviceFormatProperties(
+        static_cast<VkPhysicalDevice>(m_physicalDevice),
+        static_cast<VkFormat>(m_depthFormat), &props);
+    m_depthSampled = (props.optimalTilingFeatures &
+                      VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT) != 0;
+  }
+
+  uint32_t usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+  if (m_depthSampled) {
+    usage |= VK_IMAGE_USAGE_SAMPLED_BIT;
+  }
+
   if (!CreateImage(m_swapChainExtent.width, m_swapChainExtent.height,
-                   m_depthFormat, VK_IMAGE_TILING_OPTIMAL,
-                   VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
+                   m_depthFormat, VK_IMAGE_TILING_OPTIMAL, usage,
                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_depthImage,
-                   m_depthImageMemory)) {
+                   m_depthImageAllocation)) {
     std::cerr << "Failed to create depth image" << '\n';
     return false;
   }
@@ -1854,7 +2662,8 @@ bool VulkanRenderer::HasStencilComponent(uint32_t format) {
 bool VulkanRenderer::CreateImage(uint32_t width, uint32_t height,
                                  uint32_t format, uint32_t tiling,
                                  uint32_t usage, uint32_t properties,
-                                 void *&image, void *&imageMemory) {
+                                 void *&image,
+                                 MemoryAllocation &imageAllocation) {
   VkDevice device = static_cast<VkDevice>(m_device);
 
   VkImageCreateInfo imageInfo{};
@@ -1878,27 +2687,15 @@ bool VulkanRenderer::CreateImage(uint32_t width, uint32_t height,
     return false;
   }
 
-  VkMemoryRequirements memRequirements;
-  vkGetImageMemoryRequirements(device, vkImage, &memRequirements);
-
-  VkMemoryAllocateInfo allocInfo{};
-  allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-  allocInfo.allocationSize = memRequirements.size;
-  allocInfo.memoryTypeIndex =
-      FindMemoryType(memRequirements.memoryTypeBits, properties);
-
-  VkDeviceMemory vkImageMemory;
-  if (vkAllocateMemory(device, &allocInfo, nullptr, &vkImageMemory) !=
-      VK_SUCCESS) {
+  if (!MemoryAllocator::Instance().AllocateForImage(
+          vkImage, static_cast<VkMemoryPropertyFlags>(properties),
+          imageAllocation)) {
     std::cerr << "Failed to allocate image memory" << '\n';
     vkDestroyImage(device, vkImage, nullptr);
     return false;
   }
 
-  vkBindImageMemory(device, vkImage, vkImageMemory, 0);
-
   image = static_cast<void *>(vkImage);
-  imageMemory = static_cast<void *>(vkImageMemory);
 
   return true;
 }
@@ -1928,27 +2725,9 @@ void *VulkanRenderer::CreateImageView(void *image, uint32_t format,
   return static_cast<void *>(imageView);
 }
 
-uint32_t VulkanRenderer::FindMemoryType(uint32_t typeFilter,
-                                        uint32_t properties) {
-  VkPhysicalDevice physicalDevice =
-      static_cast<VkPhysicalDevice>(m_physicalDevice);
-
-  VkPhysicalDeviceMemoryProperties memProperties;
-  vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memProperties);
-
-  for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++) {
-    if ((typeFilter & (1 << i)) && (memProperties.memoryTypes[i].propertyFlags &
-                                    properties) == properties) {
-      return i;
-    }
-  }
-
-  throw std::runtime_error("Failed to find suitable memory type");
-}
-
 bool VulkanRenderer::CreateBuffer(uint64_t size, uint32_t usage,
                                   uint32_t properties, void *&buffer,
-                                  void *&bufferMemory) {
+                                  MemoryAllocation &bufferAllocation) {
   VkDevice device = static_cast<VkDevice>(m_device);
 
   VkBufferCreateInfo bufferInfo{};
@@ -1963,59 +2742,41 @@ bool VulkanRenderer::CreateBuffer(uint64_t size, uint32_t usage,
     return false;
   }
 
-  VkMemoryRequirements memRequirements;
-  vkGetBufferMemoryRequirements(device, vkBuffer, &memRequirements);
-
-  VkMemoryAllocateInfo allocInfo{};
-  allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-  allocInfo.allocationSize = memRequirements.size;
-  allocInfo.memoryTypeIndex =
-      FindMemoryType(memRequirements.memoryTypeBits, properties);
-
-  VkDeviceMemory vkBufferMemory;
-  if (vkAllocateMemory(device, &allocInfo, nullptr, &vkBufferMemory) !=
-      VK_SUCCESS) {
+  if (!MemoryAllocator::Instance().AllocateForBuffer(
+          vkBuffer, static_cast<VkMemoryPropertyFlags>(properties),
+          bufferAllocation)) {
     std::cerr << "Failed to allocate buffer memory" << '\n';
     vkDestroyBuffer(device, vkBuffer, nullptr);
     return false;
   }
 
-  vkBindBufferMemory(device, vkBuffer, vkBufferMemory, 0);
-
   buffer = static_cast<void *>(vkBuffer);
-  bufferMemory = static_cast<void *>(vkBufferMemory);
 
   return true;
 }
 
-bool VulkanRenderer::CreateUniformBuffers() {
-  std::cout << "Creating uniform buffers..." << '\n';
-
-  uint64_t bufferSize = sizeof(CameraUBO);
-
-  m_uniformBuffers.resize(MAX_FRAMES_IN_FLIGHT);
-  m_uniformBuffersMemory.resize(MAX_FRAMES_IN_FLIGHT);
-  m_uniformBuffersMapped.resize(MAX_FRAMES_IN_FLIGHT);
-
-  for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-    if (!CreateBuffer(bufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-                      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
-                          VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                      m_uniformBuffers[i], m_uniformBuffersMemory[i])) {
-      std::cerr << "Failed to create uniform buffer " << i << '\n';
-      return false;
-    }
+void VulkanRenderer::DestroyBuffer(void *&buffer,
+                                   MemoryAllocation &bufferAllocation) {
+  if (buffer != nullptr && m_device != nullptr) {
+    vkDestroyBuffer(static_cast<VkDevice>(m_device),
+                    static_cast<VkBuffer>(buffer), nullptr);
+    buffer = nullptr;
+  }
+  MemoryAllocator::Instance().Free(bufferAllocation);
+}
 
-    // Map the buffer memory
-    VkDevice device = static_cast<VkDevice>(m_device);
-    VkDeviceMemory memory =
-        static_cast<VkDeviceMemory>(m_uniformBuffersMemory[i]);
-    void *mapped;
-    if (vkMapMemory(device, memory, 0, bufferSize, 0, &mapped) != VK_SUCCESS) {
-      std::cerr << "Failed to map uniform buffer memory " << i << '\n';
-      return false;
-    }
-    m_uniformBuffersMapped[i] = mapped;
+bool VulkanRenderer::CreateUniformBuffers() {
+  std::cout << "Creating per-frame uniform allocator..." << '\n';
+
+  // One mapped buffer holds every draw's uniform block for all frames in
+  // flight; draws select their block through a dynamic offset
+  m_frameAllocator = std::make_unique<FrameAllocator>();
+  if (!m_frameAllocator->Initialize(
+          static_cast<VkDevice>(m_device),
+          static_cast<VkPhysicalDevice>(m_physicalDevice),
+          MAX_FRAMES_IN_FLIGHT, m_config.frameUniformSize)) {
+    std::cerr << "Failed to create per-frame uniform allocator" << '\n';
+    return false;
   }
 
   std::cout << "Uniform buffers created successfully" << '\n';
@@ -2028,7 +2789,7 @@ bool VulkanRenderer::CreateDescriptorSetLayout() {
   // Uniform buffer binding (binding = 0)
   VkDescriptorSetLayoutBinding uboLayoutBinding{};
   uboLayoutBinding.binding = 0;
-  uboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+  uboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
   uboLayoutBinding.descriptorCount = 1;
   uboLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
   uboLayoutBinding.pImmutableSamplers = nullptr;
@@ -2069,7 +2830,7 @@ bool VulkanRenderer::CreateDescriptorPool() {
   std::array<VkDescriptorPoolSize, 2> poolSizes{};
 
   // Uniform buffer pool size
-  poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+  poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
   poolSizes[0].descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
 
   // Combined image sampler pool size
@@ -2118,11 +2879,11 @@ bool VulkanRenderer::CreateDescriptorSets() {
 
   m_descriptorSets.resize(MAX_FRAMES_IN_FLIGHT);
   for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-    // Uniform buffer descriptor
+    // Uniform buffer descriptor, the block is selected per draw
     VkDescriptorBufferInfo bufferInfo{};
-    bufferInfo.buffer = static_cast<VkBuffer>(m_uniformBuffers[i]);
+    bufferInfo.buffer = m_frameAllocator->GetBuffer();
     bufferInfo.offset = 0;
-    bufferInfo.range = sizeof(CameraUBO);
+    bufferInfo.range = sizeof(ObjectUBO);
 
     // Texture sampler descriptor
     VkDescriptorImageInfo imageInfo{};
@@ -2137,7 +2898,8 @@ bool VulkanRenderer::CreateDescriptorSets() {
     descriptorWrites[0].dstSet = descriptorSets[i];
     descriptorWrites[0].dstBinding = 0;
     descriptorWrites[0].dstArrayElement = 0;
-    descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    descriptorWrites[0].descriptorType =
+        VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
     descriptorWrites[0].descriptorCount = 1;
     descriptorWrites[0].pBufferInfo = &bufferInfo;
 
@@ -2162,20 +2924,60 @@ bool VulkanRenderer::CreateDescriptorSets() {
   return true;
 }
 
-void VulkanRenderer::UpdateUniformBuffer(uint32_t currentImage) {
-  if (currentImage >= m_uniformBuffersMapped.size()) {
-    std::cerr << "UpdateUniformBuffer: Invalid current image index: "
-              << currentImage << '\n';
-    return;
+bool VulkanRenderer::WriteObjectUniforms(
+    const Matrix4 &modelMatrix, uint32_t &dynamicOffset,
+    const VertexQuantization *quantization) {
+  FrameAllocation block = m_frameAllocator->Allocate(sizeof(ObjectUBO));
+  if (!block.IsValid()) {
+    return false;
   }
 
-  void *data = m_uniformBuffersMapped[currentImage];
-  if (data) {
-    std::memcpy(data, &m_currentCameraUBO, sizeof(CameraUBO));
-  } else {
-    std::cerr << "UpdateUniformBuffer: Uniform buffer not mapped for frame "
-              << currentImage << '\n';
+  ObjectUBO *ubo = static_cast<ObjectUBO *>(block.data);
+  std::memcpy(ubo->viewMatrix, m_currentCameraUBO.viewMatrix,
+              sizeof(ubo->viewMatrix));
+  std::memcpy(ubo->projectionMatrix, m_currentCameraUBO.projectionMatrix,
+              sizeof(ubo->projectionMatrix));
+  std::memcpy(ubo->modelMatrix, modelMatrix.Data(), sizeof(ubo->modelMatrix));
+  const VertexQuantization identity;
+  const VertexQuantization &mapping = quantization ? *quantization : identity;
+  for (int axis = 0; axis < 3; ++axis) {
+    ubo->positionOffset[axis] = mapping.offset[axis];
+    ubo->positionScale[axis] = mapping.scale[axis];
+  }
+  ubo->positionOffset[3] = 0.0f;
+  ubo->positionScale[3] = 0.0f;
+
+  dynamicOffset = block.offset;
+  return true;
+}
+
+bool VulkanRenderer::AcquireUniformBlock(const Mesh &mesh,
+                                         uint32_t &dynamicOffset) {
+  // Camera matrices, shared until the camera changes
+  if (!m_config.packedVertices) {
+    if (m_cameraBlockOffset == UINT32_MAX &&
+        !WriteObjectUniforms(Matrix4::Identity(), m_cameraBlockOffset)) {
+      m_cameraBlockOffset = UINT32_MAX;
+      return false;
+    }
+    dynamicOffset = m_cameraBlockOffset;
+    return true;
   }
+
+  // Instances of a mesh still share one block and one indirect batch
+  MeshBlock &block = m_meshBlocks[mesh.GetId()];
+  if (block.offset == UINT32_MAX || block.version != mesh.GetVersion()) {
+    const VertexQuantization quantization =
+        VertexPacking::ComputeQuantization(mesh.GetBounds());
+    if (!WriteObjectUniforms(Matrix4::Identity(), block.offset,
+                             &quantization)) {
+      m_meshBlocks.erase(mesh.GetId());
+      return false;
+    }
+    block.version = mesh.GetVersion();
+  }
+  dynamicOffset = block.offset;
+  return true;
 }
 
 void VulkanRenderer::OnWindowResize(int width, int height) {
@@ -2210,6 +3012,16 @@ void VulkanRenderer::OnWindowResize(int width, int height) {
       return;
     }
 
+    // The depth pyramid follows the depth buffer size
+    if (m_gpuCuller) {
+      m_gpuCuller->SetDepthSource(
+          m_depthSampled ? static_cast<VkImage>(m_depthImage) : VK_NULL_HANDLE,
+          m_depthSampled ? static_cast<VkImageView>(m_depthImageView)
+                         : VK_NULL_HANDLE,
+          static_cast<VkFormat>(m_depthFormat), m_swapChainExtent.width,
+          m_swapChainExtent.height);
+    }
+
     if (!CreateFramebuffers()) {
       std::cerr << "Failed to recreate framebuffers after resize" << '\n';
       return;
@@ -2296,30 +3108,35 @@ bool VulkanRenderer::CreateTextureImage() {
   VkDeviceSize imageSize = texWidth * texHeight * texChannels;
 
   // Create staging buffer
-  void *stagingBuffer, *stagingBufferMemory;
+  void *stagingBuffer = nullptr;
+  MemoryAllocation stagingBufferAllocation;
   if (!CreateBuffer(imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
                         VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                    stagingBuffer, stagingBufferMemory)) {
+                    stagingBuffer, stagingBufferAllocation)) {
     std::cerr << "Failed to create staging buffer for texture" << '\n';
     return false;
   }
 
   // Copy pixel data to staging buffer
-  VkDevice device = static_cast<VkDevice>(m_device);
-  void *data;
-  vkMapMemory(device, static_cast<VkDeviceMemory>(stagingBufferMemory), 0,
-              imageSize, 0, &data);
+  MemoryAllocator &allocator = MemoryAllocator::Instance();
+  void *data = allocator.Map(stagingBufferAllocation);
+  if (data == nullptr) {
+    std::cerr << "Failed to map staging buffer for texture" << '\n';
+    DestroyBuffer(stagingBuffer, stagingBufferAllocation);
+    return false;
+  }
   memcpy(data, pixels, static_cast<size_t>(imageSize));
-  vkUnmapMemory(device, static_cast<VkDeviceMemory>(stagingBufferMemory));
+  allocator.Unmap(stagingBufferAllocation);
 
   // Create texture image
   if (!CreateImage(texWidth, texHeight, VK_FORMAT_R8G8B8A8_SRGB,
                    VK_IMAGE_TILING_OPTIMAL,
                    VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_textureImage,
-                   m_textureImageMemory)) {
+                   m_textureImageAllocation)) {
     std::cerr << "Failed to create texture image" << '\n';
+    DestroyBuffer(stagingBuffer, stagingBufferAllocation);
     return false;
   }
 
@@ -2333,9 +3150,7 @@ bool VulkanRenderer::CreateTextureImage() {
                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
 
   // Clean up staging buffer
-  vkDestroyBuffer(device, static_cast<VkBuffer>(stagingBuffer), nullptr);
-  vkFreeMemory(device, static_cast<VkDeviceMemory>(stagingBufferMemory),
-               nullptr);
+  DestroyBuffer(stagingBuffer, stagingBufferAllocation);
 
   std::cout << "Texture image created successfully" << '\n';
   return true;
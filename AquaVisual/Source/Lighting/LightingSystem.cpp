@@ -7,7 +7,6 @@ namespace Lighting {
 
 LightingSystem::LightingSystem()
     : m_device(VK_NULL_HANDLE), m_uniformBuffer(VK_NULL_HANDLE),
-      m_uniformBufferMemory(VK_NULL_HANDLE),
       m_descriptorSetLayout(VK_NULL_HANDLE), m_descriptorPool(VK_NULL_HANDLE),
       m_descriptorSet(VK_NULL_HANDLE), m_needsUpdate(true) {
 
@@ -82,10 +81,11 @@ void LightingSystem::Cleanup() {
       m_uniformBuffer = VK_NULL_HANDLE;
     }
 
-    if (m_uniformBufferMemory != VK_NULL_HANDLE) {
-      vkFreeMemory(m_device, m_uniformBufferMemory, nullptr);
-      m_uniformBufferMemory = VK_NULL_HANDLE;
+    if (m_uniformBufferMapped != nullptr) {
+      MemoryAllocator::Instance().Unmap(m_uniformBufferAllocation);
+      m_uniformBufferMapped = nullptr;
     }
+    MemoryAllocator::Instance().Free(m_uniformBufferAllocation);
   }
 
   std::cout << "LightingSystem cleanup completed" << std::endl;
@@ -212,16 +212,12 @@ void LightingSystem::UpdateUBO() {
     return;
   }
 
-  void *data;
-  VkResult result = vkMapMemory(m_device, m_uniformBufferMemory, 0,
-                                sizeof(LightingUBO), 0, &data);
-  if (result != VK_SUCCESS) {
-    std::cerr << "Failed to map uniform buffer memory" << std::endl;
+  if (m_uniformBufferMapped == nullptr) {
+    std::cerr << "Uniform buffer memory is not mapped" << std::endl;
     return;
   }
 
-  memcpy(data, &m_lightingData, sizeof(LightingUBO));
-  vkUnmapMemory(m_device, m_uniformBufferMemory);
+  memcpy(m_uniformBufferMapped, &m_lightingData, sizeof(LightingUBO));
 
   m_needsUpdate = false;
 }
@@ -257,27 +253,20 @@ bool LightingSystem::CreateUniformBuffer(VkPhysicalDevice physicalDevice) {
     return false;
   }
 
-  VkMemoryRequirements memRequirements;
-  vkGetBufferMemoryRequirements(m_device, m_uniformBuffer, &memRequirements);
-
-  VkMemoryAllocateInfo allocInfo = {};
-  allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-  allocInfo.allocationSize = memRequirements.size;
-  allocInfo.memoryTypeIndex = FindMemoryType(
-      memRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
-                                          VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-
-  result =
-      vkAllocateMemory(m_device, &allocInfo, nullptr, &m_uniformBufferMemory);
-  if (result != VK_SUCCESS) {
+  MemoryAllocator &allocator = MemoryAllocator::Instance();
+  if (!allocator.Initialize(m_device, physicalDevice) ||
+      !allocator.AllocateForBuffer(m_uniformBuffer,
+                                   VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                                       VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                   m_uniformBufferAllocation)) {
     std::cerr << "Failed to allocate uniform buffer memory" << std::endl;
     return false;
   }
 
-  result =
-      vkBindBufferMemory(m_device, m_uniformBuffer, m_uniformBufferMemory, 0);
-  if (result != VK_SUCCESS) {
-    std::cerr << "Failed to bind uniform buffer memory" << std::endl;
+  // Mapped for the lifetime of the buffer
+  m_uniformBufferMapped = allocator.Map(m_uniformBufferAllocation);
+  if (m_uniformBufferMapped == nullptr) {
+    std::cerr << "Failed to map uniform buffer memory" << std::endl;
     return false;
   }
 
@@ -370,22 +359,6 @@ void LightingSystem::UpdateDescriptorSet() {
   vkUpdateDescriptorSets(m_device, 1, &descriptorWrite, 0, nullptr);
 }
 
-uint32_t LightingSystem::FindMemoryType(uint32_t typeFilter,
-                                        VkMemoryPropertyFlags properties) {
-  VkPhysicalDeviceMemoryProperties memProperties;
-  vkGetPhysicalDeviceMemoryProperties(m_physicalDevice, &memProperties);
-
-  for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++) {
-    if ((typeFilter & (1 << i)) && (memProperties.memoryTypes[i].propertyFlags &
-                                    properties) == properties) {
-      return i;
-    }
-  }
-
-  std::cerr << "Failed to find suitable memory type" << std::endl;
-  return 0;
-}
-
 void LightingSystem::PrintLightingInfo() const {
   std::cout << "=== Lighting System Info ===" << std::endl;
   std::cout << "Ambient Light: (" << m_lightingData.ambientColor.x << ", "
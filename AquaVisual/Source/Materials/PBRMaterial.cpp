@@ -13,7 +13,6 @@ namespace Materials {
 PBRMaterial::PBRMaterial() : 
     m_device(VK_NULL_HANDLE),
     m_uniformBuffer(VK_NULL_HANDLE),
-    m_uniformBufferMemory(VK_NULL_HANDLE),
     m_uniformBufferMapped(nullptr),
     m_descriptorSetLayout(VK_NULL_HANDLE),
     m_descriptorPool(VK_NULL_HANDLE),
@@ -82,10 +81,10 @@ void PBRMaterial::Cleanup() {
             m_uniformBuffer = VK_NULL_HANDLE;
         }
 
-        if (m_uniformBufferMemory != VK_NULL_HANDLE) {
-            vkFreeMemory(m_device, m_uniformBufferMemory, nullptr);
-            m_uniformBufferMemory = VK_NULL_HANDLE;
+        if (m_uniformBufferMapped != nullptr) {
+            MemoryAllocator::Instance().Unmap(m_uniformBufferAllocation);
         }
+        MemoryAllocator::Instance().Free(m_uniformBufferAllocation);
 
         m_uniformBufferMapped = nullptr;
         m_device = VK_NULL_HANDLE;
@@ -187,21 +186,15 @@ bool PBRMaterial::CreateUniformBuffer(VkPhysicalDevice physicalDevice) {
         return false;
     }
 
-    VkMemoryRequirements memRequirements;
-    vkGetBufferMemoryRequirements(m_device, m_uniformBuffer, &memRequirements);
-
-    VkMemoryAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    allocInfo.allocationSize = memRequirements.size;
-    allocInfo.memoryTypeIndex = FindMemoryType(physicalDevice, memRequirements.memoryTypeBits, 
-                                               VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-
-    if (vkAllocateMemory(m_device, &allocInfo, nullptr, &m_uniformBufferMemory) != VK_SUCCESS) {
+    MemoryAllocator& allocator = MemoryAllocator::Instance();
+    if (!allocator.Initialize(m_device, physicalDevice) ||
+        !allocator.AllocateForBuffer(m_uniformBuffer,
+                                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                     m_uniformBufferAllocation)) {
         return false;
     }
 
-    vkBindBufferMemory(m_device, m_uniformBuffer, m_uniformBufferMemory, 0);
-    vkMapMemory(m_device, m_uniformBufferMemory, 0, bufferSize, 0, &m_uniformBufferMapped);
+    m_uniformBufferMapped = allocator.Map(m_uniformBufferAllocation);
 
     return true;
 }
@@ -264,19 +257,6 @@ void PBRMaterial::UpdateDescriptorSet() {
     vkUpdateDescriptorSets(m_device, 1, &descriptorWrite, 0, nullptr);
 }
 
-uint32_t PBRMaterial::FindMemoryType(VkPhysicalDevice physicalDevice, uint32_t typeFilter, VkMemoryPropertyFlags properties) {
-    VkPhysicalDeviceMemoryProperties memProperties;
-    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memProperties);
-
-    for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++) {
-        if ((typeFilter & (1 << i)) && (memProperties.memoryTypes[i].propertyFlags & properties) == properties) {
-            return i;
-        }
-    }
-
-    throw std::runtime_error("Failed to find suitable memory type!");
-}
-
 // MaterialPresets 实现
 PBRMaterialData MaterialPresets::GetGoldMaterial() {
     PBRMaterialData material;
@@ -0,0 +1,512 @@
+#include "AquaVisual/Math/Geometry.h"
+#include "AquaVisual/Math/Simd.h"
+#include <algorithm>
+#include <bitset>
+#include <cmath>
+#include <limits>
+
+namespace AquaVisual {
+
+namespace {
+
+using Simd::FloatN;
+using Simd::MaskN;
+
+constexpr float EPSILON = 1e-7f;
+
+Vector3 Min(const Vector3& a, const Vector3& b) {
+    return Vector3(std::min(a.x, b.x), std::min(a.y, b.y), std::min(a.z, b.z));
+}
+
+Vector3 Max(const Vector3& a, const Vector3& b) {
+    return Vector3(std::max(a.x, b.x), std::max(a.y, b.y), std::max(a.z, b.z));
+}
+
+// Frustum planes broadcast across a register each, shared by every batch
+struct FrustumLanes {
+    FloatN normalX[Frustum::PLANE_COUNT];
+    FloatN normalY[Frustum::PLANE_COUNT];
+    FloatN normalZ[Frustum::PLANE_COUNT];
+    FloatN distance[Frustum::PLANE_COUNT];
+};
+
+FrustumLanes SplatPlanes(const Frustum& frustum) {
+    FrustumLanes lanes;
+    for (int i = 0; i < Frustum::PLANE_COUNT; i++) {
+        const Plane& plane = frustum.GetPlane(i);
+        lanes.normalX[i] = Simd::SplatN(plane.normal.x);
+        lanes.normalY[i] = Simd::SplatN(plane.normal.y);
+        lanes.normalZ[i] = Simd::SplatN(plane.normal.z);
+        lanes.distance[i] = Simd::SplatN(plane.distance);
+    }
+    return lanes;
+}
+
+FloatN PlaneDistance(const FrustumLanes& planes, int i, FloatN x, FloatN y,
+                     FloatN z) {
+    FloatN distance = Simd::MulAdd(planes.normalX[i], x, planes.distance[i]);
+    distance = Simd::MulAdd(planes.normalY[i], y, distance);
+    return Simd::MulAdd(planes.normalZ[i], z, distance);
+}
+
+// Lanes whose sphere lies entirely behind some plane
+int CulledSpheres(const FrustumLanes& planes, FloatN centerX, FloatN centerY,
+                  FloatN centerZ, FloatN radius) {
+    const FloatN negativeRadius = Simd::Sub(Simd::SplatN(0.0f), radius);
+    MaskN outside = Simd::Less(
+        PlaneDistance(planes, 0, centerX, centerY, centerZ), negativeRadius);
+    for (int i = 1; i < Frustum::PLANE_COUNT; i++) {
+        outside = Simd::Or(
+            outside,
+            Simd::Less(PlaneDistance(planes, i, centerX, centerY, centerZ),
+                       negativeRadius));
+    }
+    return Simd::MoveMask(outside);
+}
+
+// Lanes whose box lies entirely behind some plane: the center's distance
+// plus the extents projected onto the plane normal is negative, as in
+// Frustum::Intersects(AABB)
+int CulledBoxes(const FrustumLanes& planes, FloatN centerX, FloatN centerY,
+                FloatN centerZ, FloatN extentX, FloatN extentY,
+                FloatN extentZ) {
+    const FloatN zero = Simd::SplatN(0.0f);
+    auto behind = [&](int i) {
+        FloatN radius = Simd::Mul(Simd::Abs(planes.normalX[i]), extentX);
+        radius = Simd::MulAdd(Simd::Abs(planes.normalY[i]), extentY, radius);
+        radius = Simd::MulAdd(Simd::Abs(planes.normalZ[i]), extentZ, radius);
+        const FloatN distance =
+            PlaneDistance(planes, i, centerX, centerY, centerZ);
+        return Simd::Less(Simd::Add(distance, radius), zero);
+    };
+
+    MaskN outside = behind(0);
+    for (int i = 1; i < Frustum::PLANE_COUNT; i++) {
+        outside = Simd::Or(outside, behind(i));
+    }
+    return Simd::MoveMask(outside);
+}
+
+void ClearMask(uint32_t* visibleMask, size_t count) {
+    std::fill(visibleMask, visibleMask + (count + 31) / 32, 0u);
+}
+
+void MarkVisible(uint32_t* visibleMask, size_t index) {
+    visibleMask[index / 32] |= 1u << (index % 32);
+}
+
+// Set the bits of the lanes not culled for the batch starting at `index`, a
+// multiple of Simd::WIDTH, so the batch never straddles two words
+size_t MarkLanes(uint32_t* visibleMask, size_t index, int culled) {
+    const uint32_t lanes = ~static_cast<uint32_t>(culled) &
+                           ((1u << Simd::WIDTH) - 1u);
+    visibleMask[index / 32] |= lanes << (index % 32);
+    return std::bitset<Simd::WIDTH>(lanes).count();
+}
+
+} // namespace
+
+// AABB
+
+AABB::AABB()
+    : minimum(std::numeric_limits<float>::max()),
+      maximum(-std::numeric_limits<float>::max()) {}
+
+AABB::AABB(const Vector3& minimum, const Vector3& maximum)
+    : minimum(minimum), maximum(maximum) {}
+
+AABB AABB::FromCenterExtents(const Vector3& center, const Vector3& extents) {
+    return AABB(center - extents, center + extents);
+}
+
+bool AABB::IsValid() const {
+    return minimum.x <= maximum.x && minimum.y <= maximum.y &&
+           minimum.z <= maximum.z;
+}
+
+Vector3 AABB::GetCenter() const {
+    return (minimum + maximum) * 0.5f;
+}
+
+Vector3 AABB::GetExtents() const {
+    return (maximum - minimum) * 0.5f;
+}
+
+float AABB::GetSurfaceArea() const {
+    if (!IsValid()) {
+        return 0.0f;
+    }
+    const Vector3 size = maximum - minimum;
+    return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+void AABB::Expand(const Vector3& point) {
+    minimum = Min(minimum, point);
+    maximum = Max(maximum, point);
+}
+
+void AABB::Merge(const AABB& other) {
+    minimum = Min(minimum, other.minimum);
+    maximum = Max(maximum, other.maximum);
+}
+
+bool AABB::Contains(const Vector3& point) const {
+    return point.x >= minimum.x && point.x <= maximum.x &&
+           point.y >= minimum.y && point.y <= maximum.y &&
+           point.z >= minimum.z && point.z <= maximum.z;
+}
+
+bool AABB::Contains(const AABB& other) const {
+    return Contains(other.minimum) && Contains(other.maximum);
+}
+
+bool AABB::Intersects(const AABB& other) const {
+    return minimum.x <= other.maximum.x && maximum.x >= other.minimum.x &&
+           minimum.y <= other.maximum.y && maximum.y >= other.minimum.y &&
+           minimum.z <= other.maximum.z && maximum.z >= other.minimum.z;
+}
+
+AABB AABB::Transformed(const Matrix4& transform) const {
+    if (!IsValid()) {
+        return *this;
+    }
+
+    // Arvo: the new extents are the old ones through the absolute values of
+    // the linear part
+    const Vector3 center = transform.TransformPoint(GetCenter());
+    const Vector3 extents = GetExtents();
+    Vector3 newExtents;
+    float* out = &newExtents.x;
+    for (int row = 0; row < 3; row++) {
+        out[row] = std::fabs(transform.m[0][row]) * extents.x +
+                   std::fabs(transform.m[1][row]) * extents.y +
+                   std::fabs(transform.m[2][row]) * extents.z;
+    }
+    return FromCenterExtents(center, newExtents);
+}
+
+// BoundingSphere
+
+BoundingSphere::BoundingSphere() : center(0.0f), radius(0.0f) {}
+
+BoundingSphere::BoundingSphere(const Vector3& center, float radius)
+    : center(center), radius(radius) {}
+
+BoundingSphere BoundingSphere::FromAABB(const AABB& box) {
+    return BoundingSphere(box.GetCenter(), box.GetExtents().Length());
+}
+
+bool BoundingSphere::Contains(const Vector3& point) const {
+    return (point - center).LengthSquared() <= radius * radius;
+}
+
+bool BoundingSphere::Intersects(const BoundingSphere& other) const {
+    const float reach = radius + other.radius;
+    return (other.center - center).LengthSquared() <= reach * reach;
+}
+
+bool BoundingSphere::Intersects(const AABB& box) const {
+    const Vector3 closest = Min(Max(center, box.minimum), box.maximum);
+    return Contains(closest);
+}
+
+BoundingSphere BoundingSphere::Transformed(const Matrix4& transform) const {
+    const float scaleX = transform.TransformVector(Vector3(1, 0, 0)).Length();
+    const float scaleY = transform.TransformVector(Vector3(0, 1, 0)).Length();
+    const float scaleZ = transform.TransformVector(Vector3(0, 0, 1)).Length();
+    const float scale = std::max(scaleX, std::max(scaleY, scaleZ));
+    return BoundingSphere(transform.TransformPoint(center), radius * scale);
+}
+
+// Plane
+
+Plane::Plane() : normal(0.0f, 1.0f, 0.0f), distance(0.0f) {}
+
+Plane::Plane(const Vector3& normal, float distance)
+    : normal(normal), distance(distance) {}
+
+Plane Plane::FromPointNormal(const Vector3& point, const Vector3& normal) {
+    const Vector3 unit = normal.Normalize();
+    return Plane(unit, -unit.Dot(point));
+}
+
+Plane Plane::FromPoints(const Vector3& a, const Vector3& b,
+                        const Vector3& c) {
+    return FromPointNormal(a, (b - a).Cross(c - a));
+}
+
+float Plane::SignedDistance(const Vector3& point) const {
+    return normal.Dot(point) + distance;
+}
+
+Plane Plane::Normalize() const {
+    const float length = normal.Length();
+    if (length > 0.0f) {
+        return Plane(normal / length, distance / length);
+    }
+    return *this;
+}
+
+// Frustum
+
+Frustum::Frustum() {}
+
+Frustum Frustum::FromMatrix(const Matrix4& viewProjection) {
+    // Gribb-Hartmann: each plane is the w row plus or minus an x, y or z row.
+    // Near uses w + z for the -1..1 depth range of Matrix4::Perspective.
+    const Matrix4& m = viewProjection;
+    auto row = [&m](int index) {
+        return Vector4(m.m[0][index], m.m[1][index], m.m[2][index],
+                       m.m[3][index]);
+    };
+    const Vector4 x = row(0), y = row(1), z = row(2), w = row(3);
+    const Vector4 planes[PLANE_COUNT] = {w + x, w - x, w + y,
+                                         w - y, w + z, w - z};
+
+    Frustum frustum;
+    for (int i = 0; i < PLANE_COUNT; i++) {
+        frustum.m_planes[i] =
+            Plane(Vector3(planes[i].x, planes[i].y, planes[i].z), planes[i].w)
+                .Normalize();
+    }
+    return frustum;
+}
+
+bool Frustum::Contains(const Vector3& point) const {
+    for (const Plane& plane : m_planes) {
+        if (plane.SignedDistance(point) < 0.0f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Frustum::Intersects(const BoundingSphere& sphere) const {
+    for (const Plane& plane : m_planes) {
+        if (plane.SignedDistance(sphere.center) < -sphere.radius) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Frustum::Intersects(const AABB& box) const {
+    const Vector3 center = box.GetCenter();
+    const Vector3 extents = box.GetExtents();
+    for (const Plane& plane : m_planes) {
+        const float radius = std::fabs(plane.normal.x) * extents.x +
+                             std::fabs(plane.normal.y) * extents.y +
+                             std::fabs(plane.normal.z) * extents.z;
+        if (plane.SignedDistance(center) + radius < 0.0f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+Containment Frustum::Classify(const AABB& box) const {
+    const Vector3 center = box.GetCenter();
+    const Vector3 extents = box.GetExtents();
+    Containment result = Containment::Inside;
+    for (const Plane& plane : m_planes) {
+        const float radius = std::fabs(plane.normal.x) * extents.x +
+                             std::fabs(plane.normal.y) * extents.y +
+                             std::fabs(plane.normal.z) * extents.z;
+        const float distance = plane.SignedDistance(center);
+        if (distance + radius < 0.0f) {
+            return Containment::Outside;
+        }
+        if (distance - radius < 0.0f) {
+            result = Containment::Intersecting;
+        }
+    }
+    return result;
+}
+
+size_t Frustum::CullSpheres(const BoundingSphere* spheres, size_t count,
+                            uint32_t* visibleMask) const {
+    static_assert(sizeof(BoundingSphere) == 4 * sizeof(float),
+                  "spheres are loaded as four floats each");
+    ClearMask(visibleMask, count);
+    const FrustumLanes planes = SplatPlanes(*this);
+
+    size_t visible = 0;
+    size_t index = 0;
+    for (; index + Simd::WIDTH <= count; index += Simd::WIDTH) {
+        FloatN centerX, centerY, centerZ, radius;
+        Simd::LoadInterleaved(&spheres[index].center.x, 4, centerX, centerY,
+                              centerZ, radius);
+        const int culled =
+            CulledSpheres(planes, centerX, centerY, centerZ, radius);
+        visible += MarkLanes(visibleMask, index, culled);
+    }
+    for (; index < count; index++) {
+        if (Intersects(spheres[index])) {
+            MarkVisible(visibleMask, index);
+            visible++;
+        }
+    }
+    return visible;
+}
+
+size_t Frustum::CullAABBs(const AABB* boxes, size_t count,
+                          uint32_t* visibleMask) const {
+    static_assert(sizeof(AABB) == 6 * sizeof(float),
+                  "boxes are loaded as six floats each");
+    ClearMask(visibleMask, count);
+    const FrustumLanes planes = SplatPlanes(*this);
+    const FloatN half = Simd::SplatN(0.5f);
+
+    size_t visible = 0;
+    size_t index = 0;
+    for (; index + Simd::WIDTH <= count; index += Simd::WIDTH) {
+        // Two overlapping four-float loads per box: min xyz + max x, then
+        // min z + max xyz
+        const float* base = &boxes[index].minimum.x;
+        FloatN minX, minY, minZ, maxX, unused0, unused1, maxY, maxZ;
+        Simd::LoadInterleaved(base, 6, minX, minY, minZ, maxX);
+        Simd::LoadInterleaved(base + 2, 6, unused0, unused1, maxY, maxZ);
+
+        const int culled = CulledBoxes(
+            planes, Simd::Mul(Simd::Add(minX, maxX), half),
+            Simd::Mul(Simd::Add(minY, maxY), half),
+            Simd::Mul(Simd::Add(minZ, maxZ), half),
+            Simd::Mul(Simd::Sub(maxX, minX), half),
+            Simd::Mul(Simd::Sub(maxY, minY), half),
+            Simd::Mul(Simd::Sub(maxZ, minZ), half));
+        visible += MarkLanes(visibleMask, index, culled);
+    }
+    for (; index < count; index++) {
+        if (Intersects(boxes[index])) {
+            MarkVisible(visibleMask, index);
+            visible++;
+        }
+    }
+    return visible;
+}
+
+// Ray
+
+Ray::Ray() : origin(0.0f), direction(0.0f, 0.0f, -1.0f) {}
+
+Ray::Ray(const Vector3& origin, const Vector3& direction)
+    : origin(origin), direction(direction) {}
+
+Ray Ray::FromScreenPoint(float ndcX, float ndcY,
+                         const Matrix4& inverseViewProjection) {
+    auto unproject = [&](float depth) {
+        const Vector4 point =
+            inverseViewProjection * Vector4(ndcX, ndcY, depth, 1.0f);
+        return Vector3(point.x, point.y, point.z) / point.w;
+    };
+    const Vector3 nearPoint = unproject(-1.0f);
+    const Vector3 farPoint = unproject(1.0f);
+    return Ray(nearPoint, (farPoint - nearPoint).Normalize());
+}
+
+bool Ray::Intersects(const AABB& box, float* distance) const {
+    // Slabs; a zero direction component gives infinite inverse and the
+    // comparisons still hold
+    const float* rayOrigin = &origin.x;
+    const float* rayDirection = &direction.x;
+    const float* boxMinimum = &box.minimum.x;
+    const float* boxMaximum = &box.maximum.x;
+
+    float nearT = 0.0f;
+    float farT = std::numeric_limits<float>::max();
+    for (int axis = 0; axis < 3; axis++) {
+        const float inverse = 1.0f / rayDirection[axis];
+        float t0 = (boxMinimum[axis] - rayOrigin[axis]) * inverse;
+        float t1 = (boxMaximum[axis] - rayOrigin[axis]) * inverse;
+        if (t0 > t1) {
+            std::swap(t0, t1);
+        }
+        // NaN (origin on a slab plane of a parallel ray) keeps the old bound
+        nearT = t0 > nearT ? t0 : nearT;
+        farT = t1 < farT ? t1 : farT;
+        if (nearT > farT) {
+            return false;
+        }
+    }
+    if (distance) {
+        *distance = nearT;
+    }
+    return true;
+}
+
+bool Ray::Intersects(const BoundingSphere& sphere, float* distance) const {
+    const Vector3 offset = origin - sphere.center;
+    const float a = direction.LengthSquared();
+    const float b = offset.Dot(direction);
+    const float c = offset.LengthSquared() - sphere.radius * sphere.radius;
+    if (a <= 0.0f) {
+        return false;
+    }
+
+    const float discriminant = b * b - a * c;
+    if (discriminant < 0.0f) {
+        return false;
+    }
+    const float root = std::sqrt(discriminant);
+    float t = (-b - root) / a;
+    if (t < 0.0f) {
+        // Origin inside the sphere: the exit point is the hit
+        t = (-b + root) / a;
+        if (t < 0.0f) {
+            return false;
+        }
+    }
+    if (distance) {
+        *distance = c <= 0.0f ? 0.0f : t;
+    }
+    return true;
+}
+
+bool Ray::Intersects(const Plane& plane, float* distance) const {
+    const float denominator = plane.normal.Dot(direction);
+    if (std::fabs(denominator) < EPSILON) {
+        return false;
+    }
+    const float t = -plane.SignedDistance(origin) / denominator;
+    if (t < 0.0f) {
+        return false;
+    }
+    if (distance) {
+        *distance = t;
+    }
+    return true;
+}
+
+bool Ray::IntersectsTriangle(const Vector3& a, const Vector3& b,
+                             const Vector3& c, float* distance) const {
+    // Moller-Trumbore, both faces
+    const Vector3 edge1 = b - a;
+    const Vector3 edge2 = c - a;
+    const Vector3 p = direction.Cross(edge2);
+    const float determinant = edge1.Dot(p);
+    if (std::fabs(determinant) < EPSILON) {
+        return false;
+    }
+    const float inverse = 1.0f / determinant;
+
+    const Vector3 s = origin - a;
+    const float u = s.Dot(p) * inverse;
+    if (u < 0.0f || u > 1.0f) {
+        return false;
+    }
+    const Vector3 q = s.Cross(edge1);
+    const float v = direction.Dot(q) * inverse;
+    if (v < 0.0f || u + v > 1.0f) {
+        return false;
+    }
+    const float t = edge2.Dot(q) * inverse;
+    if (t < 0.0f) {
+        return false;
+    }
+    if (distance) {
+        *distance = t;
+    }
+    return true;
+}
+
+} // namespace AquaVisual
@@ -3,16 +3,26 @@
 
 namespace AquaVisual {
 
-Matrix4 Transform::GetMatrix() const {
-    // Create transformation matrix: T * R * S
-    Matrix4 translation = Matrix4::Translate(position);
-    Matrix4 rotationX = Matrix4::RotateX(rotation.x);
-    Matrix4 rotationY = Matrix4::RotateY(rotation.y);
-    Matrix4 rotationZ = Matrix4::RotateZ(rotation.z);
-    Matrix4 scaling = Matrix4::Scale(scale);
-    
-    // Combine transformations: Translation * RotationZ * RotationY * RotationX * Scale
-    return translation * rotationZ * rotationY * rotationX * scaling;
+const Matrix4 &Transform::GetMatrix() const {
+    if (!m_dirty) {
+        return m_matrix;
+    }
+
+    // Rotation columns scaled, translation in the last column; no trig and no
+    // matrix products
+    m_matrix = m_rotation.ToMatrix();
+    const float scale[3] = {m_scale.x, m_scale.y, m_scale.z};
+    for (int column = 0; column < 3; column++) {
+        for (int row = 0; row < 3; row++) {
+            m_matrix.m[column][row] *= scale[column];
+        }
+    }
+    m_matrix.m[3][0] = m_position.x;
+    m_matrix.m[3][1] = m_position.y;
+    m_matrix.m[3][2] = m_position.z;
+
+    m_dirty = false;
+    return m_matrix;
 }
 
-} // namespace AquaVisual
\ No newline at end of file
+} // namespace AquaVisual
@@ -4,79 +4,194 @@
 
 namespace AquaVisual {
 
-Matrix4::Matrix4() {
-    for (int i = 0; i < 4; i++) {
-        for (int j = 0; j < 4; j++) {
-            m[i][j] = (i == j) ? 1.0f : 0.0f;
-        }
-    }
+Matrix4 Matrix4::Translate(const Vector3& translation) {
+    Matrix4 result(1.0f);
+    result.m[3][0] = translation.x;
+    result.m[3][1] = translation.y;
+    result.m[3][2] = translation.z;
+    return result;
 }
 
-Matrix4::Matrix4(float diagonal) {
-    for (int i = 0; i < 4; i++) {
-        for (int j = 0; j < 4; j++) {
-            m[i][j] = (i == j) ? diagonal : 0.0f;
-        }
-    }
+Matrix4 Matrix4::Scale(const Vector3& scale) {
+    Matrix4 result(1.0f);
+    result.m[0][0] = scale.x;
+    result.m[1][1] = scale.y;
+    result.m[2][2] = scale.z;
+    return result;
 }
 
-Matrix4::Matrix4(const float matrix[16]) {
-    for (int i = 0; i < 4; i++) {
-        for (int j = 0; j < 4; j++) {
-            m[i][j] = matrix[i * 4 + j];
-        }
-    }
+Matrix4 Matrix4::RotateX(float angle) {
+    float c = std::cos(angle);
+    float s = std::sin(angle);
+
+    Matrix4 result(1.0f);
+    result.m[1][1] = c;
+    result.m[1][2] = s;
+    result.m[2][1] = -s;
+    result.m[2][2] = c;
+    return result;
 }
 
-Matrix4 Matrix4::operator*(const Matrix4& other) const {
-    Matrix4 result(0.0f);
-    for (int i = 0; i < 4; i++) {
-        for (int j = 0; j < 4; j++) {
-            for (int k = 0; k < 4; k++) {
-                result.m[i][j] += m[i][k] * other.m[k][j];
-            }
-        }
-    }
+Matrix4 Matrix4::RotateY(float angle) {
+    float c = std::cos(angle);
+    float s = std::sin(angle);
+
+    Matrix4 result(1.0f);
+    result.m[0][0] = c;
+    result.m[0][2] = -s;
+    result.m[2][0] = s;
+    result.m[2][2] = c;
     return result;
 }
 
-Matrix4& Matrix4::operator*=(const Matrix4& other) {
-    Matrix4 temp = *this;
-    for (int i = 0; i < 4; i++) {
-        for (int j = 0; j < 4; j++) {
-            m[i][j] = 0.0f;
-            for (int k = 0; k < 4; k++) {
-                m[i][j] += temp.m[i][k] * other.m[k][j];
-            }
-        }
-    }
-    return *this;
+Matrix4 Matrix4::RotateZ(float angle) {
+    float c = std::cos(angle);
+    float s = std::sin(angle);
+
+    Matrix4 result(1.0f);
+    result.m[0][0] = c;
+    result.m[0][1] = s;
+    result.m[1][0] = -s;
+    result.m[1][1] = c;
+    return result;
 }
 
-float* Matrix4::Data() {
-    return &m[0][0];
+namespace {
+
+// 2x2 matrices packed row-major in one register, (a b c d) = |a b; c d|
+
+// A * B
+Simd::Float4 Mat2Mul(Simd::Float4 a, Simd::Float4 b) {
+    return Simd::Add(
+        Simd::Mul(a, Simd::Swizzle<0, 3, 0, 3>(b)),
+        Simd::Mul(Simd::Swizzle<1, 0, 3, 2>(a), Simd::Swizzle<2, 1, 2, 1>(b)));
 }
 
-const float* Matrix4::Data() const {
-    return &m[0][0];
+// adj(A) * B
+Simd::Float4 Mat2AdjMul(Simd::Float4 a, Simd::Float4 b) {
+    return Simd::Sub(
+        Simd::Mul(Simd::Swizzle<3, 3, 0, 0>(a), b),
+        Simd::Mul(Simd::Swizzle<1, 1, 2, 2>(a), Simd::Swizzle<2, 3, 0, 1>(b)));
 }
 
-Matrix4 Matrix4::Identity() {
-    return Matrix4(1.0f);
+// A * adj(B)
+Simd::Float4 Mat2MulAdj(Simd::Float4 a, Simd::Float4 b) {
+    return Simd::Sub(
+        Simd::Mul(a, Simd::Swizzle<3, 0, 3, 0>(b)),
+        Simd::Mul(Simd::Swizzle<1, 0, 3, 2>(a), Simd::Swizzle<2, 1, 2, 1>(b)));
 }
 
-Matrix4 Matrix4::Transpose() const {
+// Columns of the inverse from the rows of the inverse 3x3 part; the inverse
+// translation is -(L^-1 * t)
+Matrix4 ComposeAffineInverse(Simd::Float4 r0, Simd::Float4 r1,
+                             Simd::Float4 r2, Simd::Float4 translation) {
+    Simd::Float4 r3 = Simd::Set(0.0f, 0.0f, 0.0f, 0.0f);
+    Simd::Transpose(r0, r1, r2, r3);
+
+    // With translation.w == 1 the last column ends up with w == 1
+    const Simd::Float4 t = Simd::Combine(translation, r0, r1, r2,
+                                         Simd::Set(0.0f, 0.0f, 0.0f, -1.0f));
+
     Matrix4 result(0.0f);
-    for (int i = 0; i < 4; i++) {
-        for (int j = 0; j < 4; j++) {
-            result.m[i][j] = m[j][i];
-        }
-    }
+    Simd::Store(result.m[0], r0);
+    Simd::Store(result.m[1], r1);
+    Simd::Store(result.m[2], r2);
+    Simd::Store(result.m[3], Simd::Sub(Simd::Splat(0.0f), t));
     return result;
 }
 
+} // namespace
+
 Matrix4 Matrix4::Inverse() const {
-    return Matrix4(1.0f);
+    // Block inverse over the 2x2 sub-matrices with cofactors. Columns are fed
+    // in as rows, which inverts the transpose and yields the columns of the
+    // inverse directly.
+    const Simd::Float4 c0 = Simd::Load(m[0]);
+    const Simd::Float4 c1 = Simd::Load(m[1]);
+    const Simd::Float4 c2 = Simd::Load(m[2]);
+    const Simd::Float4 c3 = Simd::Load(m[3]);
+
+    const Simd::Float4 a = Simd::Shuffle<0, 1, 0, 1>(c0, c1);
+    const Simd::Float4 b = Simd::Shuffle<2, 3, 2, 3>(c0, c1);
+    const Simd::Float4 c = Simd::Shuffle<0, 1, 0, 1>(c2, c3);
+    const Simd::Float4 d = Simd::Shuffle<2, 3, 2, 3>(c2, c3);
+
+    // (|A| |B| |C| |D|)
+    const Simd::Float4 subDeterminants = Simd::Sub(
+        Simd::Mul(Simd::Shuffle<0, 2, 0, 2>(c0, c2),
+                  Simd::Shuffle<1, 3, 1, 3>(c1, c3)),
+        Simd::Mul(Simd::Shuffle<1, 3, 1, 3>(c0, c2),
+                  Simd::Shuffle<0, 2, 0, 2>(c1, c3)));
+    const Simd::Float4 detA = Simd::SplatLane<0>(subDeterminants);
+    const Simd::Float4 detB = Simd::SplatLane<1>(subDeterminants);
+    const Simd::Float4 detC = Simd::SplatLane<2>(subDeterminants);
+    const Simd::Float4 detD = Simd::SplatLane<3>(subDeterminants);
+
+    const Simd::Float4 adjDC = Mat2AdjMul(d, c);
+    const Simd::Float4 adjAB = Mat2AdjMul(a, b);
+
+    // Adjugates of the result blocks |X Y; Z W|
+    Simd::Float4 x = Simd::Sub(Simd::Mul(detD, a), Mat2Mul(b, adjDC));
+    Simd::Float4 w = Simd::Sub(Simd::Mul(detA, d), Mat2Mul(c, adjAB));
+    Simd::Float4 y = Simd::Sub(Simd::Mul(detB, c), Mat2MulAdj(d, adjAB));
+    Simd::Float4 z = Simd::Sub(Simd::Mul(detC, b), Mat2MulAdj(a, adjDC));
+
+    // |M| = |A||D| + |B||C| - tr(adj(A)B adj(D)C)
+    const Simd::Float4 trace =
+        Simd::Dot4(adjAB, Simd::Swizzle<0, 2, 1, 3>(adjDC));
+    const Simd::Float4 determinant =
+        Simd::Sub(Simd::Add(Simd::Mul(detA, detD), Simd::Mul(detB, detC)),
+                  trace);
+
+    if (Simd::GetX(determinant) == 0.0f) {
+        return Matrix4(1.0f);
+    }
+
+    const Simd::Float4 inverseDeterminant =
+        Simd::Div(Simd::Set(1.0f, -1.0f, -1.0f, 1.0f), determinant);
+    x = Simd::Mul(x, inverseDeterminant);
+    y = Simd::Mul(y, inverseDeterminant);
+    z = Simd::Mul(z, inverseDeterminant);
+    w = Simd::Mul(w, inverseDeterminant);
+
+    // Undo the adjugate swizzle while interleaving the blocks
+    Matrix4 result(0.0f);
+    Simd::Store(result.m[0], Simd::Shuffle<3, 1, 3, 1>(x, y));
+    Simd::Store(result.m[1], Simd::Shuffle<2, 0, 2, 0>(x, y));
+    Simd::Store(result.m[2], Simd::Shuffle<3, 1, 3, 1>(z, w));
+    Simd::Store(result.m[3], Simd::Shuffle<2, 0, 2, 0>(z, w));
+    return result;
+}
+
+Matrix4 Matrix4::InverseAffine() const {
+    // Rows of the inverse 3x3 part are cross products of its columns over
+    // the determinant. The w lanes of the first three columns are zero.
+    const Simd::Float4 c0 = Simd::Load(m[0]);
+    const Simd::Float4 c1 = Simd::Load(m[1]);
+    const Simd::Float4 c2 = Simd::Load(m[2]);
+
+    Simd::Float4 r0 = Simd::Cross3(c1, c2);
+    Simd::Float4 r1 = Simd::Cross3(c2, c0);
+    Simd::Float4 r2 = Simd::Cross3(c0, c1);
+
+    const Simd::Float4 determinant = Simd::Dot4(c0, r0);
+    if (Simd::GetX(determinant) == 0.0f) {
+        return Matrix4(1.0f);
+    }
+
+    const Simd::Float4 inverseDeterminant =
+        Simd::Div(Simd::Splat(1.0f), determinant);
+    r0 = Simd::Mul(r0, inverseDeterminant);
+    r1 = Simd::Mul(r1, inverseDeterminant);
+    r2 = Simd::Mul(r2, inverseDeterminant);
+
+    return ComposeAffineInverse(r0, r1, r2, Simd::Load(m[3]));
+}
+
+Matrix4 Matrix4::InverseRigid() const {
+    // The rotation is orthonormal, so its inverse is its transpose
+    return ComposeAffineInverse(Simd::Load(m[0]), Simd::Load(m[1]),
+                                Simd::Load(m[2]), Simd::Load(m[3]));
 }
 
 Matrix4 Matrix4::Perspective(float fov, float aspectRatio, float nearPlane, float farPlane) {
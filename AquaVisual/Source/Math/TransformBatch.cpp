@@ -0,0 +1,226 @@
+#include "AquaVisual/Math/TransformBatch.h"
+#include "AquaVisual/Core/JobSystem.h"
+#include "AquaVisual/Math/Simd.h"
+#include <algorithm>
+
+namespace AquaVisual {
+
+namespace {
+
+using Simd::FloatN;
+
+// 2 pi split so that k * TWO_PI_HIGH is exact for the k we reduce by
+constexpr float INV_TWO_PI = 0.159154943091895f;
+constexpr float TWO_PI_HIGH = 6.28125f;
+constexpr float TWO_PI_LOW = 0.00193530717958647692f;
+
+// Transforms per parallel chunk; below this threads cost more than they save
+constexpr size_t PARALLEL_CHUNK = 4096;
+
+// Sine and cosine of every lane. The angle is reduced to [-pi, pi], the half
+// angle evaluated with Taylor polynomials that are accurate to float
+// precision on [-pi/2, pi/2], then doubled.
+void SinCos(FloatN angle, FloatN& sine, FloatN& cosine) {
+    const FloatN turns =
+        Simd::Round(Simd::Mul(angle, Simd::SplatN(INV_TWO_PI)));
+    FloatN x = Simd::MulAdd(turns, Simd::SplatN(-TWO_PI_HIGH), angle);
+    x = Simd::MulAdd(turns, Simd::SplatN(-TWO_PI_LOW), x);
+
+    const FloatN h = Simd::Mul(x, Simd::SplatN(0.5f));
+    const FloatN h2 = Simd::Mul(h, h);
+
+    FloatN s = Simd::SplatN(-1.0f / 39916800.0f);
+    s = Simd::MulAdd(s, h2, Simd::SplatN(1.0f / 362880.0f));
+    s = Simd::MulAdd(s, h2, Simd::SplatN(-1.0f / 5040.0f));
+    s = Simd::MulAdd(s, h2, Simd::SplatN(1.0f / 120.0f));
+    s = Simd::MulAdd(s, h2, Simd::SplatN(-1.0f / 6.0f));
+    s = Simd::MulAdd(s, h2, Simd::SplatN(1.0f));
+    s = Simd::Mul(s, h);
+
+    FloatN c = Simd::SplatN(1.0f / 479001600.0f);
+    c = Simd::MulAdd(c, h2, Simd::SplatN(-1.0f / 3628800.0f));
+    c = Simd::MulAdd(c, h2, Simd::SplatN(1.0f / 40320.0f));
+    c = Simd::MulAdd(c, h2, Simd::SplatN(-1.0f / 720.0f));
+    c = Simd::MulAdd(c, h2, Simd::SplatN(1.0f / 24.0f));
+    c = Simd::MulAdd(c, h2, Simd::SplatN(-0.5f));
+    c = Simd::MulAdd(c, h2, Simd::SplatN(1.0f));
+
+    // sin(x) = 2 sin(x/2) cos(x/2), cos(x) = 1 - 2 sin^2(x/2)
+    sine = Simd::Mul(Simd::SplatN(2.0f), Simd::Mul(s, c));
+    cosine = Simd::MulAdd(Simd::SplatN(-2.0f), Simd::Mul(s, s),
+                          Simd::SplatN(1.0f));
+}
+
+// Simd::WIDTH matrices starting at element `index` of the streams
+void ComposeLanes(const TransformStreams& in, size_t index, float* out) {
+    FloatN sinX, cosX, sinY, cosY, sinZ, cosZ;
+    SinCos(Simd::LoadN(in.rotationX + index), sinX, cosX);
+    SinCos(Simd::LoadN(in.rotationY + index), sinY, cosY);
+    SinCos(Simd::LoadN(in.rotationZ + index), sinZ, cosZ);
+
+    const FloatN scaleX = Simd::LoadN(in.scaleX + index);
+    const FloatN scaleY = Simd::LoadN(in.scaleY + index);
+    const FloatN scaleZ = Simd::LoadN(in.scaleZ + index);
+    const FloatN zero = Simd::SplatN(0.0f);
+    const FloatN one = Simd::SplatN(1.0f);
+
+    // Rz * Ry * Rx, column by column, then scaled
+    const FloatN sinYsinX = Simd::Mul(sinY, sinX);
+    const FloatN sinYcosX = Simd::Mul(sinY, cosX);
+
+    const FloatN x0 = Simd::Mul(Simd::Mul(cosZ, cosY), scaleX);
+    const FloatN y0 = Simd::Mul(Simd::Mul(sinZ, cosY), scaleX);
+    const FloatN z0 = Simd::Mul(Simd::Sub(zero, sinY), scaleX);
+
+    const FloatN x1 = Simd::Mul(
+        Simd::Sub(Simd::Mul(cosZ, sinYsinX), Simd::Mul(sinZ, cosX)), scaleY);
+    const FloatN y1 = Simd::Mul(
+        Simd::MulAdd(sinZ, sinYsinX, Simd::Mul(cosZ, cosX)), scaleY);
+    const FloatN z1 = Simd::Mul(Simd::Mul(cosY, sinX), scaleY);
+
+    const FloatN x2 = Simd::Mul(
+        Simd::MulAdd(cosZ, sinYcosX, Simd::Mul(sinZ, sinX)), scaleZ);
+    const FloatN y2 = Simd::Mul(
+        Simd::Sub(Simd::Mul(sinZ, sinYcosX), Simd::Mul(cosZ, sinX)), scaleZ);
+    const FloatN z2 = Simd::Mul(Simd::Mul(cosY, cosX), scaleZ);
+
+    const size_t stride = 16;
+    Simd::StoreInterleaved(out, stride, x0, y0, z0, zero);
+    Simd::StoreInterleaved(out + 4, stride, x1, y1, z1, zero);
+    Simd::StoreInterleaved(out + 8, stride, x2, y2, z2, zero);
+    Simd::StoreInterleaved(out + 12, stride,
+                           Simd::LoadN(in.positionX + index),
+                           Simd::LoadN(in.positionY + index),
+                           Simd::LoadN(in.positionZ + index), one);
+}
+
+} // namespace
+
+TransformStreams TransformStreams::Offset(size_t offset) const {
+    TransformStreams result;
+    result.positionX = positionX + offset;
+    result.positionY = positionY + offset;
+    result.positionZ = positionZ + offset;
+    result.rotationX = rotationX + offset;
+    result.rotationY = rotationY + offset;
+    result.rotationZ = rotationZ + offset;
+    result.scaleX = scaleX + offset;
+    result.scaleY = scaleY + offset;
+    result.scaleZ = scaleZ + offset;
+    return result;
+}
+
+void TransformArray::Resize(size_t count) {
+    for (int i = 0; i < STREAM_COUNT; i++) {
+        const bool isScale = i >= SCALE_X;
+        m_streams[i].resize(count, isScale ? 1.0f : 0.0f);
+    }
+}
+
+void TransformArray::Clear() {
+    for (std::vector<float>& stream : m_streams) {
+        stream.clear();
+    }
+}
+
+size_t TransformArray::Add(const Transform& transform) {
+    const size_t index = Size();
+    Resize(index + 1);
+    Set(index, transform);
+    return index;
+}
+
+void TransformArray::Set(size_t index, const Transform& transform) {
+    const Vector3& position = transform.GetPosition();
+    const Vector3 rotation = transform.GetEulerAngles();
+    const Vector3& scale = transform.GetScale();
+    m_streams[POSITION_X][index] = position.x;
+    m_streams[POSITION_Y][index] = position.y;
+    m_streams[POSITION_Z][index] = position.z;
+    m_streams[ROTATION_X][index] = rotation.x;
+    m_streams[ROTATION_Y][index] = rotation.y;
+    m_streams[ROTATION_Z][index] = rotation.z;
+    m_streams[SCALE_X][index] = scale.x;
+    m_streams[SCALE_Y][index] = scale.y;
+    m_streams[SCALE_Z][index] = scale.z;
+}
+
+Transform TransformArray::Get(size_t index) const {
+    return Transform(Vector3(m_streams[POSITION_X][index],
+                             m_streams[POSITION_Y][index],
+                             m_streams[POSITION_Z][index]),
+                     Vector3(m_streams[ROTATION_X][index],
+                             m_streams[ROTATION_Y][index],
+                             m_streams[ROTATION_Z][index]),
+                     Vector3(m_streams[SCALE_X][index],
+                             m_streams[SCALE_Y][index],
+                             m_streams[SCALE_Z][index]));
+}
+
+TransformStreams TransformArray::GetStreams() const {
+    TransformStreams streams;
+    streams.positionX = m_streams[POSITION_X].data();
+    streams.positionY = m_streams[POSITION_Y].data();
+    streams.positionZ = m_streams[POSITION_Z].data();
+    streams.rotationX = m_streams[ROTATION_X].data();
+    streams.rotationY = m_streams[ROTATION_Y].data();
+    streams.rotationZ = m_streams[ROTATION_Z].data();
+    streams.scaleX = m_streams[SCALE_X].data();
+    streams.scaleY = m_streams[SCALE_Y].data();
+    streams.scaleZ = m_streams[SCALE_Z].data();
+    return streams;
+}
+
+namespace Math {
+
+void ComposeTransforms(const TransformStreams& transforms, size_t count,
+                       Matrix4* out) {
+    size_t index = 0;
+    for (; index + Simd::WIDTH <= count; index += Simd::WIDTH) {
+        ComposeLanes(transforms, index, out[index].Data());
+    }
+    if (index == count) {
+        return;
+    }
+
+    // Pad the tail to a full register so it goes through the same kernel
+    const size_t tail = count - index;
+    float padded[9][Simd::WIDTH];
+    const float* sources[9] = {
+        transforms.positionX, transforms.positionY, transforms.positionZ,
+        transforms.rotationX, transforms.rotationY, transforms.rotationZ,
+        transforms.scaleX,    transforms.scaleY,    transforms.scaleZ};
+    for (int stream = 0; stream < 9; stream++) {
+        std::fill(padded[stream], padded[stream] + Simd::WIDTH, 0.0f);
+        std::copy(sources[stream] + index, sources[stream] + count,
+                  padded[stream]);
+    }
+
+    TransformStreams tailStreams;
+    tailStreams.positionX = padded[0];
+    tailStreams.positionY = padded[1];
+    tailStreams.positionZ = padded[2];
+    tailStreams.rotationX = padded[3];
+    tailStreams.rotationY = padded[4];
+    tailStreams.rotationZ = padded[5];
+    tailStreams.scaleX = padded[6];
+    tailStreams.scaleY = padded[7];
+    tailStreams.scaleZ = padded[8];
+
+    Matrix4 matrices[Simd::WIDTH];
+    ComposeLanes(tailStreams, 0, matrices[0].Data());
+    std::copy(matrices, matrices + tail, out + index);
+}
+
+void ComposeTransformsParallel(const TransformStreams& transforms,
+                               size_t count, Matrix4* out) {
+    JobSystem::Instance().ParallelFor(
+        count, PARALLEL_CHUNK, [&](size_t begin, size_t end) {
+            ComposeTransforms(transforms.Offset(begin), end - begin,
+                              out + begin);
+        });
+}
+
+} // namespace Math
+
+} // namespace AquaVisual
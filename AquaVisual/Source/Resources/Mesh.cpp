@@ -1,11 +1,157 @@
 #include "AquaVisual/Resources/Mesh.h"
+#include "AquaVisual/Resources/MeshFile.h"
+#include "AquaVisual/Resources/MeshOptimizer.h"
+#include "AquaVisual/Resources/MeshSimplifier.h"
+#include "AquaVisual/Resources/MeshletBuilder.h"
+#include "AquaVisual/Resources/ObjLoader.h"
+#include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <utility>
 
 namespace AquaVisual {
 
+namespace {
+
+AABB ComputeBounds(ArrayView<Vertex> vertices) {
+  AABB bounds;
+  for (const Vertex &vertex : vertices) {
+    bounds.Expand(vertex.position);
+  }
+  return bounds;
+}
+
+bool HasExtension(const std::string &path, const char *extension) {
+  const size_t length = std::char_traits<char>::length(extension);
+  if (path.size() < length) {
+    return false;
+  }
+  for (size_t i = 0; i < length; ++i) {
+    const char c = path[path.size() - length + i];
+    const char lower = (c >= 'A' && c <= 'Z') ? static_cast<char>(c + 32) : c;
+    if (lower != extension[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+uint64_t Mesh::NextId() {
+  static std::atomic<uint64_t> s_nextId{1};
+  return s_nextId.fetch_add(1, std::memory_order_relaxed);
+}
+
 Mesh::Mesh(const std::vector<Vertex> &vertices,
            const std::vector<uint32_t> &indices)
-    : m_vertices(vertices), m_indices(indices) {}
+    : m_vertices(vertices), m_indices(indices),
+      m_bounds(ComputeBounds(m_vertices)), m_id(NextId()) {}
+
+Mesh::Mesh(std::vector<Vertex> &&vertices, std::vector<uint32_t> &&indices)
+    : m_vertices(std::move(vertices)), m_indices(std::move(indices)),
+      m_bounds(ComputeBounds(m_vertices)), m_id(NextId()) {}
+
+Mesh::Mesh(std::shared_ptr<const void> storage, ArrayView<Vertex> vertices,
+           ArrayView<uint32_t> indices, const AABB &bounds)
+    : m_storage(std::move(storage)), m_externalVertices(vertices),
+      m_externalIndices(indices), m_bounds(bounds), m_id(NextId()) {}
+
+// Copies share the external storage; it is read-only
+Mesh::Mesh(const Mesh &other)
+    : m_vertices(other.m_vertices), m_indices(other.m_indices),
+      m_storage(other.m_storage),
+      m_externalVertices(other.m_externalVertices),
+      m_externalIndices(other.m_externalIndices),
+      m_externalLodIndices(other.m_externalLodIndices),
+      m_lodIndices(other.m_lodIndices), m_submeshes(other.m_submeshes),
+      m_lods(other.m_lods), m_meshlets(other.m_meshlets),
+      m_bounds(other.m_bounds), m_id(NextId()) {}
+
+Mesh &Mesh::operator=(const Mesh &other) {
+  if (this != &other) {
+    m_vertices = other.m_vertices;
+    m_indices = other.m_indices;
+    m_storage = other.m_storage;
+    m_externalVertices = other.m_externalVertices;
+    m_externalIndices = other.m_externalIndices;
+    m_externalLodIndices = other.m_externalLodIndices;
+    m_lodIndices = other.m_lodIndices;
+    m_submeshes = other.m_submeshes;
+    m_lods = other.m_lods;
+    m_meshlets = other.m_meshlets;
+    m_bounds = other.m_bounds;
+    MarkDirty();
+  }
+  return *this;
+}
+
+void Mesh::Detach() {
+  if (!m_storage) {
+    return;
+  }
+  m_vertices = m_externalVertices.ToVector();
+  m_indices = m_externalIndices.ToVector();
+  m_lodIndices = m_externalLodIndices.ToVector();
+  m_externalVertices = ArrayView<Vertex>();
+  m_externalIndices = ArrayView<uint32_t>();
+  m_externalLodIndices = ArrayView<uint32_t>();
+  m_storage.reset();
+}
+
+void Mesh::SetVertices(const std::vector<Vertex> &vertices) {
+  Detach();
+  m_vertices = vertices;
+  m_bounds = ComputeBounds(m_vertices);
+  m_lods.clear();
+  m_lodIndices.clear();
+  m_meshlets.clear();
+  MarkDirty();
+}
+
+void Mesh::SetIndices(const std::vector<uint32_t> &indices) {
+  Detach();
+  m_indices = indices;
+  for (const Submesh &submesh : m_submeshes) {
+    if (submesh.indexOffset > m_indices.size() ||
+        submesh.indexCount > m_indices.size() - submesh.indexOffset) {
+      m_submeshes.clear();
+      break;
+    }
+  }
+  m_lods.clear();
+  m_lodIndices.clear();
+  m_meshlets.clear();
+  MarkDirty();
+}
+
+void Mesh::SetSubmeshes(const std::vector<Submesh> &submeshes) {
+  m_submeshes = submeshes;
+  MarkDirty();
+}
+
+void Mesh::SetLods(const std::vector<MeshLod> &lods,
+                   const std::vector<uint32_t> &lodIndices) {
+  Detach();
+  m_lods = lods;
+  m_lodIndices = lodIndices;
+  MarkDirty();
+}
+
+void Mesh::SetMeshlets(const std::vector<Meshlet> &meshlets) {
+  m_meshlets = meshlets;
+  MarkDirty();
+}
+
+uint32_t Mesh::SelectLod(float maxError) const {
+  // Levels are ordered by increasing error
+  uint32_t level = 0;
+  const size_t levelCount = std::min<size_t>(m_lods.size(), MAX_LODS);
+  while (level < levelCount && m_lods[level].error <= maxError) {
+    level++;
+  }
+  return level;
+}
 
 std::unique_ptr<Mesh> Mesh::CreateTriangle(float size) {
   std::vector<Vertex> vertices = {
@@ -116,9 +262,25 @@ std::unique_ptr<Mesh> Mesh::CreateCube(float size) {
 }
 
 std::unique_ptr<Mesh> Mesh::LoadFromFile(const std::string &filepath) {
-  // 简单的OBJ加载器实现（暂时返回一个三角形）
-  // 在实际项目中，这里应该实现完整的OBJ文件解析
-  return CreateTriangle(1.0f);
+  if (HasExtension(filepath, MeshFile::EXTENSION)) {
+    return MeshFile::Load(filepath);
+  }
+  return MeshFile::LoadCached(filepath);
+}
+
+std::unique_ptr<Mesh> Mesh::BuildFromObj(const std::string &filepath) {
+  std::vector<Vertex> vertices;
+  std::vector<uint32_t> indices;
+  if (!ObjLoader::Load(filepath, vertices, indices)) {
+    return nullptr;
+  }
+  auto mesh = std::make_unique<Mesh>(std::move(vertices), std::move(indices));
+  MeshSimplifier::GenerateLods(*mesh);
+  MeshOptimizer::Optimize(*mesh);
+  if (mesh->GetIndexCount() / 3 >= MeshletBuilder::MIN_MESH_TRIANGLES) {
+    MeshletBuilder::Build(*mesh);
+  }
+  return mesh;
 }
 
 } // namespace AquaVisual
\ No newline at end of file
@@ -0,0 +1,362 @@
+#include "AquaVisual/Resources/MeshFile.h"
+#include "AquaVisual/Core/JobSystem.h"
+#include "AquaVisual/Core/MappedFile.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <type_traits>
+#include <vector>
+
+namespace AquaVisual {
+
+static_assert(sizeof(Vertex) == 32, "cache files store Vertex as is");
+static_assert(std::is_trivially_copyable<Vertex>::value &&
+                  std::is_trivially_copyable<Submesh>::value &&
+                  std::is_trivially_copyable<MeshLod>::value &&
+                  std::is_trivially_copyable<Meshlet>::value,
+              "cache sections are raw copies of these types");
+static_assert(sizeof(MeshFile::Header) % 8 == 0, "header has no tail padding");
+
+namespace {
+
+// Hash input is split into blocks of this size so it can be hashed in
+// parallel; changing it changes every hash
+constexpr size_t HASH_BLOCK_SIZE = 8u << 20;
+
+// xxHash64 constants and round structure
+constexpr uint64_t PRIME1 = 0x9E3779B185EBCA87ull;
+constexpr uint64_t PRIME2 = 0xC2B2AE3D27D4EB4Full;
+constexpr uint64_t PRIME3 = 0x165667B19E3779F9ull;
+constexpr uint64_t PRIME4 = 0x85EBCA77C2B2AE63ull;
+constexpr uint64_t PRIME5 = 0x27D4EB2F165667C5ull;
+
+uint64_t RotateLeft(uint64_t value, int bits) {
+  return (value << bits) | (value >> (64 - bits));
+}
+
+uint64_t Round(uint64_t accumulator, uint64_t input) {
+  accumulator += input * PRIME2;
+  return RotateLeft(accumulator, 31) * PRIME1;
+}
+
+uint64_t ReadWord(const unsigned char *bytes) {
+  uint64_t word;
+  std::memcpy(&word, bytes, sizeof(word));
+  return word;
+}
+
+uint64_t AlignOffset(uint64_t offset) {
+  return (offset + MeshFile::ALIGNMENT - 1) /
+         MeshFile::ALIGNMENT * MeshFile::ALIGNMENT;
+}
+
+bool CheckSection(const MeshFile::Section &section, size_t elementSize,
+                  uint64_t fileSize) {
+  return section.offset % MeshFile::ALIGNMENT == 0 &&
+         section.offset >= sizeof(MeshFile::Header) &&
+         section.offset <= fileSize &&
+         section.count <= (fileSize - section.offset) / elementSize;
+}
+
+bool CheckHeader(const MeshFile::Header &header, uint64_t fileSize) {
+  return header.magic == MeshFile::MAGIC &&
+         header.version == MeshFile::VERSION &&
+         header.vertexSize == sizeof(Vertex) && header.fileSize == fileSize &&
+         CheckSection(header.vertices, sizeof(Vertex), fileSize) &&
+         CheckSection(header.indices, sizeof(uint32_t), fileSize) &&
+         CheckSection(header.submeshes, sizeof(Submesh), fileSize) &&
+         CheckSection(header.lods, sizeof(MeshLod), fileSize) &&
+         CheckSection(header.lodIndices, sizeof(uint32_t), fileSize) &&
+         CheckSection(header.meshlets, sizeof(Meshlet), fileSize);
+}
+
+template <typename T>
+ArrayView<T> SectionView(const char *base, const MeshFile::Section &section) {
+  return ArrayView<T>(reinterpret_cast<const T *>(base + section.offset),
+                      static_cast<size_t>(section.count));
+}
+
+bool RangeInside(uint32_t offset, uint32_t count, size_t size) {
+  return offset <= size && count <= size - offset;
+}
+
+// Appends sections to a stream, padding each to MeshFile::ALIGNMENT
+class SectionWriter {
+public:
+  explicit SectionWriter(std::ofstream &stream) : m_stream(stream) {}
+
+  void Write(const void *data, uint64_t bytes) {
+    m_stream.write(static_cast<const char *>(data),
+                   static_cast<std::streamsize>(bytes));
+    m_position += bytes;
+    static const char zeros[MeshFile::ALIGNMENT] = {};
+    const uint64_t aligned = AlignOffset(m_position);
+    m_stream.write(zeros, static_cast<std::streamsize>(aligned - m_position));
+    m_position = aligned;
+  }
+
+private:
+  std::ofstream &m_stream;
+  uint64_t m_position = 0;
+};
+
+} // namespace
+
+uint64_t MeshFile::Hash(const void *data, size_t size, uint64_t seed) {
+  const unsigned char *bytes = static_cast<const unsigned char *>(data);
+  const unsigned char *end = bytes + size;
+  uint64_t hash;
+
+  if (size >= 32) {
+    uint64_t a = seed + PRIME1 + PRIME2;
+    uint64_t b = seed + PRIME2;
+    uint64_t c = seed;
+    uint64_t d = seed - PRIME1;
+    // Four independent lanes keep the multipliers busy
+    do {
+      a = Round(a, ReadWord(bytes));
+      b = Round(b, ReadWord(bytes + 8));
+      c = Round(c, ReadWord(bytes + 16));
+      d = Round(d, ReadWord(bytes + 24));
+      bytes += 32;
+    } while (end - bytes >= 32);
+    hash = RotateLeft(a, 1) + RotateLeft(b, 7) + RotateLeft(c, 12) +
+           RotateLeft(d, 18);
+    for (uint64_t lane : {a, b, c, d}) {
+      hash = (hash ^ Round(0, lane)) * PRIME1 + PRIME4;
+    }
+  } else {
+    hash = seed + PRIME5;
+  }
+
+  hash += static_cast<uint64_t>(size);
+  for (; end - bytes >= 8; bytes += 8) {
+    hash ^= Round(0, ReadWord(bytes));
+    hash = RotateLeft(hash, 27) * PRIME1 + PRIME4;
+  }
+  for (; bytes < end; ++bytes) {
+    hash ^= *bytes * PRIME5;
+    hash = RotateLeft(hash, 11) * PRIME1;
+  }
+
+  hash ^= hash >> 33;
+  hash *= PRIME2;
+  hash ^= hash >> 29;
+  hash *= PRIME3;
+  hash ^= hash >> 32;
+  return hash;
+}
+
+bool MeshFile::HashFile(const std::string &path, uint64_t &hash,
+                        uint64_t &size) {
+  MappedFile file;
+  if (!file.Open(path)) {
+    return false;
+  }
+  const char *data = file.GetData();
+  const size_t fileSize = file.GetSize();
+  const size_t blockCount = (fileSize + HASH_BLOCK_SIZE - 1) / HASH_BLOCK_SIZE;
+
+  std::vector<uint64_t> blockHashes(blockCount);
+  JobSystem::Instance().ParallelFor(
+      blockCount, 1, [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; i++) {
+          const size_t begin = i * HASH_BLOCK_SIZE;
+          const size_t bytes = std::min(HASH_BLOCK_SIZE, fileSize - begin);
+          blockHashes[i] = Hash(data + begin, bytes, i);
+        }
+      });
+
+  hash = Hash(blockHashes.data(), blockHashes.size() * sizeof(uint64_t),
+              static_cast<uint64_t>(fileSize));
+  size = static_cast<uint64_t>(fileSize);
+  return true;
+}
+
+bool MeshFile::Save(const std::string &path, const Mesh &mesh,
+                    uint64_t sourceHash, uint64_t sourceSize) {
+  const ArrayView<Vertex> vertices = mesh.GetVertices();
+  const ArrayView<uint32_t> indices = mesh.GetIndices();
+  const std::vector<Submesh> &submeshes = mesh.GetSubmeshes();
+  const std::vector<MeshLod> &lods = mesh.GetLods();
+  const ArrayView<uint32_t> lodIndices = mesh.GetLodIndices();
+  const std::vector<Meshlet> &meshlets = mesh.GetMeshlets();
+  const AABB &bounds = mesh.GetBounds();
+
+  Header header = {};
+  header.magic = MAGIC;
+  header.version = VERSION;
+  header.vertexSize = sizeof(Vertex);
+  header.sourceHash = sourceHash;
+  header.sourceSize = sourceSize;
+  header.boundsMin[0] = bounds.minimum.x;
+  header.boundsMin[1] = bounds.minimum.y;
+  header.boundsMin[2] = bounds.minimum.z;
+  header.boundsMax[0] = bounds.maximum.x;
+  header.boundsMax[1] = bounds.maximum.y;
+  header.boundsMax[2] = bounds.maximum.z;
+
+  // Sections follow the header in declaration order
+  uint64_t offset = AlignOffset(sizeof(Header));
+  auto place = [&offset](Section &section, size_t count, size_t elementSize) {
+    section.offset = offset;
+    section.count = count;
+    offset = AlignOffset(offset + count * elementSize);
+  };
+  place(header.vertices, vertices.size(), sizeof(Vertex));
+  place(header.indices, indices.size(), sizeof(uint32_t));
+  place(header.submeshes, submeshes.size(), sizeof(Submesh));
+  place(header.lods, lods.size(), sizeof(MeshLod));
+  place(header.lodIndices, lodIndices.size(), sizeof(uint32_t));
+  place(header.meshlets, meshlets.size(), sizeof(Meshlet));
+  header.fileSize = offset;
+
+  const std::string temporaryPath = path + ".tmp";
+  {
+    std::ofstream stream(temporaryPath, std::ios::binary | std::ios::trunc);
+    if (!stream) {
+      std::cerr << "MeshFile: cannot create " << temporaryPath << std::endl;
+      return false;
+    }
+    SectionWriter writer(stream);
+    writer.Write(&header, sizeof(header));
+    writer.Write(vertices.data(), vertices.size() * sizeof(Vertex));
+    writer.Write(indices.data(), indices.size() * sizeof(uint32_t));
+    writer.Write(submeshes.data(), submeshes.size() * sizeof(Submesh));
+    writer.Write(lods.data(), lods.size() * sizeof(MeshLod));
+    writer.Write(lodIndices.data(), lodIndices.size() * sizeof(uint32_t));
+    writer.Write(meshlets.data(), meshlets.size() * sizeof(Meshlet));
+    stream.close();
+    if (!stream) {
+      std::cerr << "MeshFile: cannot write " << temporaryPath << std::endl;
+      std::remove(temporaryPath.c_str());
+      return false;
+    }
+  }
+
+#ifdef _WIN32
+  // rename() does not replace existing files here
+  std::remove(path.c_str());
+#endif
+  if (std::rename(temporaryPath.c_str(), path.c_str()) != 0) {
+    std::cerr << "MeshFile: cannot rename " << temporaryPath << " to " << path
+              << std::endl;
+    std::remove(temporaryPath.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool MeshFile::ReadHeader(const std::string &path, Header &header) {
+  std::ifstream stream(path, std::ios::binary | std::ios::ate);
+  if (!stream) {
+    return false;
+  }
+  const uint64_t fileSize = static_cast<uint64_t>(stream.tellg());
+  if (fileSize < sizeof(Header)) {
+    return false;
+  }
+  stream.seekg(0);
+  stream.read(reinterpret_cast<char *>(&header), sizeof(Header));
+  return stream && CheckHeader(header, fileSize);
+}
+
+std::unique_ptr<Mesh> MeshFile::Load(const std::string &path) {
+  auto file = std::make_shared<MappedFile>();
+  if (!file->Open(path)) {
+    return nullptr;
+  }
+
+  Header header;
+  const char *base = file->GetData();
+  const uint64_t fileSize = file->GetSize();
+  if (fileSize < sizeof(Header)) {
+    std::cerr << "MeshFile: " << path << " is too small" << std::endl;
+    return nullptr;
+  }
+  std::memcpy(&header, base, sizeof(Header));
+  if (!CheckHeader(header, fileSize)) {
+    std::cerr << "MeshFile: " << path << " is not a version " << VERSION
+              << " mesh cache" << std::endl;
+    return nullptr;
+  }
+
+  // Only the small tables are range checked; checking index values would
+  // touch every page of the index stream
+  const ArrayView<Vertex> vertices = SectionView<Vertex>(base, header.vertices);
+  const ArrayView<uint32_t> indices =
+      SectionView<uint32_t>(base, header.indices);
+  const ArrayView<Submesh> submeshes =
+      SectionView<Submesh>(base, header.submeshes);
+  const ArrayView<MeshLod> lods = SectionView<MeshLod>(base, header.lods);
+  const ArrayView<uint32_t> lodIndices =
+      SectionView<uint32_t>(base, header.lodIndices);
+  const ArrayView<Meshlet> meshlets =
+      SectionView<Meshlet>(base, header.meshlets);
+  for (const Submesh &submesh : submeshes) {
+    if (!RangeInside(submesh.indexOffset, submesh.indexCount,
+                     indices.size())) {
+      std::cerr << "MeshFile: " << path << " has a bad submesh" << std::endl;
+      return nullptr;
+    }
+  }
+  for (const MeshLod &lod : lods) {
+    if (!RangeInside(lod.indexOffset, lod.indexCount, lodIndices.size())) {
+      std::cerr << "MeshFile: " << path << " has a bad LOD" << std::endl;
+      return nullptr;
+    }
+  }
+  for (const Meshlet &meshlet : meshlets) {
+    if (!RangeInside(meshlet.firstIndex, meshlet.indexCount, indices.size())) {
+      std::cerr << "MeshFile: " << path << " has a bad meshlet" << std::endl;
+      return nullptr;
+    }
+  }
+
+  const AABB bounds(
+      Vec3(header.boundsMin[0], header.boundsMin[1], header.boundsMin[2]),
+      Vec3(header.boundsMax[0], header.boundsMax[1], header.boundsMax[2]));
+  auto mesh = std::make_unique<Mesh>(file, vertices, indices, bounds);
+  mesh->m_externalLodIndices = lodIndices;
+  mesh->m_submeshes = submeshes.ToVector();
+  mesh->m_lods = lods.ToVector();
+  mesh->m_meshlets = meshlets.ToVector();
+  return mesh;
+}
+
+std::unique_ptr<Mesh> MeshFile::LoadCached(const std::string &sourcePath,
+                                           const std::string &cachePath) {
+  const std::string path =
+      cachePath.empty() ? sourcePath + EXTENSION : cachePath;
+
+  // Builds may ship the cache without its source
+  uint64_t sourceHash = 0;
+  uint64_t sourceSize = 0;
+  const bool haveSource = std::ifstream(sourcePath).good() &&
+                          HashFile(sourcePath, sourceHash, sourceSize);
+
+  Header header;
+  if (ReadHeader(path, header) &&
+      (!haveSource || (header.sourceHash == sourceHash &&
+                       header.sourceSize == sourceSize))) {
+    if (std::unique_ptr<Mesh> mesh = Load(path)) {
+      return mesh;
+    }
+  }
+  if (!haveSource) {
+    std::cerr << "MeshFile: no source or cache for " << sourcePath
+              << std::endl;
+    return nullptr;
+  }
+
+  std::unique_ptr<Mesh> mesh = Mesh::BuildFromObj(sourcePath);
+  if (mesh && !Save(path, *mesh, sourceHash, sourceSize)) {
+    std::cerr << "MeshFile: continuing without a cache for " << sourcePath
+              << std::endl;
+  }
+  return mesh;
+}
+
+} // namespace AquaVisual
@@ -0,0 +1,455 @@
+#include "AquaVisual/Resources/MeshOptimizer.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace AquaVisual {
+namespace MeshOptimizer {
+
+namespace {
+
+constexpr uint32_t NONE = 0xFFFFFFFFu;
+
+// Forsyth's scoring. The modeled LRU cache is larger than real FIFO caches,
+// which makes the greedy choice look a little further ahead.
+constexpr uint32_t FORSYTH_CACHE_SIZE = 32;
+constexpr uint32_t VALENCE_TABLE_SIZE = 64;
+constexpr float LAST_TRIANGLE_SCORE = 0.75f;
+constexpr float CACHE_DECAY_POWER = 1.5f;
+constexpr float VALENCE_BOOST_SCALE = 2.0f;
+constexpr float VALENCE_BOOST_POWER = 0.5f;
+
+struct ScoreTables {
+  float cache[FORSYTH_CACHE_SIZE];
+  float valence[VALENCE_TABLE_SIZE];
+
+  ScoreTables() {
+    for (uint32_t i = 0; i < FORSYTH_CACHE_SIZE; i++) {
+      // The last triangle's vertices score lower so strips do not reverse
+      cache[i] = i < 3 ? LAST_TRIANGLE_SCORE
+                       : std::pow(1.0f - static_cast<float>(i - 3) /
+                                             (FORSYTH_CACHE_SIZE - 3),
+                                  CACHE_DECAY_POWER);
+    }
+    valence[0] = 0.0f;
+    for (uint32_t i = 1; i < VALENCE_TABLE_SIZE; i++) {
+      valence[i] = ValenceScore(i);
+    }
+  }
+
+  // Vertices with few triangles left are finished first
+  static float ValenceScore(uint32_t liveTriangles) {
+    return VALENCE_BOOST_SCALE *
+           std::pow(static_cast<float>(liveTriangles), -VALENCE_BOOST_POWER);
+  }
+
+  float Score(int32_t cachePosition, uint32_t liveTriangles) const {
+    if (liveTriangles == 0) {
+      return -1.0f;
+    }
+    const float cacheScore = cachePosition >= 0 ? cache[cachePosition] : 0.0f;
+    return cacheScore + (liveTriangles < VALENCE_TABLE_SIZE
+                             ? valence[liveTriangles]
+                             : ValenceScore(liveTriangles));
+  }
+};
+
+// FIFO cache simulated with timestamps: a vertex is cached while fewer than
+// cacheSize misses happened since it was loaded
+class FifoCache {
+public:
+  FifoCache(size_t vertexCount, uint32_t cacheSize)
+      : m_timestamps(vertexCount, 0), m_cacheSize(cacheSize),
+        m_time(cacheSize + 1) {}
+
+  uint32_t Access(uint32_t vertex) {
+    if (m_time - m_timestamps[vertex] > m_cacheSize) {
+      m_timestamps[vertex] = m_time++;
+      return 1;
+    }
+    return 0;
+  }
+
+  uint32_t AccessTriangle(const uint32_t *triangle) {
+    return Access(triangle[0]) + Access(triangle[1]) + Access(triangle[2]);
+  }
+
+  void Flush() { m_time += m_cacheSize + 1; }
+
+private:
+  std::vector<uint32_t> m_timestamps;
+  uint32_t m_cacheSize;
+  uint32_t m_time;
+};
+
+// Hands out new numbers to vertices in the order indices first use them
+void AssignFirstUse(const std::vector<uint32_t> &indices,
+                    std::vector<uint32_t> &remap, uint32_t &nextVertex) {
+  for (uint32_t index : indices) {
+    if (remap[index] == NONE) {
+      remap[index] = nextVertex++;
+    }
+  }
+}
+
+void ApplyRemap(std::vector<Vertex> &vertices,
+                const std::vector<uint32_t> &remap, uint32_t vertexCount) {
+  std::vector<Vertex> reordered(vertexCount);
+  for (size_t i = 0; i < vertices.size(); i++) {
+    if (remap[i] != NONE) {
+      reordered[remap[i]] = vertices[i];
+    }
+  }
+  vertices.swap(reordered);
+}
+
+void RemapIndices(std::vector<uint32_t> &indices,
+                  const std::vector<uint32_t> &remap) {
+  for (uint32_t &index : indices) {
+    index = remap[index];
+  }
+}
+
+bool IndicesInRange(ArrayView<uint32_t> indices, size_t vertexCount) {
+  for (uint32_t index : indices) {
+    if (index >= vertexCount) {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+VertexCacheStats AnalyzeVertexCache(ArrayView<uint32_t> indices,
+                                    size_t vertexCount, uint32_t cacheSize) {
+  VertexCacheStats stats;
+  const size_t triangleCount = indices.size() / 3;
+  if (triangleCount == 0) {
+    return stats;
+  }
+
+  FifoCache cache(vertexCount, cacheSize);
+  std::vector<bool> referenced(vertexCount, false);
+  size_t referencedCount = 0;
+  for (size_t i = 0; i < triangleCount * 3; i++) {
+    stats.vertexTransforms += cache.Access(indices[i]);
+    if (!referenced[indices[i]]) {
+      referenced[indices[i]] = true;
+      referencedCount++;
+    }
+  }
+  stats.acmr = static_cast<float>(stats.vertexTransforms) / triangleCount;
+  stats.atvr = static_cast<float>(stats.vertexTransforms) / referencedCount;
+  return stats;
+}
+
+std::vector<uint32_t> OptimizeVertexCache(ArrayView<uint32_t> indices,
+                                          size_t vertexCount) {
+  const size_t triangleCount = indices.size() / 3;
+  std::vector<uint32_t> result;
+  result.reserve(triangleCount * 3);
+  if (triangleCount == 0) {
+    return result;
+  }
+
+  // Triangles per vertex; the first liveCount entries of each list are the
+  // ones not emitted yet
+  std::vector<uint32_t> liveCount(vertexCount, 0);
+  for (size_t i = 0; i < triangleCount * 3; i++) {
+    liveCount[indices[i]]++;
+  }
+  std::vector<uint32_t> offsets(vertexCount);
+  uint32_t total = 0;
+  for (size_t v = 0; v < vertexCount; v++) {
+    offsets[v] = total;
+    total += liveCount[v];
+  }
+  std::vector<uint32_t> adjacency(total);
+  {
+    std::vector<uint32_t> fill(offsets);
+    for (size_t i = 0; i < triangleCount * 3; i++) {
+      adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+    }
+  }
+
+  static const ScoreTables tables;
+  std::vector<int32_t> cachePosition(vertexCount, -1);
+  std::vector<float> vertexScores(vertexCount);
+  for (size_t v = 0; v < vertexCount; v++) {
+    vertexScores[v] = tables.Score(-1, liveCount[v]);
+  }
+
+  std::vector<float> triangleScores(triangleCount);
+  std::vector<bool> emitted(triangleCount, false);
+  uint32_t best = 0;
+  float bestScore = -1.0f;
+  for (size_t t = 0; t < triangleCount; t++) {
+    const uint32_t *triangle = &indices[t * 3];
+    triangleScores[t] = vertexScores[triangle[0]] +
+                        vertexScores[triangle[1]] + vertexScores[triangle[2]];
+    if (triangleScores[t] > bestScore) {
+      bestScore = triangleScores[t];
+      best = static_cast<uint32_t>(t);
+    }
+  }
+
+  uint32_t cache[FORSYTH_CACHE_SIZE + 3];
+  uint32_t newCache[FORSYTH_CACHE_SIZE + 3];
+  size_t cacheCount = 0;
+  size_t nextUnemitted = 0;
+
+  for (size_t emittedCount = 0; emittedCount < triangleCount;
+       emittedCount++) {
+    if (best == NONE) {
+      // Nothing in the cache has triangles left; restart anywhere
+      while (emitted[nextUnemitted]) {
+        nextUnemitted++;
+      }
+      best = static_cast<uint32_t>(nextUnemitted);
+    }
+
+    const uint32_t *triangle = &indices[best * 3];
+    result.insert(result.end(), triangle, triangle + 3);
+    emitted[best] = true;
+
+    for (int k = 0; k < 3; k++) {
+      const uint32_t vertex = triangle[k];
+      uint32_t *list = adjacency.data() + offsets[vertex];
+      uint32_t &count = liveCount[vertex];
+      for (uint32_t i = 0; i < count; i++) {
+        if (list[i] == best) {
+          list[i] = list[--count];
+          break;
+        }
+      }
+    }
+
+    // The emitted triangle's vertices move to the front, in LRU order
+    size_t newCount = 0;
+    for (int k = 0; k < 3; k++) {
+      if (std::find(newCache, newCache + newCount, triangle[k]) ==
+          newCache + newCount) {
+        newCache[newCount++] = triangle[k];
+      }
+    }
+    for (size_t i = 0; i < cacheCount; i++) {
+      if (cache[i] != triangle[0] && cache[i] != triangle[1] &&
+          cache[i] != triangle[2]) {
+        newCache[newCount++] = cache[i];
+      }
+    }
+
+    // Rescore every vertex whose position changed, including the ones that
+    // just fell out, and push the change into their live triangles
+    for (size_t i = 0; i < newCount; i++) {
+      const uint32_t vertex = newCache[i];
+      const int32_t position =
+          i < FORSYTH_CACHE_SIZE ? static_cast<int32_t>(i) : -1;
+      cachePosition[vertex] = position;
+      const float score = tables.Score(position, liveCount[vertex]);
+      const float delta = score - vertexScores[vertex];
+      vertexScores[vertex] = score;
+      const uint32_t *list = adjacency.data() + offsets[vertex];
+      for (uint32_t j = 0; j < liveCount[vertex]; j++) {
+        triangleScores[list[j]] += delta;
+      }
+    }
+
+    cacheCount = std::min<size_t>(newCount, FORSYTH_CACHE_SIZE);
+    std::copy(newCache, newCache + cacheCount, cache);
+
+    best = NONE;
+    bestScore = -1.0f;
+    for (size_t i = 0; i < cacheCount; i++) {
+      const uint32_t vertex = cache[i];
+      const uint32_t *list = adjacency.data() + offsets[vertex];
+      for (uint32_t j = 0; j < liveCount[vertex]; j++) {
+        if (triangleScores[list[j]] > bestScore) {
+          bestScore = triangleScores[list[j]];
+          best = list[j];
+        }
+      }
+    }
+  }
+  return result;
+}
+
+std::vector<uint32_t> OptimizeOverdraw(ArrayView<uint32_t> indices,
+                                       ArrayView<Vertex> vertices,
+                                       float threshold) {
+  const size_t triangleCount = indices.size() / 3;
+  std::vector<uint32_t> result;
+  result.reserve(triangleCount * 3);
+  if (triangleCount == 0) {
+    return result;
+  }
+
+  // Hard boundaries: triangles missing all three vertices, where the cache
+  // is cold anyway and reordering costs nothing
+  FifoCache cache(vertices.size(), DEFAULT_CACHE_SIZE);
+  std::vector<uint32_t> hardStarts;
+  for (size_t t = 0; t < triangleCount; t++) {
+    if (cache.AccessTriangle(&indices[t * 3]) == 3 || t == 0) {
+      hardStarts.push_back(static_cast<uint32_t>(t));
+    }
+  }
+  hardStarts.push_back(static_cast<uint32_t>(triangleCount));
+
+  // Soft boundaries: split a hard cluster wherever the part so far, drawn
+  // from a cold cache, is within threshold of the whole cluster's ACMR
+  std::vector<uint32_t> clusterStarts;
+  for (size_t c = 0; c + 1 < hardStarts.size(); c++) {
+    const uint32_t begin = hardStarts[c];
+    const uint32_t end = hardStarts[c + 1];
+
+    cache.Flush();
+    uint32_t misses = 0;
+    for (uint32_t t = begin; t < end; t++) {
+      misses += cache.AccessTriangle(&indices[t * 3]);
+    }
+    const float target = threshold * misses / (end - begin);
+
+    cache.Flush();
+    clusterStarts.push_back(begin);
+    uint32_t start = begin;
+    uint32_t partMisses = 0;
+    for (uint32_t t = begin; t + 1 < end; t++) {
+      partMisses += cache.AccessTriangle(&indices[t * 3]);
+      if (partMisses <= target * (t + 1 - start)) {
+        clusterStarts.push_back(t + 1);
+        start = t + 1;
+        partMisses = 0;
+        cache.Flush();
+      }
+    }
+  }
+  clusterStarts.push_back(static_cast<uint32_t>(triangleCount));
+
+  // Area weighted centroid and normal per cluster
+  struct Cluster {
+    uint32_t begin;
+    uint32_t end;
+    Vector3 centroid;
+    Vector3 normal;
+    float sortKey;
+  };
+  std::vector<Cluster> clusters(clusterStarts.size() - 1);
+  Vector3 meshCentroid(0.0f, 0.0f, 0.0f);
+  float meshArea = 0.0f;
+  for (size_t i = 0; i < clusters.size(); i++) {
+    Cluster &cluster = clusters[i];
+    cluster.begin = clusterStarts[i];
+    cluster.end = clusterStarts[i + 1];
+    Vector3 weightedCenter(0.0f, 0.0f, 0.0f);
+    Vector3 normal(0.0f, 0.0f, 0.0f);
+    float area = 0.0f;
+    for (uint32_t t = cluster.begin; t < cluster.end; t++) {
+      const Vector3 &a = vertices[indices[t * 3]].position;
+      const Vector3 &b = vertices[indices[t * 3 + 1]].position;
+      const Vector3 &c = vertices[indices[t * 3 + 2]].position;
+      const Vector3 cross = (b - a).Cross(c - a);
+      const float triangleArea = cross.Length() * 0.5f;
+      weightedCenter += (a + b + c) * (triangleArea / 3.0f);
+      normal += cross;
+      area += triangleArea;
+    }
+    meshCentroid += weightedCenter;
+    meshArea += area;
+    cluster.centroid = area > 0.0f ? weightedCenter / area : weightedCenter;
+    cluster.normal = normal;
+  }
+  if (meshArea > 0.0f) {
+    meshCentroid /= meshArea;
+  }
+
+  // Clusters far out along their own normal are likely in front of the
+  // rest from any direction that sees them
+  for (Cluster &cluster : clusters) {
+    const float length = cluster.normal.Length();
+    cluster.sortKey =
+        length > 0.0f
+            ? (cluster.centroid - meshCentroid).Dot(cluster.normal) / length
+            : 0.0f;
+  }
+  std::stable_sort(clusters.begin(), clusters.end(),
+                   [](const Cluster &a, const Cluster &b) {
+                     return a.sortKey > b.sortKey;
+                   });
+
+  for (const Cluster &cluster : clusters) {
+    result.insert(result.end(), indices.begin() + cluster.begin * 3,
+                  indices.begin() + cluster.end * 3);
+  }
+  return result;
+}
+
+size_t OptimizeVertexFetch(std::vector<Vertex> &vertices,
+                           std::vector<uint32_t> &indices) {
+  std::vector<uint32_t> remap(vertices.size(), NONE);
+  uint32_t vertexCount = 0;
+  AssignFirstUse(indices, remap, vertexCount);
+  ApplyRemap(vertices, remap, vertexCount);
+  RemapIndices(indices, remap);
+  return vertexCount;
+}
+
+Report Optimize(Mesh &mesh) {
+  Report report;
+  const ArrayView<Vertex> sourceVertices = mesh.GetVertices();
+  report.vertexCountBefore = sourceVertices.size();
+  report.vertexCountAfter = sourceVertices.size();
+  report.before =
+      AnalyzeVertexCache(mesh.GetIndices(), sourceVertices.size());
+  report.after = report.before;
+  if (!IndicesInRange(mesh.GetIndices(), sourceVertices.size()) ||
+      !IndicesInRange(mesh.GetLodIndices(), sourceVertices.size())) {
+    std::cerr << "MeshOptimizer: mesh has out of range indices, skipped"
+              << std::endl;
+    return report;
+  }
+
+  std::vector<Vertex> vertices = sourceVertices.ToVector();
+  std::vector<uint32_t> indices = mesh.GetIndices().ToVector();
+  std::vector<uint32_t> lodIndices = mesh.GetLodIndices().ToVector();
+  const std::vector<MeshLod> lods = mesh.GetLods();
+
+  auto optimizeRange = [&vertices](std::vector<uint32_t> &stream,
+                                   uint32_t offset, uint32_t count) {
+    const ArrayView<uint32_t> range(stream.data() + offset, count - count % 3);
+    const std::vector<uint32_t> ordered = OptimizeOverdraw(
+        OptimizeVertexCache(range, vertices.size()), vertices);
+    std::copy(ordered.begin(), ordered.end(), stream.begin() + offset);
+  };
+  if (mesh.GetSubmeshes().empty()) {
+    optimizeRange(indices, 0, static_cast<uint32_t>(indices.size()));
+  }
+  for (const Submesh &submesh : mesh.GetSubmeshes()) {
+    optimizeRange(indices, submesh.indexOffset, submesh.indexCount);
+  }
+  for (const MeshLod &lod : lods) {
+    optimizeRange(lodIndices, lod.indexOffset, lod.indexCount);
+  }
+
+  // Base mesh order first; vertices only the LODs use go at the end
+  std::vector<uint32_t> remap(vertices.size(), NONE);
+  uint32_t vertexCount = 0;
+  AssignFirstUse(indices, remap, vertexCount);
+  AssignFirstUse(lodIndices, remap, vertexCount);
+  ApplyRemap(vertices, remap, vertexCount);
+  RemapIndices(indices, remap);
+  RemapIndices(lodIndices, remap);
+
+  mesh.SetVertices(vertices);
+  mesh.SetIndices(indices);
+  if (!lods.empty()) {
+    mesh.SetLods(lods, lodIndices);
+  }
+
+  report.vertexCountAfter = vertexCount;
+  report.after = AnalyzeVertexCache(mesh.GetIndices(), vertexCount);
+  return report;
+}
+
+} // namespace MeshOptimizer
+} // namespace AquaVisual
@@ -0,0 +1,548 @@
+#include "AquaVisual/Resources/MeshSimplifier.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <numeric>
+
+namespace AquaVisual {
+namespace MeshSimplifier {
+
+namespace {
+
+constexpr uint32_t NONE = 0xFFFFFFFFu;
+
+// Planes through border and seam edges weigh this much more than surface
+// planes, so outlines hold while interiors simplify
+constexpr double EDGE_WEIGHT = 10.0;
+
+enum class VertexKind : uint8_t {
+  Manifold, // interior, one attribute set: may collapse anywhere
+  Border,   // on an open border: collapses along the border only
+  Seam,     // one of two attribute sets at a position: along the seam only
+  Locked    // corners, complex seams, non-manifold: never moves
+};
+
+// Sum of squared distances to weighted planes, stored as the symmetric
+// matrix A, vector b and constant c of p'Ap + 2b'p + c
+struct Quadric {
+  double a00 = 0.0, a11 = 0.0, a22 = 0.0, a01 = 0.0, a02 = 0.0, a12 = 0.0;
+  double b0 = 0.0, b1 = 0.0, b2 = 0.0;
+  double c = 0.0;
+  double weight = 0.0;
+
+  // Plane n.p + d = 0 with unit normal n
+  static Quadric FromPlane(double nx, double ny, double nz, double d,
+                           double weight) {
+    Quadric q;
+    q.a00 = nx * nx * weight;
+    q.a11 = ny * ny * weight;
+    q.a22 = nz * nz * weight;
+    q.a01 = nx * ny * weight;
+    q.a02 = nx * nz * weight;
+    q.a12 = ny * nz * weight;
+    q.b0 = nx * d * weight;
+    q.b1 = ny * d * weight;
+    q.b2 = nz * d * weight;
+    q.c = d * d * weight;
+    q.weight = weight;
+    return q;
+  }
+
+  void Add(const Quadric &other) {
+    a00 += other.a00;
+    a11 += other.a11;
+    a22 += other.a22;
+    a01 += other.a01;
+    a02 += other.a02;
+    a12 += other.a12;
+    b0 += other.b0;
+    b1 += other.b1;
+    b2 += other.b2;
+    c += other.c;
+    weight += other.weight;
+  }
+
+  // Weighted mean squared distance of a point to the planes
+  double Error(const Vector3 &point) const {
+    const double x = point.x;
+    const double y = point.y;
+    const double z = point.z;
+    const double error = a00 * x * x + a11 * y * y + a22 * z * z +
+                         2.0 * (a01 * x * y + a02 * x * z + a12 * y * z) +
+                         2.0 * (b0 * x + b1 * y + b2 * z) + c;
+    return weight > 0.0 ? std::max(error, 0.0) / weight : 0.0;
+  }
+};
+
+struct Collapse {
+  uint32_t from;
+  uint32_t to;
+  double error;
+};
+
+// Triangles around each vertex, in compressed rows
+struct TriangleAdjacency {
+  std::vector<uint32_t> offsets;
+  std::vector<uint32_t> triangles;
+
+  void Build(const std::vector<uint32_t> &indices, size_t vertexCount) {
+    offsets.assign(vertexCount + 1, 0);
+    for (uint32_t index : indices) {
+      offsets[index + 1]++;
+    }
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+    triangles.resize(indices.size());
+    std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+    for (size_t i = 0; i < indices.size(); i++) {
+      triangles[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+    }
+  }
+
+  const uint32_t *begin(uint32_t vertex) const {
+    return triangles.data() + offsets[vertex];
+  }
+  const uint32_t *end(uint32_t vertex) const {
+    return triangles.data() + offsets[vertex + 1];
+  }
+};
+
+// True when some triangle has the directed edge from -> to
+bool HasEdge(const TriangleAdjacency &adjacency,
+             const std::vector<uint32_t> &indices, uint32_t from,
+             uint32_t to) {
+  for (const uint32_t *t = adjacency.begin(from); t != adjacency.end(from);
+       ++t) {
+    const uint32_t *triangle = &indices[*t * 3];
+    for (int k = 0; k < 3; k++) {
+      if (triangle[k] == from && triangle[(k + 1) % 3] == to) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+uint32_t HashPosition(const Vector3 &position) {
+  // + 0.0f folds -0 into +0 so both hash alike
+  const float values[3] = {position.x + 0.0f, position.y + 0.0f,
+                           position.z + 0.0f};
+  uint32_t bits[3];
+  std::memcpy(bits, values, sizeof(bits));
+  return (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^
+         (bits[2] * 83492791u);
+}
+
+// remap: first vertex with the same position; wedge: ring through all
+// vertices sharing a position
+void BuildPositionRemap(ArrayView<Vertex> vertices,
+                        std::vector<uint32_t> &remap,
+                        std::vector<uint32_t> &wedge) {
+  const size_t vertexCount = vertices.size();
+  size_t tableSize = 16;
+  while (tableSize < vertexCount * 2) {
+    tableSize *= 2;
+  }
+  const size_t mask = tableSize - 1;
+  std::vector<uint32_t> table(tableSize, NONE);
+
+  remap.resize(vertexCount);
+  for (uint32_t v = 0; v < vertexCount; v++) {
+    const Vector3 &position = vertices[v].position;
+    size_t slot = HashPosition(position) & mask;
+    for (;;) {
+      const uint32_t other = table[slot];
+      if (other == NONE) {
+        table[slot] = v;
+        remap[v] = v;
+        break;
+      }
+      const Vector3 &otherPosition = vertices[other].position;
+      if (otherPosition.x == position.x && otherPosition.y == position.y &&
+          otherPosition.z == position.z) {
+        remap[v] = other;
+        break;
+      }
+      slot = (slot + 1) & mask;
+    }
+  }
+
+  wedge.resize(vertexCount);
+  std::iota(wedge.begin(), wedge.end(), 0u);
+  for (uint32_t v = 0; v < vertexCount; v++) {
+    if (remap[v] != v) {
+      wedge[v] = wedge[remap[v]];
+      wedge[remap[v]] = v;
+    }
+  }
+}
+
+// Owns the per-vertex state of one Simplify() call
+class Simplifier {
+public:
+  Simplifier(ArrayView<Vertex> vertices, std::vector<uint32_t> &indices)
+      : m_vertices(vertices), m_indices(indices) {
+    const size_t vertexCount = vertices.size();
+    BuildPositionRemap(vertices, m_remap, m_wedge);
+    m_adjacency.Build(m_indices, vertexCount);
+    m_openOut.assign(vertexCount, NONE);
+    m_openIn.assign(vertexCount, NONE);
+    m_kinds.assign(vertexCount, VertexKind::Manifold);
+    m_quadrics.resize(vertexCount);
+    m_collapseRemap.resize(vertexCount);
+    m_locked.resize(vertexCount);
+    ClassifyVertices();
+  }
+
+  // Returns the largest collapse error, squared
+  double Run(size_t targetIndexCount, double errorLimit) {
+    double maxError = 0.0;
+    std::vector<Collapse> collapses;
+    while (m_indices.size() > targetIndexCount) {
+      PickCollapses(collapses);
+      std::sort(collapses.begin(), collapses.end(),
+                [](const Collapse &a, const Collapse &b) {
+                  return a.error < b.error;
+                });
+      const size_t removeGoal = (m_indices.size() - targetIndexCount) / 3;
+      if (!PerformCollapses(collapses, removeGoal, errorLimit, maxError)) {
+        break;
+      }
+      ApplyCollapses();
+    }
+    return maxError;
+  }
+
+private:
+  void ClassifyVertices() {
+    const size_t vertexCount = m_vertices.size();
+    std::vector<bool> multiple(vertexCount, false);
+
+    for (size_t i = 0; i < m_indices.size(); i += 3) {
+      const Vector3 &p0 = m_vertices[m_indices[i]].position;
+      const Vector3 &p1 = m_vertices[m_indices[i + 1]].position;
+      const Vector3 &p2 = m_vertices[m_indices[i + 2]].position;
+      const Vector3 cross = (p1 - p0).Cross(p2 - p0);
+      const double length = cross.Length();
+      if (length == 0.0) {
+        continue;
+      }
+      const double nx = cross.x / length;
+      const double ny = cross.y / length;
+      const double nz = cross.z / length;
+      const Quadric plane = Quadric::FromPlane(
+          nx, ny, nz, -(nx * p0.x + ny * p0.y + nz * p0.z), length * 0.5);
+      for (int k = 0; k < 3; k++) {
+        m_quadrics[m_remap[m_indices[i + k]]].Add(plane);
+      }
+
+      // Edges without a twin in attribute space are borders or seams
+      for (int k = 0; k < 3; k++) {
+        const uint32_t a = m_indices[i + k];
+        const uint32_t b = m_indices[i + (k + 1) % 3];
+        if (HasEdge(m_adjacency, m_indices, b, a)) {
+          continue;
+        }
+        if (m_openOut[a] != NONE && m_openOut[a] != b) {
+          multiple[a] = true;
+        }
+        if (m_openIn[b] != NONE && m_openIn[b] != a) {
+          multiple[b] = true;
+        }
+        m_openOut[a] = b;
+        m_openIn[b] = a;
+
+        // Plane through the edge, perpendicular to the triangle
+        const Vector3 &pa = m_vertices[a].position;
+        const Vector3 edge = m_vertices[b].position - pa;
+        const double ex = edge.y * nz - edge.z * ny;
+        const double ey = edge.z * nx - edge.x * nz;
+        const double ez = edge.x * ny - edge.y * nx;
+        const double edgeLength = std::sqrt(ex * ex + ey * ey + ez * ez);
+        if (edgeLength == 0.0) {
+          continue;
+        }
+        const Quadric edgePlane = Quadric::FromPlane(
+            ex / edgeLength, ey / edgeLength, ez / edgeLength,
+            -(ex * pa.x + ey * pa.y + ez * pa.z) / edgeLength,
+            edge.LengthSquared() * EDGE_WEIGHT);
+        m_quadrics[m_remap[a]].Add(edgePlane);
+        m_quadrics[m_remap[b]].Add(edgePlane);
+      }
+    }
+
+    for (uint32_t v = 0; v < vertexCount; v++) {
+      const bool hasOpen = m_openOut[v] != NONE || m_openIn[v] != NONE;
+      const bool simpleLoop =
+          m_openOut[v] != NONE && m_openIn[v] != NONE && !multiple[v];
+      if (m_wedge[v] == v) {
+        m_kinds[v] = !hasOpen     ? VertexKind::Manifold
+                     : simpleLoop ? VertexKind::Border
+                                  : VertexKind::Locked;
+        continue;
+      }
+
+      // A seam has exactly two attribute sets whose open edges run in
+      // opposite directions between the same positions
+      const uint32_t twin = m_wedge[v];
+      const bool pair = m_wedge[twin] == v;
+      const bool twinSimple = pair && m_openOut[twin] != NONE &&
+                              m_openIn[twin] != NONE && !multiple[twin];
+      const bool seam =
+          simpleLoop && twinSimple &&
+          m_remap[m_openOut[v]] == m_remap[m_openIn[twin]] &&
+          m_remap[m_openIn[v]] == m_remap[m_openOut[twin]];
+      m_kinds[v] = seam ? VertexKind::Seam : VertexKind::Locked;
+    }
+  }
+
+  bool CanCollapse(uint32_t from, uint32_t to) const {
+    switch (m_kinds[from]) {
+    case VertexKind::Manifold:
+      return true;
+    case VertexKind::Border:
+    case VertexKind::Seam:
+      return m_kinds[to] == m_kinds[from] &&
+             (m_openOut[from] == to || m_openIn[from] == to);
+    default:
+      return false;
+    }
+  }
+
+  void PickCollapses(std::vector<Collapse> &collapses) const {
+    collapses.clear();
+    for (size_t i = 0; i < m_indices.size(); i += 3) {
+      for (int k = 0; k < 3; k++) {
+        const uint32_t a = m_indices[i + k];
+        const uint32_t b = m_indices[i + (k + 1) % 3];
+        // Interior edges are seen from both triangles; take them once
+        if (a > b && HasEdge(m_adjacency, m_indices, b, a)) {
+          continue;
+        }
+        if (CanCollapse(a, b)) {
+          collapses.push_back(
+              {a, b, m_quadrics[m_remap[a]].Error(m_vertices[b].position)});
+        }
+        if (CanCollapse(b, a)) {
+          collapses.push_back(
+              {b, a, m_quadrics[m_remap[b]].Error(m_vertices[a].position)});
+        }
+      }
+    }
+  }
+
+  // True if moving vertex to target flips or flattens one of its
+  // triangles; triangles touching target's position are removed anyway
+  bool Flips(uint32_t vertex, uint32_t targetPosition,
+             const Vector3 &target) const {
+    for (const uint32_t *t = m_adjacency.begin(vertex);
+         t != m_adjacency.end(vertex); ++t) {
+      const uint32_t *triangle = &m_indices[*t * 3];
+      const int k = triangle[0] == vertex ? 0 : triangle[1] == vertex ? 1 : 2;
+      const uint32_t b = triangle[(k + 1) % 3];
+      const uint32_t c = triangle[(k + 2) % 3];
+      if (m_remap[b] == targetPosition || m_remap[c] == targetPosition) {
+        continue;
+      }
+      const Vector3 &pa = m_vertices[vertex].position;
+      const Vector3 &pb = m_vertices[b].position;
+      const Vector3 &pc = m_vertices[c].position;
+      const Vector3 before = (pb - pa).Cross(pc - pa);
+      const Vector3 after = (pb - target).Cross(pc - target);
+      if (before.Dot(after) <= 0.0f) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Keeps every triangle changed by at most one collapse per pass, so the
+  // flip test above sees the final positions
+  void LockNeighborhood(uint32_t vertex) {
+    for (const uint32_t *t = m_adjacency.begin(vertex);
+         t != m_adjacency.end(vertex); ++t) {
+      for (int k = 0; k < 3; k++) {
+        m_locked[m_remap[m_indices[*t * 3 + k]]] = true;
+      }
+    }
+  }
+
+  // The open edge loop skips the collapsed vertex
+  void UpdateLoop(uint32_t from, uint32_t to) {
+    if (m_openOut[from] == to) {
+      const uint32_t previous = m_openIn[from];
+      if (previous != NONE) {
+        m_openOut[previous] = to;
+      }
+      m_openIn[to] = previous;
+    } else if (m_openIn[from] == to) {
+      const uint32_t next = m_openOut[from];
+      if (next != NONE) {
+        m_openIn[next] = to;
+      }
+      m_openOut[to] = next;
+    }
+  }
+
+  bool PerformCollapses(const std::vector<Collapse> &collapses,
+                        size_t removeGoal, double errorLimit,
+                        double &maxError) {
+    std::iota(m_collapseRemap.begin(), m_collapseRemap.end(), 0u);
+    std::fill(m_locked.begin(), m_locked.end(), false);
+
+    size_t removed = 0;
+    bool collapsed = false;
+    for (const Collapse &collapse : collapses) {
+      if (removed >= removeGoal || collapse.error > errorLimit) {
+        break;
+      }
+      const uint32_t fromPosition = m_remap[collapse.from];
+      const uint32_t toPosition = m_remap[collapse.to];
+      if (m_locked[fromPosition] || m_locked[toPosition]) {
+        continue;
+      }
+
+      // Seam partners move together, along the partner seam
+      uint32_t twinFrom = NONE;
+      uint32_t twinTo = NONE;
+      if (m_kinds[collapse.from] == VertexKind::Seam) {
+        twinFrom = m_wedge[collapse.from];
+        twinTo = m_wedge[collapse.to];
+        if (m_openOut[twinFrom] != twinTo && m_openIn[twinFrom] != twinTo) {
+          continue;
+        }
+      }
+
+      const Vector3 &target = m_vertices[collapse.to].position;
+      if (Flips(collapse.from, toPosition, target) ||
+          (twinFrom != NONE && Flips(twinFrom, toPosition, target))) {
+        continue;
+      }
+
+      LockNeighborhood(collapse.from);
+      m_collapseRemap[collapse.from] = collapse.to;
+      UpdateLoop(collapse.from, collapse.to);
+      if (twinFrom != NONE) {
+        LockNeighborhood(twinFrom);
+        m_collapseRemap[twinFrom] = twinTo;
+        UpdateLoop(twinFrom, twinTo);
+      }
+      m_quadrics[toPosition].Add(m_quadrics[fromPosition]);
+
+      removed += m_kinds[collapse.from] == VertexKind::Border ? 1 : 2;
+      maxError = std::max(maxError, collapse.error);
+      collapsed = true;
+    }
+    return collapsed;
+  }
+
+  void ApplyCollapses() {
+    size_t write = 0;
+    for (size_t i = 0; i < m_indices.size(); i += 3) {
+      const uint32_t a = m_collapseRemap[m_indices[i]];
+      const uint32_t b = m_collapseRemap[m_indices[i + 1]];
+      const uint32_t c = m_collapseRemap[m_indices[i + 2]];
+      if (a != b && b != c && c != a) {
+        m_indices[write++] = a;
+        m_indices[write++] = b;
+        m_indices[write++] = c;
+      }
+    }
+    m_indices.resize(write);
+    m_adjacency.Build(m_indices, m_vertices.size());
+  }
+
+  ArrayView<Vertex> m_vertices;
+  std::vector<uint32_t> &m_indices;
+  std::vector<uint32_t> m_remap;
+  std::vector<uint32_t> m_wedge;
+  TriangleAdjacency m_adjacency;
+  std::vector<uint32_t> m_openOut; // next vertex along an open edge
+  std::vector<uint32_t> m_openIn;  // previous vertex along an open edge
+  std::vector<VertexKind> m_kinds;
+  std::vector<Quadric> m_quadrics; // indexed by m_remap
+  std::vector<uint32_t> m_collapseRemap;
+  std::vector<bool> m_locked; // indexed by m_remap, reset every pass
+};
+
+} // namespace
+
+std::vector<uint32_t> Simplify(ArrayView<Vertex> vertices,
+                               ArrayView<uint32_t> indices,
+                               size_t targetIndexCount, float targetError,
+                               float *resultError) {
+  std::vector<uint32_t> result(indices.begin(),
+                               indices.begin() + indices.size() / 3 * 3);
+  if (resultError) {
+    *resultError = 0.0f;
+  }
+  if (result.size() <= targetIndexCount) {
+    return result;
+  }
+
+  Simplifier simplifier(vertices, result);
+  const double limit = std::max(targetError, 0.0f);
+  const double error = simplifier.Run(targetIndexCount, limit * limit);
+  if (resultError) {
+    *resultError = static_cast<float>(std::sqrt(error));
+  }
+  return result;
+}
+
+bool GenerateLods(Mesh &mesh, const LodOptions &options) {
+  if (mesh.GetSubmeshes().size() > 1) {
+    std::cerr << "MeshSimplifier: LODs of meshes with several submeshes are "
+                 "not supported"
+              << std::endl;
+    return false;
+  }
+  const AABB &bounds = mesh.GetBounds();
+  if (!bounds.IsValid() || mesh.GetIndexCount() < 3) {
+    return false;
+  }
+
+  const ArrayView<Vertex> vertices = mesh.GetVertices();
+  const float errorLimit =
+      options.maxError * (bounds.maximum - bounds.minimum).Length();
+  const size_t levelCount = std::min(options.maxLevels, Mesh::MAX_LODS);
+
+  std::vector<MeshLod> lods;
+  std::vector<uint32_t> lodIndices;
+  std::vector<uint32_t> current = mesh.GetIndices().ToVector();
+  float error = 0.0f;
+  while (lods.size() < levelCount) {
+    const size_t triangleCount = current.size() / 3;
+    const size_t targetTriangles =
+        static_cast<size_t>(triangleCount * options.reduction);
+    if (targetTriangles < options.minTriangles) {
+      break;
+    }
+
+    float stepError = 0.0f;
+    std::vector<uint32_t> next = Simplify(
+        vertices, current, targetTriangles * 3, errorLimit - error, &stepError);
+    // The error limit or locked vertices stopped it at less than half the
+    // requested reduction; further levels would barely differ
+    if (next.size() / 3 > triangleCount - (triangleCount - targetTriangles) / 2) {
+      break;
+    }
+
+    error += stepError;
+    MeshLod lod;
+    lod.indexOffset = static_cast<uint32_t>(lodIndices.size());
+    lod.indexCount = static_cast<uint32_t>(next.size());
+    lod.error = error;
+    lods.push_back(lod);
+    lodIndices.insert(lodIndices.end(), next.begin(), next.end());
+    current.swap(next);
+  }
+
+  if (lods.empty()) {
+    return false;
+  }
+  mesh.SetLods(lods, lodIndices);
+  return true;
+}
+
+} // namespace MeshSimplifier
+} // namespace AquaVisual
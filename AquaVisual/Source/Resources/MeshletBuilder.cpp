@@ -0,0 +1,461 @@
+#include "AquaVisual/Resources/MeshletBuilder.h"
+#include "AquaVisual/Resources/MeshOptimizer.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace AquaVisual {
+namespace MeshletBuilder {
+
+namespace {
+
+constexpr uint32_t NONE = 0xFFFFFFFFu;
+
+struct CellKey {
+  int64_t cell[3];
+  bool operator==(const CellKey &other) const {
+    return cell[0] == other.cell[0] && cell[1] == other.cell[1] &&
+           cell[2] == other.cell[2];
+  }
+};
+
+struct CellKeyHash {
+  size_t operator()(const CellKey &key) const {
+    return static_cast<size_t>(key.cell[0] * 73856093 ^
+                               key.cell[1] * 19349663 ^
+                               key.cell[2] * 83492791);
+  }
+};
+
+// True when every edge between distinct positions is shared by a triangle
+// running the other way, i.e. the surface has no holes. Positions are
+// welded on a fine grid so seams computed with rounding still close.
+bool IsClosed(ArrayView<Vertex> vertices, ArrayView<uint32_t> indices,
+              const AABB &bounds) {
+  const float cellSize =
+      std::max((bounds.maximum - bounds.minimum).Length() * 1e-6f,
+               std::numeric_limits<float>::min());
+  std::unordered_map<CellKey, uint32_t, CellKeyHash> cells;
+  std::vector<uint32_t> weld(vertices.size());
+  for (size_t v = 0; v < vertices.size(); v++) {
+    const Vec3 &position = vertices[v].position;
+    const CellKey key = {{std::llround(position.x / cellSize),
+                          std::llround(position.y / cellSize),
+                          std::llround(position.z / cellSize)}};
+    weld[v] =
+        cells.emplace(key, static_cast<uint32_t>(cells.size())).first->second;
+  }
+
+  std::unordered_set<uint64_t> edges;
+  for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+    for (int k = 0; k < 3; k++) {
+      const uint32_t a = weld[indices[i + k]];
+      const uint32_t b = weld[indices[i + (k + 1) % 3]];
+      if (a != b) {
+        edges.insert(static_cast<uint64_t>(a) << 32 | b);
+      }
+    }
+  }
+  for (uint64_t edge : edges) {
+    if (!edges.count(edge << 32 | edge >> 32)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+Vec3 TriangleNormal(ArrayView<Vertex> vertices, const uint32_t *triangle) {
+  const Vec3 &a = vertices[triangle[0]].position;
+  return (vertices[triangle[1]].position - a)
+      .Cross(vertices[triangle[2]].position - a);
+}
+
+// +1 when the winding agrees with the vertex normals, -1 when it opposes
+float FacingSign(ArrayView<Vertex> vertices,
+                 const std::vector<uint32_t> &indices) {
+  double agreement = 0.0;
+  for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+    const Vec3 normal =
+        vertices[indices[i]].normal + vertices[indices[i + 1]].normal +
+        vertices[indices[i + 2]].normal;
+    agreement += TriangleNormal(vertices, &indices[i]).Dot(normal);
+  }
+  return agreement < 0.0 ? -1.0f : 1.0f;
+}
+
+int8_t QuantizeSnorm(float value) {
+  return static_cast<int8_t>(
+      std::lround(std::max(-1.0f, std::min(1.0f, value)) * 127.0f));
+}
+
+void ComputeBounds(ArrayView<Vertex> vertices,
+                   const std::vector<uint32_t> &meshletVertices,
+                   Meshlet &meshlet) {
+  // Sphere around the box center, as for whole meshes in GeometryArena
+  AABB box;
+  for (uint32_t v : meshletVertices) {
+    box.Expand(vertices[v].position);
+  }
+  const Vec3 center = box.GetCenter();
+  float radiusSquared = 0.0f;
+  for (uint32_t v : meshletVertices) {
+    radiusSquared = std::max(radiusSquared,
+                             (vertices[v].position - center).LengthSquared());
+  }
+  meshlet.boundingSphere[0] = center.x;
+  meshlet.boundingSphere[1] = center.y;
+  meshlet.boundingSphere[2] = center.z;
+  meshlet.boundingSphere[3] = std::sqrt(radiusSquared);
+}
+
+uint32_t ComputeCone(ArrayView<Vertex> vertices, const uint32_t *indices,
+                     size_t indexCount, float facing) {
+  std::vector<Vec3> normals;
+  normals.reserve(indexCount / 3);
+  Vec3 sum(0.0f, 0.0f, 0.0f);
+  for (size_t i = 0; i < indexCount; i += 3) {
+    const Vec3 normal = TriangleNormal(vertices, indices + i) * facing;
+    const float length = normal.Length();
+    if (length > 0.0f) {
+      normals.push_back(normal / length);
+      sum += normals.back();
+    }
+  }
+  if (normals.empty() || sum.Length() <= 0.0f) {
+    return 0;
+  }
+
+  // Measure the spread against the axis as the shader will decode it
+  const Vec3 axis = sum / sum.Length();
+  const int8_t quantized[3] = {QuantizeSnorm(axis.x), QuantizeSnorm(axis.y),
+                               QuantizeSnorm(axis.z)};
+  Vec3 decoded(quantized[0] / 127.0f, quantized[1] / 127.0f,
+               quantized[2] / 127.0f);
+  decoded = decoded / decoded.Length();
+
+  float minDot = 1.0f;
+  for (const Vec3 &normal : normals) {
+    minDot = std::min(minDot, normal.Dot(decoded));
+  }
+  // Half angle of 90 degrees or more: some triangle always faces the camera
+  if (minDot <= 0.0f) {
+    return 0;
+  }
+  const float sine = std::sqrt(std::max(0.0f, 1.0f - minDot * minDot));
+  const float cutoff = std::ceil(sine * 127.0f);
+  if (cutoff >= 127.0f) {
+    return 0;
+  }
+
+  uint32_t packed = 0;
+  for (int k = 0; k < 3; k++) {
+    packed |= static_cast<uint32_t>(static_cast<uint8_t>(quantized[k]))
+              << (8 * k);
+  }
+  return packed | static_cast<uint32_t>(cutoff) << 24;
+}
+
+// Greedy cluster growth over one triangle list
+class Clusterizer {
+public:
+  Clusterizer(ArrayView<Vertex> vertices, const std::vector<uint32_t> &indices)
+      : m_vertices(vertices), m_indices(indices),
+        m_triangleCount(indices.size() / 3), m_emitted(m_triangleCount, false),
+        m_inMeshlet(vertices.size(), false) {
+    m_offsets.assign(vertices.size() + 1, 0);
+    for (size_t i = 0; i < m_triangleCount * 3; i++) {
+      m_offsets[indices[i] + 1]++;
+    }
+    std::partial_sum(m_offsets.begin(), m_offsets.end(), m_offsets.begin());
+    m_adjacency.resize(m_triangleCount * 3);
+    std::vector<uint32_t> fill(m_offsets.begin(), m_offsets.end() - 1);
+    for (size_t i = 0; i < m_triangleCount * 3; i++) {
+      m_adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+    }
+    m_live.resize(vertices.size());
+    for (size_t v = 0; v < vertices.size(); v++) {
+      m_live[v] = m_offsets[v + 1] - m_offsets[v];
+    }
+  }
+
+  // Appends triangle ids meshlet by meshlet; ends holds one past each
+  // meshlet's last triangle
+  void Run(std::vector<uint32_t> &order, std::vector<uint32_t> &ends,
+           std::vector<std::vector<uint32_t>> &meshletVertices) {
+    size_t scan = 0;
+    for (;;) {
+      uint32_t next = m_meshletVertices.empty() ? NONE : PickGrowth();
+      if (next == NONE) {
+        // Nothing fits or touches the meshlet: close it and start the next
+        // one beside it
+        if (!m_meshletVertices.empty()) {
+          Flush(order, ends, meshletVertices);
+          next = PickSeed(meshletVertices.back());
+        }
+        if (next == NONE) {
+          while (scan < m_triangleCount && m_emitted[scan]) {
+            scan++;
+          }
+          if (scan == m_triangleCount) {
+            break;
+          }
+          next = static_cast<uint32_t>(scan);
+        }
+      }
+      Add(next, order);
+      if (m_triangles == MAX_TRIANGLES) {
+        Flush(order, ends, meshletVertices);
+        next = PickSeed(meshletVertices.back());
+        if (next != NONE) {
+          Add(next, order);
+        }
+      }
+    }
+  }
+
+private:
+  uint32_t NewVertexCount(uint32_t triangle) const {
+    uint32_t count = 0;
+    for (int k = 0; k < 3; k++) {
+      count += m_inMeshlet[m_indices[triangle * 3 + k]] ? 0 : 1;
+    }
+    return count;
+  }
+
+  // Unemitted triangle next to the meshlet that adds the fewest vertices,
+  // then lies closest to its center; NONE if none fits
+  uint32_t PickGrowth() const {
+    const Vec3 center = m_centroidSum / static_cast<float>(m_triangles);
+    uint32_t best = NONE;
+    uint32_t bestAdded = 4;
+    float bestDistance = std::numeric_limits<float>::max();
+    for (uint32_t v : m_meshletVertices) {
+      for (uint32_t a = m_offsets[v]; a < m_offsets[v + 1]; a++) {
+        const uint32_t triangle = m_adjacency[a];
+        if (m_emitted[triangle]) {
+          continue;
+        }
+        const uint32_t added = NewVertexCount(triangle);
+        if (added > bestAdded ||
+            m_meshletVertices.size() + added > MAX_VERTICES) {
+          continue;
+        }
+        const float distance = (Centroid(triangle) - center).LengthSquared();
+        if (added < bestAdded || distance < bestDistance) {
+          best = triangle;
+          bestAdded = added;
+          bestDistance = distance;
+        }
+      }
+    }
+    return best;
+  }
+
+  // Unemitted triangle next to the previous meshlet with the fewest
+  // unemitted neighbors, so corners get used up before they are stranded
+  uint32_t PickSeed(const std::vector<uint32_t> &previous) const {
+    uint32_t best = NONE;
+    uint32_t bestLive = std::numeric_limits<uint32_t>::max();
+    for (uint32_t v : previous) {
+      for (uint32_t a = m_offsets[v]; a < m_offsets[v + 1]; a++) {
+        const uint32_t triangle = m_adjacency[a];
+        if (m_emitted[triangle]) {
+          continue;
+        }
+        const uint32_t live = m_live[m_indices[triangle * 3]] +
+                              m_live[m_indices[triangle * 3 + 1]] +
+                              m_live[m_indices[triangle * 3 + 2]];
+        if (live < bestLive) {
+          best = triangle;
+          bestLive = live;
+        }
+      }
+    }
+    return best;
+  }
+
+  Vec3 Centroid(uint32_t triangle) const {
+    return (m_vertices[m_indices[triangle * 3]].position +
+            m_vertices[m_indices[triangle * 3 + 1]].position +
+            m_vertices[m_indices[triangle * 3 + 2]].position) /
+           3.0f;
+  }
+
+  void Add(uint32_t triangle, std::vector<uint32_t> &order) {
+    m_emitted[triangle] = true;
+    order.push_back(triangle);
+    for (int k = 0; k < 3; k++) {
+      const uint32_t v = m_indices[triangle * 3 + k];
+      m_live[v]--;
+      if (!m_inMeshlet[v]) {
+        m_inMeshlet[v] = true;
+        m_meshletVertices.push_back(v);
+      }
+    }
+    m_centroidSum += Centroid(triangle);
+    m_triangles++;
+  }
+
+  void Flush(std::vector<uint32_t> &order, std::vector<uint32_t> &ends,
+             std::vector<std::vector<uint32_t>> &meshletVertices) {
+    ends.push_back(static_cast<uint32_t>(order.size()));
+    for (uint32_t v : m_meshletVertices) {
+      m_inMeshlet[v] = false;
+    }
+    meshletVertices.push_back(std::move(m_meshletVertices));
+    m_meshletVertices.clear();
+    m_centroidSum = Vec3(0.0f, 0.0f, 0.0f);
+    m_triangles = 0;
+  }
+
+  ArrayView<Vertex> m_vertices;
+  const std::vector<uint32_t> &m_indices;
+  size_t m_triangleCount;
+  std::vector<uint32_t> m_offsets; // vertex -> triangles, compressed rows
+  std::vector<uint32_t> m_adjacency;
+  std::vector<uint32_t> m_live; // unemitted triangles per vertex
+  std::vector<bool> m_emitted;
+
+  // Meshlet being built
+  std::vector<bool> m_inMeshlet;
+  std::vector<uint32_t> m_meshletVertices;
+  Vec3 m_centroidSum = Vec3(0.0f, 0.0f, 0.0f);
+  uint32_t m_triangles = 0;
+};
+
+} // namespace
+
+std::vector<Meshlet> Build(ArrayView<Vertex> vertices,
+                           std::vector<uint32_t> &indices, uint32_t firstIndex,
+                           bool cones) {
+  std::vector<Meshlet> meshlets;
+  indices.resize(indices.size() / 3 * 3);
+  if (indices.empty()) {
+    return meshlets;
+  }
+
+  std::vector<uint32_t> order;
+  std::vector<uint32_t> ends;
+  std::vector<std::vector<uint32_t>> meshletVertices;
+  order.reserve(indices.size() / 3);
+  Clusterizer(vertices, indices).Run(order, ends, meshletVertices);
+
+  std::vector<uint32_t> reordered;
+  reordered.reserve(indices.size());
+  for (uint32_t triangle : order) {
+    reordered.insert(reordered.end(), indices.begin() + triangle * 3,
+                     indices.begin() + triangle * 3 + 3);
+  }
+
+  const float facing = cones ? FacingSign(vertices, indices) : 1.0f;
+  meshlets.resize(ends.size());
+  std::vector<uint32_t> localIds(vertices.size());
+  std::vector<uint32_t> local;
+  uint32_t begin = 0;
+  for (size_t m = 0; m < ends.size(); m++) {
+    Meshlet &meshlet = meshlets[m];
+    const uint32_t count = (ends[m] - begin) * 3;
+    uint32_t *range = reordered.data() + begin * 3;
+
+    // Growth order is spatial; restore vertex cache order inside, on
+    // meshlet-local vertex ids
+    const std::vector<uint32_t> &used = meshletVertices[m];
+    for (uint32_t i = 0; i < used.size(); i++) {
+      localIds[used[i]] = i;
+    }
+    local.resize(count);
+    for (uint32_t i = 0; i < count; i++) {
+      local[i] = localIds[range[i]];
+    }
+    const std::vector<uint32_t> cached =
+        MeshOptimizer::OptimizeVertexCache(local, used.size());
+    for (uint32_t i = 0; i < count; i++) {
+      range[i] = used[cached[i]];
+    }
+
+    meshlet.firstIndex = firstIndex + begin * 3;
+    meshlet.indexCount = count;
+    meshlet.vertexCount = static_cast<uint32_t>(meshletVertices[m].size());
+    ComputeBounds(vertices, meshletVertices[m], meshlet);
+    if (cones) {
+      meshlet.cone = ComputeCone(vertices, range, count, facing);
+    }
+    begin = ends[m];
+  }
+
+  indices.swap(reordered);
+  return meshlets;
+}
+
+bool Build(Mesh &mesh) {
+  const ArrayView<Vertex> vertices = mesh.GetVertices();
+  std::vector<uint32_t> indices = mesh.GetIndices().ToVector();
+  if (indices.size() < 3) {
+    return false;
+  }
+  for (uint32_t index : indices) {
+    if (index >= vertices.size()) {
+      std::cerr << "MeshletBuilder: mesh has out of range indices, skipped"
+                << std::endl;
+      return false;
+    }
+  }
+
+  std::vector<Submesh> ranges = mesh.GetSubmeshes();
+  if (ranges.empty()) {
+    Submesh whole;
+    whole.indexCount = static_cast<uint32_t>(indices.size());
+    ranges.push_back(whole);
+  }
+  for (const Submesh &range : ranges) {
+    if (range.indexOffset > indices.size() ||
+        range.indexCount > indices.size() - range.indexOffset) {
+      std::cerr << "MeshletBuilder: mesh has a bad submesh, skipped"
+                << std::endl;
+      return false;
+    }
+  }
+
+  const bool cones = IsClosed(vertices, indices, mesh.GetBounds());
+  std::vector<Meshlet> meshlets;
+  for (const Submesh &range : ranges) {
+    const uint32_t count = range.indexCount - range.indexCount % 3;
+    std::vector<uint32_t> local(indices.begin() + range.indexOffset,
+                                indices.begin() + range.indexOffset + count);
+    const std::vector<Meshlet> built =
+        Build(vertices, local, range.indexOffset, cones);
+    std::copy(local.begin(), local.end(),
+              indices.begin() + range.indexOffset);
+    meshlets.insert(meshlets.end(), built.begin(), built.end());
+  }
+
+  // Triangles only moved within their ranges, the LOD chain still applies
+  const std::vector<MeshLod> lods = mesh.GetLods();
+  const std::vector<uint32_t> lodIndices = mesh.GetLodIndices().ToVector();
+  mesh.SetIndices(indices);
+  if (!lods.empty()) {
+    mesh.SetLods(lods, lodIndices);
+  }
+  mesh.SetMeshlets(meshlets);
+  return true;
+}
+
+bool DecodeCone(const Meshlet &meshlet, Vec3 &axis, float &cutoff) {
+  if (meshlet.cone == 0) {
+    return false;
+  }
+  const auto component = [&meshlet](int k) {
+    return static_cast<int8_t>(meshlet.cone >> (8 * k) & 0xFFu) / 127.0f;
+  };
+  axis = Vec3(component(0), component(1), component(2));
+  axis = axis / axis.Length();
+  cutoff = component(3);
+  return true;
+}
+
+} // namespace MeshletBuilder
+} // namespace AquaVisual
@@ -0,0 +1,568 @@
+#include "AquaVisual/Resources/ObjLoader.h"
+#include "AquaVisual/Core/JobSystem.h"
+#include "AquaVisual/Core/MappedFile.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+namespace AquaVisual {
+
+namespace {
+
+// Smallest piece of the file handed to one worker
+constexpr size_t MIN_CHUNK_SIZE = 4u << 20;
+// Chunks per thread, so uneven chunks still balance
+constexpr size_t CHUNKS_PER_THREAD = 8;
+
+constexpr uint32_t NONE = 0xFFFFFFFFu;
+
+// One face corner: position, texture coordinate and normal indices
+struct Corner {
+  uint32_t position;
+  uint32_t texCoord; // NONE when absent
+  uint32_t normal;   // NONE when absent
+
+  bool operator==(const Corner &other) const {
+    return position == other.position && texCoord == other.texCoord &&
+           normal == other.normal;
+  }
+};
+
+struct AttributeCounts {
+  size_t positions = 0;
+  size_t texCoords = 0;
+  size_t normals = 0;
+};
+
+struct Chunk {
+  const char *begin = nullptr;
+  const char *end = nullptr;
+  AttributeCounts counts;  // records in this chunk
+  AttributeCounts offsets; // records in the chunks before it
+
+  std::vector<Corner> corners;   // distinct corners in first-use order
+  std::vector<uint32_t> indices; // triangles, indexing corners
+  std::vector<uint32_t> remap;   // corners to final vertices
+  size_t indexOffset = 0;
+
+  const char *errorLine = nullptr;
+  const char *error = nullptr;
+};
+
+struct Attributes {
+  std::vector<Vector3> positions;
+  std::vector<Vector2> texCoords;
+  std::vector<Vector3> normals;
+};
+
+// Open addressing set of corners. Slots hold indices into the corner list
+// the set is used with, so the corners themselves are stored only once.
+class CornerTable {
+public:
+  uint32_t Insert(const Corner &corner, std::vector<Corner> &corners) {
+    if ((corners.size() + 1) * 2 > m_slots.size()) {
+      Grow(corners);
+    }
+    size_t slot = Hash(corner) & m_mask;
+    for (;;) {
+      const uint32_t entry = m_slots[slot];
+      if (entry == NONE) {
+        m_slots[slot] = static_cast<uint32_t>(corners.size());
+        corners.push_back(corner);
+        return m_slots[slot];
+      }
+      if (corners[entry] == corner) {
+        return entry;
+      }
+      slot = (slot + 1) & m_mask;
+    }
+  }
+
+  void Reserve(size_t count, const std::vector<Corner> &corners) {
+    size_t capacity = 64;
+    while (capacity < count * 2) {
+      capacity *= 2;
+    }
+    if (capacity > m_slots.size()) {
+      Rehash(capacity, corners);
+    }
+  }
+
+private:
+  static size_t Hash(const Corner &corner) {
+    uint64_t hash = (static_cast<uint64_t>(corner.position) << 32 |
+                     corner.texCoord) *
+                        0x9E3779B97F4A7C15ull ^
+                    corner.normal * 0xC2B2AE3D27D4EB4Full;
+    hash ^= hash >> 29;
+    return static_cast<size_t>(hash);
+  }
+
+  void Grow(const std::vector<Corner> &corners) {
+    Rehash(std::max<size_t>(m_slots.size() * 2, 64), corners);
+  }
+
+  void Rehash(size_t capacity, const std::vector<Corner> &corners) {
+    m_slots.assign(capacity, NONE);
+    m_mask = capacity - 1;
+    for (size_t i = 0; i < corners.size(); i++) {
+      size_t slot = Hash(corners[i]) & m_mask;
+      while (m_slots[slot] != NONE) {
+        slot = (slot + 1) & m_mask;
+      }
+      m_slots[slot] = static_cast<uint32_t>(i);
+    }
+  }
+
+  std::vector<uint32_t> m_slots;
+  size_t m_mask = 0;
+};
+
+bool IsBlank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+void SkipBlanks(const char *&p, const char *end) {
+  while (p < end && IsBlank(*p)) {
+    p++;
+  }
+}
+
+bool IsDigit(char c) { return c >= '0' && c <= '9'; }
+
+// Decimal float with optional sign, fraction and exponent. Up to 19
+// significant digits are accumulated exactly, then scaled once.
+bool ParseFloat(const char *&p, const char *end, float &value) {
+  static const double POWERS[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,
+                                  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                  1e12, 1e13, 1e14, 1e15, 1e16, 1e17,
+                                  1e18, 1e19, 1e20, 1e21, 1e22};
+  SkipBlanks(p, end);
+  bool negative = false;
+  if (p < end && (*p == '-' || *p == '+')) {
+    negative = *p == '-';
+    p++;
+  }
+
+  uint64_t mantissa = 0;
+  int digits = 0;
+  int exponent = 0;
+  bool any = false;
+  for (; p < end && IsDigit(*p); p++, any = true) {
+    if (digits < 19) {
+      mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+      digits += mantissa != 0 ? 1 : 0;
+    } else {
+      exponent++;
+    }
+  }
+  if (p < end && *p == '.') {
+    for (p++; p < end && IsDigit(*p); p++, any = true) {
+      if (digits < 19) {
+        mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+        digits += mantissa != 0 ? 1 : 0;
+        exponent--;
+      }
+    }
+  }
+  if (!any) {
+    return false;
+  }
+  if (p < end && (*p == 'e' || *p == 'E')) {
+    const char *mark = p++;
+    bool negativeExponent = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+      negativeExponent = *p == '-';
+      p++;
+    }
+    if (p < end && IsDigit(*p)) {
+      int written = 0;
+      for (; p < end && IsDigit(*p); p++) {
+        written = std::min(written * 10 + (*p - '0'), 1000);
+      }
+      exponent += negativeExponent ? -written : written;
+    } else {
+      p = mark; // not an exponent after all
+    }
+  }
+
+  double result = static_cast<double>(mantissa);
+  if (mantissa != 0 && exponent != 0) {
+    if (exponent > 0 && exponent <= 22) {
+      result *= POWERS[exponent];
+    } else if (exponent < 0 && exponent >= -22) {
+      result /= POWERS[-exponent];
+    } else {
+      result *= std::pow(10.0, exponent);
+    }
+  }
+  value = static_cast<float>(negative ? -result : result);
+  return true;
+}
+
+bool ParseIndex(const char *&p, const char *end, int64_t &value) {
+  bool negative = false;
+  if (p < end && (*p == '-' || *p == '+')) {
+    negative = *p == '-';
+    p++;
+  }
+  if (p >= end || !IsDigit(*p)) {
+    return false;
+  }
+  int64_t result = 0;
+  for (; p < end && IsDigit(*p); p++) {
+    result = std::min<int64_t>(result * 10 + (*p - '0'), INT64_C(1) << 40);
+  }
+  value = negative ? -result : result;
+  return true;
+}
+
+// Record type of the line starting at p
+enum class Record { Other, Position, TexCoord, Normal, Face };
+
+Record Classify(const char *&p, const char *end) {
+  SkipBlanks(p, end);
+  if (end - p < 2) {
+    return Record::Other;
+  }
+  if (p[0] == 'f' && IsBlank(p[1])) {
+    p += 2;
+    return Record::Face;
+  }
+  if (p[0] != 'v') {
+    return Record::Other;
+  }
+  if (IsBlank(p[1])) {
+    p += 2;
+    return Record::Position;
+  }
+  if (end - p >= 3 && IsBlank(p[2])) {
+    if (p[1] == 't') {
+      p += 3;
+      return Record::TexCoord;
+    }
+    if (p[1] == 'n') {
+      p += 3;
+      return Record::Normal;
+    }
+  }
+  return Record::Other;
+}
+
+template <typename Visitor>
+void ForEachLine(const char *begin, const char *end, Visitor &&visit) {
+  for (const char *line = begin; line < end;) {
+    const void *found = std::memchr(line, '\n', end - line);
+    const char *lineEnd = found ? static_cast<const char *>(found) : end;
+    if (!visit(line, lineEnd)) {
+      return;
+    }
+    line = lineEnd + 1;
+  }
+}
+
+void CountRecords(Chunk &chunk) {
+  ForEachLine(chunk.begin, chunk.end, [&](const char *p, const char *end) {
+    switch (Classify(p, end)) {
+    case Record::Position:
+      chunk.counts.positions++;
+      break;
+    case Record::TexCoord:
+      chunk.counts.texCoords++;
+      break;
+    case Record::Normal:
+      chunk.counts.normals++;
+      break;
+    default:
+      break;
+    }
+    return true;
+  });
+}
+
+// OBJ indices are 1-based, or relative to the records read so far when
+// negative
+bool ResolveIndex(int64_t index, size_t before, size_t total,
+                  uint32_t &resolved) {
+  const int64_t absolute =
+      index > 0 ? index - 1 : static_cast<int64_t>(before) + index;
+  if (index == 0 || absolute < 0 || absolute >= static_cast<int64_t>(total)) {
+    return false;
+  }
+  resolved = static_cast<uint32_t>(absolute);
+  return true;
+}
+
+void ParseChunk(Chunk &chunk, const AttributeCounts &totals,
+                Attributes &attributes) {
+  AttributeCounts read = chunk.offsets;
+  CornerTable table;
+  // Roughly one distinct corner per 40 bytes of typical files
+  table.Reserve(static_cast<size_t>(chunk.end - chunk.begin) / 40,
+                chunk.corners);
+  chunk.indices.reserve(static_cast<size_t>(chunk.end - chunk.begin) / 16);
+
+  auto fail = [&](const char *line, const char *message) {
+    chunk.errorLine = line;
+    chunk.error = message;
+    return false;
+  };
+
+  ForEachLine(chunk.begin, chunk.end, [&](const char *line, const char *end) {
+    const char *p = line;
+    switch (Classify(p, end)) {
+    case Record::Position: {
+      Vector3 &position = attributes.positions[read.positions++];
+      if (!ParseFloat(p, end, position.x) || !ParseFloat(p, end, position.y) ||
+          !ParseFloat(p, end, position.z)) {
+        return fail(line, "malformed vertex position");
+      }
+      return true;
+    }
+    case Record::TexCoord: {
+      Vector2 &texCoord = attributes.texCoords[read.texCoords++];
+      if (!ParseFloat(p, end, texCoord.x)) {
+        return fail(line, "malformed texture coordinate");
+      }
+      // v is optional
+      const char *mark = p;
+      if (!ParseFloat(p, end, texCoord.y)) {
+        p = mark;
+        texCoord.y = 0.0f;
+      }
+      return true;
+    }
+    case Record::Normal: {
+      Vector3 &normal = attributes.normals[read.normals++];
+      if (!ParseFloat(p, end, normal.x) || !ParseFloat(p, end, normal.y) ||
+          !ParseFloat(p, end, normal.z)) {
+        return fail(line, "malformed vertex normal");
+      }
+      return true;
+    }
+    case Record::Face: {
+      uint32_t first = NONE;
+      uint32_t previous = NONE;
+      int cornerCount = 0;
+      for (;;) {
+        SkipBlanks(p, end);
+        if (p >= end || *p == '#') {
+          break;
+        }
+        Corner corner{NONE, NONE, NONE};
+        int64_t index = 0;
+        if (!ParseIndex(p, end, index) ||
+            !ResolveIndex(index, read.positions, totals.positions,
+                          corner.position)) {
+          return fail(line, "invalid position index in face");
+        }
+        if (p < end && *p == '/') {
+          p++;
+          if (p < end && *p != '/' && !IsBlank(*p)) {
+            if (!ParseIndex(p, end, index) ||
+                !ResolveIndex(index, read.texCoords, totals.texCoords,
+                              corner.texCoord)) {
+              return fail(line, "invalid texture coordinate index in face");
+            }
+          }
+          if (p < end && *p == '/') {
+            p++;
+            if (!ParseIndex(p, end, index) ||
+                !ResolveIndex(index, read.normals, totals.normals,
+                              corner.normal)) {
+              return fail(line, "invalid normal index in face");
+            }
+          }
+        }
+        if (p < end && !IsBlank(*p) && *p != '#') {
+          return fail(line, "malformed face");
+        }
+
+        // Fan triangulation
+        const uint32_t current = table.Insert(corner, chunk.corners);
+        if (cornerCount == 0) {
+          first = current;
+        } else if (cornerCount >= 2) {
+          chunk.indices.push_back(first);
+          chunk.indices.push_back(previous);
+          chunk.indices.push_back(current);
+        }
+        previous = current;
+        cornerCount++;
+      }
+      return true;
+    }
+    default:
+      return true;
+    }
+  });
+}
+
+size_t LineNumber(const char *data, const char *line) {
+  return static_cast<size_t>(std::count(data, line, '\n')) + 1;
+}
+
+} // namespace
+
+namespace ObjLoader {
+
+bool Load(const std::string &filepath, std::vector<Vertex> &vertices,
+          std::vector<uint32_t> &indices) {
+  MappedFile file;
+  if (!file.Open(filepath)) {
+    return false;
+  }
+  if (!Parse(file.GetData(), file.GetSize(), vertices, indices)) {
+    std::cerr << "ObjLoader: failed to load " << filepath << std::endl;
+    return false;
+  }
+  return true;
+}
+
+bool Parse(const char *data, size_t size, std::vector<Vertex> &vertices,
+           std::vector<uint32_t> &indices) {
+  vertices.clear();
+  indices.clear();
+  if (size == 0) {
+    return true;
+  }
+  const char *end = data + size;
+
+  // Split at line boundaries
+  JobSystem &jobs = JobSystem::Instance();
+  const size_t threads = jobs.GetWorkerCount() + 1;
+  const size_t chunkSize =
+      std::max(MIN_CHUNK_SIZE, size / (threads * CHUNKS_PER_THREAD) + 1);
+  std::vector<Chunk> chunks;
+  for (const char *begin = data; begin < end;) {
+    const char *split = begin + std::min(chunkSize, size_t(end - begin));
+    if (split < end) {
+      const void *newline = std::memchr(split, '\n', end - split);
+      split = newline ? static_cast<const char *>(newline) + 1 : end;
+    }
+    chunks.emplace_back();
+    chunks.back().begin = begin;
+    chunks.back().end = split;
+    begin = split;
+  }
+
+  // Attribute records are written in place, so count them first to know
+  // where each chunk's records go and how far relative indices reach
+  jobs.ParallelFor(chunks.size(), 1, [&](size_t first, size_t last) {
+    for (size_t i = first; i < last; i++) {
+      CountRecords(chunks[i]);
+    }
+  });
+  AttributeCounts totals;
+  for (Chunk &chunk : chunks) {
+    chunk.offsets = totals;
+    totals.positions += chunk.counts.positions;
+    totals.texCoords += chunk.counts.texCoords;
+    totals.normals += chunk.counts.normals;
+  }
+  if (totals.positions >= NONE || totals.texCoords >= NONE ||
+      totals.normals >= NONE) {
+    std::cerr << "ObjLoader: too many vertices" << std::endl;
+    return false;
+  }
+
+  Attributes attributes;
+  attributes.positions.resize(totals.positions);
+  attributes.texCoords.resize(totals.texCoords);
+  attributes.normals.resize(totals.normals);
+  jobs.ParallelFor(chunks.size(), 1, [&](size_t first, size_t last) {
+    for (size_t i = first; i < last; i++) {
+      ParseChunk(chunks[i], totals, attributes);
+    }
+  });
+  for (const Chunk &chunk : chunks) {
+    if (chunk.error) {
+      std::cerr << "ObjLoader: " << chunk.error << " on line "
+                << LineNumber(data, chunk.errorLine) << std::endl;
+      return false;
+    }
+  }
+
+  // Merge the per-chunk corners; only corners shared across chunk
+  // boundaries are found twice
+  size_t cornerCount = 0;
+  size_t indexCount = 0;
+  for (Chunk &chunk : chunks) {
+    cornerCount += chunk.corners.size();
+    chunk.indexOffset = indexCount;
+    indexCount += chunk.indices.size();
+  }
+  std::vector<Corner> corners;
+  if (chunks.size() == 1) {
+    corners = std::move(chunks[0].corners);
+  } else {
+    CornerTable table;
+    table.Reserve(cornerCount, corners);
+    for (Chunk &chunk : chunks) {
+      chunk.remap.resize(chunk.corners.size());
+      for (size_t i = 0; i < chunk.corners.size(); i++) {
+        chunk.remap[i] = table.Insert(chunk.corners[i], corners);
+      }
+      std::vector<Corner>().swap(chunk.corners);
+    }
+  }
+
+  indices.resize(indexCount);
+  jobs.ParallelFor(chunks.size(), 1, [&](size_t first, size_t last) {
+    for (size_t i = first; i < last; i++) {
+      const Chunk &chunk = chunks[i];
+      uint32_t *out = indices.data() + chunk.indexOffset;
+      if (chunk.remap.empty()) {
+        std::copy(chunk.indices.begin(), chunk.indices.end(), out);
+      } else {
+        for (size_t j = 0; j < chunk.indices.size(); j++) {
+          out[j] = chunk.remap[chunk.indices[j]];
+        }
+      }
+    }
+  });
+
+  // Area weighted normals per position, for corners the file gives none
+  std::vector<Vector3> generated;
+  const bool missingNormals =
+      std::any_of(corners.begin(), corners.end(),
+                  [](const Corner &corner) { return corner.normal == NONE; });
+  if (missingNormals) {
+    generated.assign(totals.positions, Vector3(0.0f, 0.0f, 0.0f));
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+      const uint32_t a = corners[indices[i]].position;
+      const uint32_t b = corners[indices[i + 1]].position;
+      const uint32_t c = corners[indices[i + 2]].position;
+      const Vector3 &pa = attributes.positions[a];
+      const Vector3 face = (attributes.positions[b] - pa)
+                               .Cross(attributes.positions[c] - pa);
+      generated[a] += face;
+      generated[b] += face;
+      generated[c] += face;
+    }
+  }
+
+  vertices.resize(corners.size());
+  jobs.ParallelFor(corners.size(), 4096, [&](size_t first, size_t last) {
+    for (size_t i = first; i < last; i++) {
+      const Corner &corner = corners[i];
+      Vertex &vertex = vertices[i];
+      vertex.position = attributes.positions[corner.position];
+      vertex.texCoord = corner.texCoord != NONE
+                            ? attributes.texCoords[corner.texCoord]
+                            : Vector2(0.0f, 0.0f);
+      if (corner.normal != NONE) {
+        vertex.normal = attributes.normals[corner.normal];
+      } else {
+        const Vector3 &sum = generated[corner.position];
+        const float length = sum.Length();
+        vertex.normal =
+            length > 0.0f ? sum / length : Vector3(0.0f, 1.0f, 0.0f);
+      }
+    }
+  });
+  return true;
+}
+
+} // namespace ObjLoader
+
+} // namespace AquaVisual
@@ -1,5 +1,8 @@
 #include "AquaVisual/Primitives.h"
+#include "AquaVisual/Resources/MeshOptimizer.h"
+#include "AquaVisual/Resources/MeshSimplifier.h"
 #include <cmath>
+#include <utility>
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
@@ -61,7 +64,11 @@ std::unique_ptr<Mesh> CreateSphere(float radius, int segments) {
     }
   }
 
-  return std::make_unique<Mesh>(vertices, indices);
+  // 生成LOD链，再按顶点缓存和过度绘制优化三角形与顶点顺序
+  auto mesh = std::make_unique<Mesh>(std::move(vertices), std::move(indices));
+  MeshSimplifier::GenerateLods(*mesh);
+  MeshOptimizer::Optimize(*mesh);
+  return mesh;
 }
 
 std::unique_ptr<Mesh> CreatePlane(float width, float height, int widthSegments,
@@ -107,7 +114,10 @@ std::unique_ptr<Mesh> CreatePlane(float width, float height, int widthSegments,
     }
   }
 
-  return std::make_unique<Mesh>(vertices, indices);
+  // 按顶点缓存和过度绘制优化三角形与顶点顺序
+  auto mesh = std::make_unique<Mesh>(std::move(vertices), std::move(indices));
+  MeshOptimizer::Optimize(*mesh);
+  return mesh;
 }
 
 } // namespace Primitives
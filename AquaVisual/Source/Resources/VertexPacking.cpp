@@ -0,0 +1,181 @@
+#include "AquaVisual/Resources/VertexPacking.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace AquaVisual {
+namespace VertexPacking {
+
+static_assert(sizeof(PackedVertex) == 16, "packed vertices are 16 bytes");
+
+namespace {
+
+uint16_t QuantizeUnorm16(float value) {
+  value = std::min(std::max(value, 0.0f), 1.0f);
+  return static_cast<uint16_t>(std::lround(value * 65535.0f));
+}
+
+int16_t QuantizeSnorm16(float value) {
+  value = std::min(std::max(value, -1.0f), 1.0f);
+  return static_cast<int16_t>(std::lround(value * 32767.0f));
+}
+
+float SignNotZero(float value) { return value >= 0.0f ? 1.0f : -1.0f; }
+
+} // namespace
+
+VertexQuantization ComputeQuantization(const AABB &bounds) {
+  VertexQuantization quantization;
+  if (!bounds.IsValid()) {
+    return quantization;
+  }
+  const float minimum[3] = {bounds.minimum.x, bounds.minimum.y,
+                            bounds.minimum.z};
+  const float maximum[3] = {bounds.maximum.x, bounds.maximum.y,
+                            bounds.maximum.z};
+  for (int axis = 0; axis < 3; axis++) {
+    quantization.offset[axis] = minimum[axis];
+    quantization.scale[axis] = maximum[axis] - minimum[axis];
+  }
+  return quantization;
+}
+
+void Pack(ArrayView<Vertex> vertices, const VertexQuantization &quantization,
+          PackedVertex *out) {
+  // Flat axes map everything to the offset
+  float inverseScale[3];
+  for (int axis = 0; axis < 3; axis++) {
+    inverseScale[axis] = quantization.scale[axis] > 0.0f
+                             ? 1.0f / quantization.scale[axis]
+                             : 0.0f;
+  }
+
+  for (size_t i = 0; i < vertices.size(); i++) {
+    const Vertex &vertex = vertices[i];
+    PackedVertex &packed = out[i];
+    const float position[3] = {vertex.position.x, vertex.position.y,
+                               vertex.position.z};
+    for (int axis = 0; axis < 3; axis++) {
+      packed.position[axis] = QuantizeUnorm16(
+          (position[axis] - quantization.offset[axis]) * inverseScale[axis]);
+    }
+    packed.position[3] = 0;
+    EncodeOctahedral(vertex.normal, packed.normal);
+    packed.texCoord[0] = FloatToHalf(vertex.texCoord.x);
+    packed.texCoord[1] = FloatToHalf(vertex.texCoord.y);
+  }
+}
+
+Vertex Unpack(const PackedVertex &vertex,
+              const VertexQuantization &quantization) {
+  float position[3];
+  for (int axis = 0; axis < 3; axis++) {
+    position[axis] = quantization.offset[axis] +
+                     vertex.position[axis] / 65535.0f *
+                         quantization.scale[axis];
+  }
+  return Vertex(Vec3(position[0], position[1], position[2]),
+                DecodeOctahedral(vertex.normal),
+                Vec2(HalfToFloat(vertex.texCoord[0]),
+                     HalfToFloat(vertex.texCoord[1])));
+}
+
+void EncodeOctahedral(const Vec3 &normal, int16_t out[2]) {
+  const float length =
+      std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+  if (length <= 0.0f) {
+    out[0] = 0;
+    out[1] = 0;
+    return;
+  }
+
+  // Project onto the octahedron, then fold the lower half over the upper
+  float x = normal.x / length;
+  float y = normal.y / length;
+  if (normal.z < 0.0f) {
+    const float foldedX = (1.0f - std::abs(y)) * SignNotZero(x);
+    y = (1.0f - std::abs(x)) * SignNotZero(y);
+    x = foldedX;
+  }
+  out[0] = QuantizeSnorm16(x);
+  out[1] = QuantizeSnorm16(y);
+}
+
+Vec3 DecodeOctahedral(const int16_t encoded[2]) {
+  // snorm16 decoding as done by the vertex fetch
+  const float x = std::max(encoded[0] / 32767.0f, -1.0f);
+  const float y = std::max(encoded[1] / 32767.0f, -1.0f);
+  Vec3 normal(x, y, 1.0f - std::abs(x) - std::abs(y));
+  const float fold = std::max(-normal.z, 0.0f);
+  normal.x += normal.x >= 0.0f ? -fold : fold;
+  normal.y += normal.y >= 0.0f ? -fold : fold;
+  const float length = normal.Length();
+  return length > 0.0f ? normal / length : Vec3(0.0f, 0.0f, 1.0f);
+}
+
+uint16_t FloatToHalf(float value) {
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  const uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000u);
+  const uint32_t magnitude = bits & 0x7FFFFFFFu;
+
+  if (magnitude >= 0x7F800000u) {
+    // Infinity stays infinite, NaN stays quiet NaN
+    return sign | (magnitude > 0x7F800000u ? 0x7E00u : 0x7C00u);
+  }
+  if (magnitude >= 0x477FF000u) {
+    return sign | 0x7C00u; // rounds past 65504
+  }
+  if (magnitude < 0x38800000u) {
+    // Subnormal half: align the implicit bit to 2^-24 units, then round
+    if (magnitude < 0x33000000u) {
+      return sign; // below half the smallest subnormal
+    }
+    const uint32_t exponent = magnitude >> 23;
+    const uint32_t mantissa = (magnitude & 0x7FFFFFu) | 0x800000u;
+    const uint32_t shift = 126 - exponent;
+    uint32_t half = mantissa >> shift;
+    const uint32_t remainder = mantissa & ((1u << shift) - 1);
+    const uint32_t halfway = 1u << (shift - 1);
+    if (remainder > halfway || (remainder == halfway && (half & 1u))) {
+      half++;
+    }
+    return sign | static_cast<uint16_t>(half);
+  }
+
+  // Normal range: rebias the exponent and round the dropped 13 bits; a
+  // carry out of the mantissa correctly bumps the exponent
+  uint32_t half = (magnitude - 0x38000000u) >> 13;
+  const uint32_t remainder = magnitude & 0x1FFFu;
+  if (remainder > 0x1000u || (remainder == 0x1000u && (half & 1u))) {
+    half++;
+  }
+  return sign | static_cast<uint16_t>(half);
+}
+
+float HalfToFloat(uint16_t value) {
+  const uint32_t sign = static_cast<uint32_t>(value & 0x8000u) << 16;
+  const uint32_t exponent = (value >> 10) & 0x1Fu;
+  const uint32_t mantissa = value & 0x3FFu;
+
+  uint32_t bits;
+  if (exponent == 0x1Fu) {
+    bits = sign | 0x7F800000u | (mantissa << 13);
+  } else if (exponent != 0) {
+    bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+  } else if (mantissa != 0) {
+    // Subnormal, value = mantissa * 2^-24
+    const float magnitude = std::ldexp(static_cast<float>(mantissa), -24);
+    std::memcpy(&bits, &magnitude, sizeof(bits));
+    bits |= sign;
+  } else {
+    bits = sign;
+  }
+
+  float result;
+  std::memcpy(&result, &bits, sizeof(result));
+  return result;
+}
+
+} // namespace VertexPacking
+} // namespace AquaVisual